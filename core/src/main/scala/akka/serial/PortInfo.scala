@@ -0,0 +1,11 @@
+package akka.serial
+
+/**
+ * A serial port known to the inventory of ports.
+ *
+ * @param port absolute path of the port's node, e.g. "/dev/ttyUSB0"
+ * @param aliases absolute paths of links to the port, e.g. in "/dev/serial/by-id"
+ * @param device attributes of the port's device
+ * @param open set if the port has been opened through the manager and is not closed yet
+ */
+case class PortInfo(port: String, aliases: Set[String], device: DeviceInfo, open: Boolean)
@@ -0,0 +1,211 @@
+package akka.serial
+
+import akka.actor.{ Actor, ActorRef, Props, Terminated }
+import java.nio.file.{ FileSystems, Files, Path, Paths }
+import scala.collection.JavaConverters._
+import scala.util.{ Failure, Success, Try }
+import sync.DeviceMonitor
+
+/**
+ * Keeps an index of the serial ports present on the system, on behalf of the manager.
+ *
+ * The index is built on the first query, from the ttys present at that time, and is kept up to
+ * date by a thread that blocks on a native monitor of devices. Attributes of ports are looked up
+ * in sysfs by this thread as they are connected, so that queries are answered from the index
+ * alone. Aliases of ports, i.e. links created by udev such as those in /dev/serial/by-id, are
+ * listed again after ports have been connected or disconnected, and when a port is looked up by a
+ * path that is not indexed, since udev creates them after the kernel reports a port.
+ *
+ * @param aliasDirectories directories of links to ports, such as "/dev/serial/by-id"
+ * @param source file from which the monitor reads hotplug events instead of the kernel, see
+ * `DeviceMonitor.open()`
+ */
+private[serial] class PortInventory(aliasDirectories: Seq[String], source: Option[String]) extends Actor {
+  import PortInventory._
+
+  case class Added(port: String, info: Option[DeviceInfo])
+  case class Removed(port: String)
+  case class InventoryDied(reason: Throwable)
+
+  class MonitorThread(monitor: DeviceMonitor) extends Thread {
+    setName("serial-port-inventory")
+    setDaemon(true)
+
+    override def run(): Unit = {
+      var stop = false
+      while (!stop) {
+        try {
+          monitor.next() match {
+            case Some(DeviceMonitor.Connected(port)) =>
+              self.tell(Added(port, DeviceMonitor.info(port)), Actor.noSender)
+            case Some(DeviceMonitor.Disconnected(port)) =>
+              self.tell(Removed(port), Actor.noSender)
+            case None => stop = true // injected source ended
+          }
+        } catch {
+          case _: PortInterruptedException => stop = true
+          case _: PortClosedException => stop = true
+          case ex: Exception =>
+            self.tell(InventoryDied(ex), Actor.noSender)
+            stop = true
+        }
+      }
+    }
+  }
+
+  // monitor of ports, opened on the first query
+  private var monitor: Option[DeviceMonitor] = None
+
+  // port -> attributes, and indexes of ports by attributes of their USB devices
+  private var devices: Map[String, DeviceInfo] = Map.empty
+  private var bySerial: Map[String, Set[String]] = Map.empty
+  private var byVendor: Map[Int, Set[String]] = Map.empty
+
+  // alias -> port, and port -> aliases
+  private var aliases: Map[String, String] = Map.empty
+  private var portAliases: Map[String, Set[String]] = Map.empty
+  private var aliasesStale = true
+
+  // operator -> port, of ports that are open whether indexed or not
+  private var operators: Map[ActorRef, String] = Map.empty
+  private var openPorts: Set[String] = Set.empty
+
+  private def addTo[K](index: Map[K, Set[String]], key: K, port: String) =
+    index.updated(key, index.getOrElse(key, Set.empty) + port)
+
+  private def removeFrom[K](index: Map[K, Set[String]], key: K, port: String) = {
+    val ports = index.getOrElse(key, Set.empty) - port
+    if (ports.isEmpty) index - key else index.updated(key, ports)
+  }
+
+  def add(port: String, info: DeviceInfo): Unit = {
+    remove(port) // a port may be replaced by another device with the same name
+    devices += port -> info
+    info.serial.foreach(serial => bySerial = addTo(bySerial, serial, port))
+    info.vendor.foreach(vendor => byVendor = addTo(byVendor, vendor, port))
+    aliasesStale = true
+  }
+
+  def remove(port: String): Unit = devices.get(port) foreach { info =>
+    devices -= port
+    info.serial.foreach(serial => bySerial = removeFrom(bySerial, serial, port))
+    info.vendor.foreach(vendor => byVendor = removeFrom(byVendor, vendor, port))
+    aliasesStale = true
+  }
+
+  /** Lists the links in the alias directories, which udev creates with paths relative to them. */
+  def scanAliases(): Unit = {
+    val links = for {
+      directory <- aliasDirectories.map(Paths.get(_)) if Files.isDirectory(directory)
+      link <- list(directory) if Files.isSymbolicLink(link)
+      target <- Try(link.resolveSibling(Files.readSymbolicLink(link)).normalize).toOption
+    } yield link.toString -> target.toString
+    aliases = links.toMap
+    portAliases = links.groupBy(_._2).map { case (port, ls) => port -> ls.map(_._1).toSet }
+    aliasesStale = false
+  }
+
+  /** Opens the monitor and indexes the ports present, unless already done. */
+  def open(): Unit = if (monitor.isEmpty) {
+    val m = DeviceMonitor.open(DeviceDirectory, Seq(DeviceFilter()), initial = true, source)
+    try {
+      for (_ <- 0 until m.pending(); DeviceMonitor.Connected(port) <- m.next()) {
+        DeviceMonitor.info(port).foreach(add(port, _))
+      }
+    } catch {
+      case ex: Exception =>
+        m.close()
+        throw ex
+    }
+    monitor = Some(m)
+    new MonitorThread(m).start()
+  }
+
+  def matches(port: String, filter: DeviceFilter): Boolean = {
+    filter.subsystem.forall(_ == "tty") &&
+      filter.name.forall(pattern => matcher(pattern).matches(Paths.get(port).getFileName)) &&
+      devices(port).matches(filter)
+  }
+
+  /** Selects the ports matching a filter, through the most selective index that applies. */
+  def select(filter: DeviceFilter): Set[String] = {
+    val candidates = filter.serial.map(bySerial.getOrElse(_, Set.empty[String]))
+      .orElse(filter.vendor.map(byVendor.getOrElse(_, Set.empty[String])))
+      .getOrElse(devices.keySet)
+    candidates.filter(matches(_, filter))
+  }
+
+  def describe(port: String): PortInfo =
+    PortInfo(port, portAliases.getOrElse(port, Set.empty), devices(port), openPorts.contains(port))
+
+  def query(command: Serial.Command)(answer: => Serial.Ports) = {
+    Try {
+      open()
+      if (aliasesStale) scanAliases()
+      answer
+    } match {
+      case Success(ports) => sender ! ports
+      case Failure(err) => sender ! Serial.CommandFailed(command, err)
+    }
+  }
+
+  override def receive = {
+
+    case list @ Serial.ListPorts(filters) => query(list) {
+      val ports = if (filters.isEmpty) devices.keySet else filters.flatMap(select).toSet
+      Serial.Ports(ports.toSeq.sorted.map(describe))
+    }
+
+    case lookup @ Serial.LookupPort(port) => query(lookup) {
+      val path = Paths.get(port).toAbsolutePath.normalize.toString
+      def find = if (devices.contains(path)) Some(path) else aliases.get(path).filter(devices.contains)
+      val found = find orElse {
+        scanAliases() // the alias may have been created since the last scan
+        find
+      }
+      Serial.Ports(found.map(describe).toSeq)
+    }
+
+    case Opened(port, operator) =>
+      val path = Try(Paths.get(port).toRealPath().toString).getOrElse(port)
+      context watch operator
+      operators += operator -> path
+      openPorts += path
+
+    case Terminated(operator) =>
+      operators.get(operator) foreach { port =>
+        operators -= operator
+        openPorts -= port
+      }
+
+    case Added(port, info) => info.foreach(add(port, _))
+
+    case Removed(port) => remove(port)
+
+    case InventoryDied(err) => throw err // go down with monitor thread
+
+  }
+
+  override def postStop() = {
+    monitor.foreach(_.close())
+  }
+
+}
+
+private[serial] object PortInventory {
+  private val DeviceDirectory = "/dev"
+
+  /** A port has been opened and is served by the given operator, until it terminates. */
+  case class Opened(port: String, operator: ActorRef)
+
+  private def matcher(pattern: String) = FileSystems.getDefault().getPathMatcher("glob:" + pattern)
+
+  private def list(directory: Path): Seq[Path] = {
+    val stream = Files.newDirectoryStream(directory)
+    try stream.asScala.toList finally stream.close()
+  }
+
+  def apply(aliasDirectories: Seq[String], source: Option[String] = None) =
+    Props(classOf[PortInventory], aliasDirectories, source)
+
+}
@@ -0,0 +1,136 @@
+package akka.serial
+
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.atomic.AtomicLong
+import scala.util.control.NonFatal
+
+import sync.{SerialConnection, SerialReactor}
+
+/**
+  * A fixed group of threads that serve reads of many serial ports. Every thread waits on its own
+  * native reactor and dispatches readiness of its ports to their handlers. Ports are assigned to
+  * threads in a round-robin fashion.
+  *
+  * @param threads number of reactor threads
+  * @param batchSize maximum number of ready ports handled per wakeup
+  */
+private[serial] class ReactorGroup(threads: Int, batchSize: Int) {
+  import ReactorGroup._
+
+  // token -> registration, shared by all threads
+  private val registrations = new ConcurrentHashMap[Long, Registration]
+
+  // tokens must be non-zero
+  private val nextToken = new AtomicLong(1)
+
+  private class ReactorThread(index: Int) extends Thread {
+    val reactor = SerialReactor.open()
+
+    override def run(): Unit = {
+      this.setName(s"serial-reactor-$index")
+      val tokens = new Array[Long](batchSize)
+      var stop = false
+      while (!reactor.isClosed && !stop) {
+        try {
+          val n = reactor.await(tokens)
+          var i = 0
+          while (i < n) {
+            val registration = registrations.get(tokens(i))
+            // connection may have been removed after the wait returned
+            if (registration != null) dispatch(tokens(i), registration.handler)
+            i += 1
+          }
+        } catch {
+          case _: PortInterruptedException => stop = true
+          case _: PortClosedException => stop = true
+        }
+      }
+    }
+  }
+
+  private val reactorThreads = {
+    val started = new collection.mutable.ArrayBuffer[ReactorThread](threads)
+    try {
+      for (i <- 0 until threads) {
+        val thread = new ReactorThread(i)
+        thread.setDaemon(true)
+        started += thread
+        thread.start()
+      }
+      started.toArray
+    } catch {
+      // a reactor may fail to open, e.g. when running out of file descriptors
+      case ex: Throwable =>
+        started foreach { thread =>
+          try {
+            thread.reactor.close()
+          } catch {
+            case NonFatal(suppressed) => ex.addSuppressed(suppressed)
+          }
+        }
+        throw ex
+    }
+  }
+
+  private def threadOf(token: Long) = reactorThreads((token % threads).toInt)
+
+  private def dispatch(token: Long, handler: Handler): Unit = try {
+    handler.ready()
+  } catch {
+    // an erroneous connection stays ready, hence it must not be waited on any longer
+    case NonFatal(ex) =>
+      unregister(token)
+      handler.failed(ex)
+  }
+
+  /**
+    * Registers a connection, its handler will be called from a reactor thread whenever the
+    * connection is readable. Note that, since the handler is always called from the same thread,
+    * it does not need to be thread-safe.
+    * @return a token identifying the registration
+    */
+  def register(connection: SerialConnection, handler: Handler): Long = {
+    val token = nextToken.getAndIncrement()
+    registrations.put(token, Registration(connection, handler))
+    try {
+      threadOf(token).reactor.register(connection, token)
+    } catch {
+      case ex: Exception =>
+        registrations.remove(token)
+        throw ex
+    }
+    token
+  }
+
+  /**
+    * Removes a previously registered connection. This must be called before the connection is
+    * closed. Removing a connection more than once has no effect.
+    * @param token token returned by the connection's registration
+    */
+  def unregister(token: Long): Unit = {
+    val registration = registrations.remove(token)
+    if (registration != null) threadOf(token).reactor.unregister(registration.connection)
+  }
+
+  /** Stops all reactor threads. Registered connections are not closed. */
+  def close(): Unit = reactorThreads foreach { thread =>
+    thread.reactor.close()
+  }
+
+}
+
+private[serial] object ReactorGroup {
+
+  /** Callbacks invoked from a reactor thread. */
+  trait Handler {
+
+    /** The connection is readable. */
+    def ready(): Unit
+
+    /** `ready()` threw an exception, the connection has been unregistered. */
+    def failed(cause: Throwable): Unit
+  }
+
+  private case class Registration(connection: SerialConnection, handler: Handler)
+
+}
@@ -2,6 +2,7 @@ package akka.serial
 
 import akka.actor.{ActorSystem, ExtendedActorSystem, ExtensionId, ExtensionIdProvider}
 import akka.util.ByteString
+import scala.concurrent.duration._
 
 /** Defines messages used by akka-serial's serial IO layer. */
 object Serial extends ExtensionId[SerialExt] with ExtensionIdProvider {
@@ -33,12 +34,24 @@ object Serial extends ExtensionId[SerialExt] with ExtensionIdProvider {
    *
    * In case the port is successfully opened, the operator will respond with an `Opened` message.
    * In case the port cannot be opened, the manager will respond with a `CommandFailed` message.
+   * Ports are opened concurrently, hence a port that is slow to open does not delay others.
    *
    * @param port name of serial port to open
    * @param settings settings of serial port to open
    * @param bufferSize maximum read and write buffer sizes
+   * @param leased set to receive data in buffers leased from the shared pool of the serial
+   * manager, as `ReceivedLease` messages instead of `Received` messages, which saves copying and
+   * allocating every chunk of data. Ports read into receive rings are not affected.
+   * @param timestamped set to receive data as `ReceivedTimestamped` messages instead of `Received`
+   * messages, which carry the times at which the data was read
    */
-  case class Open(port: String, settings: SerialSettings, bufferSize: Int = 1024) extends Command
+  case class Open(
+    port: String,
+    settings: SerialSettings,
+    bufferSize: Int = 1024,
+    leased: Boolean = false,
+    timestamped: Boolean = false
+  ) extends Command
 
   /**
    * A port has been successfully opened.
@@ -46,9 +59,38 @@ object Serial extends ExtensionId[SerialExt] with ExtensionIdProvider {
    * Event sent by a port operator, indicating that a serial port was successfully opened. The sender
    * of this message is the operator associated to the given serial port.
    *
+   * The achieved settings are kept in a second parameter list, so that they are neither matched
+   * by `case Opened(port)` nor compared by equality.
+   *
    * @param port name of opened serial port
+   * @param settings settings actually in effect on the port, which may differ from the requested
+   * ones depending on the port's hardware and driver
+   */
+  case class Opened(port: String)(val settings: AchievedSettings) extends Event
+
+  /**
+   * Open several serial ports at once.
+   *
+   * Send this command to the serial manager to open all of the given ports concurrently, e.g. to
+   * reconnect to the adapters of a hub that has been re-enumerated, which then takes as long as
+   * the slowest port rather than the sum of all. Every port is opened as if by its own `Open`
+   * command, hence its operator responds with an `Opened` message, or the manager with a
+   * `CommandFailed` message, as soon as the port has been opened or failed. Once all ports have
+   * done so, the manager responds with an `OpenAllCompleted` message.
+   *
+   * @param ports commands opening the ports
    */
-  case class Opened(port: String) extends Event
+  case class OpenAll(ports: Seq[Open]) extends Command
+
+  /**
+   * All ports of an `OpenAll` command have been opened or failed.
+   *
+   * Note that the `Opened` messages of operators may arrive after this message.
+   *
+   * @param opened names of the ports that were opened, in the order they were opened
+   * @param failed ports that could not be opened
+   */
+  case class OpenAllCompleted(opened: Seq[String], failed: Seq[CommandFailed]) extends Event
 
   /**
    * Data has been received.
@@ -59,6 +101,59 @@ object Serial extends ExtensionId[SerialExt] with ExtensionIdProvider {
    */
   case class Received(data: ByteString) extends Event
 
+  /**
+   * Data has been received, along with timestamps of its way through akka-serial.
+   *
+   * Event sent by an operator instead of `Received`, if its port was opened with timestamps.
+   *
+   * @param data data received on the port
+   * @param timestamps times at which the data was read, see `ReceiveTimestamps`
+   */
+  case class ReceivedTimestamped(data: ByteString, timestamps: ReceiveTimestamps) extends Event
+
+  /**
+   * Data has been received into a leased buffer.
+   *
+   * Event sent by an operator instead of `Received`, if its port was opened with leased reads.
+   * The data is not copied out of the direct buffer it was read into, which the client holds
+   * until it releases the lease. The client must release every lease once it is done with its
+   * data, and copy any data it wishes to keep beyond that; buffers that are not released are not
+   * returned to the pool and have to be allocated again.
+   *
+   * @param lease lease of the buffer that holds the data, between its position and limit
+   * @param timestamps times at which the data was read, see `ReceiveTimestamps`
+   */
+  case class ReceivedLease(lease: sync.BufferLease, timestamps: ReceiveTimestamps) extends Event {
+
+    /** A read-only view of the received data, valid until the lease is released. */
+    def data: java.nio.ByteBuffer = lease.data
+
+    /** Releases the lease, returning its buffer to the pool. */
+    def release(): Unit = lease.release()
+
+  }
+
+  /**
+   * Times at which received data passed through akka-serial, in nanoseconds of a monotonic clock
+   * (see `sync.SerialConnection.timestamp`), which on Linux is the same as the one of
+   * `System.nanoTime`. Comparing them to the time at which a client handles a received message
+   * breaks down the latency of each hop.
+   *
+   * When reading into a receive ring, the data of a message may stem from several reads, in which
+   * case the time of the last one is given.
+   *
+   * @param read time at which the data was read by the native backend, right after the read system
+   * call returned
+   * @param returned time at which the native read returned to the JVM, or, with a receive ring, at
+   * which the ring was drained
+   */
+  case class ReceiveTimestamps(read: Long, returned: Long)
+
+  object ReceiveTimestamps {
+    /** Timestamps of data that did not pass through a serial port. */
+    val Unknown = ReceiveTimestamps(0L, 0L)
+  }
+
   /**
    * Write data to a serial port.
    *
@@ -74,6 +169,33 @@ object Serial extends ExtensionId[SerialExt] with ExtensionIdProvider {
    */
   case class Write(data: ByteString, ack: Int => Event = NoAck) extends Command
 
+  /**
+   * Write data to a serial port and confirm its transmission.
+   *
+   * As with `Write`, however the acknowledgment is only sent back once the data has physically
+   * been transmitted, i.e. once the port's queues have drained (and, if its driver can tell, the
+   * last character has left the UART). Waiting for transmission does not block the operator,
+   * other commands are still handled meanwhile. This is useful for half-duplex protocols, which
+   * must not listen for a response before the request has been sent, and for measuring latency.
+   *
+   * Note that data written after this command delays its acknowledgment, since the port is only
+   * ever considered drained as a whole.
+   *
+   * @param data data to be written to port
+   * @param ack acknowledgment sent back to sender once data has been transmitted
+   */
+  case class WriteDrained(data: ByteString, ack: Transmitted => Event) extends Command
+
+  /**
+   * Timestamps of a write that has been transmitted, see `WriteDrained`. Timestamps are in
+   * nanoseconds of a monotonic clock, which on Linux is the same as the one of `System.nanoTime`.
+   *
+   * @param length number of bytes written
+   * @param queued time at which all data has been accepted by the port
+   * @param drained time at which all data has been found transmitted
+   */
+  case class Transmitted(length: Int, queued: Long, drained: Long)
+
   /**
    *  Special type of acknowledgment that is not sent back.
    */
@@ -81,6 +203,98 @@ object Serial extends ExtensionId[SerialExt] with ExtensionIdProvider {
     def apply(length: Int) = sys.error("cannot apply NoAck")
   }
 
+  /**
+   * Stop reading from a serial port.
+   *
+   * Send this command to an operator to stop receiving `Received` messages, e.g. while a client
+   * cannot keep up with incoming data. Data that is already being read may still be delivered.
+   * Further data is left in the operating system's buffer, which, once full, pauses the remote
+   * device if flow control is enabled in the port's settings (otherwise data is dropped).
+   */
+  case object SuspendReading extends Command
+
+  /**
+   * Resume reading from a serial port, after it has been suspended with `SuspendReading`.
+   */
+  case object ResumeReading extends Command
+
+  /**
+   * Query the depths of a serial port's queues.
+   *
+   * Send this command to an operator to get the number of bytes waiting in its port's queues. The
+   * operator will respond with a `QueueDepths` message.
+   */
+  case object GetQueueDepths extends Command
+
+  /**
+   * Depths of a serial port's queues, in response to `GetQueueDepths`.
+   *
+   * @param input number of bytes received by the operating system but not yet read
+   * @param output number of bytes written but not yet transmitted
+   */
+  case class QueueDepths(input: Int, output: Int) extends Event
+
+  /**
+   * Query statistics of a serial port.
+   *
+   * Send this command to an operator to get the counts of data transferred over its port and of
+   * errors on the line. The operator will respond with a `Stats` message.
+   */
+  case object GetStats extends Command
+
+  /**
+   * Statistics of a serial port, in response to `GetStats`.
+   *
+   * @param stats statistics counted since the port was opened
+   */
+  case class Stats(stats: SerialStats) extends Event
+
+  /**
+   * Thresholds of a queue's depth, in bytes. A queue is considered full once its depth reaches
+   * the high watermark, and empty again once its depth falls to the low watermark.
+   */
+  case class Watermarks(low: Int, high: Int) {
+    require(low >= 0 && low < high, "watermarks must satisfy 0 <= low < high")
+  }
+
+  /**
+   * Watch the depths of a serial port's queues.
+   *
+   * Send this command to an operator to be notified whenever the depth of its port's input or
+   * output queue crosses a watermark. Depths are sampled periodically, the output queue is also
+   * sampled after every write. Every crossing is reported once, i.e. a queue that reached its high
+   * watermark is reported again only after it fell to its low watermark. A subsequent command
+   * replaces any previous one.
+   *
+   * @param input watermarks of the input queue (data received but not yet read), none to not
+   * watch the input queue
+   * @param output watermarks of the output queue (data written but not yet transmitted), none to
+   * not watch the output queue
+   * @param interval time between samples of the queues' depths
+   */
+  case class WatchQueues(
+    input: Option[Watermarks] = None,
+    output: Option[Watermarks] = None,
+    interval: FiniteDuration = 10.millis
+  ) extends Command
+
+  /**
+   * Stop watching the depths of a serial port's queues.
+   */
+  case object UnwatchQueues extends Command
+
+  /** The input queue of a watched port reached its high watermark. */
+  case class InputQueueHigh(depth: Int) extends Event
+
+  /** The input queue of a watched port fell to its low watermark. */
+  case class InputQueueLow(depth: Int) extends Event
+
+  /** The output queue of a watched port reached its high watermark. */
+  case class OutputQueueHigh(depth: Int) extends Event
+
+  /** The output queue of a watched port fell to its low watermark. */
+  case class OutputQueueLow(depth: Int) extends Event
+
   /**
    *  Request closing of port.
    *
@@ -97,21 +311,33 @@ object Serial extends ExtensionId[SerialExt] with ExtensionIdProvider {
   case object Closed extends Event
 
   /**
-   * Watch a directory for new ports.
+   * Watch a directory for ports being connected and disconnected.
    *
-   * Send this command to the manager to get notifications when a new port (i.e. file) is created in
-   * the given directory.
+   * Send this command to the manager to get notifications when a port matching any of the given
+   * filters is connected, i.e. its node is created in the given directory, and when it is
+   * disconnected again.
    * In case the given directory cannot be watched, the manager responds with a `CommandFailed` message.
    *
+   * On Linux, devices in /dev are monitored through the kernel's hotplug events (uevents) and
+   * filtered by the native backend, including by the attributes of the USB devices behind them.
+   * Other directories, and /dev on other platforms, are watched themselves; ports are then only
+   * filtered by name, and filters selecting USB devices match none.
+   *
    * Note: the sender is also notified of currently existing ports.
    *
    * @param directory the directory to watch
    * @param skipInitial don't get notified of already existing ports
+   * @param filters filters of the ports to notify about, any port (i.e. device node) if empty
    *
    * @see Unwatch
    * @see Connected
+   * @see Disconnected
    */
-  case class Watch(directory: String = "/dev", skipInitial: Boolean = false) extends Command
+  case class Watch(
+    directory: String = "/dev",
+    skipInitial: Boolean = false,
+    filters: Seq[DeviceFilter] = Seq.empty
+  ) extends Command
 
   /**
    * Stop receiving notifications about a previously watched directory.
@@ -121,12 +347,54 @@ object Serial extends ExtensionId[SerialExt] with ExtensionIdProvider {
   case class Unwatch(directory: String = "/dev") extends Command
 
   /**
-   * A new port (i.e. file) has been detected.
+   * A new port has been detected.
    *
    * @param port the absolute file name of the connected port
    */
   case class Connected(port: String) extends Event
 
+  /**
+   * A port that was previously reported connected has been removed.
+   *
+   * @param port the absolute file name of the disconnected port
+   */
+  case class Disconnected(port: String) extends Event
+
+  /**
+   * List the serial ports present on the system that match any of the given filters.
+   *
+   * Send this command to the manager to query its inventory of ports, an index of the ttys known
+   * to the kernel along with the attributes of their devices, links to them and whether they are
+   * open. The inventory is built on the first query and kept up to date as ports are connected
+   * and disconnected, so that queries are answered without scanning any directories. Filters on
+   * USB serial numbers and vendor ids are answered through indexes of these attributes.
+   * The manager responds with a `Ports` message, or a `CommandFailed` message if the inventory is
+   * not available, i.e. on platforms other than Linux.
+   *
+   * @param filters filters of the ports to list, all ports if empty
+   *
+   * @see Ports
+   */
+  case class ListPorts(filters: Seq[DeviceFilter] = Seq.empty) extends Command
+
+  /**
+   * Look up a port in the inventory of ports by the path of its node or of a link to it, such as
+   * "/dev/serial/by-id/usb-FTDI_FT232R_USB_UART_A50285BI-if00-port0".
+   * The manager responds with a `Ports` message, which contains the port if it is present.
+   *
+   * @param port path of the port or of any of its aliases
+   *
+   * @see ListPorts
+   */
+  case class LookupPort(port: String) extends Command
+
+  /**
+   * Ports listed or looked up in the inventory of ports, sorted by their paths.
+   *
+   * @param ports ports that were found
+   */
+  case class Ports(ports: Seq[PortInfo]) extends Event
+
   /**
    * Sets native debugging mode. If debugging is enabled, detailed error messages
    * are printed (to stderr) from native method calls.
@@ -135,4 +403,31 @@ object Serial extends ExtensionId[SerialExt] with ExtensionIdProvider {
    */
   def debug(value: Boolean) = sync.UnsafeSerial.debug(value)
 
+  /**
+   * Sets the engine used to read from subsequently opened ports. This is usually configured
+   * through `akka.serial.engine`, ports fall back to `Engine.Poll` if the given engine is not
+   * available on the running system.
+   *
+   * @param value engine to use
+   */
+  def engine(value: Engine.Engine) = sync.UnsafeSerial.engine(value.id)
+
+  /**
+   * Sets the binding through which subsequently opened ports call the native backend. This is
+   * usually configured through `akka.serial.binding`, ports fall back to `Binding.Jni` if the
+   * given binding is not available on the running JDK.
+   *
+   * @param value binding to use
+   * @return the binding actually used
+   */
+  def binding(value: Binding.Binding): Binding.Binding = sync.NativeBinding.select(value)
+
+  /**
+   * Sets the directory under which sysfs is mounted, used to look up attributes of ports such as
+   * the latency timer of USB adapters. This is usually configured through `akka.serial.sysfs-root`.
+   *
+   * @param value path of sysfs
+   */
+  def sysfsRoot(value: String) = sync.UnsafeSerial.sysfsRoot(value)
+
 }
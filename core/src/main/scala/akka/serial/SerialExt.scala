@@ -2,8 +2,70 @@ package akka.serial
 
 import akka.actor.{ ExtendedActorSystem, Props }
 import akka.io.IO
+import com.typesafe.config.Config
+import scala.collection.JavaConverters._
+import scala.concurrent.duration._
 
 /** Provides the serial IO manager. */
 class SerialExt(system: ExtendedActorSystem) extends IO.Extension {
-  lazy val manager = system.systemActorOf(Props(classOf[SerialManager]), name = "IO-SERIAL")
+
+  val settings = new SerialExt.Settings(system.settings.config.getConfig("akka.serial"))
+
+  Serial.engine(settings.Engine)
+  Serial.binding(settings.Binding)
+  Serial.sysfsRoot(settings.SysfsRoot)
+
+  /** Reactor threads shared by all operators, if enabled. */
+  private[serial] lazy val reactors: Option[ReactorGroup] =
+    if (settings.ReactorThreads > 0) {
+      val group = new ReactorGroup(settings.ReactorThreads, settings.ReactorBatchSize)
+      system.registerOnTermination(group.close())
+      Some(group)
+    } else {
+      None
+    }
+
+  /** Pool of direct buffers into which operators read. */
+  private[serial] lazy val bufferPool =
+    new sync.BufferPool(settings.BufferPoolMinSize, settings.BufferPoolMaxSize, settings.BufferPoolCapacity)
+
+  lazy val manager = system.systemActorOf(Props(classOf[SerialManager], this), name = "IO-SERIAL")
+}
+
+object SerialExt {
+
+  /** Settings of the serial IO layer, read from the `akka.serial` configuration section. */
+  class Settings(config: Config) {
+    val ReactorThreads: Int = config.getInt("reactor-threads")
+    val ReactorBatchSize: Int = config.getInt("reactor-batch-size")
+    val ReceiveRingSize: Int = config.getInt("receive-ring-size")
+    val SysfsRoot: String = config.getString("sysfs-root")
+    val BufferPoolMinSize: Int = config.getInt("buffer-pool.min-size")
+    val BufferPoolMaxSize: Int = config.getInt("buffer-pool.max-size")
+    val BufferPoolCapacity: Long = config.getBytes("buffer-pool.capacity")
+    val WriteCoalescingMaxSize: Int = config.getBytes("write-coalescing.max-size").toInt
+    val WriteCoalescingDelay: FiniteDuration = config.getDuration("write-coalescing.delay").toNanos.nanos
+    val AliasDirectories: Seq[String] = config.getStringList("alias-directories").asScala.toList
+    val Engine: akka.serial.Engine.Engine = config.getString("engine") match {
+      case "poll" => akka.serial.Engine.Poll
+      case "io-uring" => akka.serial.Engine.IoUring
+      case other => throw new IllegalArgumentException(s"unknown engine '$other', must be 'poll' or 'io-uring'")
+    }
+    val Binding: akka.serial.Binding.Binding = config.getString("binding") match {
+      case "jni" => akka.serial.Binding.Jni
+      case "foreign" => akka.serial.Binding.Foreign
+      case other => throw new IllegalArgumentException(s"unknown binding '$other', must be 'jni' or 'foreign'")
+    }
+
+    require(ReactorThreads >= 0, "reactor-threads must be >= 0")
+    require(ReactorBatchSize > 0, "reactor-batch-size must be > 0")
+    require(BufferPoolMinSize > 0 && (BufferPoolMinSize & (BufferPoolMinSize - 1)) == 0,
+      "buffer-pool.min-size must be a power of two")
+    require(BufferPoolMaxSize >= BufferPoolMinSize && (BufferPoolMaxSize & (BufferPoolMaxSize - 1)) == 0,
+      "buffer-pool.max-size must be a power of two, not less than buffer-pool.min-size")
+    require(WriteCoalescingMaxSize >= 0, "write-coalescing.max-size must be >= 0")
+    require(ReceiveRingSize >= 0 && (ReceiveRingSize & (ReceiveRingSize - 1)) == 0,
+      "receive-ring-size must be 0 or a power of two")
+  }
+
 }
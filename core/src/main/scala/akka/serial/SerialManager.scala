@@ -1,45 +1,145 @@
 package akka.serial
 
-import akka.actor.{ Actor, ActorLogging, OneForOneStrategy }
+import akka.actor.{ Actor, ActorLogging, ActorRef, OneForOneStrategy }
 import akka.actor.SupervisorStrategy.{ Escalate, Stop }
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.atomic.AtomicBoolean
+import scala.concurrent.Future
 import scala.util.{ Failure, Success, Try }
 import sync.SerialConnection
 
 /**
  * Entry point to the serial API. Actor that manages serial port creation. Once opened, a serial port is handed over to
  * a dedicated operator actor that acts as an intermediate between client code and the native system serial port.
+ *
+ * Opening a port blocks until the device has been locked and configured, which may take long for USB adapters. Ports
+ * are therefore opened concurrently on a dedicated dispatcher (`akka.serial.open-dispatcher`), and their operators are
+ * created once the result is sent back to this actor, which keeps serving other commands in the meantime. Ports whose
+ * result arrives after this actor stopped are closed rather than leaked.
  * @see SerialOperator
  */
-private[serial] class SerialManager extends Actor {
+private[serial] class SerialManager(serial: SerialExt) extends Actor {
   import SerialManager._
   import context._
 
   override val supervisorStrategy = OneForOneStrategy() {
-    case _: Exception if sender == watcher => Escalate
+    case _: Exception if sender == watcher || sender == inventory => Escalate
     case _: Exception => Stop
   }
 
   private val watcher = actorOf(Watcher(self), "watcher")
 
-  def receive = {
+  private val inventory = actorOf(PortInventory(serial.settings.AliasDirectories), "inventory")
+
+  private val opening = system.dispatchers.lookup(OpenDispatcher)
+
+  // id -> bulk open waiting for results of its ports
+  private var batches: Map[Long, Batch] = Map.empty
+  private var nextBatch = 0L
+
+  // connections opened but not yet handed to an operator, closed by whichever of postStop and the
+  // opening future removes them once this actor stopped
+  private val unclaimed = ConcurrentHashMap.newKeySet[SerialConnection]()
+  private val stopped = new AtomicBoolean(false)
+
+  def open(open: Serial.Open, client: ActorRef, batch: Option[Long]): Unit = Try {
+    serial.reactors // fails before opening, rather than leaking the port
+  } match {
+    case Success(_) =>
+      Future(SerialConnection.open(open.port, open.settings))(opening).onComplete { result =>
+        result.foreach(unclaimed.add)
+        if (stopped.get) result.foreach(close)
+        else self ! Result(open, client, batch, result)
+      }(opening)
+    case Failure(err) => self ! Result(open, client, batch, Failure(err))
+  }
+
+  private def close(connection: SerialConnection): Unit =
+    if (unclaimed.remove(connection)) Try(connection.close())
 
-    case open @ Serial.Open(port, settings, bufferSize) => Try {
-      SerialConnection.open(port, settings)
-    } match {
-      case Success(connection) => context.actorOf(SerialOperator(connection, bufferSize, sender), name = escapePortString(connection.port))
-      case Failure(err) => sender ! Serial.CommandFailed(open, err)
+  /** Claims an opened connection, unless it was closed because this actor stopped meanwhile. */
+  private def claim(connection: SerialConnection): Try[SerialConnection] =
+    if (unclaimed.remove(connection)) Success(connection)
+    else Failure(new PortClosedException(s"Port ${connection.port} was closed while opening."))
+
+  override def postStop(): Unit = {
+    stopped.set(true)
+    unclaimed.forEach(close(_))
+  }
+
+  def start(open: Serial.Open, client: ActorRef, connection: SerialConnection): Try[ActorRef] = Try {
+    // frames are read whole, and a ring carries bytes rather than frames, which are copied out of it
+    val framed = open.settings.framing != Framing.None
+    val readSize = math.max(open.bufferSize, open.settings.framing.maxSize)
+    val ringSize = if (framed || open.leased) 0 else serial.settings.ReceiveRingSize
+    val operator = SerialOperator(connection, readSize, client, serial.reactors, ringSize, serial.bufferPool, open.leased,
+      open.timestamped, serial.settings.WriteCoalescingMaxSize, serial.settings.WriteCoalescingDelay)
+    context.actorOf(operator, name = escapePortString(connection.port))
+  } recoverWith {
+    case err =>
+      Try(connection.close())
+      Failure(err)
+  }
+
+  def complete(batch: Long, port: String, failed: Option[Serial.CommandFailed]): Unit = batches.get(batch) foreach { b =>
+    val next = failed match {
+      case Some(f) => b.copy(remaining = b.remaining - 1, failed = b.failed :+ f)
+      case None => b.copy(remaining = b.remaining - 1, opened = b.opened :+ port)
+    }
+    if (next.remaining == 0) {
+      next.client ! Serial.OpenAllCompleted(next.opened, next.failed)
+      batches -= batch
+    } else {
+      batches += batch -> next
     }
+  }
+
+  def receive = {
+
+    case o: Serial.Open => open(o, sender, None)
+
+    case Serial.OpenAll(opens) if opens.isEmpty => sender ! Serial.OpenAllCompleted(Seq.empty, Seq.empty)
+
+    case Serial.OpenAll(opens) =>
+      val batch = nextBatch
+      nextBatch += 1
+      batches += batch -> Batch(sender, opens.size, Vector.empty, Vector.empty)
+      opens.foreach(open(_, sender, Some(batch)))
+
+    case Result(open, client, batch, result) =>
+      result.flatMap(claim).flatMap(start(open, client, _)) match {
+        case Success(operator) =>
+          inventory ! PortInventory.Opened(open.port, operator)
+          batch.foreach(complete(_, open.port, None))
+        case Failure(err) =>
+          val failed = Serial.CommandFailed(open, err)
+          client ! failed
+          batch.foreach(complete(_, open.port, Some(failed)))
+      }
 
     case w: Serial.Watch => watcher.forward(w)
 
     case u: Serial.Unwatch => watcher.forward(u)
 
+    case l: Serial.ListPorts => inventory.forward(l)
+
+    case l: Serial.LookupPort => inventory.forward(l)
+
   }
 
 }
 
 private[serial] object SerialManager {
 
+  /** Configuration path of the dispatcher on which ports are opened. */
+  final val OpenDispatcher = "akka.serial.open-dispatcher"
+
+  /** Outcome of opening a port on behalf of a client, possibly as part of a bulk open. */
+  private case class Result(open: Serial.Open, client: ActorRef, batch: Option[Long], result: Try[SerialConnection])
+
+  /** A bulk open, which is completed once all of its ports have been opened or failed. */
+  private case class Batch(client: ActorRef, remaining: Int, opened: Vector[String], failed: Vector[Serial.CommandFailed])
+
   private def escapePortString(port: String) = port map {
     case '/' => '-'
     case c => c
@@ -1,31 +1,145 @@
 package akka.serial
 
-import akka.actor.{Actor, ActorRef, Props, Terminated}
+import akka.actor.{Actor, ActorRef, Props, Terminated, Timers}
 import akka.util.ByteString
 import java.nio.{Buffer, ByteBuffer}
+import java.util.concurrent.LinkedBlockingQueue
+import scala.collection.immutable.Queue
+import scala.concurrent.duration._
 
-import sync.SerialConnection
+import sync.{BufferPool, ReceiveRing, SerialConnection}
 
 /**
   * Operator associated to an open serial port. All communication with a port is done via an operator. Operators are created though the serial manager.
+  *
+  * Data is read from the port either by a dedicated reader thread, or, if a reactor group is
+  * given, by one of the group's shared threads. A dedicated reader may read into a receive ring
+  * (if `ringSize` is non-zero), which the operator drains in batches.
+  *
+  * Other readers read into the `ByteString`s sent to the client, a dedicated reader through a
+  * direct buffer of its own and reactor threads straight into arrays, or, if reads are `leased`,
+  * into buffers leased from a pool shared by all operators, one per read. Leases are handed to
+  * the client, which releases them once done with the data.
+  *
+  * Bursts of small writes may be coalesced, if `coalesceSize` is non-zero: writes are gathered
+  * until they amount to `coalesceSize` bytes, `coalesceDelay` has passed since the first of them,
+  * or any other message is handled, and then written by a single call into the port. Without a
+  * delay, writes are gathered for as long as they are queued in the operator's mailbox. Every
+  * write is still acknowledged on its own.
+  *
+  * Writes that are not completely accepted by the port, since its transmit queue is full, are
+  * kept by the operator and resumed once the queue has been drained. Their acknowledgments are
+  * only sent once all data has been accepted. Transmission of writes may also be confirmed, by a
+  * drainer thread that waits for the port's queues to drain.
+  *
+  * Reading may be suspended by the client, in which case received data is left in the kernel's
+  * buffer (or in the receive ring), so that flow control can pause the remote device.
+  *
+  * The depths of the port's queues may be watched, in which case they are sampled periodically
+  * and crossings of their watermarks are reported to the watcher.
   * @see SerialManager
   */
-private[serial] class SerialOperator(connection: SerialConnection, bufferSize: Int, client: ActorRef) extends Actor {
+private[serial] class SerialOperator(
+  connection: SerialConnection,
+  bufferSize: Int,
+  client: ActorRef,
+  reactors: Option[ReactorGroup],
+  ringSize: Int,
+  pool: BufferPool,
+  leased: Boolean,
+  timestamped: Boolean,
+  coalesceSize: Int,
+  coalesceDelay: FiniteDuration
+) extends Actor with Timers {
   import SerialOperator._
   import context._
 
   case class ReaderDied(ex: Throwable)
+
+  /** The port's transmit queue has been drained, pending writes may be resumed. */
+  case object Writable
+
+  private def timestamps = Serial.ReceiveTimestamps(connection.readTimestamp, SerialConnection.timestamp)
+
+  /** The message of received data, timestamped only if requested since taking the time is not free. */
+  private def received(data: ByteString, timestamps: => Serial.ReceiveTimestamps): Serial.Event =
+    if (timestamped) Serial.ReceivedTimestamped(data, timestamps) else Serial.Received(data)
+
+  /** Reads of a single thread into the ByteStrings sent to the client, when reads are not leased. */
+  trait HeapReads {
+    /** Reads once, returning the data read, empty if none. */
+    def read(): ByteString
+  }
+
+  /**
+    * Blocking reads, which must not pin an array while they wait. Data is read into a direct
+    * buffer that is reused, and copied from it into a ByteString of exactly the data read.
+    */
+  class BufferedReads extends HeapReads {
+    private val buffer = ByteBuffer.allocateDirect(bufferSize)
+
+    def read(): ByteString = {
+      buffer.asInstanceOf[Buffer].clear()
+      if (connection.read(buffer) > 0) ByteString.fromByteBuffer(buffer) else ByteString.empty
+    }
+  }
+
+  /**
+    * Non-blocking reads, straight into an array. The array is handed over to the data's
+    * ByteString if mostly filled, hence data is copied only once. Otherwise data is copied again,
+    * into a ByteString of its own, and the array is reused, so that small reads do not hold on to
+    * arrays of the full buffer size.
+    */
+  class ArrayReads extends HeapReads {
+    private var array = new Array[Byte](bufferSize)
+
+    def read(): ByteString = {
+      val n = connection.tryRead(array, 0, array.length)
+      if (n > array.length / 2) {
+        val data = ByteString.fromArrayUnsafe(array, 0, n)
+        array = new Array[Byte](bufferSize)
+        data
+      } else if (n > 0) {
+        ByteString.fromArray(array, 0, n)
+      } else {
+        ByteString.empty
+      }
+    }
+  }
+
+  /**
+    * Reads once, either into a leased buffer or through the heap reads of the calling thread, and
+    * sends data read to the client, which takes over the lease if reads are leased.
+    * @return true if data was read
+    */
+  private def readOnce(heap: HeapReads, blocking: Boolean): Boolean = {
+    if (leased) {
+      val lease = pool.lease(bufferSize)
+      val n = try {
+        if (blocking) connection.read(lease) else connection.tryRead(lease)
+      } catch {
+        case ex: Throwable =>
+          lease.release()
+          throw ex
+      }
+      if (n > 0) client.tell(Serial.ReceivedLease(lease, timestamps), self)
+      else lease.release()
+      n > 0
+    } else {
+      val data = heap.read()
+      if (data.nonEmpty) client.tell(received(data, timestamps), self)
+      data.nonEmpty
+    }
+  }
+
   object Reader extends Thread {
-    val buffer = ByteBuffer.allocateDirect(bufferSize)
+    val heap = if (leased) null else new BufferedReads
 
     def loop() = {
       var stop = false
       while (!connection.isClosed && !stop) {
         try {
-          buffer.asInstanceOf[Buffer].clear()
-          connection.read(buffer)
-          val data = ByteString.fromByteBuffer(buffer)
-          client.tell(Serial.Received(data), self)
+          if (!readOnce(heap, blocking = true)) self.tell(Writable, Actor.noSender)
         } catch {
           // don't do anything if port is interrupted
           case ex: PortInterruptedException => {}
@@ -45,21 +159,301 @@ private[serial] class SerialOperator(connection: SerialConnection, bufferSize: I
 
   }
 
-  val writeBuffer = ByteBuffer.allocateDirect(bufferSize)
+  /** Confirms transmission of writes, on a thread of its own since waiting for a drain blocks. */
+  object Drainer extends Thread {
+    val requests = new LinkedBlockingQueue[DrainRequest]
+
+    def loop() = {
+      var stop = false
+      while (!connection.isClosed && !stop) {
+        try {
+          val request = requests.take()
+          val drained = connection.awaitTransmitted()
+          val transmitted = Serial.Transmitted(request.length, request.queued, drained)
+          request.sender.tell(request.ack(transmitted), self)
+        } catch {
+          // stop if port is closed
+          case ex: InterruptedException => stop = true
+          case ex: PortInterruptedException => stop = true
+          case ex: PortClosedException => stop = true
+
+          //stop and tell operator on other exception
+          case ex: Exception =>
+            stop = true
+            self.tell(ReaderDied(ex), Actor.noSender)
+        }
+      }
+    }
+
+    override def run() {
+      this.setName(s"serial-drainer(${connection.port})")
+      loop()
+    }
+
+  }
+
+  private var drainerStarted = false
+
+  /** Requests confirmation of a write once all its data has been accepted by the port. */
+  private def confirm(write: PendingWrite): Unit = write.drained foreach { ack =>
+    if (!drainerStarted) {
+      Drainer.setDaemon(true)
+      Drainer.start()
+      drainerStarted = true
+    }
+    Drainer.requests.put(DrainRequest(write.length, SerialConnection.timestamp, ack, write.sender))
+  }
+
+  /** Data has been read into the receive ring while the operator was waiting. */
+  case object RingReady
+
+  /** Reader that fills a receive ring, used instead of `Reader` if a ring size is given. */
+  object RingReader extends Thread {
+    val ring = new ReceiveRing(ringSize)
+
+    def loop() = {
+      var stop = false
+      while (!connection.isClosed && !stop) {
+        try {
+          val events = connection.fill(ring)
+          if ((events & ReceiveRing.DataAvailable) != 0) self.tell(RingReady, Actor.noSender)
+          if ((events & ReceiveRing.TransmitDrained) != 0) self.tell(Writable, Actor.noSender)
+        } catch {
+          // don't do anything if port is interrupted
+          case ex: PortInterruptedException => {}
+
+          //stop and tell operator on other exception
+          case ex: Exception =>
+            stop = true
+            self.tell(ReaderDied(ex), Actor.noSender)
+        }
+      }
+    }
+
+    override def run() {
+      this.setName(s"serial-ring-reader(${connection.port})")
+      loop()
+    }
+
+  }
+
+  /** Sends all data accumulated in the receive ring to the client, as a single message. */
+  private def drainRing(): Unit = {
+    val ring = RingReader.ring
+    var data = ByteString.empty
+    connection.drain(ring) { buffer =>
+      data ++= ByteString.fromByteBuffer(buffer)
+    }
+    if (data.nonEmpty) {
+      client ! received(data, Serial.ReceiveTimestamps(ring.readTimestamp, SerialConnection.timestamp))
+    }
+
+    // data that arrived in the meantime is drained after handling other messages
+    if (!ring.prepareWait()) self ! RingReady
+  }
+
+  /** Reads available data from a reactor thread, used instead of a dedicated reader. */
+  object ReadyHandler extends ReactorGroup.Handler {
+
+    // frames may remain buffered by the port once the kernel's buffer has been read
+    val framed = connection.framing != Framing.None
+
+    val heap = if (leased) null else new ArrayReads
+
+    def ready(): Unit = {
+      var more = true
+      while (more) {
+        more = readOnce(heap, blocking = false) && framed
+      }
+      // readiness is also signaled once the transmit queue has been drained
+      if (connection.transmitDrained) self.tell(Writable, Actor.noSender)
+    }
+
+    def failed(cause: Throwable): Unit = cause match {
+      // don't do anything if port is closing
+      case ex: PortClosedException => {}
+      case ex => self.tell(ReaderDied(ex), Actor.noSender)
+    }
+  }
+
+  private var token: Long = 0
+
+  // reading has been suspended by the client
+  private var suspended = false
+
+  // writes that have not yet been completely accepted by the port, in order of arrival
+  private var pending = Queue.empty[PendingWrite]
+
+  // number of bytes of pending writes not yet accepted by the port, kept as writes are queued and written
+  private var pendingSize = 0L
+
+  // the port did not accept all data of the last write, pending writes wait until it is writable
+  private var blocked = false
+
+  // writes are being gathered, and will be flushed on the next FlushWrites message
+  private var gathering = false
+
+  // queue watermarks, if watched, and whether each queue is above its high watermark
+  private var queues: Option[Serial.WatchQueues] = None
+  private var queueWatcher: ActorRef = Actor.noSender
+  private var inputHigh = false
+  private var outputHigh = false
+
+  /**
+    * Notifies the queue watcher if a queue's depth crossed one of its watermarks.
+    * @return whether the queue is above its high watermark
+    */
+  private def crossed(marks: Serial.Watermarks, depth: Int, high: Boolean)(
+    above: Int => Serial.Event, below: Int => Serial.Event): Boolean = {
+    if (!high && depth >= marks.high) {
+      queueWatcher ! above(depth)
+      true
+    } else if (high && depth <= marks.low) {
+      queueWatcher ! below(depth)
+      false
+    } else {
+      high
+    }
+  }
+
+  private def sampleInput(): Unit = for (watch <- queues; marks <- watch.input) {
+    inputHigh = crossed(marks, connection.inputQueued, inputHigh)(Serial.InputQueueHigh, Serial.InputQueueLow)
+  }
+
+  private def sampleOutput(): Unit = for (watch <- queues; marks <- watch.output) {
+    outputHigh = crossed(marks, connection.outputQueued, outputHigh)(Serial.OutputQueueHigh, Serial.OutputQueueLow)
+  }
+
+  /** Writes as much pending data as the port accepts, gathering up to `coalesceSize` bytes per call. */
+  private def flush(): Unit = {
+    while (pending.nonEmpty && !blocked) {
+      // the first write is written regardless of its size
+      var batch = Vector(pending.head)
+      var size = pending.head.remaining.length
+      var rest = pending.tail
+      while (rest.nonEmpty && size + rest.head.remaining.length <= coalesceSize) {
+        batch :+= rest.head
+        size += rest.head.remaining.length
+        rest = rest.tail
+      }
+      // the chunks of composite ByteStrings are written without being copied
+      var accepted = connection.write(batch.flatMap(_.remaining.asByteBuffers).toArray)
+      pendingSize -= accepted
+
+      // writes are acknowledged once all their data has been accepted, the others are resumed
+      var resumed = Vector.empty[PendingWrite]
+      for (write <- batch) {
+        if (resumed.isEmpty && accepted >= write.remaining.length) {
+          accepted -= write.remaining.length
+          if (write.ack != Serial.NoAck) write.sender ! write.ack(write.length)
+          confirm(write)
+        } else {
+          resumed :+= write.copy(remaining = write.remaining.drop(accepted))
+          accepted = 0
+        }
+      }
+      pending = resumed ++: rest
+      blocked = resumed.nonEmpty
+    }
+    sampleOutput()
+  }
+
+  /** Writes the writes gathered so far, without waiting for the end of the gathering window. */
+  private def flushGathered(): Unit = {
+    if (gathering) {
+      gathering = false
+      timers.cancel(FlushWrites)
+    }
+    flush()
+  }
+
+  private def enqueue(write: PendingWrite): Unit = {
+    pending = pending enqueue write
+    pendingSize += write.remaining.length
+    // otherwise wait until the port's transmit queue has been drained
+    if (!blocked) {
+      if (coalesceSize == 0 || pendingSize >= coalesceSize) {
+        flushGathered()
+      } else if (!gathering) {
+        gathering = true
+        if (coalesceDelay > Duration.Zero) timers.startSingleTimer(FlushWrites, FlushWrites, coalesceDelay)
+        else self ! FlushWrites
+      }
+    }
+  }
 
   override def preStart() = {
     context watch client
-    client ! Serial.Opened(connection.port)
-    Reader.start()
+    client ! Serial.Opened(connection.port)(connection.achieved)
+    reactors match {
+      case Some(group) => token = group.register(connection, ReadyHandler)
+      case None if ringSize > 0 => RingReader.start()
+      case None => Reader.start()
+    }
   }
 
   override def receive: Receive = {
 
     case Serial.Write(data, ack) =>
-      writeBuffer.asInstanceOf[Buffer].clear()
-      data.copyToBuffer(writeBuffer)
-      val sent = connection.write(writeBuffer)
-      if (ack != Serial.NoAck) sender ! ack(sent)
+      enqueue(PendingWrite(data, data.length, ack, sender))
+
+    case Serial.WriteDrained(data, ack) =>
+      enqueue(PendingWrite(data, data.length, Serial.NoAck, sender, Some(ack)))
+
+    case FlushWrites =>
+      gathering = false
+      flush()
+
+    // writes gathered so far are written before any other message, which may depend on them
+    case message if gathering =>
+      flushGathered()
+      commands.applyOrElse(message, unhandled)
+
+    case message => commands.applyOrElse(message, unhandled)
+  }
+
+  private def commands: Receive = {
+
+    case Writable =>
+      blocked = false
+      flush()
+
+    // a ring that is not drained fills up and then stops being filled
+    case RingReady =>
+      if (!suspended) drainRing()
+
+    case Serial.SuspendReading =>
+      suspended = true
+      connection.suspendReading(true)
+
+    case Serial.ResumeReading =>
+      if (suspended) {
+        suspended = false
+        connection.suspendReading(false)
+        if (ringSize > 0 && reactors.isEmpty) drainRing()
+      }
+
+    case Serial.GetQueueDepths =>
+      sender ! Serial.QueueDepths(connection.inputQueued, connection.outputQueued)
+
+    case Serial.GetStats =>
+      sender ! Serial.Stats(connection.stats)
+
+    case watch: Serial.WatchQueues =>
+      queues = Some(watch)
+      queueWatcher = sender
+      inputHigh = false
+      outputHigh = false
+      timers.startTimerWithFixedDelay(SampleQueues, SampleQueues, watch.interval)
+      self ! SampleQueues
+
+    case Serial.UnwatchQueues =>
+      queues = None
+      timers.cancel(SampleQueues)
+
+    case SampleQueues =>
+      sampleInput()
+      sampleOutput()
 
     case Serial.Close =>
       client ! Serial.Closed
@@ -74,11 +468,47 @@ private[serial] class SerialOperator(connection: SerialConnection, bufferSize: I
   }
 
   override def postStop() = {
+    reactors foreach { _.unregister(token) }
     connection.close()
+    if (drainerStarted) Drainer.interrupt()
   }
 
 }
 
 private[serial] object SerialOperator {
-  def apply(connection: SerialConnection, bufferSize: Int, client: ActorRef) = Props(classOf[SerialOperator], connection, bufferSize, client)
+
+  /** Timer message and key, the depths of the port's queues should be sampled. */
+  private case object SampleQueues
+
+  /** Message and timer key, gathered writes should be written. */
+  private case object FlushWrites
+
+  /**
+    * A write whose data has not yet been completely accepted by the port.
+    * @param drained acknowledgment of the write's transmission, if it should be confirmed
+    */
+  private case class PendingWrite(
+    remaining: ByteString,
+    length: Int,
+    ack: Int => Serial.Event,
+    sender: ActorRef,
+    drained: Option[Serial.Transmitted => Serial.Event] = None
+  )
+
+  /** A write whose transmission should be confirmed, queued at the given time. */
+  private case class DrainRequest(length: Int, queued: Long, ack: Serial.Transmitted => Serial.Event, sender: ActorRef)
+
+  def apply(
+    connection: SerialConnection,
+    bufferSize: Int,
+    client: ActorRef,
+    reactors: Option[ReactorGroup] = None,
+    ringSize: Int = 0,
+    pool: BufferPool = BufferPool.shared,
+    leased: Boolean = false,
+    timestamped: Boolean = false,
+    coalesceSize: Int = 0,
+    coalesceDelay: FiniteDuration = Duration.Zero
+  ) = Props(classOf[SerialOperator], connection, bufferSize, client, reactors, ringSize, pool, leased,
+    timestamped, coalesceSize, coalesceDelay)
 }
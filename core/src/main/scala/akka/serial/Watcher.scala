@@ -1,71 +1,125 @@
 package akka.serial
 
 import akka.actor.{ Actor, ActorRef, Props, Terminated }
-import java.nio.file.{ ClosedWatchServiceException, FileSystems, Files, Path, Paths, WatchEvent, WatchKey }
+import java.nio.file.{ ClosedWatchServiceException, FileSystems, Files, NotDirectoryException, Path, Paths, WatchEvent }
 import java.nio.file.StandardWatchEventKinds._
 import scala.collection.JavaConverters._
-import scala.collection.mutable.{ HashMap, Map, MultiMap, Set }
 import scala.util.{ Failure, Success, Try }
-
-private[serial] class Watcher(from: Option[ActorRef]) extends Actor {
+import sync.DeviceMonitor
+
+/**
+ * Watches for ports being connected and disconnected, on behalf of clients of the manager.
+ *
+ * Every watch is served by a thread of its own, which blocks on a native monitor of devices or,
+ * where there is none, on a watch service of the directory.
+ *
+ * @param from actor on behalf of which notifications are sent, this actor if none
+ * @param source file from which native monitors read hotplug events instead of the kernel, see
+ * `DeviceMonitor.open()`
+ */
+private[serial] class Watcher(from: Option[ActorRef], source: Option[String]) extends Actor {
+  import Watcher._
 
   case class WatcherDied(reason: Throwable)
-  object WatcherThread extends Thread {
-    import Watcher.NewFile
+  case class Device(thread: WatchThread, event: DeviceMonitor.Event)
+
+  abstract class WatchThread extends Thread {
+    setName("serial-port-watcher")
+    setDaemon(true)
+
+    protected def report(event: DeviceMonitor.Event) = self.tell(Device(this, event), Actor.noSender)
+    protected def fail(reason: Throwable) = self.tell(WatcherDied(reason), Actor.noSender)
+
+    def close(): Unit
+  }
 
+  class MonitorThread(monitor: DeviceMonitor) extends WatchThread {
+    override def run(): Unit = {
+      var stop = false
+      while (!stop) {
+        try {
+          monitor.next() match {
+            case Some(event) => report(event)
+            case None => stop = true // injected source ended
+          }
+        } catch {
+          case _: PortInterruptedException => stop = true
+          case _: PortClosedException => stop = true
+          case ex: Exception =>
+            fail(ex)
+            stop = true
+        }
+      }
+    }
+
+    def close() = monitor.close() // interrupts a waiting call to next()
+  }
+
+  class DirectoryThread(directory: Path, filters: Seq[DeviceFilter], skipInitial: Boolean) extends WatchThread {
     private val service = FileSystems.getDefault().newWatchService()
+    directory.register(service, ENTRY_CREATE, ENTRY_DELETE)
+
+    // files in a directory do not tell their subsystem, let alone their USB device
+    private val names = filters.filterNot(_.usb).map { filter =>
+      filter.name.map(pattern => FileSystems.getDefault().getPathMatcher("glob:" + pattern))
+    }
 
-    def register(directory: Path) = directory.register(service, ENTRY_CREATE)
+    private def matches(file: Path) = filters.isEmpty || names.exists(_.forall(_.matches(file.getFileName)))
 
     override def run(): Unit = {
-      this.setName("serial-port-watcher")
       var stop = false
+      try {
+        if (!skipInitial) {
+          Files.newDirectoryStream(directory).asScala foreach { path =>
+            if (!Files.isDirectory(path) && matches(path)) report(DeviceMonitor.Connected(path.toString))
+          }
+        }
+      } catch {
+        case ex: Exception => fail(ex)
+      }
       while (!stop) {
         try {
           val key = service.take()
           key.pollEvents().asScala foreach { ev =>
             val event = ev.asInstanceOf[WatchEvent[Path]]
-            if (event.kind == ENTRY_CREATE) {
-              val directory = key.watchable().asInstanceOf[Path]
-              val file = event.context()
-              self.tell(NewFile(directory, file), Actor.noSender)
-            }
+            val file = directory resolve event.context()
+            if (event.kind == ENTRY_CREATE && matches(file)) report(DeviceMonitor.Connected(file.toString))
+            if (event.kind == ENTRY_DELETE && matches(file)) report(DeviceMonitor.Disconnected(file.toString))
           }
           key.reset()
         } catch {
           case _: InterruptedException => stop = true
           case _: ClosedWatchServiceException => stop = true
-          case ex: Exception => self.tell(WatcherDied(ex), Actor.noSender)
+          case ex: Exception => fail(ex)
         }
       }
     }
 
-    def close() = service.close // causes the service to throw a ClosedWatchServiceException
+    def close() = service.close() // causes the service to throw a ClosedWatchServiceException
   }
 
-
-  // directory -> subscribers
-  private val clients: MultiMap[String, ActorRef] = new HashMap[String, Set[ActorRef]] with MultiMap[String, ActorRef]
-
-  // directory -> watchkey
-  private val keys: Map[String, WatchKey] = Map.empty
-
-  def subscribe(directory: String, client: ActorRef): WatchKey = {
-    val normal = Paths.get(directory).toAbsolutePath
-    val index = normal.toString
-    val key = keys.getOrElseUpdate(index, WatcherThread.register(normal))
-    clients addBinding (index, client)
-    key
+  // thread -> (subscriber, directory)
+  private var watches: Map[WatchThread, (ActorRef, String)] = Map.empty
+
+  def open(directory: Path, skipInitial: Boolean, filters: Seq[DeviceFilter]): WatchThread = {
+    if (!Files.isDirectory(directory)) throw new NotDirectoryException(directory.toString)
+    // the kernel creates nodes of devices in /dev, other directories (e.g. of links) are watched
+    val monitor = if (directory == DeviceDirectory || source.isDefined) {
+      try {
+        Some(DeviceMonitor.open(directory.toString, filters, !skipInitial, source))
+      } catch {
+        case _: UnsupportedOperationException if source.isEmpty => None // not on Linux
+      }
+    } else {
+      None
+    }
+    monitor.map(new MonitorThread(_)).getOrElse(new DirectoryThread(directory, filters, skipInitial))
   }
 
-  def unsubscribe(directory: String, client: ActorRef): Unit = {
-    val index = Paths.get(directory).toAbsolutePath.toString
-
-    clients removeBinding (index, sender)
-
-    if (clients.get(index).isEmpty && keys.get(index).isDefined) {
-      keys(index).cancel()
-      keys -= index
+  def unsubscribe(client: ActorRef, directory: Option[String]): Unit = {
+    for ((thread, (c, dir)) <- watches if c == client && directory.forall(_ == dir)) {
+      thread.close()
+      watches -= thread
     }
   }
 
@@ -77,52 +131,34 @@ private[serial] class Watcher(from: Option[ActorRef]) extends Actor {
     sender.tell(msg, origin)
   }
 
-  override def preStart() = {
-    WatcherThread.setDaemon(true)
-    WatcherThread.start()
-  }
-
   override def receive = {
 
-    case w @ Serial.Watch(directory, skipInitial) =>
-      val normalPath = Paths.get(directory).toAbsolutePath
-      val normal = normalPath.toString
+    case w @ Serial.Watch(directory, skipInitial, filters) =>
+      val normal = Paths.get(directory).toAbsolutePath
 
       Try {
-        subscribe(directory, sender)
+        open(normal, skipInitial, filters)
       } match {
         case Failure(err) => reply(Serial.CommandFailed(w, err), sender)
-        case Success(key) =>
+        case Success(thread) =>
           context watch sender
-          if (!skipInitial) {
-            Files.newDirectoryStream(normalPath).asScala foreach { path =>
-              if (!Files.isDirectory(path)) {
-                reply(Serial.Connected(path.toString), sender)
-              }
-            }
-          }
+          watches += thread -> (sender -> normal.toString)
+          thread.start()
       }
 
-    case u @ Serial.Unwatch(directory) =>
-      val normal = Paths.get(directory).toAbsolutePath.toString
-
-      clients.removeBinding(normal, sender)
-
-      if (clients.get(normal).isEmpty && keys.get(normal).isDefined) {
-        keys(normal).cancel()
-        keys -= normal
-      }
+    case Serial.Unwatch(directory) =>
+      unsubscribe(sender, Some(Paths.get(directory).toAbsolutePath.toString))
 
     case Terminated(client) =>
-      for ((directory, c) <- clients if c == client) {
-        unsubscribe(directory, client)
-      }
-
-    case Watcher.NewFile(directory, file) =>
-      val normal = directory.toAbsolutePath
-      val absFile = normal resolve file
-      clients.getOrElse(normal.toString, Set.empty) foreach { client =>
-        reply(Serial.Connected(absFile.toString), client)
+      unsubscribe(client, None)
+
+    case Device(thread, event) =>
+      // events of threads closed in the meantime are dropped
+      watches.get(thread) foreach { case (client, _) =>
+        event match {
+          case DeviceMonitor.Connected(port) => reply(Serial.Connected(port), client)
+          case DeviceMonitor.Disconnected(port) => reply(Serial.Disconnected(port), client)
+        }
       }
 
     case WatcherDied(err) => throw err // go down with watcher thread
@@ -130,14 +166,14 @@ private[serial] class Watcher(from: Option[ActorRef]) extends Actor {
   }
 
   override def postStop() = {
-    WatcherThread.close()
+    watches.keys.foreach(_.close())
   }
 
 }
 
 private[serial] object Watcher {
-  private case class NewFile(directory: Path, file: Path)
+  private val DeviceDirectory = Paths.get("/dev")
 
-  def apply(from: ActorRef) = Props(classOf[Watcher], Some(from))
+  def apply(from: ActorRef, source: Option[String] = None) = Props(classOf[Watcher], Some(from), source)
 
 }
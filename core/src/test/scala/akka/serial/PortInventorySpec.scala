@@ -0,0 +1,102 @@
+package akka.serial
+
+import java.nio.file.{Files, Path, Paths}
+import scala.concurrent.duration._
+
+import akka.actor.ActorSystem
+import akka.testkit.{ImplicitSender, TestKit, TestProbe}
+import org.scalatest._
+import sync.UnsafeSerial
+
+class PortInventorySpec
+    extends TestKit(ActorSystem("serial-inventory"))
+    with ImplicitSender
+    with WordSpecLike
+    with Matchers
+    with BeforeAndAfterAll {
+
+  override def afterAll {
+    TestKit.shutdownActorSystem(system)
+  }
+
+  /** A uevent of a tty, as sent by the kernel and followed by an empty field. */
+  def uevent(action: String, devpath: String, name: String): String =
+    Seq(s"$action@$devpath", s"ACTION=$action", s"DEVPATH=$devpath", "SUBSYSTEM=tty", s"DEVNAME=$name")
+      .map(_ + "\u0000").mkString + "\u0000"
+
+  /** Creates a USB device with a tty in a fake sysfs tree, linked from the tty class if present. */
+  def usbTty(root: Path, usb: String, vendor: String, serial: String, name: String, present: Boolean): String = {
+    val device = Files.createDirectories(root.resolve(s"devices/usb1/$usb"))
+    Files.write(device.resolve("idVendor"), s"$vendor\n".getBytes)
+    Files.write(device.resolve("idProduct"), "6001\n".getBytes)
+    Files.write(device.resolve("serial"), s"$serial\n".getBytes)
+    val tty = Files.createDirectories(device.resolve(s"$usb:1.0/$name/tty/$name"))
+    Files.write(tty.resolve("uevent"), s"DEVNAME=$name\n".getBytes)
+    if (present) {
+      val ttys = Files.createDirectories(root.resolve("class/tty"))
+      Files.createSymbolicLink(ttys.resolve(name), Paths.get(s"../../devices/usb1/$usb/$usb:1.0/$name/tty/$name"))
+    }
+    s"/devices/usb1/$usb/$usb:1.0/$name/tty/$name"
+  }
+
+  "Port inventory" should {
+
+    "index present and connected ports with their attributes and aliases" in {
+      val root = Files.createTempDirectory("akka-serial-sysfs")
+      usbTty(root, "1-1", "0403", "A50285BI", "ttyUSB0", present = true)
+      val arduino = usbTty(root, "1-2", "2341", "7543331", "ttyACM0", present = false)
+      val events = Files.write(root.resolve("uevents"), uevent("add", arduino, "ttyACM0").getBytes("UTF-8"))
+      val byId = Files.createDirectories(root.resolve("by-id"))
+      val alias = byId.resolve("usb-FTDI_A50285BI-if00-port0")
+      Files.createSymbolicLink(alias, Paths.get("/dev/ttyUSB0"))
+
+      UnsafeSerial.sysfsRoot(root.toString)
+      try {
+        val inventory = system.actorOf(PortInventory(Seq(byId.toString), Some(events.toString)))
+
+        inventory ! Serial.LookupPort(alias.toString)
+        val ftdi = expectMsgType[Serial.Ports].ports
+        ftdi.map(_.port) shouldBe Seq("/dev/ttyUSB0")
+        ftdi.head.aliases shouldBe Set(alias.toString)
+        ftdi.head.device.vendor shouldBe Some(0x0403)
+        ftdi.head.device.serial shouldBe Some("A50285BI")
+        ftdi.head.open shouldBe false
+
+        // ports connected after the first query are indexed as they are reported
+        awaitAssert {
+          inventory ! Serial.ListPorts(Seq(DeviceFilter(serial = Some("7543331"))))
+          expectMsgType[Serial.Ports].ports.map(_.port) shouldBe Seq("/dev/ttyACM0")
+        }
+        inventory ! Serial.ListPorts(Seq(DeviceFilter(vendor = Some(0x0403)), DeviceFilter(name = Some("ttyACM*"))))
+        expectMsgType[Serial.Ports].ports.map(_.port) shouldBe Seq("/dev/ttyACM0", "/dev/ttyUSB0")
+        inventory ! Serial.LookupPort("/dev/ttyS9")
+        expectMsg(Serial.Ports(Seq.empty))
+
+        // ports are open for as long as their operators live
+        val operator = TestProbe()
+        inventory ! PortInventory.Opened("/dev/ttyACM0", operator.ref)
+        inventory ! Serial.LookupPort("/dev/ttyACM0")
+        expectMsgType[Serial.Ports].ports.map(_.open) shouldBe Seq(true)
+        system.stop(operator.ref)
+        awaitAssert {
+          inventory ! Serial.LookupPort("/dev/ttyACM0")
+          expectMsgType[Serial.Ports].ports.map(_.open) shouldBe Seq(false)
+        }
+        system.stop(inventory)
+      } finally {
+        UnsafeSerial.sysfsRoot("/sys")
+      }
+    }
+
+    "fail queries if its uevents cannot be read" in {
+      val inventory = system.actorOf(PortInventory(Seq.empty, Some("/nonexistent")))
+      val cmd = Serial.ListPorts()
+      inventory ! cmd
+      assert(expectMsgType[Serial.CommandFailed].command == cmd)
+      expectNoMessage(100.millis)
+      system.stop(inventory)
+    }
+
+  }
+
+}
@@ -2,7 +2,9 @@ package akka.serial
 
 import akka.actor.ActorSystem
 import akka.io.IO
-import akka.testkit.{ImplicitSender, TestKit}
+import akka.testkit.{ImplicitSender, TestKit, TestProbe}
+import akka.util.ByteString
+import com.typesafe.config.ConfigFactory
 import org.scalatest._
 
 class SerialManagerSpec
@@ -23,7 +25,9 @@ class SerialManagerSpec
     "open an existing port" in {
       withEcho{ case (port, settings) =>
         manager ! Serial.Open(port, settings)
-        expectMsgType[Serial.Opened]
+        val opened = expectMsgType[Serial.Opened]
+        opened.port shouldBe port
+        opened.settings.baud shouldBe settings.baud
       }
     }
 
@@ -35,6 +39,39 @@ class SerialManagerSpec
       assert(expectMsgType[Serial.CommandFailed].command == cmd)
     }
 
+    "open several ports at once and report each of them" in {
+      withEcho{ case (port, settings) =>
+        val missing = Serial.Open("nonexistent", settings)
+        manager ! Serial.OpenAll(Seq(Serial.Open(port, settings), missing))
+        val replies = receiveN(3)
+        replies.collect{ case Serial.Opened(p) => p } shouldBe Seq(port)
+        replies.collect{ case Serial.CommandFailed(c, _) => c } shouldBe Seq(missing)
+        replies.collect{ case Serial.OpenAllCompleted(opened, failed) => (opened, failed.map(_.command)) } shouldBe
+          Seq((Seq(port), Seq(missing)))
+      }
+    }
+
+    "deliver leased reads even if receive rings are configured" in {
+      val ringed = ActorSystem("serial-manager-ring", ConfigFactory.parseString("akka.serial.receive-ring-size = 4096"))
+      try {
+        withEcho{ case (port, settings) =>
+          val client = TestProbe()(ringed)
+          IO(Serial)(ringed).tell(Serial.Open(port, settings, leased = true), client.ref)
+          client.expectMsgType[Serial.Opened]
+          val operator = client.lastSender
+
+          operator.tell(Serial.Write(ByteString("hello")), client.ref)
+          val lease = client.expectMsgType[Serial.ReceivedLease]
+          lease.release()
+
+          operator.tell(Serial.Close, client.ref)
+          client.fishForMessage() { case Serial.Closed => true; case _ => false }
+        }
+      } finally {
+        TestKit.shutdownActorSystem(ringed)
+      }
+    }
+
   }
 
 }
@@ -9,6 +9,7 @@ import org.scalatest._
 import sync._
 
 case class Ack(n: Int) extends Serial.Event
+case class DrainAck(transmitted: Serial.Transmitted) extends Serial.Event
 
 class SerialOperatorSpec
     extends TestKit(ActorSystem("serial-operator"))
@@ -23,10 +24,12 @@ class SerialOperatorSpec
     TestKit.shutdownActorSystem(system)
   }
 
-  def withEchoOp[A](action: ActorRef => A): A = {
+  def withEchoOp[A](action: ActorRef => A): A = withEchoOp(None)(action)
+
+  def withEchoOp[A](reactors: Option[ReactorGroup], ringSize: Int = 0)(action: ActorRef => A): A = {
     withEcho { case (port, settings) =>
       val connection = SerialConnection.open(port, settings)
-      val operator = system.actorOf(SerialOperator.apply(connection, 1024, testActor))
+      val operator = system.actorOf(SerialOperator.apply(connection, 1024, testActor, reactors, ringSize))
       action(operator)
     }
   }
@@ -45,6 +48,212 @@ class SerialOperatorSpec
 
     }
 
+    "receive data through a reactor" in {
+      val reactors = new ReactorGroup(1, 16)
+      try {
+        withEchoOp(Some(reactors)) { op =>
+          expectMsgType[Serial.Opened]
+
+          val data = ByteString("hello world".getBytes("utf-8"))
+          op ! Serial.Write(data)
+          expectMsg(Serial.Received(data))
+
+          op ! Serial.Close
+          expectMsg(Serial.Closed)
+        }
+      } finally {
+        reactors.close()
+      }
+    }
+
+    "receive data through a receive ring" in withEchoOp(None, ringSize = 4096) { op =>
+      expectMsgType[Serial.Opened]
+
+      // more data than the ring can hold at once
+      val data = ByteString(Array.tabulate[Byte](64 * 1024)(i => (i % 251).toByte))
+      op ! Serial.Write(data)
+
+      var received = ByteString.empty
+      while (received.length < data.length) {
+        received ++= expectMsgType[Serial.Received](5.seconds).data
+      }
+      received shouldBe data
+
+      op ! Serial.Close
+      expectMsg(Serial.Closed)
+    }
+
+    "deliver data in leased buffers, which return to the pool" in withEcho { case (port, settings) =>
+      val pool = new BufferPool(256, 4096, 64 * 1024)
+      val connection = SerialConnection.open(port, settings)
+      val op = system.actorOf(SerialOperator(connection, 1024, testActor, None, 0, pool, leased = true))
+      expectMsgType[Serial.Opened]
+
+      for (text <- Seq("hello", "world")) {
+        val data = ByteString(text)
+        op ! Serial.Write(data)
+        var received = ByteString.empty
+        while (received.length < data.length) {
+          val lease = expectMsgType[Serial.ReceivedLease]
+          lease.data.isReadOnly shouldBe true
+          received ++= ByteString.fromByteBuffer(lease.data)
+          lease.release()
+        }
+        received shouldBe data
+      }
+      // the reader holds one buffer at a time, released ones are reused
+      pool.stats.allocations should be < pool.stats.leases
+
+      op ! Serial.Close
+      expectMsg(Serial.Closed)
+    }
+
+    "deliver data with timestamps only when opened timestamped" in withEcho { case (port, settings) =>
+      val connection = SerialConnection.open(port, settings)
+      val op = system.actorOf(SerialOperator(connection, 1024, testActor, timestamped = true))
+      expectMsgType[Serial.Opened]
+
+      val data = ByteString("hello")
+      val start = System.nanoTime
+      op ! Serial.Write(data)
+      var received = ByteString.empty
+      while (received.length < data.length) {
+        val chunk = expectMsgType[Serial.ReceivedTimestamped]
+        chunk.timestamps.read should be >= start
+        chunk.timestamps.returned should be >= chunk.timestamps.read
+        received ++= chunk.data
+      }
+      received shouldBe data
+
+      op ! Serial.Close
+      expectMsg(Serial.Closed)
+    }
+
+    "confirm transmission of writes with timestamps" in withEchoOp { op =>
+      expectMsgType[Serial.Opened]
+
+      val data = ByteString(Array.tabulate[Byte](64 * 1024)(i => (i % 251).toByte))
+      val start = System.nanoTime
+      op ! Serial.WriteDrained(data, DrainAck(_))
+
+      var received = ByteString.empty
+      var transmitted: Option[Serial.Transmitted] = None
+      while (received.length < data.length || transmitted.isEmpty) {
+        expectMsgPF(5.seconds) {
+          case Serial.Received(chunk) => received ++= chunk
+          case DrainAck(t) => transmitted = Some(t)
+        }
+      }
+      received shouldBe data
+
+      val t = transmitted.get
+      t.length shouldBe data.length
+      t.queued should be >= start
+      t.drained should be >= t.queued
+
+      op ! Serial.Close
+      expectMsg(Serial.Closed)
+    }
+
+    "report statistics of transferred data" in withEchoOp { op =>
+      expectMsgType[Serial.Opened]
+
+      val data = ByteString("hello world")
+      op ! Serial.Write(data)
+      var received = ByteString.empty
+      while (received.length < data.length) {
+        received ++= expectMsgType[Serial.Received].data
+      }
+
+      op ! Serial.GetStats
+      val stats = expectMsgType[Serial.Stats].stats
+      stats.bytesWritten shouldBe data.length
+      stats.bytesRead shouldBe data.length
+      stats.reads should be >= 1L
+      stats.errors shouldBe None // pseudo terminals do not count errors on the line
+
+      op ! Serial.Close
+      expectMsg(Serial.Closed)
+    }
+
+    "coalesce bursts of small writes and acknowledge each of them" in withEcho { case (port, settings) =>
+      val connection = SerialConnection.open(port, settings)
+      val op = system.actorOf(SerialOperator(connection, 1024, testActor, coalesceSize = 4096, coalesceDelay = 100.millis))
+      expectMsgType[Serial.Opened]
+
+      val commands = (0 until 20).map(i => ByteString(f"cmd $i%03d;"))
+      commands.foreach(op ! Serial.Write(_, Ack(_)))
+      var received = ByteString.empty
+      var acks = Seq.empty[Ack]
+      while (received.length < commands.map(_.length).sum || acks.length < commands.length) {
+        expectMsgPF() {
+          case Serial.Received(data) => received ++= data
+          case ack: Ack => acks :+= ack
+        }
+      }
+      received shouldBe commands.reduce(_ ++ _)
+      acks shouldBe commands.map(c => Ack(c.length))
+
+      op ! Serial.GetStats
+      expectMsgType[Serial.Stats].stats.writes should be < commands.length.toLong
+
+      op ! Serial.Close
+      expectMsg(Serial.Closed)
+    }
+
+    "report input queue watermarks while reading is suspended" in withEchoOp { op =>
+      expectMsgType[Serial.Opened]
+
+      op ! Serial.SuspendReading
+      op ! Serial.WatchQueues(input = Some(Serial.Watermarks(0, 32)))
+      val data = ByteString(Array.fill[Byte](64)(42))
+      op ! Serial.Write(data)
+
+      // echoed data stays in the input queue
+      expectMsgType[Serial.InputQueueHigh].depth should be >= 32
+      op ! Serial.GetQueueDepths
+      expectMsgType[Serial.QueueDepths].input should be >= 32
+
+      op ! Serial.ResumeReading
+      var received = ByteString.empty
+      var low = false
+      while (received.length < data.length || !low) {
+        expectMsgPF(5.seconds) {
+          case Serial.Received(chunk) => received ++= chunk
+          case Serial.InputQueueLow(depth) =>
+            depth shouldBe 0
+            low = true
+        }
+      }
+      received shouldBe data
+
+      op ! Serial.UnwatchQueues
+      op ! Serial.Close
+      expectMsg(Serial.Closed)
+    }
+
+    "acknowledge writes larger than its buffer once completely accepted" in withEchoOp { op =>
+      expectMsgType[Serial.Opened]
+
+      val data = ByteString(Array.tabulate[Byte](64 * 1024)(i => (i % 251).toByte))
+      op ! Serial.Write(data, Ack(_))
+
+      var received = ByteString.empty
+      var acked = false
+      while (received.length < data.length || !acked) {
+        expectMsgPF(5.seconds) {
+          case Serial.Received(chunk) => received ++= chunk
+          case Ack(n) =>
+            n shouldBe data.length
+            acked = true
+        }
+      }
+      received shouldBe data
+
+      op ! Serial.Close
+      expectMsg(Serial.Closed)
+    }
+
   }
 
 }
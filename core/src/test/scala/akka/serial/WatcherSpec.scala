@@ -0,0 +1,73 @@
+package akka.serial
+
+import java.nio.file.{Files, Path}
+import scala.concurrent.duration._
+
+import akka.actor.ActorSystem
+import akka.testkit.{ImplicitSender, TestKit}
+import org.scalatest._
+import sync.UnsafeSerial
+
+class WatcherSpec
+    extends TestKit(ActorSystem("serial-watcher"))
+    with ImplicitSender
+    with WordSpecLike
+    with Matchers
+    with BeforeAndAfterAll {
+
+  override def afterAll {
+    TestKit.shutdownActorSystem(system)
+  }
+
+  /** A uevent of a tty, as sent by the kernel and followed by an empty field. */
+  def uevent(action: String, devpath: String, name: String): String =
+    Seq(s"$action@$devpath", s"ACTION=$action", s"DEVPATH=$devpath", "SUBSYSTEM=tty", s"DEVNAME=$name")
+      .map(_ + "\u0000").mkString + "\u0000"
+
+  /** Creates a USB device with a tty in a fake sysfs tree. */
+  def usbTty(root: Path, usb: String, vendor: String, name: String): String = {
+    val device = Files.createDirectories(root.resolve(s"devices/usb1/$usb"))
+    Files.write(device.resolve("idVendor"), s"$vendor\n".getBytes)
+    Files.write(device.resolve("idProduct"), "6001\n".getBytes)
+    val tty = Files.createDirectories(device.resolve(s"$usb:1.0/$name/tty/$name"))
+    Files.write(tty.resolve("uevent"), s"DEVNAME=$name\n".getBytes)
+    s"/devices/usb1/$usb/$usb:1.0/$name/tty/$name"
+  }
+
+  "Watcher" should {
+
+    "report connected and disconnected devices matching its filters" in {
+      val root = Files.createTempDirectory("akka-serial-sysfs")
+      val ftdi = usbTty(root, "1-1", "0403", "ttyUSB0")
+      val arduino = usbTty(root, "1-2", "2341", "ttyACM0")
+      val events = Files.write(root.resolve("uevents"), (
+        uevent("add", arduino, "ttyACM0") +
+        uevent("add", ftdi, "ttyUSB0") +
+        uevent("remove", arduino, "ttyACM0") +
+        uevent("remove", ftdi, "ttyUSB0")
+      ).getBytes("UTF-8"))
+
+      UnsafeSerial.sysfsRoot(root.toString)
+      try {
+        val watcher = system.actorOf(Watcher(testActor, Some(events.toString)))
+        watcher ! Serial.Watch("/dev", skipInitial = true, filters = Seq(DeviceFilter(vendor = Some(0x0403))))
+        expectMsg(Serial.Connected("/dev/ttyUSB0"))
+        expectMsg(Serial.Disconnected("/dev/ttyUSB0"))
+        expectNoMessage(100.millis)
+        system.stop(watcher)
+      } finally {
+        UnsafeSerial.sysfsRoot("/sys")
+      }
+    }
+
+    "fail watching a directory that does not exist" in {
+      val watcher = system.actorOf(Watcher(testActor))
+      val cmd = Serial.Watch("/nonexistent")
+      watcher ! cmd
+      assert(expectMsgType[Serial.CommandFailed].command == cmd)
+      system.stop(watcher)
+    }
+
+  }
+
+}
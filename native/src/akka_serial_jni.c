@@ -1,39 +1,179 @@
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "akka_serial.h"
 
 #include "akka_serial_sync_UnsafeSerial.h"
 #include "akka_serial_sync_UnsafeSerial__.h"
+#include "akka_serial_sync_UnsafeReactor.h"
+#include "akka_serial_sync_UnsafeReactor__.h"
+#include "akka_serial_sync_UnsafeMonitor.h"
+#include "akka_serial_sync_UnsafeMonitor__.h"
+
+// maximum number of ready tokens retrieved per reactor wait
+#define MAX_TOKENS 256
+
+// number of buffers of a gather write that are handled without allocating memory
+#define STACK_BUFFERS 16
 
 // suppress unused parameter warnings
 #define UNUSED_ARG(x) (void)(x)
 
-static inline void throwException(JNIEnv* env, const char* const exception, const char * const message)
+/** A heap buffer of a gather write, whose backing array is pinned during the write. */
+struct heap_buffer {
+	jbyteArray array; // backing array, NULL for direct buffers
+	jint offset; // index of first byte to write in backing array
+	void* pinned; // elements of pinned array, NULL if not pinned
+};
+
+/* Classes and fields used by natives, looked up once when the library is
+ * loaded. Classes are held as global references, so that cached IDs remain
+ * valid. */
+static struct {
+	jclass io_exception;
+	jclass port_in_use_exception;
+	jclass access_denied_exception;
+	jclass invalid_settings_exception;
+	jclass port_interrupted_exception;
+	jclass no_such_port_exception;
+	jclass unsupported_operation_exception;
+	jclass illegal_argument_exception;
+	jclass null_pointer_exception;
+	jclass out_of_memory_error;
+	jfieldID buffer_position; // Buffer.position
+	jfieldID buffer_limit; // Buffer.limit
+	jfieldID buffer_array; // ByteBuffer.hb, NULL if not available on the running VM
+	jfieldID buffer_offset; // ByteBuffer.offset, NULL if not available on the running VM
+	jfieldID reactor_addr; // UnsafeReactor.reactorAddr, looked up on first use
+	jfieldID monitor_addr; // UnsafeMonitor.monitorAddr, looked up on first use
+} cache;
+
+static const struct {
+	jclass* clazz;
+	const char* name;
+} cached_classes[] = {
+	{&cache.io_exception, "java/io/IOException"},
+	{&cache.port_in_use_exception, "akka/serial/PortInUseException"},
+	{&cache.access_denied_exception, "akka/serial/AccessDeniedException"},
+	{&cache.invalid_settings_exception, "akka/serial/InvalidSettingsException"},
+	{&cache.port_interrupted_exception, "akka/serial/PortInterruptedException"},
+	{&cache.no_such_port_exception, "akka/serial/NoSuchPortException"},
+	{&cache.unsupported_operation_exception, "java/lang/UnsupportedOperationException"},
+	{&cache.illegal_argument_exception, "java/lang/IllegalArgumentException"},
+	{&cache.null_pointer_exception, "java/lang/NullPointerException"},
+	{&cache.out_of_memory_error, "java/lang/OutOfMemoryError"}
+};
+
+#define CACHED_CLASSES (sizeof(cached_classes) / sizeof(cached_classes[0]))
+
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved)
+{
+	UNUSED_ARG(reserved);
+
+	JNIEnv* env;
+	if ((*vm)->GetEnv(vm, (void**) &env, JNI_VERSION_1_6) != JNI_OK) return JNI_ERR;
+
+	for (size_t i = 0; i < CACHED_CLASSES; ++i) {
+		jclass local = (*env)->FindClass(env, cached_classes[i].name);
+		if (local == NULL) return JNI_ERR; // NoClassDefFoundError pending
+		*cached_classes[i].clazz = (jclass) (*env)->NewGlobalRef(env, local);
+		(*env)->DeleteLocalRef(env, local);
+		if (*cached_classes[i].clazz == NULL) return JNI_ERR;
+	}
+
+	jclass buffer_class = (*env)->FindClass(env, "java/nio/Buffer");
+	if (buffer_class == NULL) return JNI_ERR;
+	cache.buffer_position = (*env)->GetFieldID(env, buffer_class, "position", "I");
+	cache.buffer_limit = (*env)->GetFieldID(env, buffer_class, "limit", "I");
+	(*env)->DeleteLocalRef(env, buffer_class);
+	if (cache.buffer_position == NULL || cache.buffer_limit == NULL) return JNI_ERR;
+
+	/* the backing array of a heap buffer is accessed through its fields, since
+	 * ByteBuffer.array() is not available for read-only buffers, as created by
+	 * ByteString.asByteBuffers */
+	jclass byte_buffer_class = (*env)->FindClass(env, "java/nio/ByteBuffer");
+	if (byte_buffer_class == NULL) return JNI_ERR;
+	cache.buffer_array = (*env)->GetFieldID(env, byte_buffer_class, "hb", "[B");
+	if (cache.buffer_array == NULL) (*env)->ExceptionClear(env);
+	cache.buffer_offset = (*env)->GetFieldID(env, byte_buffer_class, "offset", "I");
+	if (cache.buffer_offset == NULL) (*env)->ExceptionClear(env);
+	(*env)->DeleteLocalRef(env, byte_buffer_class);
+
+	return JNI_VERSION_1_6;
+}
+
+JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved)
+{
+	UNUSED_ARG(reserved);
+
+	JNIEnv* env;
+	if ((*vm)->GetEnv(vm, (void**) &env, JNI_VERSION_1_6) != JNI_OK) return;
+
+	for (size_t i = 0; i < CACHED_CLASSES; ++i) {
+		if (*cached_classes[i].clazz != NULL) {
+			(*env)->DeleteGlobalRef(env, *cached_classes[i].clazz);
+			*cached_classes[i].clazz = NULL;
+		}
+	}
+}
+
+static inline void throwException(JNIEnv* env, jclass exception, const char * const message)
 {
-	(*env)->ThrowNew(env, (*env)->FindClass(env, exception), message);
+	(*env)->ThrowNew(env, exception, message);
 }
 
 /** Check return code and throw exception in case it is non-zero. */
 static void check(JNIEnv* env, int ret)
 {
 	switch (ret) {
-	case -E_IO: throwException(env, "java/io/IOException", ""); break;
-	case -E_BUSY: throwException(env, "akka/serial/PortInUseException", ""); break;
-	case -E_ACCESS_DENIED: throwException(env, "akka/serial/AccessDeniedException", ""); break;
-	case -E_INVALID_SETTINGS: throwException(env, "akka/serial/InvalidSettingsException", ""); break;
-	case -E_INTERRUPT: throwException(env, "akka/serial/PortInterruptedException", ""); break;
-	case -E_NO_PORT: throwException(env, "akka/serial/NoSuchPortException", ""); break;
+	case -E_IO: throwException(env, cache.io_exception, ""); break;
+	case -E_BUSY: throwException(env, cache.port_in_use_exception, ""); break;
+	case -E_ACCESS_DENIED: throwException(env, cache.access_denied_exception, ""); break;
+	case -E_INVALID_SETTINGS: throwException(env, cache.invalid_settings_exception, ""); break;
+	case -E_INTERRUPT: throwException(env, cache.port_interrupted_exception, ""); break;
+	case -E_NO_PORT: throwException(env, cache.no_such_port_exception, ""); break;
+	case -E_UNSUPPORTED: throwException(env, cache.unsupported_operation_exception, ""); break;
 	default: return;
 	}
 }
 
-/** Get pointer to serial config associated to an UnsafeSerial instance. */
-static struct serial_config* get_config(JNIEnv* env, jobject unsafe_serial)
+/** Get pointer to serial config from its address, as passed to natives of UnsafeSerial. */
+static inline struct serial_config* to_config(jlong serial)
+{
+	return (struct serial_config*) (intptr_t) serial;
+}
+
+/** Get pointer to reactor associated to an UnsafeReactor instance.
+ * Returns NULL if its address field is not found, a NoSuchFieldError is then thrown. */
+static struct serial_reactor* get_reactor(JNIEnv* env, jobject unsafe_reactor)
+{
+	/* looked up lazily rather than when loading, since finding UnsafeReactor
+	 * would initialize it, which in turn loads this library; racing threads
+	 * store the same ID */
+	if (cache.reactor_addr == NULL) {
+		jclass clazz = (*env)->GetObjectClass(env, unsafe_reactor);
+		cache.reactor_addr = (*env)->GetFieldID(env, clazz, "reactorAddr", "J");
+		(*env)->DeleteLocalRef(env, clazz);
+		if (cache.reactor_addr == NULL) return NULL;
+	}
+	jlong addr = (*env)->GetLongField(env, unsafe_reactor, cache.reactor_addr);
+	return (struct serial_reactor*) (intptr_t) addr;
+}
+
+/** Get pointer to monitor associated to an UnsafeMonitor instance.
+ * Returns NULL if its address field is not found, a NoSuchFieldError is then thrown. */
+static struct serial_monitor* get_monitor(JNIEnv* env, jobject unsafe_monitor)
 {
-	jclass clazz = (*env)->FindClass(env, "akka/serial/sync/UnsafeSerial");
-	jfieldID field = (*env)->GetFieldID(env, clazz, "serialAddr", "J");
-	jlong addr = (*env)->GetLongField(env, unsafe_serial, field);
-	return (struct serial_config*) (intptr_t) addr;
+	// looked up lazily for the same reason as UnsafeReactor.reactorAddr
+	if (cache.monitor_addr == NULL) {
+		jclass clazz = (*env)->GetObjectClass(env, unsafe_monitor);
+		cache.monitor_addr = (*env)->GetFieldID(env, clazz, "monitorAddr", "J");
+		(*env)->DeleteLocalRef(env, clazz);
+		if (cache.monitor_addr == NULL) return NULL;
+	}
+	jlong addr = (*env)->GetLongField(env, unsafe_monitor, cache.monitor_addr);
+	return (struct serial_monitor*) (intptr_t) addr;
 }
 
 /*
@@ -61,20 +201,115 @@ JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeSerial_00024_open
 }
 
 /*
- * Class:     akka_serial_sync_UnsafeSerial
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    setReadCoalescing
+ * Signature: (JII)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_setReadCoalescing
+(JNIEnv *env, jobject instance, jlong serial, jint min_size, jint timeout)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_set_read_coalescing(to_config(serial), (size_t) min_size, (unsigned int) timeout);
+	if (r < 0) {
+		check(env, r);
+	}
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    setFlowControl
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_setFlowControl
+(JNIEnv *env, jobject instance, jlong serial, jint flow)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_set_flow_control(to_config(serial), flow);
+	if (r < 0) {
+		check(env, r);
+	}
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    suspendReading
+ * Signature: (JZ)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_suspendReading
+(JNIEnv *env, jobject instance, jlong serial, jboolean suspended)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_suspend_reading(to_config(serial), suspended);
+	if (r < 0) {
+		check(env, r);
+	}
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    setFraming
+ * Signature: (JII[BZIIZIIIZI)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_setFraming
+(JNIEnv *env, jobject instance, jlong serial, jint kind, jint max_size, jbyteArray delimiter,
+ jboolean strip_delimiter, jint length_offset, jint length_width, jboolean big_endian, jint length_adjustment,
+ jint checksum, jint checksum_offset, jboolean checksum_big_endian, jint gap)
+{
+	UNUSED_ARG(instance);
+
+	struct serial_framing framing;
+	memset(&framing, 0, sizeof(framing));
+	framing.kind = kind;
+	framing.max_size = max_size < 0 ? 0 : (size_t) max_size;
+
+	jsize delimiter_size = delimiter == NULL ? 0 : (*env)->GetArrayLength(env, delimiter);
+	if (delimiter_size > FRAMING_DELIMITER_MAX) {
+		throwException(env, cache.invalid_settings_exception, "Delimiter is too long");
+		return;
+	}
+	if (delimiter_size > 0) {
+		(*env)->GetByteArrayRegion(env, delimiter, 0, delimiter_size, (jbyte*) framing.delimiter);
+	}
+	framing.delimiter_size = (size_t) delimiter_size;
+	framing.strip_delimiter = strip_delimiter;
+
+	framing.length_offset = length_offset < 0 ? 0 : (size_t) length_offset;
+	framing.length_width = length_width < 0 ? 0 : (size_t) length_width;
+	framing.length_big_endian = big_endian;
+	framing.length_adjustment = length_adjustment;
+
+	framing.checksum = checksum;
+	framing.checksum_offset = checksum_offset < 0 ? 0 : (size_t) checksum_offset;
+	framing.checksum_big_endian = checksum_big_endian;
+
+	framing.gap = gap < 0 ? 0 : (unsigned int) gap;
+
+	int r = serial_set_framing(to_config(serial), &framing);
+	if (r < 0) {
+		check(env, r);
+	}
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
  * Method:    read
- * Signature: (Ljava/nio/ByteBuffer;)I
+ * Signature: (JLjava/nio/ByteBuffer;)I
  */
-JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_read
-(JNIEnv *env, jobject instance, jobject buffer)
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_read
+(JNIEnv *env, jobject instance, jlong serial, jobject buffer)
 {
+	UNUSED_ARG(instance);
+
 	char* local_buffer = (char*) (*env)->GetDirectBufferAddress(env, buffer);
 	if (local_buffer == NULL) {
-		throwException(env, "java/lang/IllegalArgumentException", "buffer is not direct");
+		throwException(env, cache.illegal_argument_exception, "buffer is not direct");
 		return -E_IO;
 	}
 	size_t size = (size_t) (*env)->GetDirectBufferCapacity(env, buffer);
-	struct serial_config* config = get_config(env, instance);
+	struct serial_config* config = to_config(serial);
 
 	int r = serial_read(config, local_buffer, size);
 	if (r < 0) {
@@ -85,35 +320,202 @@ JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_read
 }
 
 /*
- * Class:     akka_serial_sync_UnsafeSerial
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    readAddress
+ * Signature: (JJI)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_readAddress
+(JNIEnv *env, jobject instance, jlong serial, jlong address, jint size)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_read(to_config(serial), (char*) (intptr_t) address, (size_t) size);
+	if (r < 0) {
+		check(env, r);
+	}
+	return r;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    tryRead
+ * Signature: (JLjava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_tryRead
+(JNIEnv *env, jobject instance, jlong serial, jobject buffer)
+{
+	UNUSED_ARG(instance);
+
+	char* local_buffer = (char*) (*env)->GetDirectBufferAddress(env, buffer);
+	if (local_buffer == NULL) {
+		throwException(env, cache.illegal_argument_exception, "buffer is not direct");
+		return -E_IO;
+	}
+	size_t size = (size_t) (*env)->GetDirectBufferCapacity(env, buffer);
+
+	int r = serial_try_read(to_config(serial), local_buffer, size);
+	if (r < 0) {
+		check(env, r);
+	}
+	return r;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    tryReadAddress
+ * Signature: (JJI)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_tryReadAddress
+(JNIEnv *env, jobject instance, jlong serial, jlong address, jint size)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_try_read(to_config(serial), (char*) (intptr_t) address, (size_t) size);
+	if (r < 0) {
+		check(env, r);
+	}
+	return r;
+}
+
+/* Checks that a range of an array is within its bounds, throwing an exception if not. */
+static bool check_range(JNIEnv *env, jbyteArray array, jint offset, jint length)
+{
+	jsize size = (*env)->GetArrayLength(env, array);
+	if (offset < 0 || length < 0 || offset > size - length) {
+		throwException(env, cache.illegal_argument_exception, "range is out of array bounds");
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    tryReadArray
+ * Signature: (J[BII)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_tryReadArray
+(JNIEnv *env, jobject instance, jlong serial, jbyteArray array, jint offset, jint length)
+{
+	UNUSED_ARG(instance);
+
+	if (!check_range(env, array, offset, length)) return -E_INVALID_SETTINGS;
+
+	/* the read does not block, hence data is read straight into the pinned
+	 * array; blocking reads must not pin arrays, as that would stall the
+	 * garbage collector while they wait */
+	char* pinned = (char*) (*env)->GetPrimitiveArrayCritical(env, array, NULL);
+	if (pinned == NULL) return -E_IO; // OutOfMemoryError pending
+	int r = serial_try_read(to_config(serial), pinned + offset, (size_t) length);
+	(*env)->ReleasePrimitiveArrayCritical(env, array, pinned, r > 0 ? 0 : JNI_ABORT);
+
+	if (r < 0) {
+		check(env, r);
+	}
+	return r;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    takeDrained
+ * Signature: (J)Z
+ */
+JNIEXPORT jboolean JNICALL Java_akka_serial_sync_UnsafeSerial_00024_takeDrained
+(JNIEnv *env, jobject instance, jlong serial)
+{
+	UNUSED_ARG(env);
+	UNUSED_ARG(instance);
+
+	return serial_take_drained(to_config(serial)) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    readTimestamp
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeSerial_00024_readTimestamp
+(JNIEnv *env, jobject instance, jlong serial)
+{
+	UNUSED_ARG(env);
+	UNUSED_ARG(instance);
+
+	return (jlong) serial_read_timestamp(to_config(serial));
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    fill
+ * Signature: (JLjava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_fill
+(JNIEnv *env, jobject instance, jlong serial, jobject ring)
+{
+	UNUSED_ARG(instance);
+
+	char* local_ring = (char*) (*env)->GetDirectBufferAddress(env, ring);
+	if (local_ring == NULL) {
+		throwException(env, cache.illegal_argument_exception, "ring is not direct");
+		return -E_IO;
+	}
+	size_t capacity = (size_t) (*env)->GetDirectBufferCapacity(env, ring) - RING_DATA;
+
+	int r = serial_ring_fill(to_config(serial), local_ring, capacity);
+	if (r < 0) {
+		check(env, r);
+	}
+	return r;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    wakeRing
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_wakeRing
+(JNIEnv *env, jobject instance, jlong serial)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_ring_wake(to_config(serial));
+	if (r < 0) {
+		check(env, r);
+	}
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
  * Method:    cancelRead
- * Signature: ()V
+ * Signature: (J)V
  */
-JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_cancelRead
-(JNIEnv *env, jobject instance)
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_cancelRead
+(JNIEnv *env, jobject instance, jlong serial)
 {
-	int r = serial_cancel_read(get_config(env, instance));
+	UNUSED_ARG(instance);
+
+	int r = serial_cancel_read(to_config(serial));
 	if (r < 0) {
 		check(env, r);
 	}
 }
 
 /*
- * Class:     akka_serial_sync_UnsafeSerial
+ * Class:     akka_serial_sync_UnsafeSerial__
  * Method:    write
- * Signature: (Ljava/nio/ByteBuffer;I)I
+ * Signature: (JLjava/nio/ByteBuffer;I)I
  */
-JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_write
-(JNIEnv *env, jobject instance, jobject buffer, jint size)
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_write
+(JNIEnv *env, jobject instance, jlong serial, jobject buffer, jint size)
 {
+	UNUSED_ARG(instance);
+
 
 	char* local_buffer = (char *) (*env)->GetDirectBufferAddress(env, buffer);
 	if (local_buffer == NULL) {
-		throwException(env, "java/lang/IllegalArgumentException", "buffer is not direct");
+		throwException(env, cache.illegal_argument_exception, "buffer is not direct");
 		return -E_IO;
 	}
 
-	int r = serial_write(get_config(env, instance), local_buffer, (size_t) size);
+	int r = serial_write(to_config(serial), local_buffer, (size_t) size);
 	if (r < 0) {
 		check(env, r);
 		return -E_IO;
@@ -122,29 +524,824 @@ JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_write
 }
 
 /*
- * Class:     akka_serial_sync_UnsafeSerial
- * Method:    close
- * Signature: ()V
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    writeAddress
+ * Signature: (JJI)I
  */
-JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_close
-(JNIEnv *env, jobject instance)
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_writeAddress
+(JNIEnv *env, jobject instance, jlong serial, jlong address, jint length)
 {
-	int r = serial_close(get_config(env, instance));
+	UNUSED_ARG(instance);
+
+	int r = serial_write(to_config(serial), (char*) (intptr_t) address, (size_t) length);
 	if (r < 0) {
 		check(env, r);
+		return -E_IO;
 	}
+	return r;
 }
 
 /*
  * Class:     akka_serial_sync_UnsafeSerial__
- * Method:    debug
- * Signature: (Z)V
+ * Method:    writev
+ * Signature: (J[Ljava/nio/ByteBuffer;)I
  */
-JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_debug
-(JNIEnv *env, jobject instance, jboolean value)
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_writev
+(JNIEnv *env, jobject instance, jlong serial, jobjectArray buffers)
+{
+	UNUSED_ARG(instance);
+
+	struct serial_config* config = to_config(serial);
+	jsize count = (*env)->GetArrayLength(env, buffers);
+
+	struct serial_buffer stack_local[STACK_BUFFERS];
+	struct heap_buffer stack_heap[STACK_BUFFERS];
+	struct serial_buffer* local = stack_local;
+	struct heap_buffer* heap = stack_heap;
+	if (count > STACK_BUFFERS) {
+		local = malloc(count * sizeof(*local));
+		heap = malloc(count * sizeof(*heap));
+		if (local == NULL || heap == NULL) {
+			free(local);
+			free(heap);
+			throwException(env, cache.out_of_memory_error, "cannot allocate gather write buffers");
+			return -E_IO;
+		}
+	}
+
+	int r = -E_IO;
+	jsize resolved = 0; // number of buffers whose heap_buffer entry is initialized
+	if ((*env)->EnsureLocalCapacity(env, count + 1) < 0) goto out; // OutOfMemoryError pending
+
+	/* resolve all buffers before pinning any heap arrays, no other JNI
+	 * functions may be called while arrays are pinned */
+	for (; resolved < count; ++resolved) {
+		jobject buffer = (*env)->GetObjectArrayElement(env, buffers, resolved);
+		if (buffer == NULL) {
+			throwException(env, cache.null_pointer_exception, "buffer is null");
+			goto release;
+		}
+		jint position = (*env)->GetIntField(env, buffer, cache.buffer_position);
+		jint limit = (*env)->GetIntField(env, buffer, cache.buffer_limit);
+		char* address = (char*) (*env)->GetDirectBufferAddress(env, buffer);
+
+		struct heap_buffer* h = &heap[resolved];
+		h->pinned = NULL;
+		if (address != NULL) {
+			h->array = NULL;
+			local[resolved].data = address + position;
+		} else if (cache.buffer_array != NULL && cache.buffer_offset != NULL) {
+			h->array = (jbyteArray) (*env)->GetObjectField(env, buffer, cache.buffer_array);
+			h->offset = (*env)->GetIntField(env, buffer, cache.buffer_offset) + position;
+		} else {
+			(*env)->DeleteLocalRef(env, buffer);
+			throwException(env, cache.unsupported_operation_exception, "heap buffers are not supported by this VM");
+			goto release;
+		}
+		local[resolved].size = (size_t) (limit - position);
+		(*env)->DeleteLocalRef(env, buffer);
+	}
+
+	for (jsize i = 0; i < count; ++i) {
+		if (heap[i].array != NULL) {
+			heap[i].pinned = (*env)->GetPrimitiveArrayCritical(env, heap[i].array, NULL);
+			if (heap[i].pinned == NULL) goto release; // OutOfMemoryError pending
+			local[i].data = (char*) heap[i].pinned + heap[i].offset;
+		}
+	}
+
+	r = serial_writev(config, local, (size_t) count);
+
+release:
+	for (jsize i = resolved - 1; i >= 0; --i) {
+		if (heap[i].pinned != NULL) {
+			// data is only read, hence there is nothing to copy back
+			(*env)->ReleasePrimitiveArrayCritical(env, heap[i].array, heap[i].pinned, JNI_ABORT);
+		}
+	}
+	if (r < 0 && !(*env)->ExceptionCheck(env)) check(env, r);
+
+out:
+	if (local != stack_local) {
+		free(local);
+		free(heap);
+	}
+	return r;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    drain
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeSerial_00024_drain
+(JNIEnv *env, jobject instance, jlong serial)
+{
+	UNUSED_ARG(instance);
+
+	int64_t timestamp;
+	int r = serial_drain(to_config(serial), &timestamp);
+	if (r < 0) {
+		check(env, r);
+		return 0;
+	}
+	return (jlong) timestamp;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    readEngine
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_readEngine
+(JNIEnv *env, jobject instance, jlong serial)
 {
 	UNUSED_ARG(env);
 	UNUSED_ARG(instance);
 
-	serial_debug((bool) value);
+	return serial_get_engine(to_config(serial));
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    speed
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_speed
+(JNIEnv *env, jobject instance, jlong serial)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_get_speed(to_config(serial));
+	if (r < 0) {
+		check(env, r);
+	}
+	return r;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    inputQueued
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_inputQueued
+(JNIEnv *env, jobject instance, jlong serial)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_input_queued(to_config(serial));
+	if (r < 0) {
+		check(env, r);
+	}
+	return r;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    outputQueued
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_outputQueued
+(JNIEnv *env, jobject instance, jlong serial)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_output_queued(to_config(serial));
+	if (r < 0) {
+		check(env, r);
+	}
+	return r;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    stats
+ * Signature: (J[J)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_stats
+(JNIEnv *env, jobject instance, jlong serial, jlongArray values)
+{
+	UNUSED_ARG(instance);
+
+	struct serial_stats stats;
+	int r = serial_get_stats(to_config(serial), &stats);
+	if (r < 0) {
+		check(env, r);
+		return;
+	}
+
+	// in the order of the fields of serial_stats
+	jlong snapshot[] = {
+		(jlong) stats.bytes_read,
+		(jlong) stats.bytes_written,
+		(jlong) stats.reads,
+		(jlong) stats.writes,
+		(jlong) stats.wakeups,
+		(jlong) stats.cancels,
+		stats.overruns,
+		stats.buffer_overruns,
+		stats.frame_errors,
+		stats.parity_errors,
+		stats.breaks
+	};
+	jsize count = (jsize) (sizeof(snapshot) / sizeof(snapshot[0]));
+	if ((*env)->GetArrayLength(env, values) < count) {
+		throwException(env, cache.illegal_argument_exception, "array is too small for statistics");
+		return;
+	}
+	(*env)->SetLongArrayRegion(env, values, 0, count, snapshot);
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    lowLatency
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_lowLatency
+(JNIEnv *env, jobject instance, jlong serial)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_set_low_latency(to_config(serial));
+	if (r < 0) {
+		check(env, r);
+	}
+	return r;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    latencyTimer
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_latencyTimer
+(JNIEnv *env, jobject instance, jlong serial)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_get_latency_timer(to_config(serial));
+	if (r == -E_UNSUPPORTED) {
+		return -1;
+	} else if (r < 0) {
+		check(env, r);
+	}
+	return r;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    close
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_close
+(JNIEnv *env, jobject instance, jlong serial)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_close(to_config(serial));
+	if (r < 0) {
+		check(env, r);
+	}
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    engine
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_engine
+(JNIEnv *env, jobject instance, jint value)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_engine(value);
+	if (r < 0) {
+		check(env, r);
+	}
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    sysfsRoot
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_sysfsRoot
+(JNIEnv *env, jobject instance, jstring value)
+{
+	UNUSED_ARG(instance);
+
+	const char *root = (*env)->GetStringUTFChars(env, value, 0);
+	int r = serial_sysfs_root(root);
+	(*env)->ReleaseStringUTFChars(env, value, root);
+
+	if (r < 0) {
+		check(env, r);
+	}
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    address
+ * Signature: (Ljava/nio/ByteBuffer;)J
+ */
+JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeSerial_00024_address
+(JNIEnv *env, jobject instance, jobject buffer)
+{
+	UNUSED_ARG(instance);
+
+	void* address = (*env)->GetDirectBufferAddress(env, buffer);
+	if (address == NULL) {
+		throwException(env, cache.illegal_argument_exception, "buffer is not direct");
+		return 0;
+	}
+	return (jlong) (intptr_t) address;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    scanKernel
+ * Signature: (I)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_scanKernel
+(JNIEnv *env, jobject instance, jint value)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_scan_kernel(value);
+	if (r < 0) {
+		check(env, r);
+	}
+	return r;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    scan
+ * Signature: (Ljava/nio/ByteBuffer;BB[I)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_scan
+(JNIEnv *env, jobject instance, jobject buffer, jbyte first, jbyte second, jintArray positions)
+{
+	UNUSED_ARG(instance);
+
+	jint position = (*env)->GetIntField(env, buffer, cache.buffer_position);
+	jint limit = (*env)->GetIntField(env, buffer, cache.buffer_limit);
+	jsize count = (*env)->GetArrayLength(env, positions);
+
+	// heap buffers, including read-only ones, are scanned in their backing array
+	char* data = (char*) (*env)->GetDirectBufferAddress(env, buffer);
+	jbyteArray array = NULL;
+	jint offset = 0;
+	if (data == NULL) {
+		if (cache.buffer_array == NULL || cache.buffer_offset == NULL) {
+			throwException(env, cache.unsupported_operation_exception, "heap buffers are not supported by this VM");
+			return -E_UNSUPPORTED;
+		}
+		array = (jbyteArray) (*env)->GetObjectField(env, buffer, cache.buffer_array);
+		if (array == NULL) {
+			throwException(env, cache.illegal_argument_exception, "buffer is neither direct nor backed by an array");
+			return -E_INVALID_SETTINGS;
+		}
+		offset = (*env)->GetIntField(env, buffer, cache.buffer_offset);
+	}
+
+	// no other JNI functions may be called while arrays are pinned
+	jint* found = (jint*) (*env)->GetPrimitiveArrayCritical(env, positions, NULL);
+	if (found == NULL) return -E_IO; // OutOfMemoryError pending
+	void* pinned = NULL;
+	if (array != NULL) {
+		pinned = (*env)->GetPrimitiveArrayCritical(env, array, NULL);
+		if (pinned == NULL) {
+			(*env)->ReleasePrimitiveArrayCritical(env, positions, found, JNI_ABORT);
+			return -E_IO;
+		}
+		data = (char*) pinned + offset;
+	}
+
+	jint n = 0;
+	size_t i = (size_t) position;
+	while (n < count && i < (size_t) limit) {
+		i += serial_scan(data + i, (size_t) limit - i, (char) first, (char) second);
+		if (i < (size_t) limit) found[n++] = (jint) i++;
+	}
+
+	if (pinned != NULL) {
+		// data is only read, hence there is nothing to copy back
+		(*env)->ReleasePrimitiveArrayCritical(env, array, pinned, JNI_ABORT);
+	}
+	(*env)->ReleasePrimitiveArrayCritical(env, positions, found, 0);
+	return n;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    checksumKernel
+ * Signature: (I)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_checksumKernel
+(JNIEnv *env, jobject instance, jint value)
+{
+	UNUSED_ARG(instance);
+
+	int r = serial_checksum_kernel(value);
+	if (r < 0) {
+		check(env, r);
+	}
+	return r;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    checksum
+ * Signature: (ILjava/nio/ByteBuffer;)J
+ */
+JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeSerial_00024_checksum
+(JNIEnv *env, jobject instance, jint kind, jobject buffer)
+{
+	UNUSED_ARG(instance);
+
+	jint position = (*env)->GetIntField(env, buffer, cache.buffer_position);
+	jint limit = (*env)->GetIntField(env, buffer, cache.buffer_limit);
+	size_t size = limit > position ? (size_t) (limit - position) : 0;
+
+	// heap buffers, including read-only ones, are checksummed in their backing array
+	char* data = (char*) (*env)->GetDirectBufferAddress(env, buffer);
+	if (data != NULL) {
+		int64_t r = serial_checksum(kind, data + position, size);
+		if (r < 0) {
+			check(env, (int) r);
+		}
+		return r;
+	}
+	if (cache.buffer_array == NULL || cache.buffer_offset == NULL) {
+		throwException(env, cache.unsupported_operation_exception, "heap buffers are not supported by this VM");
+		return -E_UNSUPPORTED;
+	}
+	jbyteArray array = (jbyteArray) (*env)->GetObjectField(env, buffer, cache.buffer_array);
+	if (array == NULL) {
+		throwException(env, cache.illegal_argument_exception, "buffer is neither direct nor backed by an array");
+		return -E_INVALID_SETTINGS;
+	}
+	jint offset = (*env)->GetIntField(env, buffer, cache.buffer_offset);
+
+	// no other JNI functions may be called while the array is pinned
+	char* pinned = (char*) (*env)->GetPrimitiveArrayCritical(env, array, NULL);
+	if (pinned == NULL) return -E_IO; // OutOfMemoryError pending
+	int64_t r = serial_checksum(kind, pinned + offset + position, size);
+	(*env)->ReleasePrimitiveArrayCritical(env, array, pinned, JNI_ABORT);
+
+	if (r < 0) {
+		check(env, (int) r);
+	}
+	return r;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    timestamp
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeSerial_00024_timestamp
+(JNIEnv *env, jobject instance)
+{
+	UNUSED_ARG(env);
+	UNUSED_ARG(instance);
+	return (jlong) serial_timestamp();
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeSerial__
+ * Method:    debug
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_debug
+(JNIEnv *env, jobject instance, jboolean value)
+{
+	UNUSED_ARG(env);
+	UNUSED_ARG(instance);
+
+	serial_debug((bool) value);
+}
+
+
+/*
+ * Class:     akka_serial_sync_UnsafeReactor__
+ * Method:    open
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeReactor_00024_open
+(JNIEnv *env, jobject instance)
+{
+	UNUSED_ARG(instance);
+
+	struct serial_reactor* reactor;
+	int r = serial_reactor_open(&reactor);
+	if (r < 0) {
+		check(env, r);
+		return -E_IO;
+	}
+	return (jlong) (intptr_t) reactor;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeReactor
+ * Method:    register
+ * Signature: (JJ)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeReactor_register
+(JNIEnv *env, jobject instance, jlong serial, jlong token)
+{
+	struct serial_config* config = (struct serial_config*) (intptr_t) serial;
+	struct serial_reactor* reactor = get_reactor(env, instance);
+	if (reactor == NULL) return;
+
+	int r = serial_reactor_register(reactor, config, (int64_t) token);
+	if (r < 0) {
+		check(env, r);
+	}
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeReactor
+ * Method:    unregister
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeReactor_unregister
+(JNIEnv *env, jobject instance, jlong serial)
+{
+	struct serial_config* config = (struct serial_config*) (intptr_t) serial;
+	struct serial_reactor* reactor = get_reactor(env, instance);
+	if (reactor == NULL) return;
+
+	int r = serial_reactor_unregister(reactor, config);
+	if (r < 0) {
+		check(env, r);
+	}
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeReactor
+ * Method:    await
+ * Signature: ([J)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeReactor_await
+(JNIEnv *env, jobject instance, jlongArray tokens)
+{
+	int64_t local_tokens[MAX_TOKENS];
+	size_t max = (size_t) (*env)->GetArrayLength(env, tokens);
+	if (max > MAX_TOKENS) max = MAX_TOKENS;
+
+	struct serial_reactor* reactor = get_reactor(env, instance);
+	if (reactor == NULL) return -E_IO;
+
+	int r = serial_reactor_wait(reactor, local_tokens, max);
+	if (r < 0) {
+		check(env, r);
+		return r;
+	}
+	(*env)->SetLongArrayRegion(env, tokens, 0, r, (const jlong*) local_tokens);
+	return r;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeReactor
+ * Method:    cancel
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeReactor_cancel
+(JNIEnv *env, jobject instance)
+{
+	struct serial_reactor* reactor = get_reactor(env, instance);
+	if (reactor == NULL) return;
+
+	int r = serial_reactor_cancel(reactor);
+	if (r < 0) {
+		check(env, r);
+	}
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeReactor
+ * Method:    close
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeReactor_close
+(JNIEnv *env, jobject instance)
+{
+	struct serial_reactor* reactor = get_reactor(env, instance);
+	if (reactor == NULL) return;
+
+	int r = serial_reactor_close(reactor);
+	if (r < 0) {
+		check(env, r);
+	}
+}
+
+/* Copies an element of an array of strings, an empty string if it is null.
+ * Throws an InvalidSettingsException if it is too long. */
+static bool copy_element(JNIEnv* env, jobjectArray strings, jsize index, char* const value, size_t size)
+{
+	jstring string = (jstring) (*env)->GetObjectArrayElement(env, strings, index);
+	value[0] = '\0';
+	if (string == NULL) return true;
+
+	const char* chars = (*env)->GetStringUTFChars(env, string, 0);
+	if (chars == NULL) { // OutOfMemoryError pending
+		(*env)->DeleteLocalRef(env, string);
+		return false;
+	}
+	bool copied = strlen(chars) < size;
+	if (copied) strcpy(value, chars);
+	(*env)->ReleaseStringUTFChars(env, string, chars);
+	(*env)->DeleteLocalRef(env, string);
+	if (!copied) throwException(env, cache.invalid_settings_exception, "attribute of device filter is too long");
+	return copied;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeMonitor__
+ * Method:    open
+ * Signature: (Ljava/lang/String;Ljava/lang/String;Z[Ljava/lang/String;[Ljava/lang/String;[I[I[Ljava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeMonitor_00024_open
+(JNIEnv *env, jobject instance, jstring source, jstring directory, jboolean initial,
+	jobjectArray subsystems, jobjectArray names, jintArray vendors, jintArray products, jobjectArray serials)
+{
+	UNUSED_ARG(instance);
+
+	jsize count = (*env)->GetArrayLength(env, subsystems);
+	struct serial_device_filter* filters = NULL;
+	if (count > 0) {
+		filters = malloc(count * sizeof(*filters));
+		if (filters == NULL) {
+			throwException(env, cache.out_of_memory_error, "");
+			return -E_IO;
+		}
+	}
+
+	jint* vendor_ids = (*env)->GetIntArrayElements(env, vendors, NULL);
+	if (vendor_ids == NULL) { // OutOfMemoryError pending
+		free(filters);
+		return -E_IO;
+	}
+	jint* product_ids = (*env)->GetIntArrayElements(env, products, NULL);
+	if (product_ids == NULL) {
+		(*env)->ReleaseIntArrayElements(env, vendors, vendor_ids, JNI_ABORT);
+		free(filters);
+		return -E_IO;
+	}
+	bool copied = true;
+	for (jsize i = 0; i < count && copied; ++i) {
+		copied = copy_element(env, subsystems, i, filters[i].subsystem, sizeof(filters[i].subsystem)) &&
+			copy_element(env, names, i, filters[i].name, sizeof(filters[i].name)) &&
+			copy_element(env, serials, i, filters[i].serial, sizeof(filters[i].serial));
+		if (copied) {
+			filters[i].vendor = vendor_ids[i];
+			filters[i].product = product_ids[i];
+		}
+	}
+	(*env)->ReleaseIntArrayElements(env, vendors, vendor_ids, JNI_ABORT);
+	(*env)->ReleaseIntArrayElements(env, products, product_ids, JNI_ABORT);
+	if (!copied) {
+		free(filters);
+		return -E_INVALID_SETTINGS;
+	}
+
+	const char* source_path = source == NULL ? NULL : (*env)->GetStringUTFChars(env, source, 0);
+	const char* dir = source != NULL && source_path == NULL ? NULL : (*env)->GetStringUTFChars(env, directory, 0);
+	if (dir == NULL) { // OutOfMemoryError pending
+		if (source_path != NULL) (*env)->ReleaseStringUTFChars(env, source, source_path);
+		free(filters);
+		return -E_IO;
+	}
+	struct serial_monitor* monitor;
+	int r = serial_monitor_open(source_path, dir, filters, (size_t) count, (bool) initial, &monitor);
+	(*env)->ReleaseStringUTFChars(env, directory, dir);
+	if (source_path != NULL) (*env)->ReleaseStringUTFChars(env, source, source_path);
+	free(filters);
+
+	if (r < 0) {
+		check(env, r);
+		return -E_IO;
+	}
+	return (jlong) (intptr_t) monitor;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeMonitor
+ * Method:    next
+ * Signature: ([Ljava/lang/String;)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeMonitor_next
+(JNIEnv *env, jobject instance, jobjectArray paths)
+{
+	struct serial_device_event event;
+	struct serial_monitor* monitor = get_monitor(env, instance);
+	if (monitor == NULL) return -E_IO;
+
+	int r = serial_monitor_next(monitor, &event);
+	if (r < 0) {
+		check(env, r);
+		return r;
+	}
+	if (r == 0) return 0;
+
+	jstring path = (*env)->NewStringUTF(env, event.path);
+	if (path == NULL) return -E_IO; // OutOfMemoryError thrown
+	(*env)->SetObjectArrayElement(env, paths, 0, path);
+	(*env)->DeleteLocalRef(env, path);
+	return event.action;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeMonitor
+ * Method:    pending
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeMonitor_pending
+(JNIEnv *env, jobject instance)
+{
+	struct serial_monitor* monitor = get_monitor(env, instance);
+	if (monitor == NULL) return 0;
+
+	return (jint) serial_monitor_pending(monitor);
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeMonitor
+ * Method:    cancel
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeMonitor_cancel
+(JNIEnv *env, jobject instance)
+{
+	struct serial_monitor* monitor = get_monitor(env, instance);
+	if (monitor == NULL) return;
+
+	int r = serial_monitor_cancel(monitor);
+	if (r < 0) {
+		check(env, r);
+	}
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeMonitor
+ * Method:    close
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeMonitor_close
+(JNIEnv *env, jobject instance)
+{
+	struct serial_monitor* monitor = get_monitor(env, instance);
+	if (monitor == NULL) return;
+
+	int r = serial_monitor_close(monitor);
+	if (r < 0) {
+		check(env, r);
+	}
+}
+
+/* Sets an element of an array of strings. Returns false if an OutOfMemoryError has been thrown. */
+static bool set_element(JNIEnv* env, jobjectArray strings, jsize index, const char* const value)
+{
+	jstring string = (*env)->NewStringUTF(env, value);
+	if (string == NULL) return false;
+	(*env)->SetObjectArrayElement(env, strings, index, string);
+	(*env)->DeleteLocalRef(env, string);
+	return true;
+}
+
+/*
+ * Class:     akka_serial_sync_UnsafeMonitor__
+ * Method:    info
+ * Signature: (Ljava/lang/String;[I[Ljava/lang/String;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_akka_serial_sync_UnsafeMonitor_00024_info
+(JNIEnv *env, jobject instance, jstring name, jintArray ids, jobjectArray attributes)
+{
+	UNUSED_ARG(instance);
+
+	if ((*env)->GetArrayLength(env, ids) < 2 || (*env)->GetArrayLength(env, attributes) < 5) {
+		throwException(env, cache.illegal_argument_exception, "arrays are too small for attributes of device");
+		return JNI_FALSE;
+	}
+
+	const char* dev = (*env)->GetStringUTFChars(env, name, 0);
+	struct serial_device_info info;
+	int r = serial_device_info(dev, &info);
+	(*env)->ReleaseStringUTFChars(env, name, dev);
+	if (r == -E_NO_PORT) return JNI_FALSE;
+	if (r < 0) {
+		check(env, r);
+		return JNI_FALSE;
+	}
+
+	jint values[2] = { info.vendor, info.product };
+	(*env)->SetIntArrayRegion(env, ids, 0, 2, values);
+	bool set = set_element(env, attributes, 0, info.devpath) &&
+		set_element(env, attributes, 1, info.driver) &&
+		set_element(env, attributes, 2, info.serial) &&
+		set_element(env, attributes, 3, info.manufacturer) &&
+		set_element(env, attributes, 4, info.description);
+	return set ? JNI_TRUE : JNI_FALSE;
 }
@@ -7,6 +7,7 @@ extern "C" {
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 // general error codes, whose that are returned by functions
 #define E_IO 1 // IO error
@@ -15,11 +16,76 @@ extern "C" {
 #define E_INVALID_SETTINGS 4 // some port settings are invalid
 #define E_INTERRUPT 5 // not really an error, function call aborted because port is closed
 #define E_NO_PORT 6 // requested port does not exist
+#define E_UNSUPPORTED 7 // operation is not supported on this platform
 
 #define PARITY_NONE 0
 #define PARITY_ODD 1
 #define PARITY_EVEN 2
 
+#define FLOW_NONE 0
+#define FLOW_HARDWARE 1 // RTS/CTS
+#define FLOW_SOFTWARE 2 // XON/XOFF
+
+// kinds of framing applied to received data, see 'serial_set_framing'
+#define FRAMING_NONE 0
+#define FRAMING_DELIMITER 1 // frames end with a delimiter
+#define FRAMING_LENGTH 2 // frames contain a length field
+#define FRAMING_FIXED 3 // frames are of a fixed size
+#define FRAMING_GAP 4 // frames are separated by silence on the line
+
+// maximum size of the delimiter of delimited frames
+#define FRAMING_DELIMITER_MAX 16
+
+// checksums, see 'serial_checksum'
+#define CHECKSUM_NONE 0
+#define CHECKSUM_CRC16 1 // CRC-16/MODBUS: reflected polynomial 0x8005, initial value 0xFFFF
+#define CHECKSUM_CRC16_CCITT 2 // CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF
+#define CHECKSUM_CRC32 3 // CRC-32 of IEEE 802.3 and zlib
+#define CHECKSUM_LRC 4 // longitudinal redundancy check of Modbus ASCII, the negated sum of all bytes
+
+// kernels used to compute checksums, see 'serial_checksum_kernel'
+#define CHECKSUM_KERNEL_AUTO 0 // the fastest kernel supported by the running CPU
+#define CHECKSUM_KERNEL_TABLE 1 // one byte at a time, from a table
+#define CHECKSUM_KERNEL_SLICE8 2 // eight bytes at a time, from eight tables
+#define CHECKSUM_KERNEL_PCLMUL 3 // CRC-32 by carry-less multiplication (x86 with PCLMULQDQ), otherwise as SLICE8
+
+// engines used for reading from serial ports
+#define ENGINE_POLL 0 // wait for data with poll(), then read it
+#define ENGINE_IO_URING 1 // submit linked polls and reads through io_uring (Linux 5.17 and above)
+
+/* layout of a receive ring, see 'serial_ring_fill'. Offsets are in bytes from the start of the
+ * ring, every field of the header is placed on its own cache line */
+#define RING_HEAD 0 // int64, total number of bytes written by the producer
+#define RING_TAIL 64 // int64, total number of bytes consumed
+#define RING_CONSUMER_WAITING 128 // int32, set by a consumer that waits to be notified of data
+#define RING_PRODUCER_WAITING 192 // int32, set by the producer while the ring is full
+#define RING_READ_TIMESTAMP 256 // int64, time of the producer's last read, see 'serial_timestamp'
+#define RING_DATA 320 // start of data, followed by 'capacity' bytes
+
+// kernels used to scan data for delimiters, see 'serial_scan_kernel'
+#define SCAN_AUTO 0 // the fastest kernel supported by the running CPU
+#define SCAN_SCALAR 1 // one byte at a time
+#define SCAN_SSE2 2 // 16 bytes at a time (x86)
+#define SCAN_AVX2 3 // 32 bytes at a time (x86 with AVX2)
+
+// low-latency settings applied by 'serial_set_low_latency'
+#define LOW_LATENCY_ASYNC 1 // the driver's ASYNC_LOW_LATENCY flag has been set
+#define LOW_LATENCY_TIMER 2 // the adapter's latency timer has been set to its minimum
+
+// events reported by 'serial_ring_fill'
+#define RING_DATA_AVAILABLE 1 // data has been written while the consumer was waiting
+#define RING_TX_DRAINED 2 // the transmit queue has been drained after a blocked write
+
+// actions of device events, see 'serial_monitor_next'
+#define DEVICE_CONNECTED 1
+#define DEVICE_DISCONNECTED 2
+
+// maximum lengths of device attributes and paths, including the terminating null character
+#define DEVICE_SUBSYSTEM_MAX 32
+#define DEVICE_NAME_MAX 64
+#define DEVICE_SERIAL_MAX 128
+#define DEVICE_PATH_MAX 256
+
 /**
  * Contains internal configuration of an open serial port.
  */
@@ -29,7 +95,8 @@ struct serial_config;
  * Opens a serial port and allocates memory for storing configuration. Note: if this function fails,
  * any internally allocated resources will be freed.
  * @param port_name name of port
- * @param baud baud rate
+ * @param baud baud rate, any positive rate on Linux, otherwise one of the rates defined by termios
+ * (see 'serial_get_speed' for the rate actually achieved)
  * @param char_size character size of data transmitted through serial device
  * @param two_stop_bits set to use two stop bits instead of one
  * @param parity kind of parity checking to use
@@ -60,21 +127,159 @@ int serial_open(
  */
 int serial_close(struct serial_config* const serial);
 
+/**
+ * Configures how reads of a previously opened serial port coalesce data that arrives in small
+ * chunks. By default, a read returns as soon as any data is available.
+ *
+ * Similar to VMIN and VTIME of non-canonical terminal input, a read that received some data
+ * continues until the minimum size is reached, or until no further byte arrived within the
+ * timeout. Without a minimum size, the read continues until its buffer is full or the timeout
+ * expires. Without a timeout, the minimum size is waited for indefinitely; in this case the
+ * port is not signaled as readable before that many bytes are available (VMIN), also not to
+ * reactors. 'serial_try_read' accumulates data until a read would return, and reactors are also
+ * signaled once the timeout expires. Receive rings notify their consumer under the same rules,
+ * see 'serial_ring_fill'. This must be configured before a port is registered with a reactor.
+ * @param serial pointer to serial configuration
+ * @param min_size minimum number of bytes returned by a read, 0 for none
+ * @param timeout inter-byte timeout in milliseconds, 0 for none
+ * @return 0 on success
+ * @return -E_IO on error
+ */
+int serial_set_read_coalescing(struct serial_config* const serial, size_t min_size, unsigned int timeout);
+
+/**
+ * Sets the flow control of a previously opened serial port. With flow control, the remote end is
+ * paused once the kernel's receive buffer of the port fills up, i.e. once data is no longer read
+ * (see 'serial_suspend_reading'), and this end's transmission is paused when requested by the
+ * remote end.
+ * @param serial pointer to serial configuration
+ * @param flow kind of flow control to use, one of FLOW_NONE, FLOW_HARDWARE or FLOW_SOFTWARE
+ * @return 0 on success
+ * @return -E_INVALID_SETTINGS if the kind of flow control is invalid or not supported on the
+ * current platform
+ * @return -E_IO on other error
+ */
+int serial_set_flow_control(struct serial_config* const serial, int flow);
+
+/**
+ * Suspends or resumes reading from a previously opened serial port. While suspended, neither
+ * 'serial_read' nor a reactor waits for the port to become readable, and 'serial_try_read' reads
+ * no data, so that received data accumulates in the kernel's buffer. Transmit queues are still
+ * drained and disconnections are still reported. A blocked read stops waiting for data, however
+ * data that arrives concurrently with a suspension may still be read. This function is thread
+ * safe.
+ * @param serial pointer to serial configuration
+ * @param suspended set to suspend reading, clear to resume it
+ * @return 0 on success
+ * @return -E_IO on error
+ */
+int serial_suspend_reading(struct serial_config* const serial, bool suspended);
+
+/**
+ * Framing applied to data received by a serial port.
+ */
+struct serial_framing {
+	int kind; // one of the FRAMING_* kinds
+	size_t max_size; // maximum size of a frame, including any delimiter; the size of fixed frames
+
+	// FRAMING_DELIMITER
+	char delimiter[FRAMING_DELIMITER_MAX]; // sequence of bytes that ends a frame
+	size_t delimiter_size; // size of the delimiter, at least 1
+	bool strip_delimiter; // set to leave the delimiter out of returned frames
+
+	// FRAMING_LENGTH
+	size_t length_offset; // offset of the length field from the start of a frame
+	size_t length_width; // size of the length field, 1, 2, 4 or 8 bytes
+	bool length_big_endian; // byte order of the length field
+	int64_t length_adjustment; // added to the length field's value to get the size of the rest of the frame
+
+	// FRAMING_GAP
+	unsigned int gap; // silence in microseconds that ends a frame, 0 for 3.5 characters at the port's speed
+
+	// any kind of framing
+	int checksum; // CHECKSUM_* verified for every frame, CHECKSUM_NONE for none
+	size_t checksum_offset; // offset of the data covered by the checksum from the start of a frame
+	bool checksum_big_endian; // byte order of the checksum
+};
+
+/**
+ * Sets the framing of data received by a previously opened serial port. With framing, received
+ * data is accumulated in a buffer of the port, and every 'serial_read' and 'serial_try_read'
+ * returns exactly one whole frame. Frames already accumulated are returned without waiting, also
+ * while reading is suspended.
+ *
+ * A delimited frame ends with (and includes, unless stripped) its delimiter. A length-prefixed frame
+ * has a header of 'length_offset' bytes followed by an unsigned length field, whose value plus
+ * 'length_adjustment' is the number of bytes that follow the field. Data that cannot be part of a
+ * valid frame, i.e. that exceeds the maximum size without a delimiter or that has an invalid length,
+ * is discarded until the next possible start of a frame. Empty frames, i.e. delimiters that are
+ * stripped and follow one another, are skipped.
+ *
+ * A gap-delimited frame is all data received until the line has been silent for 'gap'. By
+ * default, the gap is 3.5 character times at the port's speed, or 1750 microseconds above 19200
+ * baud, as for Modbus RTU. Silence is timed from the reception of data by the backend, hence
+ * ports with low latency (see 'serial_set_low_latency') time gaps best. Frames longer than the
+ * maximum size are discarded. Ports with gap framing must have their framing set before they are
+ * registered with a reactor, which then also reports them once a gap has elapsed.
+ *
+ * With a checksum, the last bytes of every frame (before its delimiter, if any) are a checksum of
+ * the frame's data from 'checksum_offset' on, and frames whose checksum does not match are
+ * discarded. Returned frames include their checksum.
+ *
+ * Data accumulated under a previous framing is dropped. Framing must not be changed while a read is in progress, and is not supported by receive rings
+ * (see 'serial_ring_fill').
+ * @param serial pointer to serial configuration
+ * @param framing framing to apply, NULL or of kind FRAMING_NONE to return data as it is read
+ * @return 0 on success
+ * @return -E_INVALID_SETTINGS if the framing is invalid
+ * @return -E_IO on other error
+ */
+int serial_set_framing(struct serial_config* const serial, const struct serial_framing* const framing);
+
 /**
  * Starts a read from a previously opened serial port. The read is blocking, however it may be
  * interrupted by calling 'serial_cancel_read' on the given serial port.
  * @param serial pointer to serial configuration from which to read
  * @param buffer buffer into which data is read
  * @param size maximum buffer size
- * @return n>0 the number of bytes read into buffer
+ * @return n>0 the number of bytes read into buffer, a whole frame if the port has framing
+ * @return 0 if the port's transmit queue has been drained after a write was not completely
+ * accepted (see 'serial_write')
  * @return -E_INTERRUPT if the call to this function was interrupted
+ * @return -E_INVALID_SETTINGS if the next frame does not fit into the buffer
  * @return -E_IO on IO error
  */
 int serial_read(struct serial_config* const serial, char* const buffer, size_t size);
 
 /**
- * Cancels a blocked read call. This function is thread safe, i.e. it may be called from a thread even
- * while another thread is blocked in a read call.
+ * Reads data that is immediately available from a previously opened serial port. This function
+ * never blocks and is intended to be called once a port has been signaled as readable, e.g. by a
+ * reactor (see 'serial_reactor_wait'). Any data in the port's transmit queue is written before
+ * reading.
+ * @param serial pointer to serial configuration from which to read
+ * @param buffer buffer into which data is read
+ * @param size maximum buffer size
+ * @return n>0 the number of bytes read into buffer, a whole frame if the port has framing
+ * @return 0 if no data is currently available, this is also the case when the port's transmit
+ * queue has been drained
+ * @return -E_INVALID_SETTINGS if the next frame does not fit into the buffer
+ * @return -E_IO on IO error, including disconnection of the port
+ */
+int serial_try_read(struct serial_config* const serial, char* const buffer, size_t size);
+
+/**
+ * Checks whether a port's transmit queue has been drained after a write was not completely
+ * accepted (see 'serial_write'), as 'serial_read' reports by returning 0. The drain is only
+ * reported once. This is intended to be called after 'serial_try_read', which drains the queue
+ * but cannot tell a drain apart from no data being available.
+ * @param serial pointer to serial configuration
+ * @return 1 if the transmit queue has been drained since this was last checked, 0 otherwise
+ */
+int serial_take_drained(struct serial_config* const serial);
+
+/**
+ * Cancels a blocked read call, as well as a blocked 'serial_drain'. This function is thread safe,
+ * i.e. it may be called from a thread even while another thread is blocked in a read call.
  * @param serial_config the serial port to interrupt
  * @return 0 on success
  * @return -E_IO on error
@@ -82,15 +287,449 @@ int serial_read(struct serial_config* const serial, char* const buffer, size_t s
 int serial_cancel_read(struct serial_config* const serial);
 
 /**
- * Writes data to a previously opened serial port. Non bocking.
+ * Writes data to a previously opened serial port. Non bocking. Data that cannot be written
+ * immediately, since the kernel's transmission buffer is full, is copied to a transmit queue of
+ * limited capacity. The queue is drained by a thread waiting on the port, either in 'serial_read'
+ * or in a reactor to which the port is registered.
  * @param serial pointer to serial configuration to which to write
  * @param data data to write
  * @param size number of bytes to write from data
- * @return n>0 the number of bytes written
+ * @return n>=0 the number of bytes accepted, i.e. written or queued. If less than size, the
+ * transmit queue is full and the remaining data should be written again once the queue has been
+ * drained, which is signaled by a blocked 'serial_read' returning 0
  * @return -E_IO on IO error
  */
 int serial_write(struct serial_config* const serial, char* const data, size_t size);
 
+/**
+ * A contiguous region of memory from which data is written, see 'serial_writev'.
+ */
+struct serial_buffer {
+	char* data; // start of data
+	size_t size; // number of bytes
+};
+
+/**
+ * Writes data from several buffers to a previously opened serial port, in a single system call
+ * where possible (gather write). As with 'serial_write', data that cannot be written immediately
+ * is queued. Non blocking.
+ * @param serial pointer to serial configuration to which to write
+ * @param buffers buffers from which to write, in order
+ * @param count number of buffers
+ * @return n>=0 the total number of bytes accepted, i.e. written or queued. If less than the total
+ * size of all buffers, the transmit queue is full (see 'serial_write')
+ * @return -E_IO on IO error
+ */
+int serial_writev(struct serial_config* const serial, const struct serial_buffer* const buffers, size_t count);
+
+/**
+ * Waits until all data written to a previously opened serial port has been transmitted, i.e.
+ * until the port's transmit queue and the kernel's transmission buffer are empty and, if the
+ * driver can tell, the last character has left the UART. The wait is blocking, however it may be
+ * interrupted by calling 'serial_cancel_read' on the given serial port. Since the transmit queue
+ * is drained by a thread waiting on the port, such a thread must exist while this function is
+ * called with queued data.
+ * @param serial pointer to serial configuration
+ * @param timestamp set to the time at which the port was found drained, see 'serial_timestamp'
+ * @return 0 on success
+ * @return -E_INTERRUPT if the call to this function was interrupted
+ * @return -E_IO on IO error
+ */
+int serial_drain(struct serial_config* const serial, int64_t* const timestamp);
+
+/**
+ * Gets the current time of the clock used for timestamps reported by this library.
+ * @return time in nanoseconds, of the monotonic clock (CLOCK_MONOTONIC)
+ */
+int64_t serial_timestamp(void);
+
+/**
+ * Reads data from a previously opened serial port into a single-producer/single-consumer ring,
+ * until an event has to be reported to the consumer. The ring is a region of memory shared with a
+ * consumer running on another thread, which drains data without calling any function of this
+ * library. Its layout is described by the RING_* offsets.
+ *
+ * The producer (the caller of this function) only writes the head index, the consumer only
+ * writes the tail index, both store indices with release semantics after data has been written
+ * or read respectively. Before waiting for data, a consumer sets RING_CONSUMER_WAITING and then
+ * checks the head index again; the flag is cleared by this function once data is available and
+ * RING_DATA_AVAILABLE is reported. While the ring is full, this function stops reading from the
+ * port and sets RING_PRODUCER_WAITING; a consumer that finds the flag set after advancing the
+ * tail must clear it and call 'serial_ring_wake'. With read coalescing (see
+ * 'serial_set_read_coalescing'), a waiting consumer is only notified once as much data has been
+ * filled as a read would return, or once the ring is full.
+ *
+ * As a blocked 'serial_read', this function drains the port's transmit queue, and it may be
+ * interrupted by 'serial_cancel_read'. Data is always read with poll(), regardless of the port's
+ * engine.
+ * @param serial pointer to serial configuration from which to read
+ * @param ring ring into which data is read, aligned to at least 8 bytes (64 bytes to avoid false
+ * sharing between the header's fields)
+ * @param capacity capacity of the ring's data region, a power of two
+ * @return n>0 a bitmask of RING_DATA_AVAILABLE and RING_TX_DRAINED
+ * @return -E_INTERRUPT if the call to this function was interrupted
+ * @return -E_INVALID_SETTINGS if the port has framing
+ * @return -E_IO on IO error
+ */
+int serial_ring_fill(struct serial_config* const serial, char* const ring, size_t capacity);
+
+/**
+ * Wakes up a call to 'serial_ring_fill' that waits for space in its ring. This function is
+ * thread safe.
+ * @param serial the serial port whose ring has space again
+ * @return 0 on success
+ * @return -E_IO on error
+ */
+int serial_ring_wake(struct serial_config* const serial);
+
+/**
+ * Contains internal state of a reactor. A reactor multiplexes readiness of many serial ports,
+ * so that a single thread may serve all of them, instead of blocking one thread per port in
+ * 'serial_read'.
+ */
+struct serial_reactor;
+
+/**
+ * Opens a new reactor and allocates memory for storing its state.
+ * @param reactor pointer to memory that will be allocated with a reactor structure
+ * @return 0 on success
+ * @return -E_UNSUPPORTED if reactors are not available on the current platform
+ * @return -E_IO on other error
+ */
+int serial_reactor_open(struct serial_reactor** const reactor);
+
+/**
+ * Closes a reactor and frees any associated memory. Ports registered with the reactor are not
+ * closed. As with 'serial_close', no thread may be waiting on the reactor when this function is
+ * called.
+ * @param reactor reactor to close
+ * @return 0 on success
+ * @return -E_IO on error
+ */
+int serial_reactor_close(struct serial_reactor* const reactor);
+
+/**
+ * Registers a serial port with a reactor. Once registered, the given token will be reported by
+ * 'serial_reactor_wait' whenever the port has data available, or has encountered an error. A
+ * port must be unregistered before it is closed.
+ * @param reactor reactor to register with
+ * @param serial port to register
+ * @param token arbitrary, non-zero value identifying the port to the caller
+ * @return 0 on success
+ * @return -E_IO on error
+ */
+int serial_reactor_register(struct serial_reactor* const reactor, struct serial_config* const serial, int64_t token);
+
+/**
+ * Removes a serial port from a reactor. Note that a port may still be reported by a wait call that
+ * was in progress while this function was called.
+ * @param reactor reactor to remove the port from
+ * @param serial port to remove
+ * @return 0 on success
+ * @return -E_IO on error
+ */
+int serial_reactor_unregister(struct serial_reactor* const reactor, struct serial_config* const serial);
+
+/**
+ * Waits until at least one registered port is ready. The wait may be interrupted by calling
+ * 'serial_reactor_cancel'.
+ * @param reactor reactor on which to wait
+ * @param tokens buffer into which the tokens of ready ports are written
+ * @param max maximum number of tokens to write
+ * @return n>0 the number of tokens written
+ * @return -E_INTERRUPT if the wait was interrupted
+ * @return -E_IO on error
+ */
+int serial_reactor_wait(struct serial_reactor* const reactor, int64_t* const tokens, size_t max);
+
+/**
+ * Cancels any current and future wait on a reactor. This function is thread safe.
+ * @param reactor reactor to interrupt
+ * @return 0 on success
+ * @return -E_IO on error
+ */
+int serial_reactor_cancel(struct serial_reactor* const reactor);
+
+/**
+ * Sets the engine used by subsequently opened ports to read data. If the requested engine is not
+ * available on the running system, ports fall back to ENGINE_POLL when opened. The default engine
+ * is ENGINE_POLL.
+ * @param engine engine to use
+ * @return 0 on success
+ * @return -E_INVALID_SETTINGS if the engine is not known
+ */
+int serial_engine(int engine);
+
+/**
+ * Gets the engine actually used by an open port.
+ * @param serial pointer to serial configuration
+ * @return ENGINE_POLL or ENGINE_IO_URING
+ */
+int serial_get_engine(struct serial_config* const serial);
+
+/**
+ * Gets the speed an open port actually uses. Depending on the port's hardware and driver, this
+ * may differ from the requested speed.
+ * @param serial pointer to serial configuration
+ * @return n>0 speed in baud
+ * @return -E_IO on error
+ */
+int serial_get_speed(struct serial_config* const serial);
+
+/**
+ * Gets the time at which the data returned by the last successful read of a port was read from
+ * the operating system, i.e. right after the underlying read system call returned. With read
+ * coalescing, this is the time at which the first part of the data was read. This function is
+ * not thread safe, it is intended to be called by the reading thread after a read.
+ * @param serial pointer to serial configuration
+ * @return time in nanoseconds, see 'serial_timestamp', 0 if nothing has been read yet
+ */
+int64_t serial_read_timestamp(struct serial_config* const serial);
+
+/**
+ * Gets the number of bytes that have been received by a port but not yet read, i.e. the depth of
+ * the kernel's receive queue (FIONREAD).
+ * @param serial pointer to serial configuration
+ * @return n>=0 number of bytes in the receive queue
+ * @return -E_IO on error
+ */
+int serial_input_queued(struct serial_config* const serial);
+
+/**
+ * Gets the number of bytes that have been written to a port but not yet transmitted, i.e. the
+ * depth of the kernel's transmit queue (TIOCOUTQ) plus any data in the port's own transmit queue
+ * (see 'serial_write').
+ * @param serial pointer to serial configuration
+ * @return n>=0 number of bytes not yet transmitted
+ * @return -E_IO on error
+ */
+int serial_output_queued(struct serial_config* const serial);
+
+/**
+ * Statistics of a serial port, since it was opened.
+ */
+struct serial_stats {
+	uint64_t bytes_read; // bytes read from the port
+	uint64_t bytes_written; // bytes accepted by the driver, including data from the transmit queue
+	uint64_t reads; // read system calls that returned data
+	uint64_t writes; // write system calls that accepted data
+	uint64_t wakeups; // returns of waits of blocking reads and ring fills, e.g. poll() or io_uring
+	uint64_t cancels; // calls to 'serial_cancel_read'
+
+	/* errors counted by the driver (TIOCGICOUNT), all -1 if the driver does
+	 * not count them */
+	int64_t overruns; // characters lost because the UART's receive FIFO was full
+	int64_t buffer_overruns; // characters lost because the driver's receive buffer was full
+	int64_t frame_errors; // characters received without a valid stop bit
+	int64_t parity_errors; // characters received with an invalid parity bit
+	int64_t breaks; // break conditions received
+};
+
+/**
+ * Gets a snapshot of the statistics of a port. Counters are maintained by the port at the cost of
+ * an atomic increment per system call; the driver's error counters are queried with every call.
+ * This function may be called from any thread.
+ * @param serial pointer to serial configuration
+ * @param stats set to the port's statistics
+ * @return 0 on success
+ * @return -E_IO on error
+ */
+int serial_get_stats(struct serial_config* const serial, struct serial_stats* const stats);
+
+/**
+ * Tunes a previously opened serial port for low latency, as far as its driver supports it. The
+ * driver's ASYNC_LOW_LATENCY flag is set, and, if the port belongs to a USB adapter that exposes
+ * a writable latency timer in sysfs (see 'serial_sysfs_root'), the timer is set to 1 ms.
+ * Settings are reported as applied only if reading them back shows them in effect.
+ * @param serial pointer to serial configuration
+ * @return n>=0 a bitmask of the settings that could be applied, LOW_LATENCY_ASYNC and
+ * LOW_LATENCY_TIMER, 0 if the driver supports none of them
+ * @return -E_IO if a setting that the driver supports could not be applied
+ */
+int serial_set_low_latency(struct serial_config* const serial);
+
+/**
+ * Gets the latency timer of the USB adapter behind an open port.
+ * @param serial pointer to serial configuration
+ * @return n>=0 latency timer in milliseconds
+ * @return -E_UNSUPPORTED if the port has no latency timer
+ * @return -E_IO on error
+ */
+int serial_get_latency_timer(struct serial_config* const serial);
+
+/**
+ * Sets the directory under which sysfs is mounted, "/sys" by default. This is useful for testing
+ * against a fake tree.
+ * @param root path of sysfs
+ * @return 0 on success
+ * @return -E_INVALID_SETTINGS if the path is too long
+ */
+int serial_sysfs_root(const char* const root);
+
+/**
+ * Selects devices reported by a monitor. Empty strings and negative ids match any device.
+ */
+struct serial_device_filter {
+	char subsystem[DEVICE_SUBSYSTEM_MAX]; // kernel subsystem of the device, e.g. "tty"
+	char name[DEVICE_NAME_MAX]; // shell pattern (see fnmatch) of the device's name, e.g. "ttyUSB*"
+	int vendor; // vendor id of the USB device behind the device
+	int product; // product id of the USB device behind the device
+	char serial[DEVICE_SERIAL_MAX]; // serial number of the USB device behind the device
+};
+
+/**
+ * A device that has been connected or disconnected.
+ */
+struct serial_device_event {
+	int action; // DEVICE_CONNECTED or DEVICE_DISCONNECTED
+	char path[DEVICE_PATH_MAX]; // path of the device's node, e.g. "/dev/ttyUSB0"
+};
+
+/**
+ * Contains internal state of a monitor. A monitor reports devices as they are connected and
+ * disconnected, such as USB serial adapters being plugged in.
+ */
+struct serial_monitor;
+
+/**
+ * Opens a new monitor of devices that match any of the given filters. Devices are announced by
+ * the kernel through uevents, whose format is that of Linux's NETLINK_KOBJECT_UEVENT socket: a
+ * sequence of null-terminated "KEY=value" fields. Attributes of USB devices are looked up under
+ * the sysfs root (see 'serial_sysfs_root') when a device is connected.
+ *
+ * Devices present when the monitor is opened are enumerated from the sysfs classes of the
+ * subsystems named by the filters, "tty" if a filter names none, so that they are also reported
+ * once disconnected.
+ * @param source path of a file from which uevents are read instead of the kernel, each followed by
+ * an empty field (i.e. an additional null character), or NULL to monitor the kernel's
+ * @param directory directory in which device nodes are created, usually "/dev"
+ * @param filters filters of reported devices
+ * @param count number of filters, 0 to report all devices that have a node
+ * @param initial set to report devices present when the monitor is opened as connected
+ * @param monitor pointer to memory that will be allocated with a monitor structure
+ * @return 0 on success
+ * @return -E_INVALID_SETTINGS if the directory is too long
+ * @return -E_UNSUPPORTED if the kernel's uevents are not available on the current platform
+ * @return -E_IO on other error
+ */
+int serial_monitor_open(
+	const char* const source,
+	const char* const directory,
+	const struct serial_device_filter* const filters,
+	size_t count,
+	bool initial,
+	struct serial_monitor** const monitor);
+
+/**
+ * Closes a monitor and frees any associated memory. As with 'serial_close', no thread may be
+ * waiting on the monitor when this function is called.
+ * @param monitor monitor to close
+ * @return 0 on success
+ * @return -E_IO on error
+ */
+int serial_monitor_close(struct serial_monitor* const monitor);
+
+/**
+ * Waits until a device matching the monitor's filters is connected, or one that has been reported
+ * connected is disconnected. The wait may be interrupted by calling 'serial_monitor_cancel'.
+ * @param monitor monitor on which to wait
+ * @param event event into which the device is written
+ * @return 1 if an event has been written
+ * @return 0 if the monitor's source has ended, only with sources other than the kernel
+ * @return -E_INTERRUPT if the wait was interrupted
+ * @return -E_IO on error
+ */
+int serial_monitor_next(struct serial_monitor* const monitor, struct serial_device_event* const event);
+
+/**
+ * Cancels any current and future wait on a monitor. This function is thread safe.
+ * @param monitor monitor to interrupt
+ * @return 0 on success
+ * @return -E_IO on error
+ */
+int serial_monitor_cancel(struct serial_monitor* const monitor);
+
+/**
+ * Gets the number of devices present when a monitor was opened that have not been reported yet.
+ * As many calls to 'serial_monitor_next' return these without waiting. This function must not be
+ * called concurrently with 'serial_monitor_next'.
+ * @param monitor monitor to check
+ * @return the number of devices not yet reported
+ */
+size_t serial_monitor_pending(struct serial_monitor* const monitor);
+
+/**
+ * Attributes of a serial device, as found in sysfs. Strings are empty and ids are -1 if unknown.
+ */
+struct serial_device_info {
+	char devpath[DEVICE_PATH_MAX]; // path of the device in sysfs, relative to its root
+	char driver[DEVICE_NAME_MAX]; // name of the device's driver, e.g. "ftdi_sio"
+	int vendor; // vendor id of the USB device behind the device
+	int product; // product id of the USB device behind the device
+	char serial[DEVICE_SERIAL_MAX]; // serial number of the USB device behind the device
+	char manufacturer[DEVICE_SERIAL_MAX]; // manufacturer string of the USB device
+	char description[DEVICE_SERIAL_MAX]; // product string of the USB device
+};
+
+/**
+ * Looks up the attributes of a tty under the sysfs root (see 'serial_sysfs_root').
+ * @param name name of the tty, i.e. of its node, e.g. "ttyUSB0"
+ * @param info attributes into which those of the tty are written
+ * @return 0 on success
+ * @return -E_NO_PORT if there is no such tty
+ * @return -E_UNSUPPORTED if sysfs is not available on the current platform
+ */
+int serial_device_info(const char* const name, struct serial_device_info* const info);
+
+/**
+ * Finds the first occurrence of either of two bytes, typically the delimiters of a line-oriented
+ * protocol, such as '\n' and '\r'. Pass the same byte twice to search for a single one.
+ * @param data data to search
+ * @param size size of data
+ * @param first a byte to search for
+ * @param second another byte to search for
+ * @return index of the first byte equal to 'first' or 'second', 'size' if there is none
+ */
+size_t serial_scan(const char* const data, size_t size, char first, char second);
+
+/**
+ * Selects the kernel used by 'serial_scan'. By default, the fastest kernel supported by the
+ * running CPU is selected on first use. This is useful for benchmarking kernels against each other.
+ * @param kernel one of the SCAN_* kernels
+ * @return n>0 the kernel selected, SCAN_AUTO is resolved to an actual kernel
+ * @return -E_UNSUPPORTED if the kernel is not supported by the running CPU
+ * @return -E_INVALID_SETTINGS if the kernel is not known
+ */
+int serial_scan_kernel(int kernel);
+
+/**
+ * Computes a checksum of data, with the kernel selected by 'serial_checksum_kernel'.
+ * @param kind one of the CHECKSUM_* checksums, other than CHECKSUM_NONE
+ * @param data data to checksum
+ * @param size size of data
+ * @return n>=0 the checksum
+ * @return -E_INVALID_SETTINGS if the kind of checksum is not known
+ */
+int64_t serial_checksum(int kind, const char* const data, size_t size);
+
+/**
+ * Gets the size of a checksum, as transmitted in frames.
+ * @param kind one of the CHECKSUM_* checksums, other than CHECKSUM_NONE
+ * @return n>0 the size of the checksum in bytes
+ * @return -E_INVALID_SETTINGS if the kind of checksum is not known
+ */
+int serial_checksum_size(int kind);
+
+/**
+ * Selects the kernel used by 'serial_checksum'. By default, the fastest kernel supported by the
+ * running CPU is selected on first use. This is useful for benchmarking kernels against each other.
+ * @param kernel one of the CHECKSUM_KERNEL_* kernels
+ * @return n>0 the kernel selected, CHECKSUM_KERNEL_AUTO is resolved to an actual kernel
+ * @return -E_UNSUPPORTED if the kernel is not supported by the running CPU
+ * @return -E_INVALID_SETTINGS if the kernel is not known
+ */
+int serial_checksum_kernel(int kernel);
+
 /**
  * Sets debugging option. If debugging is enabled, detailed error message are printed from method calls.
  */
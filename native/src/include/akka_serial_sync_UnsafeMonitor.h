@@ -0,0 +1,45 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class akka_serial_sync_UnsafeMonitor */
+
+#ifndef _Include_akka_serial_sync_UnsafeMonitor
+#define _Include_akka_serial_sync_UnsafeMonitor
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     akka.serial.sync.UnsafeMonitor
+ * Method:    next
+ * Signature: ([Ljava/lang/String;)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeMonitor_next
+  (JNIEnv *, jobject, jobjectArray);
+
+/*
+ * Class:     akka.serial.sync.UnsafeMonitor
+ * Method:    pending
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeMonitor_pending
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     akka.serial.sync.UnsafeMonitor
+ * Method:    cancel
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeMonitor_cancel
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     akka.serial.sync.UnsafeMonitor
+ * Method:    close
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeMonitor_close
+  (JNIEnv *, jobject);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
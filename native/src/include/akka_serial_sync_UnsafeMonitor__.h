@@ -0,0 +1,29 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class akka_serial_sync_UnsafeMonitor_00024 */
+
+#ifndef _Include_akka_serial_sync_UnsafeMonitor_00024
+#define _Include_akka_serial_sync_UnsafeMonitor_00024
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     akka.serial.sync.UnsafeMonitor_00024
+ * Method:    open
+ * Signature: (Ljava/lang/String;Ljava/lang/String;Z[Ljava/lang/String;[Ljava/lang/String;[I[I[Ljava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeMonitor_00024_open
+  (JNIEnv *, jobject, jstring, jstring, jboolean, jobjectArray, jobjectArray, jintArray, jintArray, jobjectArray);
+
+/*
+ * Class:     akka.serial.sync.UnsafeMonitor_00024
+ * Method:    info
+ * Signature: (Ljava/lang/String;[I[Ljava/lang/String;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_akka_serial_sync_UnsafeMonitor_00024_info
+  (JNIEnv *, jobject, jstring, jintArray, jobjectArray);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,53 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class akka_serial_sync_UnsafeReactor */
+
+#ifndef _Include_akka_serial_sync_UnsafeReactor
+#define _Include_akka_serial_sync_UnsafeReactor
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     akka.serial.sync.UnsafeReactor
+ * Method:    register
+ * Signature: (JJ)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeReactor_register
+  (JNIEnv *, jobject, jlong, jlong);
+
+/*
+ * Class:     akka.serial.sync.UnsafeReactor
+ * Method:    unregister
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeReactor_unregister
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     akka.serial.sync.UnsafeReactor
+ * Method:    await
+ * Signature: ([J)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeReactor_await
+  (JNIEnv *, jobject, jlongArray);
+
+/*
+ * Class:     akka.serial.sync.UnsafeReactor
+ * Method:    cancel
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeReactor_cancel
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     akka.serial.sync.UnsafeReactor
+ * Method:    close
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeReactor_close
+  (JNIEnv *, jobject);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
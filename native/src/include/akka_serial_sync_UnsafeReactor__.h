@@ -0,0 +1,21 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class akka_serial_sync_UnsafeReactor_00024 */
+
+#ifndef _Include_akka_serial_sync_UnsafeReactor_00024
+#define _Include_akka_serial_sync_UnsafeReactor_00024
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     akka.serial.sync.UnsafeReactor_00024
+ * Method:    open
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeReactor_00024_open
+  (JNIEnv *, jobject);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -6,38 +6,6 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
-/*
- * Class:     akka.serial.sync.UnsafeSerial
- * Method:    read
- * Signature: (Ljava/nio/ByteBuffer;)I
- */
-JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_read
-  (JNIEnv *, jobject, jobject);
-
-/*
- * Class:     akka.serial.sync.UnsafeSerial
- * Method:    cancelRead
- * Signature: ()V
- */
-JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_cancelRead
-  (JNIEnv *, jobject);
-
-/*
- * Class:     akka.serial.sync.UnsafeSerial
- * Method:    write
- * Signature: (Ljava/nio/ByteBuffer;I)I
- */
-JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_write
-  (JNIEnv *, jobject, jobject, jint);
-
-/*
- * Class:     akka.serial.sync.UnsafeSerial
- * Method:    close
- * Signature: ()V
- */
-JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_close
-  (JNIEnv *, jobject);
-
 #ifdef __cplusplus
 }
 #endif
@@ -14,6 +14,278 @@ extern "C" {
 JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeSerial_00024_open
   (JNIEnv *, jobject, jstring, jint, jint, jboolean, jint);
 
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    setReadCoalescing
+ * Signature: (JII)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_setReadCoalescing
+  (JNIEnv *, jobject, jlong, jint, jint);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    setFlowControl
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_setFlowControl
+  (JNIEnv *, jobject, jlong, jint);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    suspendReading
+ * Signature: (JZ)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_suspendReading
+  (JNIEnv *, jobject, jlong, jboolean);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    setFraming
+ * Signature: (JII[BZIIZIIIZI)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_setFraming
+  (JNIEnv *, jobject, jlong, jint, jint, jbyteArray, jboolean, jint, jint, jboolean, jint, jint, jint, jboolean, jint);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    read
+ * Signature: (JLjava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_read
+  (JNIEnv *, jobject, jlong, jobject);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    readAddress
+ * Signature: (JJI)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_readAddress
+  (JNIEnv *, jobject, jlong, jlong, jint);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    tryRead
+ * Signature: (JLjava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_tryRead
+  (JNIEnv *, jobject, jlong, jobject);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    tryReadAddress
+ * Signature: (JJI)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_tryReadAddress
+  (JNIEnv *, jobject, jlong, jlong, jint);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    tryReadArray
+ * Signature: (J[BII)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_tryReadArray
+  (JNIEnv *, jobject, jlong, jbyteArray, jint, jint);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    takeDrained
+ * Signature: (J)Z
+ */
+JNIEXPORT jboolean JNICALL Java_akka_serial_sync_UnsafeSerial_00024_takeDrained
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    readTimestamp
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeSerial_00024_readTimestamp
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    fill
+ * Signature: (JLjava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_fill
+  (JNIEnv *, jobject, jlong, jobject);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    wakeRing
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_wakeRing
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    cancelRead
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_cancelRead
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    write
+ * Signature: (JLjava/nio/ByteBuffer;I)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_write
+  (JNIEnv *, jobject, jlong, jobject, jint);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    writeAddress
+ * Signature: (JJI)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_writeAddress
+  (JNIEnv *, jobject, jlong, jlong, jint);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    writev
+ * Signature: (J[Ljava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_writev
+  (JNIEnv *, jobject, jlong, jobjectArray);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    drain
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeSerial_00024_drain
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    readEngine
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_readEngine
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    speed
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_speed
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    inputQueued
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_inputQueued
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    outputQueued
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_outputQueued
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    stats
+ * Signature: (J[J)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_stats
+  (JNIEnv *, jobject, jlong, jlongArray);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    lowLatency
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_lowLatency
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    latencyTimer
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_latencyTimer
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    close
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_close
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    engine
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_engine
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    sysfsRoot
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_akka_serial_sync_UnsafeSerial_00024_sysfsRoot
+  (JNIEnv *, jobject, jstring);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    address
+ * Signature: (Ljava/nio/ByteBuffer;)J
+ */
+JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeSerial_00024_address
+  (JNIEnv *, jobject, jobject);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    scanKernel
+ * Signature: (I)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_scanKernel
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    scan
+ * Signature: (Ljava/nio/ByteBuffer;BB[I)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_scan
+  (JNIEnv *, jobject, jobject, jbyte, jbyte, jintArray);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    checksumKernel
+ * Signature: (I)I
+ */
+JNIEXPORT jint JNICALL Java_akka_serial_sync_UnsafeSerial_00024_checksumKernel
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    checksum
+ * Signature: (ILjava/nio/ByteBuffer;)J
+ */
+JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeSerial_00024_checksum
+  (JNIEnv *, jobject, jint, jobject);
+
+/*
+ * Class:     akka.serial.sync.UnsafeSerial_00024
+ * Method:    timestamp
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_akka_serial_sync_UnsafeSerial_00024_timestamp
+  (JNIEnv *, jobject);
+
 /*
  * Class:     akka.serial.sync.UnsafeSerial_00024
  * Method:    debug
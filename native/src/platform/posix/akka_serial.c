@@ -1,18 +1,22 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <errno.h>
 #include <termios.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <sys/file.h>
-#include <sys/select.h>
+#include <sys/ioctl.h>
 #include "akka_serial.h"
+#include "akka_serial_posix.h"
 
 #define DATA_CANCEL 0xffffffff
 
 static bool debug = false;
+static int engine = ENGINE_POLL;
 
-static void print_debug(const char* const msg, int en)
+void print_debug(const char* const msg, int en)
 {
 	if (debug) {
 		if (errno == 0) {
@@ -29,16 +33,79 @@ void serial_debug(bool value)
 	debug = value;
 }
 
-//contains file descriptors used in managing a serial port
-struct serial_config {
-	int port_fd; // file descriptor of serial port
+int serial_engine(int value)
+{
+	if (value != ENGINE_POLL && value != ENGINE_IO_URING) {
+		print_debug("Invalid engine", 0);
+		return -E_INVALID_SETTINGS;
+	}
+	engine = value;
+	return 0;
+}
+
+int serial_get_engine(struct serial_config* const serial)
+{
+	return serial->engine;
+}
 
-	/* a pipe is used to abort a serial read by writing something into the
-	 * write end of the pipe */
-	int pipe_read_fd; // file descriptor, read end of pipe
-	int pipe_write_fd; // file descriptor, write end of pipe
+// speeds that can be set through the termios interface
+static const struct {
+	int baud;
+	speed_t code;
+} speeds[] = {
+	{50, B50}, {75, B75}, {110, B110}, {134, B134}, {150, B150}, {200, B200},
+	{300, B300}, {600, B600}, {1200, B1200}, {1800, B1800}, {2400, B2400},
+	{4800, B4800}, {9600, B9600}, {19200, B19200}, {38400, B38400},
+	{57600, B57600}, {115200, B115200}, {230400, B230400},
+#ifdef B460800
+	{460800, B460800},
+#endif
+#ifdef B500000
+	{500000, B500000},
+#endif
+#ifdef B576000
+	{576000, B576000},
+#endif
+#ifdef B921600
+	{921600, B921600},
+#endif
+#ifdef B1000000
+	{1000000, B1000000},
+#endif
+#ifdef B1152000
+	{1152000, B1152000},
+#endif
+#ifdef B1500000
+	{1500000, B1500000},
+#endif
+#ifdef B2000000
+	{2000000, B2000000},
+#endif
+#ifdef B2500000
+	{2500000, B2500000},
+#endif
+#ifdef B3000000
+	{3000000, B3000000},
+#endif
+#ifdef B3500000
+	{3500000, B3500000},
+#endif
+#ifdef B4000000
+	{4000000, B4000000},
+#endif
 };
 
+#define SPEEDS (sizeof(speeds) / sizeof(speeds[0]))
+
+// gets the termios code of a speed, B0 if there is none
+static speed_t speed_code(int baud)
+{
+	for (size_t i = 0; i < SPEEDS; ++i) {
+		if (speeds[i].baud == baud) return speeds[i].code;
+	}
+	return B0;
+}
+
 int serial_open(
 	const char* const port_name,
 	int baud,
@@ -66,6 +133,7 @@ int serial_open(
 
 	/* configure new port settings */
 	struct termios newtio;
+	memset(&newtio, 0, sizeof(newtio)); // VMIN and VTIME are 0, see serial_set_read_coalescing
 
 	/* initialize serial interface */
 	newtio.c_iflag = 0;
@@ -73,34 +141,16 @@ int serial_open(
 	newtio.c_lflag = 0;
 	newtio.c_cflag = CREAD;
 
-	/* set speed */
-	speed_t bd;
-	switch (baud) {
-        case 50: bd = B50; break;
-        case 75: bd = B75; break;
-        case 110: bd = B110; break;
-        case 134: bd = B134; break;
-        case 150: bd = B150; break;
-        case 200: bd = B200; break;
-        case 300: bd = B300; break;
-        case 600: bd = B600; break;
-        case 1200: bd = B1200; break;
-        case 1800: bd = B1800; break;
-        case 2400: bd = B2400; break;
-        case 4800: bd = B4800; break;
-        case 9600: bd = B9600; break;
-        case 19200: bd = B19200; break;
-        case 38400: bd = B38400; break;
-        case 57600: bd = B57600; break;
-        case 115200: bd = B115200; break;
-        case 230400: bd = B230400; break;
-        default:
+	/* set speed, speeds without a Bxxx constant are set once the other
+	 * settings have been applied */
+	if (baud <= 0) {
 		close(fd);
-	        print_debug("Invalid baud rate", 0);
+		print_debug("Invalid baud rate", 0);
 		return -E_INVALID_SETTINGS;
 	}
 
-	if (cfsetspeed(&newtio, bd) < 0) {
+	speed_t bd = speed_code(baud);
+	if (cfsetspeed(&newtio, bd == B0 ? B38400 : bd) < 0) {
 		print_debug("Error setting baud rate", errno);
 		close(fd);
 		return -E_IO;
@@ -146,6 +196,14 @@ int serial_open(
 		return -E_IO;
 	}
 
+	if (bd == B0) {
+		int r = termios2_set_speed(fd, baud);
+		if (r < 0) {
+			close(fd);
+			return r;
+		}
+	}
+
 	int pipe_fd[2];
 	if (pipe(pipe_fd) < 0) {
 		print_debug("Error opening pipe", errno);
@@ -161,7 +219,7 @@ int serial_open(
 		return -E_IO;
 	}
 
-	struct serial_config* s = malloc(sizeof(s));
+	struct serial_config* s = malloc(sizeof(*s));
 	if (s == NULL) {
 		print_debug("Error allocating memory for serial configuration", errno);
 		close(fd);
@@ -173,13 +231,115 @@ int serial_open(
 	s->port_fd = fd;
 	s->pipe_read_fd = pipe_fd[0];
 	s->pipe_write_fd = pipe_fd[1];
+	s->cancelled = false;
+	s->drain_cancelled = false;
+	s->engine = ENGINE_POLL;
+	s->uring = NULL;
+	s->reactor = NULL;
+	s->token = 0;
+	s->read_min = 0;
+	s->read_timeout = 0;
+	s->read_suspended = false;
+	s->read_timestamp = 0;
+	s->framer = NULL;
+	s->coalescer = NULL;
+	s->ring_held = 0;
+	s->ring_deadline = 0;
+	stats_init(s);
+
+	if (tx_init(s) < 0) {
+		close(fd);
+		close(pipe_fd[0]);
+		close(pipe_fd[1]);
+		free(s);
+		return -E_IO;
+	}
+
+	// fall back to polling if io_uring is not available
+	if (engine == ENGINE_IO_URING && uring_open(s) == 0) {
+		s->engine = ENGINE_IO_URING;
+	}
+
 	(*serial) = s;
 
 	return 0;
 }
 
+int serial_get_speed(struct serial_config* const serial)
+{
+	int speed = termios2_get_speed(serial->port_fd);
+	if (speed != -E_UNSUPPORTED) return speed;
+
+	struct termios tio;
+	if (tcgetattr(serial->port_fd, &tio) < 0) {
+		print_debug("Error retrieving serial settings", errno);
+		return -E_IO;
+	}
+	speed_t code = cfgetospeed(&tio);
+	for (size_t i = 0; i < SPEEDS; ++i) {
+		if (speeds[i].code == code) return speeds[i].baud;
+	}
+	return -E_IO;
+}
+
+int character_bits(struct serial_config* const serial)
+{
+	struct termios tio;
+	if (tcgetattr(serial->port_fd, &tio) < 0) {
+		print_debug("Error retrieving serial settings", errno);
+		return -E_IO;
+	}
+
+	int data;
+	switch (tio.c_cflag & CSIZE) {
+	case CS5: data = 5; break;
+	case CS6: data = 6; break;
+	case CS7: data = 7; break;
+	default: data = 8; break;
+	}
+	// start bit, data bits, parity bit and stop bits
+	return 1 + data + ((tio.c_cflag & PARENB) ? 1 : 0) + ((tio.c_cflag & CSTOPB) ? 2 : 1);
+}
+
+int64_t serial_read_timestamp(struct serial_config* const serial)
+{
+	return serial->read_timestamp;
+}
+
+int serial_input_queued(struct serial_config* const serial)
+{
+	int n;
+	if (ioctl(serial->port_fd, FIONREAD, &n) < 0) {
+		print_debug("Error querying input queue", errno);
+		return -E_IO;
+	}
+	// data that has been read but not yet taken as frames or coalesced reads
+	if (serial->framer != NULL) {
+		n += (int) framer_buffered(serial->framer);
+	}
+	if (serial->coalescer != NULL) {
+		n += (int) coalescer_buffered(serial->coalescer);
+	}
+	return n;
+}
+
+int serial_output_queued(struct serial_config* const serial)
+{
+	int n;
+	if (ioctl(serial->port_fd, TIOCOUTQ, &n) < 0) {
+		print_debug("Error querying output queue", errno);
+		return -E_IO;
+	}
+	// data that the kernel did not accept yet is queued by the port itself
+	return n + (int) __atomic_load_n(&serial->tx_size, __ATOMIC_ACQUIRE);
+}
+
 int serial_close(struct serial_config* const serial)
 {
+	if (serial->uring != NULL) {
+		uring_close(serial->uring);
+	}
+
 	if (close(serial->pipe_write_fd) < 0) {
 		print_debug("Error closing write end of pipe", errno);
 		return -E_IO;
@@ -198,51 +358,422 @@ int serial_close(struct serial_config* const serial)
 		return -E_IO;
 	}
 
+	if (serial->framer != NULL) {
+		framer_close(serial->framer);
+	}
+	if (serial->coalescer != NULL) {
+		coalescer_close(serial->coalescer);
+	}
+	tx_free(serial);
 	free(serial);
 	return 0;
 }
 
-int serial_read(struct serial_config* const serial, char* const buffer, size_t size)
+int serial_set_read_coalescing(struct serial_config* const serial, size_t min_size, unsigned int timeout)
 {
-	int port = serial->port_fd;
-	int pipe = serial->pipe_read_fd;
+	struct termios tio;
+	if (tcgetattr(serial->port_fd, &tio) < 0) {
+		print_debug("Error retrieving serial settings", errno);
+		return -E_IO;
+	}
+
+	/* without a timeout, the kernel waits for the minimum number of bytes
+	 * before signaling the port as readable; with a timeout, it must signal
+	 * every byte, so that the inter-byte timer can be restarted */
+	tio.c_cc[VMIN] = timeout == 0 ? (min_size < 255 ? min_size : 255) : 0;
+	tio.c_cc[VTIME] = 0;
+
+	if (tcsetattr(serial->port_fd, TCSANOW, &tio) < 0) {
+		print_debug("Error applying serial settings", errno);
+		return -E_IO;
+	}
 
-	fd_set rfds;
-	FD_ZERO(&rfds);
-	FD_SET(port, &rfds);
-	FD_SET(pipe, &rfds);
+	// non-blocking reads accumulate data themselves, the coalescer is replaced before any is read
+	struct coalescer* coalescer = NULL;
+	if ((min_size > 0 || timeout > 0) && coalescer_open(min_size, timeout, &coalescer) < 0) {
+		return -E_IO;
+	}
+	if (serial->coalescer != NULL) coalescer_close(serial->coalescer);
+	serial->coalescer = coalescer;
 
-	int nfds = pipe + 1;
-	if (pipe < port) nfds = port + 1;
+	serial->read_min = min_size;
+	serial->read_timeout = timeout;
+	return 0;
+}
 
-	int n = select(nfds, &rfds, NULL, NULL, NULL);
-	if (n < 0) {
-		print_debug("Error trying to call select on port and pipe", errno);
+int serial_set_flow_control(struct serial_config* const serial, int flow)
+{
+	struct termios tio;
+	if (tcgetattr(serial->port_fd, &tio) < 0) {
+		print_debug("Error retrieving serial settings", errno);
 		return -E_IO;
 	}
 
-	if (FD_ISSET(pipe, &rfds)) {
-		return -E_INTERRUPT;
-	} else if (FD_ISSET(port, &rfds)) {
-		int r = read(port, buffer, size);
+	tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+#ifdef CRTSCTS
+	tio.c_cflag &= ~CRTSCTS;
+#endif
+
+	switch (flow) {
+	case FLOW_NONE: break;
+	case FLOW_HARDWARE:
+#ifdef CRTSCTS
+		tio.c_cflag |= CRTSCTS;
+		break;
+#else
+		print_debug("Hardware flow control is not supported on this platform", 0);
+		return -E_INVALID_SETTINGS;
+#endif
+	case FLOW_SOFTWARE:
+		// XON/XOFF characters are consumed by the kernel in both directions
+		tio.c_iflag |= IXON | IXOFF;
+		tio.c_cc[VSTART] = 0x11;
+		tio.c_cc[VSTOP] = 0x13;
+		break;
+	default:
+		print_debug("Invalid flow control", 0);
+		return -E_INVALID_SETTINGS;
+	}
+
+	if (tcsetattr(serial->port_fd, TCSANOW, &tio) < 0) {
+		print_debug("Error applying serial settings", errno);
+		return -E_IO;
+	}
+	return 0;
+}
+
+int serial_suspend_reading(struct serial_config* const serial, bool suspended)
+{
+	pthread_mutex_lock(&serial->tx_lock);
+	__atomic_store_n(&serial->read_suspended, suspended, __ATOMIC_RELEASE);
+	if (serial->reactor != NULL) reactor_watch_writable(serial, tx_pending(serial));
+	pthread_mutex_unlock(&serial->tx_lock);
+
+	// a reactor takes data held by a coalescer once woken, which new data might never do
+	if (!suspended && serial->coalescer != NULL) coalescer_wake(serial->coalescer);
+
+	// a blocked read must stop or start waiting for data
+	char data = DATA_WAKE;
+	if (write(serial->pipe_write_fd, &data, 1) < 0) {
+		print_debug("Error writing to pipe during read suspension", errno);
+		return -E_IO;
+	}
+	return 0;
+}
+
+static inline bool suspended(struct serial_config* const serial)
+{
+	return __atomic_load_n(&serial->read_suspended, __ATOMIC_ACQUIRE);
+}
+
+/* Continues a read that returned n bytes, until the port's minimum has been
+ * read or, if it has none, the buffer is full. With an inter-byte timeout, the
+ * read also ends once no further byte arrived in time. A cancellation or
+ * error ends coalescing, it is reported by the next read instead, so that data
+ * already read is not lost, as do suspension of reading and a drain of the
+ * transmit queue, which a peer may be waiting for before it sends more. */
+static int coalesce(struct serial_config* const serial, char* const buffer, size_t size, int n)
+{
+	struct pollfd fds[2];
+	fds[0].fd = serial->port_fd;
+	fds[1].fd = serial->pipe_read_fd;
+	fds[1].events = POLLIN;
+
+	int timeout = serial->read_timeout > 0 ? (int) serial->read_timeout : -1;
+
+	while (coalescing(serial, size, (size_t) n) && !suspended(serial)) {
+		fds[0].events = POLLIN;
+		if (tx_pending(serial)) fds[0].events |= POLLOUT;
+
+		int r = poll(fds, 2, timeout);
+		if (r < 0 && errno == EINTR) continue;
+		if (r <= 0) break; // timed out
+		count_wakeup(serial);
+
+		if ((fds[1].revents & POLLIN) && check_cancel(serial)) break;
+		if ((fds[0].revents & POLLOUT) && tx_flush(serial) < 0) break;
+
+		// data may have arrived just as reading was suspended
+		if (suspended(serial)) break;
+
+		// the drained flag is only ever set by this thread, hence may be checked without lock
+		if (serial->tx_drained) break;
+
+		if (fds[0].revents & (POLLIN | POLLERR | POLLHUP)) {
+			int m = read(serial->port_fd, buffer + n, size - n);
+			if (m <= 0) break;
+			serial->read_timestamp = serial_timestamp();
+			count_read(serial, m);
+			n += m;
+		}
+	}
+	return n;
+}
+
+/* Reads data as soon as any is available. */
+static int read_once(struct serial_config* const serial, char* const buffer, size_t size)
+{
+	if (serial->engine == ENGINE_IO_URING) {
+		return uring_read(serial, buffer, size);
+	}
+
+	if (serial->cancelled) return -E_INTERRUPT;
+
+	/* poll is used instead of select, since the latter cannot handle file
+	 * descriptors beyond FD_SETSIZE, a limit easily reached when many ports
+	 * are open */
+	struct pollfd fds[2];
+	fds[0].fd = serial->port_fd;
+	fds[1].fd = serial->pipe_read_fd;
+	fds[1].events = POLLIN;
+
+	for (;;) {
+		// a drain found along with data returned by the previous read is reported first
+		if (tx_take_drained(serial)) {
+			return 0;
+		}
+
+		/* also wait for writability if there is queued data to transmit,
+		 * errors and hang ups are reported even while reading is suspended */
+		fds[0].events = suspended(serial) ? 0 : POLLIN;
+		if (tx_pending(serial)) fds[0].events |= POLLOUT;
+
+		int n = poll(fds, 2, -1);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			print_debug("Error trying to call poll on port and pipe", errno);
+			return -E_IO;
+		}
+		count_wakeup(serial);
+
+		if ((fds[1].revents & POLLIN) && check_cancel(serial)) {
+			return -E_INTERRUPT;
+		}
+
+		if ((fds[0].revents & POLLOUT) && tx_flush(serial) < 0) {
+			return -E_IO;
+		}
+
+		// data may have arrived just as reading was suspended
+		bool readable = (fds[0].revents & POLLIN) && !suspended(serial);
+		if (readable || (fds[0].revents & (POLLERR | POLLHUP))) {
+			int r = read(serial->port_fd, buffer, size);
+
+			// treat 0 bytes read as an error to avoid problems on disconnect
+			// anyway, after a poll there should be more than 0 bytes available to read
+			if (r <= 0) {
+				print_debug("Error data not available after poll", errno);
+				return -E_IO;
+			}
+			serial->read_timestamp = serial_timestamp();
+			count_read(serial, r);
+			return r;
+		}
+	}
+}
+
+/* Reads data, coalesced as configured. */
+static int read_data(struct serial_config* const serial, char* const buffer, size_t size)
+{
+	// data accumulated by non-blocking reads comes first
+	if (serial->coalescer != NULL && coalescer_buffered(serial->coalescer) > 0) {
+		return coalescer_take(serial->coalescer, buffer, size, true);
+	}
+
+	int n = read_once(serial, buffer, size);
+	if (n > 0 && coalescing(serial, size, (size_t) n)) {
+		n = coalesce(serial, buffer, size, n);
+	}
+	return n;
+}
+
+/* Continues a gap-delimited frame in progress, reading data as soon as any is
+ * available or returning 0 once the line has been silent for the gap. On Linux
+ * the framer's timer is waited for, elsewhere poll's timeout, rounded up to a
+ * millisecond, times the gap. */
+static int read_gap(struct serial_config* const serial, char* const buffer, size_t size)
+{
+	if (serial->cancelled) return -E_INTERRUPT;
+
+	struct pollfd fds[3];
+	fds[0].fd = serial->port_fd;
+	fds[1].fd = serial->pipe_read_fd;
+	fds[1].events = POLLIN;
+	fds[2].fd = framer_timer(serial->framer);
+	fds[2].events = POLLIN;
+	nfds_t count = fds[2].fd < 0 ? 2 : 3;
+
+	for (;;) {
+		int64_t remaining = framer_gap_remaining(serial->framer);
+		if (remaining <= 0) return 0;
+		int timeout = count == 3 ? -1 : (int) ((remaining + 999999) / 1000000);
+
+		fds[0].events = suspended(serial) ? 0 : POLLIN;
+		if (tx_pending(serial)) fds[0].events |= POLLOUT;
+
+		int n = poll(fds, count, timeout);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			print_debug("Error trying to call poll on port, pipe and timer", errno);
+			return -E_IO;
+		}
+		count_wakeup(serial);
 
-		// treat 0 bytes read as an error to avoid problems on disconnect
-		// anyway, after a poll there should be more than 0 bytes available to read
-		if (r <= 0) {
-			print_debug("Error data not available after select", errno);
+		if ((fds[1].revents & POLLIN) && check_cancel(serial)) {
+			return -E_INTERRUPT;
+		}
+
+		if ((fds[0].revents & POLLOUT) && tx_flush(serial) < 0) {
+			return -E_IO;
+		}
+
+		// data that arrived before the timer expired continues the frame
+		bool readable = (fds[0].revents & POLLIN) && !suspended(serial);
+		if (readable || (fds[0].revents & (POLLERR | POLLHUP))) {
+			int r = read(serial->port_fd, buffer, size);
+			if (r <= 0) {
+				print_debug("Error data not available after poll", errno);
+				return -E_IO;
+			}
+			serial->read_timestamp = serial_timestamp();
+			count_read(serial, r);
+			return r;
+		}
+	}
+}
+
+int serial_read(struct serial_config* const serial, char* const buffer, size_t size)
+{
+	if (serial->framer == NULL) return read_data(serial, buffer, size);
+
+	// accumulate data until a whole frame is available
+	for (;;) {
+		int n = framer_take(serial->framer, buffer, size);
+		if (n != 0) return n;
+
+		char* space;
+		size_t space_size = framer_space(serial->framer, &space);
+		if (framer_gap_remaining(serial->framer) >= 0) {
+			n = read_gap(serial, space, space_size);
+			if (n == 0) {
+				framer_end_gap(serial->framer);
+				continue;
+			}
+		} else {
+			n = read_data(serial, space, space_size);
+		}
+		if (n <= 0) return n;
+		framer_fill(serial->framer, (size_t) n);
+	}
+}
+
+/* Reads data that is available from the port, without blocking. */
+static int try_read_port(struct serial_config* const serial, char* const buffer, size_t size)
+{
+	// a zero-sized read only checks for disconnection
+	int r = read(serial->port_fd, buffer, suspended(serial) ? 0 : size);
+	if (r < 0) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+		print_debug("Error reading from port", errno);
+		return -E_IO;
+	}
+
+	/* since ports are opened without a minimum read size, no data may be
+	 * reported as 0 bytes read instead of an error, which is however
+	 * also the case for ports that have been disconnected */
+	if (r == 0) {
+		struct pollfd fd;
+		fd.fd = serial->port_fd;
+		fd.events = POLLIN;
+		if (poll(&fd, 1, 0) < 0 || (fd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+			print_debug("Port has been disconnected", 0);
 			return -E_IO;
 		}
-		return r;
 	} else {
-		print_debug("Select returned unknown read sets", 0);
+		serial->read_timestamp = serial_timestamp();
+		count_read(serial, r);
+	}
+	return r;
+}
+
+/* Reads available data into the port's coalescer, taking it once enough has
+ * accumulated. Without an inter-byte timeout, the kernel only signals the port
+ * as readable once the minimum (up to 255 bytes) is available, hence less is
+ * not read, lest the rest never be signaled. */
+static int try_coalesce(struct serial_config* const serial, char* const buffer, size_t size)
+{
+	struct coalescer* c = serial->coalescer;
+
+	char* space;
+	size_t space_size;
+	if (coalescer_space(c, size, &space, &space_size) < 0) return -E_IO;
+
+	if (serial->read_timeout == 0 && space_size > 0) {
+		int available;
+		if (ioctl(serial->port_fd, FIONREAD, &available) < 0) {
+			print_debug("Error querying input queue", errno);
+			return -E_IO;
+		}
+		size_t signaled = serial->read_min < 255 ? serial->read_min : 255;
+		size_t total = coalescer_buffered(c) + (size_t) available;
+		if ((size_t) available < signaled && coalescing(serial, size, total)) space_size = 0;
+	}
+
+	int r = try_read_port(serial, space, space_size);
+	if (r < 0) return r;
+	coalescer_fill(c, (size_t) r);
+
+	// data held while reading is suspended is taken once the coalescer is woken on resumption
+	if (suspended(serial)) {
+		coalescer_idle(c);
+		return 0;
+	}
+	return coalescer_take(c, buffer, size, false);
+}
+
+/* Reads data if any is available, without blocking. */
+static int try_read_data(struct serial_config* const serial, char* const buffer, size_t size)
+{
+	if (tx_pending(serial) && tx_flush(serial) < 0) {
 		return -E_IO;
 	}
+
+	if (serial->coalescer != NULL) return try_coalesce(serial, buffer, size);
+	return try_read_port(serial, buffer, size);
+}
+
+int serial_try_read(struct serial_config* const serial, char* const buffer, size_t size)
+{
+	if (serial->framer == NULL) return try_read_data(serial, buffer, size);
+
+	for (;;) {
+		int n = framer_take(serial->framer, buffer, size);
+		if (n != 0) return n;
+
+		char* space;
+		size_t space_size = framer_space(serial->framer, &space);
+		n = try_read_data(serial, space, space_size);
+		if (n == 0 && framer_end_gap(serial->framer)) continue;
+		if (n <= 0) return n;
+		framer_fill(serial->framer, (size_t) n);
+
+		// less data than requested means none is left to read
+		if ((size_t) n < space_size) return framer_take(serial->framer, buffer, size);
+	}
+}
+
+int serial_take_drained(struct serial_config* const serial)
+{
+	return tx_take_drained(serial) ? 1 : 0;
 }
 
 int serial_cancel_read(struct serial_config* const serial)
 {
 	int data = DATA_CANCEL;
 
+	__atomic_store_n(&serial->drain_cancelled, true, __ATOMIC_RELEASE);
+	__atomic_add_fetch(&serial->stats.cancels, 1, __ATOMIC_RELAXED);
+
 	//write to pipe to wake up any blocked read thread (self-pipe trick)
 	if (write(serial->pipe_write_fd, &data, 1) < 0) {
 		print_debug("Error writing to pipe during read cancel", errno);
@@ -254,10 +785,13 @@ int serial_cancel_read(struct serial_config* const serial)
 
 int serial_write(struct serial_config* const serial, char* const data, size_t size)
 {
-	int r = write(serial->port_fd, data, size);
-	if (r < 0) {
-		print_debug("Error writing to port", errno);
-		return -E_IO;
-	}
-	return r;
+	struct serial_buffer buffer;
+	buffer.data = data;
+	buffer.size = size;
+	return tx_writev(serial, &buffer, 1);
+}
+
+int serial_writev(struct serial_config* const serial, const struct serial_buffer* const buffers, size_t count)
+{
+	return tx_writev(serial, buffers, count);
 }
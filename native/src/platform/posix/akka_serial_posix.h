@@ -0,0 +1,338 @@
+#ifndef AKKA_SERIAL_POSIX_H
+#define AKKA_SERIAL_POSIX_H
+
+/*
+ * Internal definitions shared by the sources of the posix backend. Nothing
+ * declared in this file is part of the public interface (see akka_serial.h).
+ */
+
+#include <pthread.h>
+#include "akka_serial.h"
+
+// capacity of the transmit queue of a port, allocated on first use
+#define TX_QUEUE_CAPACITY 65536
+
+// byte written to a port's pipe to wake up a blocked read without cancelling it
+#define DATA_WAKE 0x00
+
+//contains file descriptors used in managing a serial port
+struct serial_config {
+	int port_fd; // file descriptor of serial port
+
+	/* a pipe is used to abort a serial read by writing something into the
+	 * write end of the pipe */
+	int pipe_read_fd; // file descriptor, read end of pipe
+	int pipe_write_fd; // file descriptor, write end of pipe
+
+	bool cancelled; // a cancellation has been read from the pipe
+	bool drain_cancelled; // set by a cancellation, which also interrupts drains
+
+	size_t read_min; // minimum number of bytes returned by a read, 0 if any
+	unsigned int read_timeout; // inter-byte timeout in milliseconds, 0 if none
+	bool read_suspended; // reading is suspended, may be read without lock
+	int64_t read_timestamp; // time at which data of the last read was read, see 'serial_timestamp'
+
+	struct framer* framer; // accumulates received data into frames, NULL if the port has no framing
+	struct coalescer* coalescer; // accumulates data of non-blocking reads, NULL if reads are not coalesced
+	size_t ring_held; // bytes filled into a receive ring that the consumer has not been notified of
+	int64_t ring_deadline; // time at which held ring data is notified regardless of its size
+
+	int engine; // engine used to read from port
+	struct uring* uring; // io_uring state, only used by the io_uring engine
+
+	struct serial_reactor* reactor; // reactor the port is registered with, NULL if none
+	int64_t token; // token under which the port is registered
+
+	/* data that could not be written immediately is kept in a transmit
+	 * queue (circular buffer), which is shared between writers and the
+	 * thread that waits on the port */
+	pthread_mutex_t tx_lock; // guards the transmit queue
+	char* tx_queue; // queued data, NULL until first used
+	size_t tx_head; // index of first queued byte
+	size_t tx_size; // number of queued bytes, may be read without lock
+	bool tx_blocked; // a write was not completely accepted since the queue last drained
+	bool tx_drained; // the queue drained after a blocked write, not yet reported
+
+	/* counters are updated atomically by any thread, the driver's error
+	 * counts are those at the time the port was opened, see 'stats_init' */
+	struct serial_stats stats;
+};
+
+/* Counts a read system call that returned n bytes. */
+static inline void count_read(struct serial_config* const serial, int n)
+{
+	__atomic_add_fetch(&serial->stats.reads, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&serial->stats.bytes_read, (uint64_t) n, __ATOMIC_RELAXED);
+}
+
+/* Counts a write system call that accepted n bytes. */
+static inline void count_write(struct serial_config* const serial, size_t n)
+{
+	__atomic_add_fetch(&serial->stats.writes, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&serial->stats.bytes_written, (uint64_t) n, __ATOMIC_RELAXED);
+}
+
+/* Counts the return of a wait for a port. */
+static inline void count_wakeup(struct serial_config* const serial)
+{
+	__atomic_add_fetch(&serial->stats.wakeups, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * Prints a message to stderr if debugging is enabled.
+ * @param msg message to print
+ * @param en error number to append to the message
+ */
+void print_debug(const char* const msg, int en);
+
+/**
+ * Initializes the transmit queue of a serial port.
+ * @return 0 on success
+ * @return -E_IO on error
+ */
+int tx_init(struct serial_config* const serial);
+
+/**
+ * Frees the transmit queue of a serial port.
+ */
+void tx_free(struct serial_config* const serial);
+
+/**
+ * Implementation of 'serial_writev': writes as much data as the kernel accepts and queues the
+ * rest, as far as the queue's capacity allows.
+ */
+int tx_writev(struct serial_config* const serial, const struct serial_buffer* const buffers, size_t count);
+
+/**
+ * Writes queued data to a port, as far as the kernel accepts it without blocking.
+ * @return n>=0 the number of bytes still queued
+ * @return -E_IO on error
+ */
+int tx_flush(struct serial_config* const serial);
+
+/**
+ * Checks if a port has queued data, i.e. if it should be waited on for writability.
+ */
+bool tx_pending(struct serial_config* const serial);
+
+/**
+ * Checks and clears the notification that the transmit queue has drained after a write was not
+ * completely accepted.
+ */
+bool tx_take_drained(struct serial_config* const serial);
+
+/**
+ * Consumes any data in the port's pipe, distinguishing transmit wake ups from cancellations.
+ * @return true if the port has been cancelled
+ */
+bool check_cancel(struct serial_config* const serial);
+
+/**
+ * Sets whether a reactor should report a port when it is writable, in addition to readable
+ * (unless reading is suspended). Must be called with the port's transmit queue locked.
+ */
+void reactor_watch_writable(struct serial_config* const serial, bool writable);
+
+/**
+ * Sets a port's speed through termios2, allowing speeds that have no Bxxx constant.
+ * @return 0 on success
+ * @return -E_INVALID_SETTINGS if the speed is not supported by the port or platform
+ * @return -E_IO on other error
+ */
+int termios2_set_speed(int fd, int baud);
+
+/**
+ * Gets the speed a port actually uses, as reported by its driver.
+ * @return n>0 speed in baud
+ * @return -E_UNSUPPORTED if termios2 is not available on the current platform
+ * @return -E_IO on error
+ */
+int termios2_get_speed(int fd);
+
+/**
+ * Gets the number of bits transmitted per character by a port, including start, parity and stop
+ * bits.
+ * @return n>0 the number of bits
+ * @return -E_IO on error
+ */
+int character_bits(struct serial_config* const serial);
+
+/**
+ * Clears the statistics of a newly opened port, and records the driver's error counts as the
+ * baseline of those reported by 'serial_get_stats'.
+ */
+void stats_init(struct serial_config* const serial);
+
+// maximum length of the sysfs root, including the terminating null character
+#define SYSFS_ROOT_MAX 256
+
+/** Directory under which sysfs is mounted, see 'serial_sysfs_root'. */
+extern char sysfs_root[SYSFS_ROOT_MAX];
+
+/** Accumulates received data of a port with framing, see 'serial_set_framing'. */
+struct framer;
+
+/**
+ * Allocates a framer.
+ * @param framing framing applied by the framer, of a kind other than FRAMING_NONE
+ * @param framer pointer to memory that will be allocated with a framer
+ * @return 0 on success
+ * @return -E_INVALID_SETTINGS if the framing is invalid
+ * @return -E_IO on other error
+ */
+int framer_open(const struct serial_framing* const framing, struct framer** const framer);
+
+/**
+ * Frees a framer, discarding any data it accumulated.
+ */
+void framer_close(struct framer* const framer);
+
+/**
+ * Takes the next whole frame out of the data accumulated by a framer.
+ * @return n>0 the size of the frame copied into buffer
+ * @return 0 if no whole frame has been accumulated
+ * @return -E_INVALID_SETTINGS if the frame does not fit into the buffer, it is discarded
+ */
+int framer_take(struct framer* const framer, char* const buffer, size_t size);
+
+/**
+ * Gets the space into which data should be read, to be accumulated by a framer. There is always
+ * some space, since data that cannot be part of a frame is discarded.
+ * @param data set to the start of the space
+ * @return the size of the space
+ */
+size_t framer_space(struct framer* const framer, char** const data);
+
+/**
+ * Accumulates data that has been read into the space of a framer, see 'framer_space'.
+ * @param size number of bytes read
+ */
+void framer_fill(struct framer* const framer, size_t size);
+
+/**
+ * Gets the number of bytes accumulated by a framer, which have not been taken as frames yet.
+ */
+size_t framer_buffered(struct framer* const framer);
+
+/**
+ * Gets the timer of a framer with gap framing, which becomes readable once the gap after the
+ * last accumulated data has elapsed.
+ * @return the timer's file descriptor, -1 if the framer has none (also on platforms other than
+ * Linux, on which readers must time gaps themselves, see 'framer_gap_remaining')
+ */
+int framer_timer(struct framer* const framer);
+
+/**
+ * Gets the time left until the gap after a frame in progress has elapsed.
+ * @return n>=0 the remaining time in nanoseconds, 0 if the gap has elapsed
+ * @return -1 if no frame is in progress, i.e. the framer has no gap framing or no data
+ */
+int64_t framer_gap_remaining(struct framer* const framer);
+
+/**
+ * Ends the frame in progress if the gap after it has elapsed, so that it may be taken.
+ * @return true if the gap has elapsed
+ */
+bool framer_end_gap(struct framer* const framer);
+
+/** Accumulates data of non-blocking reads of a port with read coalescing, see 'serial_set_read_coalescing'. */
+struct coalescer;
+
+/**
+ * Allocates a coalescer.
+ * @param min minimum number of bytes taken at once, 0 if any
+ * @param timeout inter-byte timeout in milliseconds, after which data is taken regardless of
+ * its size, 0 if none
+ * @param coalescer pointer to memory that will be allocated with a coalescer
+ * @return 0 on success
+ * @return -E_IO on error
+ */
+int coalescer_open(size_t min, unsigned int timeout, struct coalescer** const coalescer);
+
+/**
+ * Frees a coalescer, discarding any data it accumulated.
+ */
+void coalescer_close(struct coalescer* const coalescer);
+
+/**
+ * Gets the space into which data should be read, to be accumulated by a coalescer until it is
+ * taken into a buffer of the given size.
+ * @param data set to the start of the space
+ * @param space set to the size of the space, 0 if the data accumulated fills the buffer already
+ * @return 0 on success
+ * @return -E_IO if the coalescer's buffer cannot be grown
+ */
+int coalescer_space(struct coalescer* const coalescer, size_t size, char** const data, size_t* const space);
+
+/**
+ * Accumulates data that has been read into the space of a coalescer, see 'coalescer_space'.
+ * @param size number of bytes read
+ */
+void coalescer_fill(struct coalescer* const coalescer, size_t size);
+
+/**
+ * Gets the number of bytes accumulated by a coalescer, which have not been taken yet.
+ */
+size_t coalescer_buffered(struct coalescer* const coalescer);
+
+/**
+ * Takes the accumulated data out of a coalescer, once the minimum has been accumulated, the
+ * buffer can be filled or the inter-byte timeout expired. Otherwise, the coalescer's timer is
+ * armed to expire with the timeout.
+ * @param force set to take the accumulated data regardless
+ * @return n>0 the number of bytes copied into buffer
+ * @return 0 if no data is taken
+ */
+int coalescer_take(struct coalescer* const coalescer, char* const buffer, size_t size, bool force);
+
+/**
+ * Gets the timer of a coalescer with an inter-byte timeout, which becomes readable once data
+ * may be taken. The timer is created on first use.
+ * @return the timer's file descriptor, -1 if the coalescer has none (also on platforms other
+ * than Linux, on which the timeout is only checked when taking data)
+ */
+int coalescer_timer(struct coalescer* const coalescer);
+
+/**
+ * Makes a coalescer's timer expire immediately, so that a reactor checks for data to take, e.g.
+ * once reading is resumed. This function may be called from any thread.
+ */
+void coalescer_wake(struct coalescer* const coalescer);
+
+/**
+ * Clears an expiration of a coalescer's timer while no data is taken, e.g. while reading is
+ * suspended.
+ */
+void coalescer_idle(struct coalescer* const coalescer);
+
+/* Checks if a read of n bytes into a buffer of the given size should wait for more data. */
+static inline bool coalescing(struct serial_config* const serial, size_t size, size_t n)
+{
+	if (n >= size) return false;
+	if (serial->read_min > 0) return n < serial->read_min;
+	return serial->read_timeout > 0;
+}
+
+/** State of the io_uring engine of a serial port. */
+struct uring;
+
+/**
+ * Sets up the io_uring engine of a serial port.
+ * @param serial serial port, its uring field is set on success
+ * @return 0 on success
+ * @return -E_UNSUPPORTED if io_uring is not available or lacks required features
+ * @return -E_IO on other error
+ */
+int uring_open(struct serial_config* const serial);
+
+/**
+ * Tears down an io_uring engine, cancelling any operations in flight.
+ */
+void uring_close(struct uring* const ring);
+
+/**
+ * Implementation of 'serial_read' for the io_uring engine.
+ */
+int uring_read(struct serial_config* const serial, char* const buffer, size_t size);
+
+#endif /* AKKA_SERIAL_POSIX_H */
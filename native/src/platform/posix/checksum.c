@@ -0,0 +1,261 @@
+/*
+ * Checksums of frames.
+ *
+ * CRCs are computed from tables, either a byte at a time or eight bytes at a
+ * time ("slice-by-8"). CRC-32 may also be computed by folding 64 bytes at a
+ * time with carry-less multiplications (PCLMULQDQ), following Intel's "Fast
+ * CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction". The
+ * kernel is selected at first use, from the features of the running CPU.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdint.h>
+#include "akka_serial.h"
+#include "akka_serial_posix.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define HAVE_X86_CHECKSUM
+#include <immintrin.h>
+#endif
+
+#define CRC16_POLY 0xA001 // 0x8005 reflected, CRC-16/MODBUS
+#define CRC32_POLY 0xEDB88320 // 0x04C11DB7 reflected, CRC-32
+#define CCITT_POLY 0x1021 // CRC-16/CCITT-FALSE, not reflected
+
+/* Tables of every CRC, table[k][b] being the CRC of byte b followed by k zero
+ * bytes, from a state of 0. */
+static uint32_t crc16_table[8][256];
+static uint32_t crc32_table[8][256];
+static uint32_t ccitt_table[8][256];
+
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+// kernel used by serial_checksum, 0 until selected
+static int kernel = 0;
+
+static void init_reflected(uint32_t table[8][256], uint32_t poly)
+{
+	for (uint32_t b = 0; b < 256; ++b) {
+		uint32_t crc = b;
+		for (int i = 0; i < 8; ++i) {
+			crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+		}
+		table[0][b] = crc;
+	}
+	for (int k = 1; k < 8; ++k) {
+		for (int b = 0; b < 256; ++b) {
+			uint32_t previous = table[k - 1][b];
+			table[k][b] = (previous >> 8) ^ table[0][previous & 0xff];
+		}
+	}
+}
+
+static void init_tables(void)
+{
+	init_reflected(crc16_table, CRC16_POLY);
+	init_reflected(crc32_table, CRC32_POLY);
+
+	for (uint32_t b = 0; b < 256; ++b) {
+		uint32_t crc = b << 8;
+		for (int i = 0; i < 8; ++i) {
+			crc = (crc & 0x8000) ? (crc << 1) ^ CCITT_POLY : crc << 1;
+		}
+		ccitt_table[0][b] = crc & 0xffff;
+	}
+	for (int k = 1; k < 8; ++k) {
+		for (int b = 0; b < 256; ++b) {
+			uint32_t previous = ccitt_table[k - 1][b];
+			ccitt_table[k][b] = ((previous << 8) & 0xffff) ^ ccitt_table[0][previous >> 8];
+		}
+	}
+}
+
+static uint32_t reflected_table(uint32_t table[8][256], uint32_t crc, const unsigned char* p, size_t size)
+{
+	while (size-- > 0) {
+		crc = (crc >> 8) ^ table[0][(crc ^ *p++) & 0xff];
+	}
+	return crc;
+}
+
+static uint32_t reflected_slice8(uint32_t table[8][256], uint32_t crc, const unsigned char* p, size_t size)
+{
+	for (; size >= 8; p += 8, size -= 8) {
+		uint32_t low = (p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24) ^ crc;
+		uint32_t high = p[4] | p[5] << 8 | p[6] << 16 | (uint32_t) p[7] << 24;
+		crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^
+			table[5][(low >> 16) & 0xff] ^ table[4][low >> 24] ^
+			table[3][high & 0xff] ^ table[2][(high >> 8) & 0xff] ^
+			table[1][(high >> 16) & 0xff] ^ table[0][high >> 24];
+	}
+	return reflected_table(table, crc, p, size);
+}
+
+static uint32_t ccitt_bytes(uint32_t crc, const unsigned char* p, size_t size)
+{
+	while (size-- > 0) {
+		crc = ((crc << 8) & 0xffff) ^ ccitt_table[0][(crc >> 8) ^ *p++];
+	}
+	return crc;
+}
+
+static uint32_t ccitt_slice8(uint32_t crc, const unsigned char* p, size_t size)
+{
+	// the state lines up with the first two bytes of a slice
+	for (; size >= 8; p += 8, size -= 8) {
+		crc = ccitt_table[7][p[0] ^ (crc >> 8)] ^ ccitt_table[6][p[1] ^ (crc & 0xff)] ^
+			ccitt_table[5][p[2]] ^ ccitt_table[4][p[3]] ^
+			ccitt_table[3][p[4]] ^ ccitt_table[2][p[5]] ^
+			ccitt_table[1][p[6]] ^ ccitt_table[0][p[7]];
+	}
+	return ccitt_bytes(crc, p, size);
+}
+
+#ifdef HAVE_X86_CHECKSUM
+
+/* Folds a multiple of 16 bytes, at least 64, into a CRC-32 state. The
+ * constants are powers of x modulo the bit-reflected polynomial, given at the
+ * end of Intel's paper. */
+__attribute__((target("pclmul")))
+static uint32_t crc32_pclmul(uint32_t crc, const unsigned char* p, size_t size)
+{
+	const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+	const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+	const __m128i k5 = _mm_set_epi64x(0, 0x0163cd6124);
+	const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+	const __m128i low32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+	__m128i x1 = _mm_loadu_si128((const __m128i*) (p + 0x00));
+	__m128i x2 = _mm_loadu_si128((const __m128i*) (p + 0x10));
+	__m128i x3 = _mm_loadu_si128((const __m128i*) (p + 0x20));
+	__m128i x4 = _mm_loadu_si128((const __m128i*) (p + 0x30));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int) crc));
+	p += 64;
+	size -= 64;
+
+	// fold four lanes of 128 bits in parallel
+	for (; size >= 64; p += 64, size -= 64) {
+		__m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+		__m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+		__m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+		__m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*) (p + 0x00)));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i*) (p + 0x10)));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i*) (p + 0x20)));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i*) (p + 0x30)));
+	}
+
+	// fold the lanes into one, then the remaining blocks of 16 bytes
+	__m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), x2), x5);
+	x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), x3), x5);
+	x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), x4), x5);
+	for (; size >= 16; p += 16, size -= 16) {
+		x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i*) p)), x5);
+	}
+
+	// fold 128 bits to 64 bits
+	x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, low32);
+	x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, k5, 0x00), x2);
+
+	// Barrett reduction to 32 bits
+	x2 = _mm_and_si128(x1, low32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+	x2 = _mm_and_si128(x2, low32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	return (uint32_t) _mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+}
+
+#endif
+
+int serial_checksum_kernel(int value)
+{
+	pthread_once(&tables_once, init_tables);
+
+#ifdef HAVE_X86_CHECKSUM
+	__builtin_cpu_init();
+	bool pclmul = __builtin_cpu_supports("pclmul");
+#else
+	bool pclmul = false;
+#endif
+
+	switch (value) {
+	case CHECKSUM_KERNEL_AUTO:
+		value = pclmul ? CHECKSUM_KERNEL_PCLMUL : CHECKSUM_KERNEL_SLICE8;
+		break;
+	case CHECKSUM_KERNEL_TABLE:
+	case CHECKSUM_KERNEL_SLICE8:
+		break;
+	case CHECKSUM_KERNEL_PCLMUL:
+		if (!pclmul) return -E_UNSUPPORTED;
+		break;
+	default:
+		print_debug("Invalid checksum kernel", 0);
+		return -E_INVALID_SETTINGS;
+	}
+
+	__atomic_store_n(&kernel, value, __ATOMIC_RELEASE);
+	return value;
+}
+
+int64_t serial_checksum(int kind, const char* const data, size_t size)
+{
+	int k = __atomic_load_n(&kernel, __ATOMIC_ACQUIRE);
+	if (k == 0) k = serial_checksum_kernel(CHECKSUM_KERNEL_AUTO);
+
+	const unsigned char* p = (const unsigned char*) data;
+	bool sliced = k != CHECKSUM_KERNEL_TABLE;
+
+	switch (kind) {
+	case CHECKSUM_CRC16:
+		return sliced ? reflected_slice8(crc16_table, 0xffff, p, size) : reflected_table(crc16_table, 0xffff, p, size);
+	case CHECKSUM_CRC16_CCITT:
+		return sliced ? ccitt_slice8(0xffff, p, size) : ccitt_bytes(0xffff, p, size);
+	case CHECKSUM_CRC32: {
+		uint32_t crc = 0xffffffff;
+#ifdef HAVE_X86_CHECKSUM
+		if (k == CHECKSUM_KERNEL_PCLMUL && size >= 64) {
+			size_t folded = size & ~(size_t) 15;
+			crc = crc32_pclmul(crc, p, folded);
+			p += folded;
+			size -= folded;
+		}
+#endif
+		crc = sliced ? reflected_slice8(crc32_table, crc, p, size) : reflected_table(crc32_table, crc, p, size);
+		return ~crc;
+	}
+	case CHECKSUM_LRC: {
+		unsigned char sum = 0;
+		for (size_t i = 0; i < size; ++i) sum += p[i];
+		return (unsigned char) -sum;
+	}
+	default:
+		print_debug("Invalid checksum", 0);
+		return -E_INVALID_SETTINGS;
+	}
+}
+
+int serial_checksum_size(int kind)
+{
+	switch (kind) {
+	case CHECKSUM_CRC16: return 2;
+	case CHECKSUM_CRC16_CCITT: return 2;
+	case CHECKSUM_CRC32: return 4;
+	case CHECKSUM_LRC: return 1;
+	default: return -E_INVALID_SETTINGS;
+	}
+}
@@ -0,0 +1,171 @@
+/*
+ * Coalescing of non-blocking reads.
+ *
+ * Blocking reads wait for a port's minimum read size or inter-byte timeout
+ * themselves (see 'coalesce' in akka_serial.c). Non-blocking reads, as made by
+ * reactors, cannot wait, hence a coalescer accumulates the data they read
+ * until enough has arrived or the line has been silent for the timeout. On
+ * Linux, a timer file descriptor re-armed while data is held expires at the
+ * end of the timeout, so that reactors can wait for it along with the port.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include "akka_serial.h"
+#include "akka_serial_posix.h"
+
+#ifdef __linux__
+#include <sys/timerfd.h>
+#else
+// suppress unused parameter warnings
+#define UNUSED_ARG(x) (void)(x)
+#endif
+
+struct coalescer {
+	size_t min; // minimum number of bytes taken, 0 if any
+	int64_t timeout; // inter-byte timeout in nanoseconds, 0 if none
+	char* data; // accumulated data, NULL until first used
+	size_t capacity; // size of data
+	size_t count; // number of accumulated bytes
+	int64_t deadline; // time at which the inter-byte timeout expires
+	int timer_fd; // timer expiring at the deadline, -1 until waited for
+};
+
+int coalescer_open(size_t min, unsigned int timeout, struct coalescer** const coalescer)
+{
+	struct coalescer* c = malloc(sizeof(*c));
+	if (c == NULL) {
+		print_debug("Error allocating memory for coalescer", errno);
+		return -E_IO;
+	}
+
+	c->min = min;
+	c->timeout = (int64_t) timeout * 1000000;
+	c->data = NULL;
+	c->capacity = 0;
+	c->count = 0;
+	c->deadline = 0;
+	c->timer_fd = -1;
+
+	*coalescer = c;
+	return 0;
+}
+
+void coalescer_close(struct coalescer* const coalescer)
+{
+	if (coalescer->timer_fd >= 0) {
+		close(coalescer->timer_fd);
+	}
+	free(coalescer->data);
+	free(coalescer);
+}
+
+/* Arms a coalescer's timer to expire at an absolute time, or disarms it if the
+ * time is 0. Setting the timer also clears any expiration not read yet. */
+static void set_timer(struct coalescer* const c, int64_t time)
+{
+#ifdef __linux__
+	if (c->timer_fd < 0) return;
+	struct itimerspec spec;
+	memset(&spec, 0, sizeof(spec));
+	spec.it_value.tv_sec = (time_t) (time / 1000000000);
+	spec.it_value.tv_nsec = (long) (time % 1000000000);
+	if (timerfd_settime(c->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) < 0) {
+		print_debug("Error setting coalescing timer", errno);
+	}
+#else
+	UNUSED_ARG(c);
+	UNUSED_ARG(time);
+#endif
+}
+
+int coalescer_space(struct coalescer* const coalescer, size_t size, char** const data, size_t* const space)
+{
+	if (size > coalescer->capacity) {
+		char* grown = realloc(coalescer->data, size);
+		if (grown == NULL) {
+			print_debug("Error allocating coalescing buffer", errno);
+			return -E_IO;
+		}
+		coalescer->data = grown;
+		coalescer->capacity = size;
+	}
+	*data = coalescer->data + coalescer->count;
+	*space = coalescer->count < size ? size - coalescer->count : 0;
+	return 0;
+}
+
+void coalescer_fill(struct coalescer* const coalescer, size_t size)
+{
+	coalescer->count += size;
+	if (coalescer->timeout > 0 && size > 0) {
+		coalescer->deadline = serial_timestamp() + coalescer->timeout;
+	}
+}
+
+size_t coalescer_buffered(struct coalescer* const coalescer)
+{
+	return coalescer->count;
+}
+
+int coalescer_take(struct coalescer* const coalescer, char* const buffer, size_t size, bool force)
+{
+	struct coalescer* c = coalescer;
+	if (c->count == 0) {
+		coalescer_idle(c);
+		return 0;
+	}
+
+	bool ready = force || c->count >= size || (c->min > 0 && c->count >= c->min)
+		|| (c->timeout > 0 && serial_timestamp() >= c->deadline);
+	if (!ready) {
+		// also clears an expiration that preceded a later read
+		if (c->timeout > 0) set_timer(c, c->deadline);
+		return 0;
+	}
+
+	size_t n = c->count < size ? c->count : size;
+	memcpy(buffer, c->data, n);
+	c->count -= n;
+	memmove(c->data, c->data + n, c->count);
+
+	// data left over by a smaller buffer is taken on the next wake up
+	set_timer(c, c->count > 0 ? 1 : 0);
+	return (int) n;
+}
+
+int coalescer_timer(struct coalescer* const coalescer)
+{
+#ifdef __linux__
+	if (coalescer->timer_fd < 0 && coalescer->timeout > 0) {
+		coalescer->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		if (coalescer->timer_fd < 0) {
+			print_debug("Error creating coalescing timer", errno);
+		}
+	}
+#endif
+	return coalescer->timer_fd;
+}
+
+void coalescer_wake(struct coalescer* const coalescer)
+{
+	// an expiration without data is cleared by the next take
+	set_timer(coalescer, 1);
+}
+
+void coalescer_idle(struct coalescer* const coalescer)
+{
+#ifdef __linux__
+	uint64_t expirations;
+	if (coalescer->timer_fd >= 0 && read(coalescer->timer_fd, &expirations, sizeof(expirations)) < 0
+		&& errno != EAGAIN) {
+		print_debug("Error reading coalescing timer", errno);
+	}
+#else
+	UNUSED_ARG(coalescer);
+#endif
+}
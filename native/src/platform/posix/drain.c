@@ -0,0 +1,76 @@
+/*
+ * Confirmation of transmitted data.
+ *
+ * tcdrain() cannot be used to wait for a port's data to be transmitted: it
+ * blocks uninterruptibly (possibly forever if the remote end stalls with
+ * hardware flow control), and it does not account for data in the port's own
+ * transmit queue. Instead, the queues are polled, sleeping for about as long
+ * as the remaining data takes to be transmitted at the port's baud rate.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include "akka_serial.h"
+#include "akka_serial_posix.h"
+
+// bounds of the time slept between polls, in nanoseconds
+#define DRAIN_POLL_MIN 20000L
+#define DRAIN_POLL_MAX 10000000L
+
+// bits per character assumed when estimating transmission times (start, 8 data, stop bit)
+#define CHAR_BITS 10
+
+int64_t serial_timestamp(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Checks if a UART's shift register is empty, i.e. if the last character has
+ * left the wire. Drivers that cannot tell are assumed to be empty. */
+static bool transmitter_empty(struct serial_config* const serial)
+{
+#ifdef TIOCSERGETLSR
+	int lsr;
+	if (ioctl(serial->port_fd, TIOCSERGETLSR, &lsr) == 0) {
+		return (lsr & TIOCSER_TEMT) != 0;
+	}
+#else
+	(void) serial;
+#endif
+	return true;
+}
+
+int serial_drain(struct serial_config* const serial, int64_t* const timestamp)
+{
+	int baud = serial_get_speed(serial);
+	if (baud <= 0) baud = 9600;
+
+	for (;;) {
+		if (__atomic_load_n(&serial->drain_cancelled, __ATOMIC_ACQUIRE)) {
+			return -E_INTERRUPT;
+		}
+
+		int queued = serial_output_queued(serial);
+		if (queued < 0) return queued;
+
+		if (queued == 0 && transmitter_empty(serial)) {
+			*timestamp = serial_timestamp();
+			return 0;
+		}
+
+		// at least one character is still being shifted out
+		long long remaining = queued > 0 ? queued : 1;
+		long long delay = remaining * CHAR_BITS * 1000000000LL / baud;
+		if (delay < DRAIN_POLL_MIN) delay = DRAIN_POLL_MIN;
+		if (delay > DRAIN_POLL_MAX) delay = DRAIN_POLL_MAX;
+
+		struct timespec ts;
+		ts.tv_sec = 0;
+		ts.tv_nsec = (long) delay;
+		nanosleep(&ts, NULL);
+	}
+}
@@ -0,0 +1,384 @@
+/*
+ * Framing of received data.
+ *
+ * A framer accumulates the data read from a port in a buffer, out of which
+ * whole frames are taken one at a time, so that reads return frames rather
+ * than arbitrary chunks. Data is read into the space at the end of the buffer,
+ * which is compacted before every read.
+ *
+ * Frames separated by silence are ended by the reader, once it has waited for
+ * the gap without receiving data. On Linux, a timer file descriptor re-armed
+ * on every read expires at the end of the gap, so that readers and reactors
+ * can wait for it along with the port.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include "akka_serial.h"
+#include "akka_serial_posix.h"
+
+#ifdef __linux__
+#include <sys/timerfd.h>
+#else
+// suppress unused parameter warnings
+#define UNUSED_ARG(x) (void)(x)
+#endif
+
+// minimum capacity of a framer's buffer, so that small frames are read in bulk
+#define FRAMER_MIN_CAPACITY 4096
+
+struct framer {
+	struct serial_framing framing;
+	char* data; // accumulated data, from start to end
+	size_t capacity; // size of data, at least twice the maximum frame size
+	size_t start; // index of the first accumulated byte
+	size_t end; // index past the last accumulated byte
+	size_t scanned; // number of bytes after start that have been searched for a delimiter
+	bool discarding; // data is discarded up to the next delimiter or gap, after an oversized frame
+
+	// FRAMING_GAP
+	int64_t gap; // silence ending a frame, in nanoseconds
+	int64_t received; // time at which data was last accumulated, see 'serial_timestamp'
+	size_t ended; // size of the accumulated frame that a silence ended, 0 if none
+	int timer_fd; // timer expiring at the end of the gap, -1 if none
+};
+
+static bool valid(const struct serial_framing* const framing)
+{
+	if (framing->max_size == 0 || framing->max_size > INT_MAX) return false;
+	if (framing->checksum != CHECKSUM_NONE && serial_checksum_size(framing->checksum) < 0) return false;
+
+	switch (framing->kind) {
+	case FRAMING_DELIMITER:
+		return framing->delimiter_size > 0 &&
+			framing->delimiter_size <= FRAMING_DELIMITER_MAX &&
+			framing->delimiter_size <= framing->max_size;
+	case FRAMING_LENGTH:
+		switch (framing->length_width) {
+		case 1: case 2: case 4: case 8: break;
+		default: return false;
+		}
+		return framing->length_offset + framing->length_width <= framing->max_size;
+	case FRAMING_FIXED:
+		return true;
+	case FRAMING_GAP:
+		return framing->gap > 0;
+	default:
+		return false;
+	}
+}
+
+int framer_open(const struct serial_framing* const framing, struct framer** const framer)
+{
+	if (!valid(framing)) {
+		print_debug("Invalid framing", 0);
+		return -E_INVALID_SETTINGS;
+	}
+
+	struct framer* f = malloc(sizeof(*f));
+	if (f == NULL) {
+		print_debug("Error allocating framer", 0);
+		return -E_IO;
+	}
+	f->framing = *framing;
+	f->capacity = 2 * framing->max_size < FRAMER_MIN_CAPACITY ? FRAMER_MIN_CAPACITY : 2 * framing->max_size;
+	f->data = malloc(f->capacity);
+	if (f->data == NULL) {
+		print_debug("Error allocating framer buffer", 0);
+		free(f);
+		return -E_IO;
+	}
+	f->start = 0;
+	f->end = 0;
+	f->scanned = 0;
+	f->discarding = false;
+	f->gap = (int64_t) framing->gap * 1000;
+	f->received = 0;
+	f->ended = 0;
+	f->timer_fd = -1;
+
+#ifdef __linux__
+	if (framing->kind == FRAMING_GAP) {
+		f->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		if (f->timer_fd < 0) {
+			print_debug("Error creating gap timer", errno);
+			free(f->data);
+			free(f);
+			return -E_IO;
+		}
+	}
+#endif
+
+	*framer = f;
+	return 0;
+}
+
+void framer_close(struct framer* const framer)
+{
+	if (framer->timer_fd >= 0) {
+		close(framer->timer_fd);
+	}
+	free(framer->data);
+	free(framer);
+}
+
+/* Arms a framer's gap timer to expire after a delay, or disarms it if the
+ * delay is 0. Setting the timer also clears any expiration not read yet. */
+static void set_timer(struct framer* const f, int64_t delay)
+{
+#ifdef __linux__
+	if (f->timer_fd < 0) return;
+	struct itimerspec spec;
+	memset(&spec, 0, sizeof(spec));
+	spec.it_value.tv_sec = (time_t) (delay / 1000000000);
+	spec.it_value.tv_nsec = (long) (delay % 1000000000);
+	if (timerfd_settime(f->timer_fd, 0, &spec, NULL) < 0) {
+		print_debug("Error setting gap timer", errno);
+	}
+#else
+	UNUSED_ARG(f);
+	UNUSED_ARG(delay);
+#endif
+}
+
+/* Drops accumulated data from the start of a framer's buffer. */
+static void discard(struct framer* const f, size_t size)
+{
+	f->start += size;
+	f->scanned = f->scanned > size ? f->scanned - size : 0;
+	if (f->start == f->end) {
+		f->start = 0;
+		f->end = 0;
+	}
+}
+
+/* Searches the accumulated data for a delimiter, resuming where the last
+ * search stopped. A delimiter may straddle the end of the data searched last.
+ * Returns the size of the frame ending with the delimiter, 0 if none. */
+static size_t find_delimiter(struct framer* const f)
+{
+	const char* const delimiter = f->framing.delimiter;
+	const size_t delimiter_size = f->framing.delimiter_size;
+	const char* const data = f->data + f->start;
+	const size_t available = f->end - f->start;
+
+	size_t i = f->scanned >= delimiter_size ? f->scanned - (delimiter_size - 1) : 0;
+	while (i + delimiter_size <= available) {
+		size_t candidates = available - i - (delimiter_size - 1);
+		size_t found = serial_scan(data + i, candidates, delimiter[0], delimiter[0]);
+		if (found == candidates) break;
+		i += found;
+		if (memcmp(data + i, delimiter, delimiter_size) == 0) {
+			return i + delimiter_size;
+		}
+		++i;
+	}
+	f->scanned = available;
+	return 0;
+}
+
+/* Decodes the unsigned length field of a frame. */
+static uint64_t length_field(const struct framer* const f)
+{
+	const unsigned char* field = (const unsigned char*) f->data + f->start + f->framing.length_offset;
+	const size_t width = f->framing.length_width;
+	uint64_t value = 0;
+	for (size_t i = 0; i < width; ++i) {
+		size_t index = f->framing.length_big_endian ? i : width - 1 - i;
+		value = (value << 8) | field[index];
+	}
+	return value;
+}
+
+/* Verifies the checksum at the end of a frame's data, i.e. before any delimiter. */
+static bool checksum_matches(const struct framer* const f, size_t data_size)
+{
+	const struct serial_framing* const framing = &f->framing;
+	const size_t width = (size_t) serial_checksum_size(framing->checksum);
+	if (data_size < framing->checksum_offset + width) return false;
+
+	const char* const data = f->data + f->start;
+	const unsigned char* field = (const unsigned char*) data + data_size - width;
+	uint64_t stored = 0;
+	for (size_t i = 0; i < width; ++i) {
+		size_t index = framing->checksum_big_endian ? i : width - 1 - i;
+		stored = (stored << 8) | field[index];
+	}
+	int64_t computed = serial_checksum(framing->checksum, data + framing->checksum_offset,
+		data_size - width - framing->checksum_offset);
+	return computed >= 0 && (uint64_t) computed == stored;
+}
+
+int framer_take(struct framer* const framer, char* const buffer, size_t size)
+{
+	const struct serial_framing* const framing = &framer->framing;
+
+	for (;;) {
+		size_t available = framer->end - framer->start;
+		size_t frame; // size of the next frame, as accumulated
+
+		if (framing->kind == FRAMING_DELIMITER) {
+			frame = find_delimiter(framer);
+			if (frame == 0) {
+				if (available >= framing->max_size) {
+					// no frame can start before the last bytes, which may be part of a delimiter
+					print_debug("No delimiter within maximum frame size, discarding data", 0);
+					discard(framer, available - (framing->delimiter_size - 1));
+					framer->discarding = true;
+				}
+				return 0;
+			}
+			if (framer->discarding || frame > framing->max_size) {
+				// the rest of an oversized frame
+				discard(framer, frame);
+				framer->discarding = false;
+				continue;
+			}
+		} else if (framing->kind == FRAMING_LENGTH) {
+			size_t header = framing->length_offset + framing->length_width;
+			if (available < header) return 0;
+			uint64_t length = length_field(framer);
+			int64_t total = length > framing->max_size ? -1 :
+				(int64_t) header + (int64_t) length + framing->length_adjustment;
+			if (total < (int64_t) header || total > (int64_t) framing->max_size) {
+				// resynchronize on the next byte
+				print_debug("Invalid frame length, discarding a byte", 0);
+				discard(framer, 1);
+				continue;
+			}
+			if (available < (size_t) total) return 0;
+			frame = (size_t) total;
+		} else if (framing->kind == FRAMING_GAP) {
+			if (framer->ended == 0) {
+				if (available > framing->max_size) {
+					print_debug("No gap within maximum frame size, discarding data", 0);
+					discard(framer, available);
+					framer->discarding = true;
+				}
+				return 0;
+			}
+			frame = framer->ended;
+			framer->ended = 0;
+			if (framer->discarding) {
+				// the rest of an oversized frame
+				discard(framer, frame);
+				framer->discarding = false;
+				continue;
+			}
+		} else {
+			if (available < framing->max_size) return 0;
+			frame = framing->max_size;
+		}
+
+		size_t data_size = frame; // size of the frame without any delimiter
+		if (framing->kind == FRAMING_DELIMITER) {
+			data_size -= framing->delimiter_size;
+		}
+		size_t returned = framing->kind == FRAMING_DELIMITER && framing->strip_delimiter ? data_size : frame;
+		if (returned == 0) {
+			// empty frames are skipped, a read of 0 bytes has a meaning of its own
+			discard(framer, frame);
+			continue;
+		}
+		if (framing->checksum != CHECKSUM_NONE && !checksum_matches(framer, data_size)) {
+			print_debug("Checksum mismatch, discarding frame", 0);
+			discard(framer, frame);
+			continue;
+		}
+		if (returned > size) {
+			print_debug("Buffer is too small for frame, discarding frame", 0);
+			discard(framer, frame);
+			return -E_INVALID_SETTINGS;
+		}
+		memcpy(buffer, framer->data + framer->start, returned);
+		discard(framer, frame);
+		return (int) returned;
+	}
+}
+
+size_t framer_space(struct framer* const framer, char** const data)
+{
+	if (framer->start > 0) {
+		memmove(framer->data, framer->data + framer->start, framer->end - framer->start);
+		framer->end -= framer->start;
+		framer->start = 0;
+	}
+	*data = framer->data + framer->end;
+	return framer->capacity - framer->end;
+}
+
+void framer_fill(struct framer* const framer, size_t size)
+{
+	framer->end += size;
+	if (framer->framing.kind == FRAMING_GAP && size > 0) {
+		framer->received = serial_timestamp();
+		set_timer(framer, framer->gap);
+	}
+}
+
+int framer_timer(struct framer* const framer)
+{
+	return framer->timer_fd;
+}
+
+int64_t framer_gap_remaining(struct framer* const framer)
+{
+	if (framer->framing.kind != FRAMING_GAP || framer->ended > 0) return -1;
+	if (framer->end == framer->start && !framer->discarding) return -1;
+	int64_t remaining = framer->received + framer->gap - serial_timestamp();
+	return remaining > 0 ? remaining : 0;
+}
+
+bool framer_end_gap(struct framer* const framer)
+{
+	if (framer_gap_remaining(framer) != 0) return false;
+	set_timer(framer, 0);
+	framer->ended = framer->end - framer->start;
+	if (framer->ended == 0) {
+		// all data of the frame was discarded
+		framer->discarding = false;
+	}
+	return true;
+}
+
+size_t framer_buffered(struct framer* const framer)
+{
+	return framer->end - framer->start;
+}
+
+/* Derives the gap that ends frames from a port's character time, as Modbus RTU does. */
+static int default_gap(struct serial_config* const serial)
+{
+	int baud = serial_get_speed(serial);
+	if (baud < 0) return baud;
+	if (baud > 19200) return 1750;
+
+	int bits = character_bits(serial);
+	if (bits < 0) return bits;
+	return (int) ((int64_t) bits * 3500000 / baud) + 1;
+}
+
+int serial_set_framing(struct serial_config* const serial, const struct serial_framing* const framing)
+{
+	struct framer* framer = NULL;
+	if (framing != NULL && framing->kind != FRAMING_NONE) {
+		struct serial_framing applied = *framing;
+		if (applied.kind == FRAMING_GAP && applied.gap == 0) {
+			int gap = default_gap(serial);
+			if (gap < 0) return gap;
+			applied.gap = (unsigned int) gap;
+		}
+		int r = framer_open(&applied, &framer);
+		if (r < 0) return r;
+	}
+	if (serial->framer != NULL) {
+		framer_close(serial->framer);
+	}
+	serial->framer = framer;
+	return 0;
+}
@@ -0,0 +1,152 @@
+/*
+ * Low-latency tuning of serial ports.
+ *
+ * Drivers of USB serial adapters usually buffer received data before passing
+ * it on, trading latency for fewer transfers. Two knobs are available on Linux:
+ * the ASYNC_LOW_LATENCY flag of the driver and, for adapters such as FTDI's,
+ * a latency timer exposed through sysfs.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include "akka_serial.h"
+#include "akka_serial_posix.h"
+
+// value of the latency timer in low-latency mode, in milliseconds
+#define LATENCY_TIMER_LOW 1
+
+char sysfs_root[SYSFS_ROOT_MAX] = "/sys";
+
+int serial_sysfs_root(const char* const root)
+{
+	if (strlen(root) >= SYSFS_ROOT_MAX) {
+		print_debug("Sysfs root is too long", 0);
+		return -E_INVALID_SETTINGS;
+	}
+	strcpy(sysfs_root, root);
+	return 0;
+}
+
+#ifdef __linux__
+
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+
+/* Gets the path of the latency timer attribute of the adapter behind a port,
+ * derived from the name of the port's device (e.g. ttyUSB0). */
+static int latency_timer_path(struct serial_config* const serial, char* const path, size_t size)
+{
+	char device[SYSFS_ROOT_MAX];
+	if (ttyname_r(serial->port_fd, device, sizeof(device)) != 0) {
+		print_debug("Error retrieving name of port", errno);
+		return -E_IO;
+	}
+
+	const char* name = strrchr(device, '/');
+	name = name == NULL ? device : name + 1;
+
+	if (snprintf(path, size, "%s/class/tty/%s/device/latency_timer", sysfs_root, name) >= (int) size) {
+		print_debug("Path of latency timer is too long", 0);
+		return -E_IO;
+	}
+	return 0;
+}
+
+int serial_get_latency_timer(struct serial_config* const serial)
+{
+	char path[2 * SYSFS_ROOT_MAX];
+	int r = latency_timer_path(serial, path, sizeof(path));
+	if (r < 0) return r;
+
+	FILE* file = fopen(path, "r");
+	if (file == NULL) return -E_UNSUPPORTED; // not an adapter with a latency timer
+
+	int value;
+	r = fscanf(file, "%d", &value);
+	fclose(file);
+	if (r != 1) {
+		print_debug("Error parsing latency timer", 0);
+		return -E_IO;
+	}
+	return value;
+}
+
+/* Sets the latency timer of the adapter behind a port, if it has one and it
+ * is writable by the current user. Returns 1 if the timer now has the value, 0
+ * if it could not be set, or a negative error if writing it failed. */
+static int set_latency_timer(struct serial_config* const serial, int value)
+{
+	char path[2 * SYSFS_ROOT_MAX];
+	int r = latency_timer_path(serial, path, sizeof(path));
+	if (r < 0) return r;
+
+	int fd = open(path, O_WRONLY | O_TRUNC); // truncation is ignored by sysfs
+	if (fd < 0) {
+		print_debug("Latency timer is not available", errno);
+		return 0;
+	}
+
+	char data[16];
+	int length = snprintf(data, sizeof(data), "%d", value);
+	bool written = write(fd, data, length) == length;
+	if (!written) print_debug("Error writing latency timer", errno);
+	close(fd);
+	if (!written) return -E_IO;
+
+	// drivers may round the value to one they support
+	r = serial_get_latency_timer(serial);
+	if (r == -E_UNSUPPORTED) return 0;
+	if (r < 0) return r;
+	return r == value;
+}
+
+int serial_set_low_latency(struct serial_config* const serial)
+{
+	int applied = 0;
+
+	// not supported by all drivers, e.g. by pseudo terminals
+	struct serial_struct ss;
+	if (ioctl(serial->port_fd, TIOCGSERIAL, &ss) == 0) {
+		ss.flags |= ASYNC_LOW_LATENCY;
+		if (ioctl(serial->port_fd, TIOCSSERIAL, &ss) < 0) {
+			print_debug("Error setting low latency flag", errno);
+			if (errno != EPERM && errno != EINVAL && errno != ENOTTY) return -E_IO;
+		} else if (ioctl(serial->port_fd, TIOCGSERIAL, &ss) < 0) {
+			print_debug("Error getting low latency flag", errno);
+			return -E_IO;
+		} else if (ss.flags & ASYNC_LOW_LATENCY) {
+			// drivers that do not support the flag may drop it silently
+			applied |= LOW_LATENCY_ASYNC;
+		}
+	}
+
+	int r = set_latency_timer(serial, LATENCY_TIMER_LOW);
+	if (r < 0) return r;
+	if (r > 0) applied |= LOW_LATENCY_TIMER;
+
+	return applied;
+}
+
+#else /* __linux__ */
+
+// suppress unused parameter warnings
+#define UNUSED_ARG(x) (void)(x)
+
+int serial_get_latency_timer(struct serial_config* const serial)
+{
+	UNUSED_ARG(serial);
+	return -E_UNSUPPORTED;
+}
+
+int serial_set_low_latency(struct serial_config* const serial)
+{
+	UNUSED_ARG(serial);
+	return 0;
+}
+
+#endif /* __linux__ */
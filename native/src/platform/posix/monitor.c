@@ -0,0 +1,641 @@
+/*
+ * Monitoring of devices as they are connected and disconnected.
+ *
+ * On Linux, the kernel announces devices as they are added and removed through
+ * uevents, broadcast on a netlink socket. A uevent is a sequence of
+ * null-terminated "KEY=value" fields, among them ACTION, DEVPATH (the path of
+ * the device in sysfs), SUBSYSTEM and DEVNAME (the name of its node). The
+ * vendor, product and serial number of the USB device behind a tty are not
+ * part of the tty's uevent, they are attributes of one of its parents in
+ * sysfs. As these are gone by the time the tty is removed, a monitor keeps
+ * track of the devices it matched, and only reports those as disconnected.
+ *
+ * The same attributes, along with the driver of a tty, are looked up to
+ * describe ttys on request, such as those of an inventory of ports.
+ */
+#define _XOPEN_SOURCE 700 // realpath
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include "akka_serial.h"
+#include "akka_serial_posix.h"
+
+#ifdef __linux__
+
+#include <limits.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+
+// size of the buffer into which uevents are received, the kernel sends at most 2048 bytes of fields
+#define UEVENT_BUFFER_SIZE 8192
+
+// multicast group of the kernel's uevents, as opposed to those rebroadcast by udev
+#define UEVENT_GROUP_KERNEL 1
+
+/** A device matched by a monitor. */
+struct device {
+	char devpath[DEVICE_PATH_MAX]; // path of the device in sysfs, relative to its root
+	char path[DEVICE_PATH_MAX]; // path of the device's node
+	bool pending; // set until the device has been reported as connected
+};
+
+struct serial_monitor {
+	int source_fd; // file descriptor of netlink socket or of injected source
+	bool netlink; // set if the source is the kernel, which sends one uevent per datagram
+
+	/* as with serial ports, a pipe is used to abort a wait by writing
+	 * something into its write end */
+	int pipe_read_fd; // file descriptor, read end of pipe
+	int pipe_write_fd; // file descriptor, write end of pipe
+
+	char directory[DEVICE_PATH_MAX]; // directory of device nodes
+	struct serial_device_filter* filters;
+	size_t filter_count;
+
+	struct device* devices; // devices matched and not yet disconnected
+	size_t device_count;
+	size_t device_capacity;
+
+	/* uevents read from an injected source are delimited by empty fields,
+	 * and may be split across reads */
+	char buffer[UEVENT_BUFFER_SIZE];
+	size_t buffered; // number of bytes in buffer
+	size_t consumed; // number of bytes of buffer already parsed
+	bool ended; // the source has been read to its end
+};
+
+/** Fields of a uevent that are relevant to monitors, NULL if absent. */
+struct uevent {
+	const char* action;
+	const char* devpath;
+	const char* subsystem;
+	const char* devname;
+};
+
+/* Parses the fields of a uevent, which point into its data. */
+static void parse_uevent(const char* data, size_t size, struct uevent* const event)
+{
+	memset(event, 0, sizeof(*event));
+	const char* end = data + size;
+	while (data < end) {
+		size_t length = strnlen(data, end - data);
+		if (strncmp(data, "ACTION=", 7) == 0) event->action = data + 7;
+		else if (strncmp(data, "DEVPATH=", 8) == 0) event->devpath = data + 8;
+		else if (strncmp(data, "SUBSYSTEM=", 10) == 0) event->subsystem = data + 10;
+		else if (strncmp(data, "DEVNAME=", 8) == 0) event->devname = data + 8;
+		data += length + 1;
+	}
+}
+
+/* Reads an attribute of a device from sysfs, without its trailing newline. */
+static bool read_attribute(const char* const dir, const char* const name, char* const value, size_t size)
+{
+	char path[2 * SYSFS_ROOT_MAX + DEVICE_PATH_MAX];
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	FILE* file = fopen(path, "r");
+	if (file == NULL) return false;
+
+	bool read = fgets(value, (int) size, file) != NULL;
+	fclose(file);
+	if (read) value[strcspn(value, "\n")] = '\0';
+	return read;
+}
+
+/** Attributes of the USB device behind a device, ids are -1 if there is none. */
+struct usb_device {
+	int vendor;
+	int product;
+	char serial[DEVICE_SERIAL_MAX];
+	char dir[2 * SYSFS_ROOT_MAX + DEVICE_PATH_MAX]; // directory of the USB device, empty if there is none
+};
+
+/* Looks up the USB device behind a device, the closest of its parents in sysfs
+ * that has a vendor id. */
+static void find_usb_device(const char* const devpath, struct usb_device* const usb)
+{
+	usb->vendor = -1;
+	usb->product = -1;
+	usb->serial[0] = '\0';
+	usb->dir[0] = '\0';
+
+	char dir[2 * SYSFS_ROOT_MAX + DEVICE_PATH_MAX];
+	size_t root = strlen(sysfs_root);
+	snprintf(dir, sizeof(dir), "%s%s", sysfs_root, devpath);
+
+	char value[DEVICE_SERIAL_MAX];
+	while (strlen(dir) > root) {
+		if (read_attribute(dir, "idVendor", value, sizeof(value))) {
+			usb->vendor = (int) strtol(value, NULL, 16);
+			if (read_attribute(dir, "idProduct", value, sizeof(value))) {
+				usb->product = (int) strtol(value, NULL, 16);
+			}
+			read_attribute(dir, "serial", usb->serial, sizeof(usb->serial));
+			strcpy(usb->dir, dir);
+			return;
+		}
+		*strrchr(dir, '/') = '\0';
+	}
+}
+
+/* Checks if a device matches any of a monitor's filters. Attributes of USB
+ * devices are only looked up if a filter needs them. */
+static bool matches(struct serial_monitor* const monitor, const char* subsystem, const char* name, const char* devpath)
+{
+	if (monitor->filter_count == 0) return true;
+
+	struct usb_device usb;
+	bool found = false;
+	for (size_t i = 0; i < monitor->filter_count; ++i) {
+		const struct serial_device_filter* filter = &monitor->filters[i];
+		if (filter->subsystem[0] != '\0' && strcmp(filter->subsystem, subsystem) != 0) continue;
+		if (filter->name[0] != '\0' && fnmatch(filter->name, name, 0) != 0) continue;
+
+		if (filter->vendor >= 0 || filter->product >= 0 || filter->serial[0] != '\0') {
+			if (!found) {
+				find_usb_device(devpath, &usb);
+				found = true;
+			}
+			if (filter->vendor >= 0 && filter->vendor != usb.vendor) continue;
+			if (filter->product >= 0 && filter->product != usb.product) continue;
+			if (filter->serial[0] != '\0' && strcmp(filter->serial, usb.serial) != 0) continue;
+		}
+		return true;
+	}
+	return false;
+}
+
+/* Finds a tracked device, returns the number of devices if there is none. */
+static size_t find_device(struct serial_monitor* const monitor, const char* const devpath)
+{
+	size_t i = 0;
+	while (i < monitor->device_count && strcmp(monitor->devices[i].devpath, devpath) != 0) ++i;
+	return i;
+}
+
+/* Tracks a matched device, unless it already is. */
+static int add_device(struct serial_monitor* const monitor, const char* devpath, const char* name, bool pending)
+{
+	if (find_device(monitor, devpath) < monitor->device_count) return 0;
+
+	struct device device;
+	device.pending = pending;
+	if (snprintf(device.devpath, sizeof(device.devpath), "%s", devpath) >= (int) sizeof(device.devpath) ||
+		snprintf(device.path, sizeof(device.path), "%s/%s", monitor->directory, name) >= (int) sizeof(device.path)) {
+		print_debug("Path of device is too long", 0);
+		return 0;
+	}
+
+	if (monitor->device_count == monitor->device_capacity) {
+		size_t capacity = monitor->device_capacity == 0 ? 16 : 2 * monitor->device_capacity;
+		struct device* devices = realloc(monitor->devices, capacity * sizeof(*devices));
+		if (devices == NULL) {
+			print_debug("Error allocating memory for devices", errno);
+			return -E_IO;
+		}
+		monitor->devices = devices;
+		monitor->device_capacity = capacity;
+	}
+	monitor->devices[monitor->device_count++] = device;
+	return 0;
+}
+
+/* Gets the name of a device's node from its uevent attribute in sysfs. */
+static bool read_devname(const char* const dir, char* const name, size_t size)
+{
+	char path[2 * SYSFS_ROOT_MAX + DEVICE_PATH_MAX];
+	snprintf(path, sizeof(path), "%s/uevent", dir);
+	FILE* file = fopen(path, "r");
+	if (file == NULL) return false;
+
+	char line[DEVICE_PATH_MAX];
+	bool found = false;
+	while (!found && fgets(line, sizeof(line), file) != NULL) {
+		if (strncmp(line, "DEVNAME=", 8) == 0) {
+			line[strcspn(line, "\n")] = '\0';
+			found = snprintf(name, size, "%s", line + 8) < (int) size;
+		}
+	}
+	fclose(file);
+	return found;
+}
+
+/* Gets the last component of the name of a device's node. */
+static const char* base_name(const char* const devname)
+{
+	const char* name = strrchr(devname, '/');
+	return name == NULL ? devname : name + 1;
+}
+
+/* Tracks the devices of a class that are present, as found in sysfs. */
+static int enumerate(struct serial_monitor* const monitor, const char* const subsystem, bool initial)
+{
+	char class[SYSFS_ROOT_MAX + DEVICE_SUBSYSTEM_MAX + 8];
+	snprintf(class, sizeof(class), "%s/class/%s", sysfs_root, subsystem);
+	DIR* dir = opendir(class);
+	if (dir == NULL) return 0; // not a class, its devices are only known once added
+
+	char root[PATH_MAX];
+	if (realpath(sysfs_root, root) == NULL) root[0] = '\0';
+	size_t root_length = strlen(root);
+
+	int r = 0;
+	struct dirent* entry;
+	while (r == 0 && (entry = readdir(dir)) != NULL) {
+		if (entry->d_name[0] == '.') continue;
+
+		// only devices with a node are reported
+		char path[2 * SYSFS_ROOT_MAX + DEVICE_PATH_MAX];
+		char devname[DEVICE_PATH_MAX];
+		snprintf(path, sizeof(path), "%s/%s", class, entry->d_name);
+		if (!read_devname(path, devname, sizeof(devname))) continue;
+
+		// entries of classes are links to the devices, whose uevents refer to the latter
+		char real[PATH_MAX];
+		const char* devpath = path + strlen(sysfs_root);
+		if (root_length > 0 && realpath(path, real) != NULL && strncmp(real, root, root_length) == 0) {
+			devpath = real + root_length;
+		}
+
+		if (matches(monitor, subsystem, base_name(devname), devpath)) {
+			r = add_device(monitor, devpath, devname, initial);
+		}
+	}
+	closedir(dir);
+	return r;
+}
+
+/* Waits until the source or the pipe of a monitor is readable. */
+static int await_source(struct serial_monitor* const monitor)
+{
+	struct pollfd polls[2];
+	polls[0].fd = monitor->source_fd;
+	polls[0].events = POLLIN;
+	polls[1].fd = monitor->pipe_read_fd;
+	polls[1].events = POLLIN;
+
+	int n;
+	do {
+		n = poll(polls, 2, -1);
+	} while (n < 0 && errno == EINTR);
+
+	if (n < 0) {
+		print_debug("Error waiting on monitor", errno);
+		return -E_IO;
+	}
+	if (polls[1].revents & POLLIN) return -E_INTERRUPT;
+	return 0;
+}
+
+/* Receives the next uevent from the kernel. */
+static int receive_uevent(struct serial_monitor* const monitor, char** const data, size_t* const size)
+{
+	for (;;) {
+		int r = await_source(monitor);
+		if (r < 0) return r;
+
+		struct sockaddr_nl sender;
+		socklen_t length = sizeof(sender);
+		ssize_t n = recvfrom(monitor->source_fd, monitor->buffer, sizeof(monitor->buffer) - 1, 0,
+			(struct sockaddr*) &sender, &length);
+		if (n < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) continue;
+			if (errno == ENOBUFS) { // uevents were dropped since the socket's buffer was full
+				print_debug("Lost uevents", errno);
+				continue;
+			}
+			print_debug("Error receiving uevent", errno);
+			return -E_IO;
+		}
+		if (sender.nl_pid != 0) continue; // not sent by the kernel
+
+		monitor->buffer[n] = '\0';
+		*data = monitor->buffer;
+		*size = (size_t) n;
+		return 1;
+	}
+}
+
+/* Reads the next uevent from an injected source. */
+static int read_uevent(struct serial_monitor* const monitor, char** const data, size_t* const size)
+{
+	for (;;) {
+		// a uevent ends with an empty field, i.e. two consecutive null characters
+		for (size_t i = monitor->consumed + 1; i < monitor->buffered; ++i) {
+			if (monitor->buffer[i] == '\0' && monitor->buffer[i - 1] == '\0') {
+				*data = monitor->buffer + monitor->consumed;
+				*size = i - monitor->consumed;
+				monitor->consumed = i + 1;
+				return 1;
+			}
+		}
+		if (monitor->ended) return 0;
+
+		memmove(monitor->buffer, monitor->buffer + monitor->consumed, monitor->buffered - monitor->consumed);
+		monitor->buffered -= monitor->consumed;
+		monitor->consumed = 0;
+		if (monitor->buffered == sizeof(monitor->buffer)) {
+			print_debug("Uevent is too large", 0);
+			monitor->buffered = 0;
+		}
+
+		int r = await_source(monitor);
+		if (r < 0) return r;
+
+		ssize_t n = read(monitor->source_fd, monitor->buffer + monitor->buffered, sizeof(monitor->buffer) - monitor->buffered);
+		if (n < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) continue;
+			print_debug("Error reading uevent", errno);
+			return -E_IO;
+		}
+		if (n == 0) monitor->ended = true; // an incomplete last uevent is dropped
+		monitor->buffered += (size_t) n;
+	}
+}
+
+int serial_monitor_open(
+	const char* const source,
+	const char* const directory,
+	const struct serial_device_filter* const filters,
+	size_t count,
+	bool initial,
+	struct serial_monitor** const monitor)
+{
+	if (strlen(directory) >= DEVICE_PATH_MAX) {
+		print_debug("Directory of devices is too long", 0);
+		return -E_INVALID_SETTINGS;
+	}
+
+	struct serial_monitor* m = calloc(1, sizeof(*m));
+	if (m == NULL) {
+		print_debug("Error allocating memory for monitor", errno);
+		return -E_IO;
+	}
+	strcpy(m->directory, directory);
+	m->source_fd = -1;
+	m->pipe_read_fd = -1;
+	m->pipe_write_fd = -1;
+
+	int r = -E_IO;
+	if (count > 0) {
+		m->filters = malloc(count * sizeof(*filters));
+		if (m->filters == NULL) {
+			print_debug("Error allocating memory for filters", errno);
+			goto fail;
+		}
+		memcpy(m->filters, filters, count * sizeof(*filters));
+		m->filter_count = count;
+	}
+
+	int pipe_fd[2];
+	if (pipe(pipe_fd) < 0) {
+		print_debug("Error opening pipe", errno);
+		goto fail;
+	}
+	m->pipe_read_fd = pipe_fd[0];
+	m->pipe_write_fd = pipe_fd[1];
+	if (fcntl(pipe_fd[0], F_SETFL, O_NONBLOCK) < 0 || fcntl(pipe_fd[1], F_SETFL, O_NONBLOCK) < 0) {
+		print_debug("Error setting pipe to non-blocking", errno);
+		goto fail;
+	}
+
+	// the source is opened before enumerating devices, so that none are missed in between
+	if (source == NULL) {
+		m->netlink = true;
+		m->source_fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+		if (m->source_fd < 0) {
+			print_debug("Error opening uevent socket", errno);
+			if (errno == EAFNOSUPPORT || errno == EPROTONOSUPPORT) r = -E_UNSUPPORTED;
+			goto fail;
+		}
+		struct sockaddr_nl address;
+		memset(&address, 0, sizeof(address));
+		address.nl_family = AF_NETLINK;
+		address.nl_groups = UEVENT_GROUP_KERNEL;
+		if (bind(m->source_fd, (struct sockaddr*) &address, sizeof(address)) < 0) {
+			print_debug("Error binding uevent socket", errno);
+			goto fail;
+		}
+	} else {
+		m->source_fd = open(source, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+		if (m->source_fd < 0) {
+			print_debug("Error opening source of uevents", errno);
+			goto fail;
+		}
+	}
+
+	// each class named by a filter is enumerated once, that of ttys for filters naming none
+	bool tty = count == 0;
+	for (size_t i = 0; i < count; ++i) {
+		const char* subsystem = filters[i].subsystem;
+		if (subsystem[0] == '\0' || strcmp(subsystem, "tty") == 0) {
+			tty = true;
+			continue;
+		}
+		size_t j = 0;
+		while (j < i && strcmp(filters[j].subsystem, subsystem) != 0) ++j;
+		if (j == i && (r = enumerate(m, subsystem, initial)) < 0) goto fail;
+	}
+	if (tty && (r = enumerate(m, "tty", initial)) < 0) goto fail;
+
+	(*monitor) = m;
+	return 0;
+
+fail:
+	serial_monitor_close(m);
+	return r;
+}
+
+int serial_monitor_close(struct serial_monitor* const monitor)
+{
+	int r = 0;
+	if (monitor->source_fd >= 0 && close(monitor->source_fd) < 0) {
+		print_debug("Error closing source of uevents", errno);
+		r = -E_IO;
+	}
+	if (monitor->pipe_write_fd >= 0) close(monitor->pipe_write_fd);
+	if (monitor->pipe_read_fd >= 0) close(monitor->pipe_read_fd);
+
+	free(monitor->filters);
+	free(monitor->devices);
+	free(monitor);
+	return r;
+}
+
+int serial_monitor_next(struct serial_monitor* const monitor, struct serial_device_event* const event)
+{
+	// devices present when the monitor was opened are reported first
+	for (size_t i = 0; i < monitor->device_count; ++i) {
+		struct device* device = &monitor->devices[i];
+		if (device->pending) {
+			device->pending = false;
+			event->action = DEVICE_CONNECTED;
+			strcpy(event->path, device->path);
+			return 1;
+		}
+	}
+
+	for (;;) {
+		char* data;
+		size_t size;
+		int r = monitor->netlink ? receive_uevent(monitor, &data, &size) : read_uevent(monitor, &data, &size);
+		if (r <= 0) return r;
+
+		struct uevent uevent;
+		parse_uevent(data, size, &uevent);
+		if (uevent.action == NULL || uevent.devpath == NULL || uevent.devname == NULL) continue;
+
+		if (strcmp(uevent.action, "add") == 0) {
+			if (find_device(monitor, uevent.devpath) < monitor->device_count) continue;
+			const char* subsystem = uevent.subsystem == NULL ? "" : uevent.subsystem;
+			if (!matches(monitor, subsystem, base_name(uevent.devname), uevent.devpath)) continue;
+
+			size_t count = monitor->device_count;
+			r = add_device(monitor, uevent.devpath, uevent.devname, false);
+			if (r < 0) return r;
+			if (monitor->device_count == count) continue; // path too long
+
+			event->action = DEVICE_CONNECTED;
+			strcpy(event->path, monitor->devices[count].path);
+			return 1;
+		}
+
+		if (strcmp(uevent.action, "remove") == 0) {
+			size_t i = find_device(monitor, uevent.devpath);
+			if (i == monitor->device_count) continue;
+
+			event->action = DEVICE_DISCONNECTED;
+			strcpy(event->path, monitor->devices[i].path);
+			monitor->devices[i] = monitor->devices[--monitor->device_count];
+			return 1;
+		}
+	}
+}
+
+size_t serial_monitor_pending(struct serial_monitor* const monitor)
+{
+	size_t pending = 0;
+	for (size_t i = 0; i < monitor->device_count; ++i) {
+		if (monitor->devices[i].pending) ++pending;
+	}
+	return pending;
+}
+
+int serial_monitor_cancel(struct serial_monitor* const monitor)
+{
+	int data = 0;
+
+	//write to pipe to wake up any waiting thread (self-pipe trick)
+	if (write(monitor->pipe_write_fd, &data, 1) < 0) {
+		print_debug("Error writing to pipe during monitor cancel", errno);
+		return -E_IO;
+	}
+
+	return 0;
+}
+
+int serial_device_info(const char* const name, struct serial_device_info* const info)
+{
+	memset(info, 0, sizeof(*info));
+	info->vendor = -1;
+	info->product = -1;
+
+	char entry[SYSFS_ROOT_MAX + DEVICE_NAME_MAX + 16];
+	if (name[0] == '\0' || strchr(name, '/') != NULL ||
+		snprintf(entry, sizeof(entry), "%s/class/tty/%s", sysfs_root, name) >= (int) sizeof(entry)) {
+		return -E_NO_PORT;
+	}
+
+	// entries of classes are links to the devices, as in 'enumerate'
+	char root[PATH_MAX], real[PATH_MAX];
+	if (realpath(sysfs_root, root) == NULL || realpath(entry, real) == NULL) return -E_NO_PORT;
+	size_t root_length = strcmp(root, "/") == 0 ? 0 : strlen(root);
+	if (strncmp(real, root, root_length) != 0 || real[root_length] != '/' ||
+		snprintf(info->devpath, sizeof(info->devpath), "%s", real + root_length) >= (int) sizeof(info->devpath)) {
+		print_debug("Device of tty is outside of sysfs root", 0);
+		return -E_NO_PORT;
+	}
+
+	// the driver is that of the tty's parent device, e.g. the port of a USB serial adapter
+	char link[sizeof(entry) + 16], target[PATH_MAX];
+	snprintf(link, sizeof(link), "%s/device/driver", entry);
+	ssize_t n = readlink(link, target, sizeof(target) - 1);
+	if (n > 0) {
+		target[n] = '\0';
+		snprintf(info->driver, sizeof(info->driver), "%s", base_name(target));
+	}
+
+	struct usb_device usb;
+	find_usb_device(info->devpath, &usb);
+	info->vendor = usb.vendor;
+	info->product = usb.product;
+	strcpy(info->serial, usb.serial);
+	if (usb.dir[0] != '\0') {
+		read_attribute(usb.dir, "manufacturer", info->manufacturer, sizeof(info->manufacturer));
+		read_attribute(usb.dir, "product", info->description, sizeof(info->description));
+	}
+	return 0;
+}
+
+#else /* __linux__ */
+
+// suppress unused parameter warnings
+#define UNUSED_ARG(x) (void)(x)
+
+int serial_monitor_open(
+	const char* const source,
+	const char* const directory,
+	const struct serial_device_filter* const filters,
+	size_t count,
+	bool initial,
+	struct serial_monitor** const monitor)
+{
+	UNUSED_ARG(source);
+	UNUSED_ARG(directory);
+	UNUSED_ARG(filters);
+	UNUSED_ARG(count);
+	UNUSED_ARG(initial);
+	UNUSED_ARG(monitor);
+	print_debug("Monitors are only supported on Linux", 0);
+	return -E_UNSUPPORTED;
+}
+
+int serial_monitor_close(struct serial_monitor* const monitor)
+{
+	UNUSED_ARG(monitor);
+	return -E_UNSUPPORTED;
+}
+
+int serial_monitor_next(struct serial_monitor* const monitor, struct serial_device_event* const event)
+{
+	UNUSED_ARG(monitor);
+	UNUSED_ARG(event);
+	return -E_UNSUPPORTED;
+}
+
+size_t serial_monitor_pending(struct serial_monitor* const monitor)
+{
+	UNUSED_ARG(monitor);
+	return 0;
+}
+
+int serial_monitor_cancel(struct serial_monitor* const monitor)
+{
+	UNUSED_ARG(monitor);
+	return -E_UNSUPPORTED;
+}
+
+int serial_device_info(const char* const name, struct serial_device_info* const info)
+{
+	UNUSED_ARG(name);
+	UNUSED_ARG(info);
+	return -E_UNSUPPORTED;
+}
+
+#endif /* __linux__ */
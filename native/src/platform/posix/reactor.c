@@ -0,0 +1,277 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include "akka_serial.h"
+#include "akka_serial_posix.h"
+
+#ifdef __linux__
+
+#include <sys/epoll.h>
+
+// maximum number of events retrieved per call to epoll_wait
+#define MAX_EVENTS 256
+
+// token reserved for the cancellation pipe, never reported to callers
+#define TOKEN_CANCEL 0
+
+struct serial_reactor {
+	int epoll_fd; // file descriptor of epoll instance
+
+	/* as with serial ports, a pipe is used to abort a wait by writing
+	 * something into its write end */
+	int pipe_read_fd; // file descriptor, read end of pipe
+	int pipe_write_fd; // file descriptor, write end of pipe
+};
+
+int serial_reactor_open(struct serial_reactor** const reactor)
+{
+	int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (epoll_fd < 0) {
+		print_debug("Error creating epoll instance", errno);
+		return -E_IO;
+	}
+
+	int pipe_fd[2];
+	if (pipe(pipe_fd) < 0) {
+		print_debug("Error opening pipe", errno);
+		close(epoll_fd);
+		return -E_IO;
+	}
+
+	if (fcntl(pipe_fd[0], F_SETFL, O_NONBLOCK) < 0 || fcntl(pipe_fd[1], F_SETFL, O_NONBLOCK) < 0) {
+		print_debug("Error setting pipe to non-blocking", errno);
+		goto fail;
+	}
+
+	/* the cancellation pipe is registered under a reserved token, which
+	 * is distinguished by the event's fd instead */
+	struct epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.u64 = TOKEN_CANCEL;
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipe_fd[0], &ev) < 0) {
+		print_debug("Error registering pipe with epoll", errno);
+		goto fail;
+	}
+
+	struct serial_reactor* r = malloc(sizeof(*r));
+	if (r == NULL) {
+		print_debug("Error allocating memory for reactor", errno);
+		goto fail;
+	}
+
+	r->epoll_fd = epoll_fd;
+	r->pipe_read_fd = pipe_fd[0];
+	r->pipe_write_fd = pipe_fd[1];
+	(*reactor) = r;
+
+	return 0;
+
+fail:
+	close(epoll_fd);
+	close(pipe_fd[0]);
+	close(pipe_fd[1]);
+	return -E_IO;
+}
+
+int serial_reactor_close(struct serial_reactor* const reactor)
+{
+	if (close(reactor->pipe_write_fd) < 0) {
+		print_debug("Error closing write end of pipe", errno);
+		return -E_IO;
+	}
+	if (close(reactor->pipe_read_fd) < 0) {
+		print_debug("Error closing read end of pipe", errno);
+		return -E_IO;
+	}
+	if (close(reactor->epoll_fd) < 0) {
+		print_debug("Error closing epoll instance", errno);
+		return -E_IO;
+	}
+
+	free(reactor);
+	return 0;
+}
+
+/* Gets the events a reactor waits for on a port. Errors and hang ups are
+ * always reported by epoll, even while reading is suspended. */
+static uint32_t interest(struct serial_config* const serial, bool writable)
+{
+	uint32_t events = serial->read_suspended ? 0 : EPOLLIN;
+	if (writable) events |= EPOLLOUT;
+	return events;
+}
+
+int serial_reactor_register(struct serial_reactor* const reactor, struct serial_config* const serial, int64_t token)
+{
+	struct epoll_event ev;
+	ev.data.u64 = (uint64_t) token;
+
+	// queued data is drained by the reactor once the port is registered
+	pthread_mutex_lock(&serial->tx_lock);
+	ev.events = interest(serial, tx_pending(serial));
+
+	if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, serial->port_fd, &ev) < 0) {
+		pthread_mutex_unlock(&serial->tx_lock);
+		print_debug("Error registering port with reactor", errno);
+		return -E_IO;
+	}
+	serial->reactor = reactor;
+	serial->token = token;
+	pthread_mutex_unlock(&serial->tx_lock);
+
+	// a port with gap framing is also reported once a gap has elapsed, under the same token
+	int timer_fd = serial->framer == NULL ? -1 : framer_timer(serial->framer);
+	if (timer_fd >= 0) {
+		ev.events = EPOLLIN;
+		if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev) < 0) {
+			print_debug("Error registering gap timer with reactor", errno);
+			serial_reactor_unregister(reactor, serial);
+			return -E_IO;
+		}
+	}
+
+	// as is a port with coalesced reads once the inter-byte timeout has expired
+	timer_fd = serial->coalescer == NULL ? -1 : coalescer_timer(serial->coalescer);
+	if (timer_fd >= 0) {
+		ev.events = EPOLLIN;
+		if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev) < 0) {
+			print_debug("Error registering coalescing timer with reactor", errno);
+			serial_reactor_unregister(reactor, serial);
+			return -E_IO;
+		}
+	}
+	return 0;
+}
+
+int serial_reactor_unregister(struct serial_reactor* const reactor, struct serial_config* const serial)
+{
+	pthread_mutex_lock(&serial->tx_lock);
+	serial->reactor = NULL;
+	pthread_mutex_unlock(&serial->tx_lock);
+
+	// timers are closed along with the port, which removes them from epoll regardless
+	int timer_fd = serial->framer == NULL ? -1 : framer_timer(serial->framer);
+	if (timer_fd >= 0) {
+		epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, timer_fd, NULL);
+	}
+	timer_fd = serial->coalescer == NULL ? -1 : coalescer_timer(serial->coalescer);
+	if (timer_fd >= 0) {
+		epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, timer_fd, NULL);
+	}
+
+	if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, serial->port_fd, NULL) < 0) {
+		print_debug("Error removing port from reactor", errno);
+		return -E_IO;
+	}
+	return 0;
+}
+
+// must be called with the port's transmit queue locked
+void reactor_watch_writable(struct serial_config* const serial, bool writable)
+{
+	struct serial_reactor* reactor = serial->reactor;
+	if (reactor == NULL) return;
+
+	struct epoll_event ev;
+	ev.events = interest(serial, writable);
+	ev.data.u64 = (uint64_t) serial->token;
+
+	// may fail if the port has concurrently been unregistered
+	if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_MOD, serial->port_fd, &ev) < 0) {
+		print_debug("Error modifying reactor interest of port", errno);
+	}
+}
+
+int serial_reactor_wait(struct serial_reactor* const reactor, int64_t* const tokens, size_t max)
+{
+	struct epoll_event events[MAX_EVENTS];
+	int capacity = max < MAX_EVENTS ? (int) max : MAX_EVENTS;
+
+	int n;
+	do {
+		n = epoll_wait(reactor->epoll_fd, events, capacity, -1);
+	} while (n < 0 && errno == EINTR);
+
+	if (n < 0) {
+		print_debug("Error waiting on reactor", errno);
+		return -E_IO;
+	}
+
+	int count = 0;
+	for (int i = 0; i < n; ++i) {
+		if (events[i].data.u64 == TOKEN_CANCEL) {
+			return -E_INTERRUPT;
+		}
+		tokens[count++] = (int64_t) events[i].data.u64;
+	}
+	return count;
+}
+
+int serial_reactor_cancel(struct serial_reactor* const reactor)
+{
+	int data = 0;
+
+	//write to pipe to wake up any waiting thread (self-pipe trick)
+	if (write(reactor->pipe_write_fd, &data, 1) < 0) {
+		print_debug("Error writing to pipe during reactor cancel", errno);
+		return -E_IO;
+	}
+
+	return 0;
+}
+
+#else /* __linux__ */
+
+// suppress unused parameter warnings
+#define UNUSED_ARG(x) (void)(x)
+
+int serial_reactor_open(struct serial_reactor** const reactor)
+{
+	UNUSED_ARG(reactor);
+	print_debug("Reactors are only supported on Linux", 0);
+	return -E_UNSUPPORTED;
+}
+
+int serial_reactor_close(struct serial_reactor* const reactor)
+{
+	UNUSED_ARG(reactor);
+	return -E_UNSUPPORTED;
+}
+
+int serial_reactor_register(struct serial_reactor* const reactor, struct serial_config* const serial, int64_t token)
+{
+	UNUSED_ARG(reactor);
+	UNUSED_ARG(serial);
+	UNUSED_ARG(token);
+	return -E_UNSUPPORTED;
+}
+
+int serial_reactor_unregister(struct serial_reactor* const reactor, struct serial_config* const serial)
+{
+	UNUSED_ARG(reactor);
+	UNUSED_ARG(serial);
+	return -E_UNSUPPORTED;
+}
+
+int serial_reactor_wait(struct serial_reactor* const reactor, int64_t* const tokens, size_t max)
+{
+	UNUSED_ARG(reactor);
+	UNUSED_ARG(tokens);
+	UNUSED_ARG(max);
+	return -E_UNSUPPORTED;
+}
+
+int serial_reactor_cancel(struct serial_reactor* const reactor)
+{
+	UNUSED_ARG(reactor);
+	return -E_UNSUPPORTED;
+}
+
+void reactor_watch_writable(struct serial_config* const serial, bool writable)
+{
+	UNUSED_ARG(serial);
+	UNUSED_ARG(writable);
+}
+
+#endif /* __linux__ */
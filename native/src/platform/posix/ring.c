@@ -0,0 +1,141 @@
+/*
+ * Receive ring of a serial port.
+ *
+ * Data is read from a port into a single-producer/single-consumer ring, which
+ * is shared with a consumer on the JVM. Both sides only exchange indices,
+ * hence a consumer may drain many reads without calling into native code.
+ * See 'serial_ring_fill' for the protocol.
+ */
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include "akka_serial.h"
+#include "akka_serial_posix.h"
+
+// fields of a ring's header
+#define HEAD(ring) ((int64_t*) ((ring) + RING_HEAD))
+#define TAIL(ring) ((int64_t*) ((ring) + RING_TAIL))
+#define CONSUMER_WAITING(ring) ((int32_t*) ((ring) + RING_CONSUMER_WAITING))
+#define PRODUCER_WAITING(ring) ((int32_t*) ((ring) + RING_PRODUCER_WAITING))
+#define READ_TIMESTAMP(ring) ((int64_t*) ((ring) + RING_READ_TIMESTAMP))
+
+/* Free space in a ring. If there is none, the producer announces that it is
+ * waiting and checks again, so that a concurrent consumer either sees the flag
+ * or has its progress seen here. */
+static size_t ring_space(char* const ring, size_t capacity)
+{
+	int64_t head = *HEAD(ring); // only written by this thread
+	size_t space = capacity - (size_t) (head - __atomic_load_n(TAIL(ring), __ATOMIC_ACQUIRE));
+	if (space > 0) return space;
+
+	__atomic_store_n(PRODUCER_WAITING(ring), 1, __ATOMIC_SEQ_CST);
+	space = capacity - (size_t) (head - __atomic_load_n(TAIL(ring), __ATOMIC_SEQ_CST));
+	if (space > 0) __atomic_store_n(PRODUCER_WAITING(ring), 0, __ATOMIC_RELAXED);
+	return space;
+}
+
+int serial_ring_fill(struct serial_config* const serial, char* const ring, size_t capacity)
+{
+	char* const data = ring + RING_DATA;
+
+	// rings carry a stream of bytes, which cannot be split into frames
+	if (serial->framer != NULL) return -E_INVALID_SETTINGS;
+	if (serial->cancelled) return -E_INTERRUPT;
+
+	struct pollfd fds[2];
+	fds[1].fd = serial->pipe_read_fd;
+	fds[1].events = POLLIN;
+
+	for (;;) {
+		int events = 0;
+
+		/* a full ring is not read from, leaving data in the kernel's buffer;
+		 * the port is ignored entirely if there is nothing to wait for, since
+		 * a hang up would otherwise be reported continuously */
+		size_t space = ring_space(ring, capacity);
+		bool suspended = __atomic_load_n(&serial->read_suspended, __ATOMIC_ACQUIRE);
+		fds[0].events = space > 0 && !suspended ? POLLIN : 0;
+		if (tx_pending(serial)) fds[0].events |= POLLOUT;
+		fds[0].fd = fds[0].events != 0 ? serial->port_fd : -1;
+
+		// held data is notified at the latest once the inter-byte timeout expires
+		int timeout = -1;
+		if (serial->ring_held > 0 && serial->read_timeout > 0) {
+			int64_t remaining = serial->ring_deadline - serial_timestamp();
+			timeout = remaining > 0 ? (int) ((remaining + 999999) / 1000000) : 0;
+		}
+
+		int n = poll(fds, 2, timeout);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			print_debug("Error trying to call poll on port and pipe", errno);
+			return -E_IO;
+		}
+		count_wakeup(serial);
+
+		// also consumes wake ups of a consumer that freed space
+		if ((fds[1].revents & POLLIN) && check_cancel(serial)) {
+			return -E_INTERRUPT;
+		}
+
+		if ((fds[0].revents & POLLOUT) && tx_flush(serial) < 0) {
+			return -E_IO;
+		}
+
+		size_t left = space;
+		if (space > 0 && (fds[0].revents & (POLLIN | POLLERR | POLLHUP))) {
+			int64_t head = *HEAD(ring);
+			size_t index = (size_t) head & (capacity - 1);
+			size_t contiguous = capacity - index;
+
+			int r = read(serial->port_fd, data + index, space < contiguous ? space : contiguous);
+
+			// as in serial_read, no data after poll means the port has been disconnected
+			if (r <= 0) {
+				print_debug("Error data not available after poll", errno);
+				return -E_IO;
+			}
+
+			count_read(serial, r);
+			left -= (size_t) r;
+
+			// publish data, which a consumer that is waiting for it is notified of below
+			int64_t now = serial_timestamp();
+			__atomic_store_n(READ_TIMESTAMP(ring), now, __ATOMIC_RELAXED);
+			__atomic_store_n(HEAD(ring), head + r, __ATOMIC_SEQ_CST);
+			serial->ring_held += (size_t) r;
+			serial->ring_deadline = now + (int64_t) serial->read_timeout * 1000000;
+		}
+
+		/* as with reads, data is held back while it is coalesced, until the
+		 * minimum has been filled, the ring is full or the line has been
+		 * silent for the inter-byte timeout */
+		if (serial->ring_held > 0) {
+			bool expired = serial->read_timeout > 0 && serial_timestamp() >= serial->ring_deadline;
+			if (expired || !coalescing(serial, serial->ring_held + left, serial->ring_held)) {
+				serial->ring_held = 0;
+				if (__atomic_exchange_n(CONSUMER_WAITING(ring), 0, __ATOMIC_SEQ_CST) != 0) {
+					events |= RING_DATA_AVAILABLE;
+				}
+			}
+		}
+
+		if (tx_take_drained(serial)) {
+			events |= RING_TX_DRAINED;
+		}
+
+		if (events != 0) return events;
+	}
+}
+
+int serial_ring_wake(struct serial_config* const serial)
+{
+	char data = DATA_WAKE;
+
+	if (write(serial->pipe_write_fd, &data, 1) < 0) {
+		print_debug("Error writing to pipe during ring wake up", errno);
+		return -E_IO;
+	}
+
+	return 0;
+}
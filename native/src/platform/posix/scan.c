@@ -0,0 +1,141 @@
+/*
+ * Search for delimiters.
+ *
+ * Vector kernels compare 16 (SSE2) or 32 (AVX2) bytes at a time against both
+ * searched bytes, and find the first match from the bitmask of comparisons.
+ * The kernel is selected at first use, from the features of the running CPU.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stddef.h>
+#include "akka_serial.h"
+#include "akka_serial_posix.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define HAVE_X86_SCAN
+#include <immintrin.h>
+#endif
+
+typedef size_t (*scan_function)(const char* const data, size_t size, char first, char second);
+
+// kernel used by serial_scan, NULL until selected
+static scan_function scan = NULL;
+
+static size_t scan_scalar(const char* const data, size_t size, char first, char second)
+{
+	for (size_t i = 0; i < size; ++i) {
+		if (data[i] == first || data[i] == second) return i;
+	}
+	return size;
+}
+
+#ifdef HAVE_X86_SCAN
+
+/* The last vector of data that does not fill a whole number of vectors
+ * overlaps with bytes already searched, which are shifted out of its mask. */
+
+static size_t scan_sse2(const char* const data, size_t size, char first, char second)
+{
+	if (size < 16) return scan_scalar(data, size, first, second);
+
+	const __m128i a = _mm_set1_epi8(first);
+	const __m128i b = _mm_set1_epi8(second);
+
+	for (size_t i = 0; i < size; i += 16) {
+		size_t overlap = 0;
+		if (i + 16 > size) {
+			overlap = i + 16 - size;
+			i = size - 16;
+		}
+		__m128i v = _mm_loadu_si128((const __m128i*) (data + i));
+		__m128i matches = _mm_or_si128(_mm_cmpeq_epi8(v, a), _mm_cmpeq_epi8(v, b));
+		unsigned int mask = (unsigned int) _mm_movemask_epi8(matches) >> overlap;
+		if (mask != 0) return i + overlap + (size_t) __builtin_ctz(mask);
+	}
+	return size;
+}
+
+/* Data of less than a vector is not handed to the SSE2 kernel, whose legacy
+ * encoding would incur a transition penalty after AVX instructions. */
+__attribute__((target("avx2")))
+static size_t scan_avx2(const char* const data, size_t size, char first, char second)
+{
+	if (size < 32) {
+		size_t i = 0;
+		if (size >= 16) {
+			// a single SSE vector, VEX-encoded in this function
+			__m128i v = _mm_loadu_si128((const __m128i*) data);
+			__m128i matches = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(first)), _mm_cmpeq_epi8(v, _mm_set1_epi8(second)));
+			unsigned int mask = (unsigned int) _mm_movemask_epi8(matches);
+			if (mask != 0) return (size_t) __builtin_ctz(mask);
+			i = 16;
+		}
+		return i + scan_scalar(data + i, size - i, first, second);
+	}
+
+	const __m256i a = _mm256_set1_epi8(first);
+	const __m256i b = _mm256_set1_epi8(second);
+
+	for (size_t i = 0; i < size; i += 32) {
+		size_t overlap = 0;
+		if (i + 32 > size) {
+			overlap = i + 32 - size;
+			i = size - 32;
+		}
+		__m256i v = _mm256_loadu_si256((const __m256i*) (data + i));
+		__m256i matches = _mm256_or_si256(_mm256_cmpeq_epi8(v, a), _mm256_cmpeq_epi8(v, b));
+		unsigned int mask = (unsigned int) _mm256_movemask_epi8(matches) >> overlap;
+		if (mask != 0) return i + overlap + (size_t) __builtin_ctz(mask);
+	}
+	return size;
+}
+
+#endif
+
+int serial_scan_kernel(int kernel)
+{
+	scan_function function;
+
+#ifdef HAVE_X86_SCAN
+	__builtin_cpu_init();
+	bool avx2 = __builtin_cpu_supports("avx2");
+	if (kernel == SCAN_AUTO) kernel = avx2 ? SCAN_AVX2 : SCAN_SSE2;
+#else
+	if (kernel == SCAN_AUTO) kernel = SCAN_SCALAR;
+#endif
+
+	switch (kernel) {
+	case SCAN_SCALAR:
+		function = scan_scalar;
+		break;
+#ifdef HAVE_X86_SCAN
+	case SCAN_SSE2:
+		function = scan_sse2;
+		break;
+	case SCAN_AVX2:
+		if (!avx2) return -E_UNSUPPORTED;
+		function = scan_avx2;
+		break;
+#else
+	case SCAN_SSE2:
+	case SCAN_AVX2:
+		return -E_UNSUPPORTED;
+#endif
+	default:
+		print_debug("Invalid scan kernel", 0);
+		return -E_INVALID_SETTINGS;
+	}
+
+	__atomic_store_n(&scan, function, __ATOMIC_RELAXED);
+	return kernel;
+}
+
+size_t serial_scan(const char* const data, size_t size, char first, char second)
+{
+	scan_function function = __atomic_load_n(&scan, __ATOMIC_RELAXED);
+	if (function == NULL) {
+		serial_scan_kernel(SCAN_AUTO);
+		function = __atomic_load_n(&scan, __ATOMIC_RELAXED);
+	}
+	return function(data, size, first, second);
+}
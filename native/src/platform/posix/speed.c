@@ -0,0 +1,73 @@
+/*
+ * Arbitrary baud rates.
+ *
+ * The termios interface only supports a fixed set of speeds, each encoded as a
+ * Bxxx constant. Linux additionally allows any speed to be set through the
+ * termios2 structure and the BOTHER flag. Since the kernel's definition of
+ * termios conflicts with the C library's, this file must not include
+ * <termios.h>.
+ */
+#include <errno.h>
+#include "akka_serial.h"
+#include "akka_serial_posix.h"
+
+#ifdef __linux__
+
+#include <sys/ioctl.h>
+#include <asm/termbits.h>
+
+int termios2_set_speed(int fd, int baud)
+{
+	struct termios2 tio;
+	if (ioctl(fd, TCGETS2, &tio) < 0) {
+		print_debug("Error retrieving serial settings", errno);
+		return -E_IO;
+	}
+
+	tio.c_cflag &= ~CBAUD;
+	tio.c_cflag |= BOTHER;
+	tio.c_ospeed = baud;
+
+	// setting an input speed of 0 makes it follow the output speed
+	tio.c_cflag &= ~(CBAUD << IBSHIFT);
+	tio.c_ispeed = 0;
+
+	if (ioctl(fd, TCSETS2, &tio) < 0) {
+		int en = errno;
+		print_debug("Error setting baud rate", en);
+		return en == EINVAL ? -E_INVALID_SETTINGS : -E_IO;
+	}
+	return 0;
+}
+
+int termios2_get_speed(int fd)
+{
+	struct termios2 tio;
+	if (ioctl(fd, TCGETS2, &tio) < 0) {
+		print_debug("Error retrieving serial settings", errno);
+		return -E_IO;
+	}
+	// drivers update the speed to the one actually achieved
+	return (int) tio.c_ospeed;
+}
+
+#else /* __linux__ */
+
+// suppress unused parameter warnings
+#define UNUSED_ARG(x) (void)(x)
+
+int termios2_set_speed(int fd, int baud)
+{
+	UNUSED_ARG(fd);
+	UNUSED_ARG(baud);
+	print_debug("Non-standard baud rates are only supported on Linux", 0);
+	return -E_INVALID_SETTINGS;
+}
+
+int termios2_get_speed(int fd)
+{
+	UNUSED_ARG(fd);
+	return -E_UNSUPPORTED;
+}
+
+#endif /* __linux__ */
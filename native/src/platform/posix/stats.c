@@ -0,0 +1,96 @@
+/*
+ * Statistics of serial ports.
+ *
+ * Counters of system calls and bytes are kept in a port's configuration and
+ * incremented atomically where the calls are made. Errors on the line, such as
+ * overruns of the UART's receive FIFO, are only known to the driver, which on
+ * Linux reports its counts through TIOCGICOUNT. These counts accumulate for as
+ * long as the driver is loaded, hence are reported relative to the counts at
+ * the time the port was opened.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <errno.h>
+#include "akka_serial.h"
+#include "akka_serial_posix.h"
+
+#ifdef __linux__
+
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+
+/* Gets the driver's error counts of a port.
+ * Returns 0 on success, -E_UNSUPPORTED if the driver does not count errors. */
+static int read_errors(int fd, struct serial_stats* const stats)
+{
+	struct serial_icounter_struct icount;
+	if (ioctl(fd, TIOCGICOUNT, &icount) < 0) {
+		if (errno == EINVAL || errno == ENOTTY) return -E_UNSUPPORTED;
+		print_debug("Error retrieving error counts of port", errno);
+		return -E_IO;
+	}
+	stats->overruns = icount.overrun;
+	stats->buffer_overruns = icount.buf_overrun;
+	stats->frame_errors = icount.frame;
+	stats->parity_errors = icount.parity;
+	stats->breaks = icount.brk;
+	return 0;
+}
+
+#else /* __linux__ */
+
+// suppress unused parameter warnings
+#define UNUSED_ARG(x) (void)(x)
+
+static int read_errors(int fd, struct serial_stats* const stats)
+{
+	UNUSED_ARG(fd);
+	UNUSED_ARG(stats);
+	return -E_UNSUPPORTED;
+}
+
+#endif /* __linux__ */
+
+/* Marks the error counts of statistics as not available. */
+static void no_errors(struct serial_stats* const stats)
+{
+	stats->overruns = -1;
+	stats->buffer_overruns = -1;
+	stats->frame_errors = -1;
+	stats->parity_errors = -1;
+	stats->breaks = -1;
+}
+
+void stats_init(struct serial_config* const serial)
+{
+	memset(&serial->stats, 0, sizeof(serial->stats));
+	if (read_errors(serial->port_fd, &serial->stats) < 0) {
+		no_errors(&serial->stats);
+	}
+}
+
+int serial_get_stats(struct serial_config* const serial, struct serial_stats* const stats)
+{
+	const struct serial_stats* const counters = &serial->stats;
+	stats->bytes_read = __atomic_load_n(&counters->bytes_read, __ATOMIC_RELAXED);
+	stats->bytes_written = __atomic_load_n(&counters->bytes_written, __ATOMIC_RELAXED);
+	stats->reads = __atomic_load_n(&counters->reads, __ATOMIC_RELAXED);
+	stats->writes = __atomic_load_n(&counters->writes, __ATOMIC_RELAXED);
+	stats->wakeups = __atomic_load_n(&counters->wakeups, __ATOMIC_RELAXED);
+	stats->cancels = __atomic_load_n(&counters->cancels, __ATOMIC_RELAXED);
+
+	// errors are only reported if they were also counted when the port was opened
+	int r = counters->overruns < 0 ? -E_UNSUPPORTED : read_errors(serial->port_fd, stats);
+	if (r == -E_IO) return r;
+	if (r < 0) {
+		no_errors(stats);
+		return 0;
+	}
+	stats->overruns -= counters->overruns;
+	stats->buffer_overruns -= counters->buffer_overruns;
+	stats->frame_errors -= counters->frame_errors;
+	stats->parity_errors -= counters->parity_errors;
+	stats->breaks -= counters->breaks;
+	return 0;
+}
@@ -0,0 +1,203 @@
+/*
+ * Transmit queue of a serial port.
+ *
+ * Ports are opened in non-blocking mode, hence a write may only be partially
+ * accepted by the kernel when its transmission buffer is full. Any data that
+ * is not accepted is kept in a per-port queue and written as soon as the port
+ * becomes writable again. The queue is drained by whoever waits on the port:
+ * a blocked 'serial_read' or a reactor.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/uio.h>
+#include "akka_serial.h"
+#include "akka_serial_posix.h"
+
+// maximum number of buffers passed to a single call of writev
+#define TX_IOV_BATCH 64
+
+int tx_init(struct serial_config* const serial)
+{
+	serial->tx_queue = NULL;
+	serial->tx_head = 0;
+	serial->tx_size = 0;
+	serial->tx_blocked = false;
+	serial->tx_drained = false;
+
+	if (pthread_mutex_init(&serial->tx_lock, NULL) != 0) {
+		print_debug("Error initializing transmit queue lock", errno);
+		return -E_IO;
+	}
+	return 0;
+}
+
+void tx_free(struct serial_config* const serial)
+{
+	pthread_mutex_destroy(&serial->tx_lock);
+	free(serial->tx_queue);
+}
+
+bool tx_pending(struct serial_config* const serial)
+{
+	return __atomic_load_n(&serial->tx_size, __ATOMIC_ACQUIRE) > 0;
+}
+
+/* Notify the thread waiting on a port that there is data to be transmitted. */
+static void wake(struct serial_config* const serial)
+{
+	if (serial->reactor != NULL) {
+		reactor_watch_writable(serial, true);
+	} else {
+		char data = DATA_WAKE;
+		if (write(serial->pipe_write_fd, &data, 1) < 0) {
+			print_debug("Error writing to pipe during transmit wake up", errno);
+		}
+	}
+}
+
+/* Copies data to the end of the transmit queue, as far as its capacity allows.
+ * Must be called with the queue locked and allocated. */
+static size_t enqueue(struct serial_config* const serial, const char* const data, size_t size)
+{
+	size_t queued = serial->tx_size;
+	size_t count = size < TX_QUEUE_CAPACITY - queued ? size : TX_QUEUE_CAPACITY - queued;
+
+	// copy into circular buffer, possibly wrapping around
+	size_t tail = (serial->tx_head + queued) % TX_QUEUE_CAPACITY;
+	size_t first = count < TX_QUEUE_CAPACITY - tail ? count : TX_QUEUE_CAPACITY - tail;
+	memcpy(serial->tx_queue + tail, data, first);
+	memcpy(serial->tx_queue, data + first, count - first);
+
+	__atomic_store_n(&serial->tx_size, queued + count, __ATOMIC_RELEASE);
+	return count;
+}
+
+int tx_writev(struct serial_config* const serial, const struct serial_buffer* const buffers, size_t count)
+{
+	size_t accepted = 0; // total number of bytes written or queued
+	size_t index = 0; // first buffer that has not been completely written
+	size_t offset = 0; // number of bytes written from that buffer
+
+	pthread_mutex_lock(&serial->tx_lock);
+
+	// data must not overtake anything that is already queued
+	if (serial->tx_size == 0) {
+		bool blocked = false;
+		while (index < count && !blocked) {
+			struct iovec iov[TX_IOV_BATCH];
+			int n = 0;
+			size_t total = 0;
+			for (size_t i = index; i < count && n < TX_IOV_BATCH; ++i, ++n) {
+				iov[n].iov_base = buffers[i].data;
+				iov[n].iov_len = buffers[i].size;
+				total += buffers[i].size;
+			}
+
+			ssize_t written = writev(serial->port_fd, iov, n);
+			if (written < 0) {
+				if (errno != EAGAIN && errno != EWOULDBLOCK) {
+					pthread_mutex_unlock(&serial->tx_lock);
+					print_debug("Error writing to port", errno);
+					return -E_IO;
+				}
+				written = 0;
+			}
+			if (written > 0) count_write(serial, (size_t) written);
+			accepted += (size_t) written;
+			blocked = (size_t) written < total;
+
+			// skip buffers that have been written completely
+			size_t left = (size_t) written;
+			while (index < count && left >= buffers[index].size) {
+				left -= buffers[index].size;
+				index++;
+			}
+			offset = left;
+		}
+	}
+
+	if (index < count) {
+		if (serial->tx_queue == NULL) {
+			serial->tx_queue = malloc(TX_QUEUE_CAPACITY);
+			if (serial->tx_queue == NULL) {
+				pthread_mutex_unlock(&serial->tx_lock);
+				print_debug("Error allocating transmit queue", errno);
+				return -E_IO;
+			}
+		}
+
+		bool was_empty = serial->tx_size == 0;
+		bool full = false;
+		for (; index < count && !full; ++index, offset = 0) {
+			size_t size = buffers[index].size - offset;
+			size_t n = enqueue(serial, buffers[index].data + offset, size);
+			accepted += n;
+			full = n < size;
+		}
+
+		if (full) serial->tx_blocked = true;
+		if (was_empty && serial->tx_size > 0) wake(serial);
+	}
+
+	pthread_mutex_unlock(&serial->tx_lock);
+	return (int) accepted;
+}
+
+int tx_flush(struct serial_config* const serial)
+{
+	pthread_mutex_lock(&serial->tx_lock);
+
+	size_t queued = serial->tx_size;
+	while (queued > 0) {
+		size_t chunk = queued < TX_QUEUE_CAPACITY - serial->tx_head ? queued : TX_QUEUE_CAPACITY - serial->tx_head;
+		ssize_t n = write(serial->port_fd, serial->tx_queue + serial->tx_head, chunk);
+		if (n < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+			pthread_mutex_unlock(&serial->tx_lock);
+			print_debug("Error writing queued data to port", errno);
+			return -E_IO;
+		}
+		if (n > 0) count_write(serial, (size_t) n);
+		serial->tx_head = (serial->tx_head + n) % TX_QUEUE_CAPACITY;
+		queued -= n;
+		if ((size_t) n < chunk) break;
+	}
+	__atomic_store_n(&serial->tx_size, queued, __ATOMIC_RELEASE);
+
+	if (queued == 0) {
+		serial->tx_head = 0;
+		if (serial->tx_blocked) {
+			serial->tx_blocked = false;
+			serial->tx_drained = true;
+		}
+		if (serial->reactor != NULL) reactor_watch_writable(serial, false);
+	}
+
+	pthread_mutex_unlock(&serial->tx_lock);
+	return (int) queued;
+}
+
+bool tx_take_drained(struct serial_config* const serial)
+{
+	pthread_mutex_lock(&serial->tx_lock);
+	bool drained = serial->tx_drained;
+	serial->tx_drained = false;
+	pthread_mutex_unlock(&serial->tx_lock);
+	return drained;
+}
+
+bool check_cancel(struct serial_config* const serial)
+{
+	char data[64];
+	ssize_t n;
+
+	// consume wake ups, but remember cancellation for any subsequent read
+	while ((n = read(serial->pipe_read_fd, data, sizeof(data))) > 0) {
+		for (ssize_t i = 0; i < n; ++i) {
+			if (data[i] != DATA_WAKE) serial->cancelled = true;
+		}
+	}
+	return serial->cancelled;
+}
@@ -0,0 +1,418 @@
+/*
+ * io_uring engine for serial reads (Linux only).
+ *
+ * Instead of waiting for data with poll and then reading it, a read is
+ * submitted as a poll linked to a read of a registered (fixed) buffer. The
+ * submission and the wait for the read's completion happen in a single
+ * system call. A poll on the cancellation pipe is kept armed alongside, so
+ * that reads may be interrupted in the same way as with the poll engine, as
+ * well as a poll for writability while data is queued for transmission.
+ *
+ * The ring is driven through raw system calls, liburing is not required.
+ */
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include "akka_serial.h"
+#include "akka_serial_posix.h"
+
+#ifdef HAVE_IO_URING
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#define RING_ENTRIES 8
+
+// user data of submitted operations
+#define TAG_POLL 1 // poll on port, linked to read
+#define TAG_READ 2 // read from port
+#define TAG_CANCEL 3 // poll on cancellation pipe
+#define TAG_ABORT 4 // cancellation of a pending poll
+#define TAG_WRITABLE 5 // poll on port for writability
+
+struct uring {
+	int ring_fd;
+
+	// submission queue
+	unsigned* sq_head;
+	unsigned* sq_tail;
+	unsigned* sq_mask;
+	unsigned* sq_array;
+	struct io_uring_sqe* sqes;
+
+	// completion queue
+	unsigned* cq_head;
+	unsigned* cq_tail;
+	unsigned* cq_mask;
+	struct io_uring_cqe* cqes;
+
+	// mapped memory
+	void* ring_ptr;
+	size_t ring_size;
+	size_t sqes_size;
+
+	// registered buffer, NULL if none
+	char* buffer;
+	size_t buffer_size;
+
+	bool read_pending; // a linked poll and read are in flight
+	bool cancel_armed; // a poll on the cancellation pipe is in flight
+	bool pipe_ready; // the pipe has data, which is either a wake up or a cancellation
+	bool writable_armed; // a poll for writability of the port is in flight
+	bool writable_ready; // the port is writable
+	bool interrupted; // the port has been cancelled
+	int read_result; // result of the last completed read
+};
+
+static int ring_setup(unsigned entries, struct io_uring_params* params)
+{
+	return (int) syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int ring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+	return (int) syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int ring_register(int fd, unsigned opcode, void* arg, unsigned nr_args)
+{
+	return (int) syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+/* Get a zeroed submission entry, the submission queue never overflows since at most five
+ * operations are in flight. */
+static struct io_uring_sqe* get_sqe(struct uring* ring, unsigned* pending)
+{
+	unsigned tail = *ring->sq_tail + *pending;
+	unsigned index = tail & *ring->sq_mask;
+	struct io_uring_sqe* sqe = &ring->sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	ring->sq_array[index] = index;
+	(*pending)++;
+	return sqe;
+}
+
+/* Make prepared submission entries visible to the kernel. */
+static void publish(struct uring* ring, unsigned pending)
+{
+	__atomic_store_n(ring->sq_tail, *ring->sq_tail + pending, __ATOMIC_RELEASE);
+}
+
+/* Reap all available completions, updating state of in-flight operations. */
+static void reap(struct uring* ring)
+{
+	unsigned head = *ring->cq_head;
+	unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+	while (head != tail) {
+		struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+		switch (cqe->user_data) {
+		case TAG_POLL:
+			/* only reported on failure, in which case the linked read is
+			 * cancelled before it starts (depending on the kernel
+			 * version, without reporting a completion of its own) */
+			ring->read_pending = false;
+			ring->read_result = cqe->res;
+			break;
+		case TAG_READ:
+			if (cqe->res == -ECANCELED) break; // already handled by failed poll
+			ring->read_pending = false;
+			ring->read_result = cqe->res;
+			break;
+		case TAG_CANCEL:
+			ring->cancel_armed = false;
+			if (cqe->res > 0) ring->pipe_ready = true;
+			break;
+		case TAG_WRITABLE:
+			ring->writable_armed = false;
+			if (cqe->res > 0) ring->writable_ready = true;
+			break;
+		default:
+			break;
+		}
+		head++;
+	}
+
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+/* Register the given buffer as fixed buffer, if it isn't already. */
+static void register_buffer(struct uring* ring, char* const buffer, size_t size)
+{
+	if (ring->buffer == buffer && ring->buffer_size >= size) return;
+
+	if (ring->buffer != NULL) {
+		ring_register(ring->ring_fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+		ring->buffer = NULL;
+	}
+
+	struct iovec iov;
+	iov.iov_base = buffer;
+	iov.iov_len = size;
+
+	/* registering may fail, e.g. if the buffer exceeds the locked memory
+	 * limit, in which case reads are performed on an unregistered buffer */
+	if (ring_register(ring->ring_fd, IORING_REGISTER_BUFFERS, &iov, 1) < 0) {
+		print_debug("Error registering buffer, falling back to unregistered reads", errno);
+		return;
+	}
+	ring->buffer = buffer;
+	ring->buffer_size = size;
+}
+
+int uring_open(struct serial_config* const serial)
+{
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	int fd = ring_setup(RING_ENTRIES, &params);
+	if (fd < 0) {
+		print_debug("io_uring is not available", errno);
+		return -E_UNSUPPORTED;
+	}
+
+	// skipping successful completions of linked polls requires Linux 5.17
+	unsigned required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_CQE_SKIP;
+	if ((params.features & required) != required) {
+		print_debug("io_uring does not support required features", 0);
+		close(fd);
+		return -E_UNSUPPORTED;
+	}
+
+	struct uring* ring = calloc(1, sizeof(*ring));
+	if (ring == NULL) {
+		print_debug("Error allocating memory for io_uring", errno);
+		close(fd);
+		return -E_IO;
+	}
+
+	size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	ring->ring_size = sq_size > cq_size ? sq_size : cq_size;
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	ring->ring_ptr = mmap(NULL, ring->ring_size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (ring->ring_ptr == MAP_FAILED) {
+		print_debug("Error mapping io_uring", errno);
+		free(ring);
+		close(fd);
+		return -E_IO;
+	}
+
+	ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED) {
+		print_debug("Error mapping io_uring submission entries", errno);
+		munmap(ring->ring_ptr, ring->ring_size);
+		free(ring);
+		close(fd);
+		return -E_IO;
+	}
+
+	char* ptr = ring->ring_ptr;
+	ring->sq_head = (unsigned*) (ptr + params.sq_off.head);
+	ring->sq_tail = (unsigned*) (ptr + params.sq_off.tail);
+	ring->sq_mask = (unsigned*) (ptr + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned*) (ptr + params.sq_off.array);
+	ring->cq_head = (unsigned*) (ptr + params.cq_off.head);
+	ring->cq_tail = (unsigned*) (ptr + params.cq_off.tail);
+	ring->cq_mask = (unsigned*) (ptr + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe*) (ptr + params.cq_off.cqes);
+	ring->ring_fd = fd;
+
+	serial->uring = ring;
+	return 0;
+}
+
+void uring_close(struct uring* const ring)
+{
+	// closing the ring cancels any operations still in flight
+	munmap(ring->sqes, ring->sqes_size);
+	munmap(ring->ring_ptr, ring->ring_size);
+	close(ring->ring_fd);
+	free(ring);
+}
+
+/* Cancel a pending read and wait until it has completed, since its buffer belongs to the caller
+ * once 'uring_read' returns. Returns the number of bytes read if the read completed before it
+ * could be cancelled. */
+static int abort_read(struct uring* ring)
+{
+	unsigned pending = 0;
+
+	if (!ring->read_pending) return 0;
+
+	struct io_uring_sqe* abort = get_sqe(ring, &pending);
+	abort->opcode = IORING_OP_ASYNC_CANCEL;
+	abort->addr = TAG_POLL;
+	abort->user_data = TAG_ABORT;
+	publish(ring, pending);
+
+	while (ring->read_pending) {
+		if (ring_enter(ring->ring_fd, pending, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+			print_debug("Error entering io_uring", errno);
+			return -E_IO;
+		}
+		pending = 0;
+		reap(ring);
+	}
+	return ring->read_result > 0 ? ring->read_result : 0;
+}
+
+int uring_read(struct serial_config* const serial, char* const buffer, size_t size)
+{
+	struct uring* ring = serial->uring;
+
+	if (ring->interrupted) return -E_INTERRUPT;
+
+	// a drain found along with data returned by the previous call is reported first
+	if (tx_take_drained(serial)) return 0;
+
+	register_buffer(ring, buffer, size);
+
+	for (;;) {
+		unsigned pending = 0;
+
+		if (!ring->cancel_armed) {
+			struct io_uring_sqe* sqe = get_sqe(ring, &pending);
+			sqe->opcode = IORING_OP_POLL_ADD;
+			sqe->fd = serial->pipe_read_fd;
+			sqe->poll32_events = POLLIN;
+			sqe->user_data = TAG_CANCEL;
+			ring->cancel_armed = true;
+		}
+
+		// no read is submitted while reading is suspended
+		if (!ring->read_pending && !__atomic_load_n(&serial->read_suspended, __ATOMIC_ACQUIRE)) {
+			struct io_uring_sqe* poll = get_sqe(ring, &pending);
+			poll->opcode = IORING_OP_POLL_ADD;
+			poll->fd = serial->port_fd;
+			poll->poll32_events = POLLIN;
+			poll->flags = IOSQE_IO_LINK | IOSQE_CQE_SKIP_SUCCESS;
+			poll->user_data = TAG_POLL;
+
+			struct io_uring_sqe* read = get_sqe(ring, &pending);
+			read->fd = serial->port_fd;
+			read->addr = (uint64_t) (uintptr_t) buffer;
+			read->len = size;
+			read->user_data = TAG_READ;
+			if (ring->buffer == buffer) {
+				read->opcode = IORING_OP_READ_FIXED;
+				read->buf_index = 0;
+			} else {
+				read->opcode = IORING_OP_READ;
+			}
+			ring->read_pending = true;
+		}
+
+		// also wait for writability if there is queued data to transmit
+		if (!ring->writable_armed && tx_pending(serial)) {
+			struct io_uring_sqe* sqe = get_sqe(ring, &pending);
+			sqe->opcode = IORING_OP_POLL_ADD;
+			sqe->fd = serial->port_fd;
+			sqe->poll32_events = POLLOUT;
+			sqe->user_data = TAG_WRITABLE;
+			ring->writable_armed = true;
+		}
+
+		// no read is in flight while reading is suspended
+		bool reading = ring->read_pending;
+
+		publish(ring, pending);
+
+		// submit and wait for a completion in one call
+		if (ring_enter(ring->ring_fd, pending, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+			print_debug("Error entering io_uring", errno);
+			return -E_IO;
+		}
+		reap(ring);
+		count_wakeup(serial);
+
+		if (ring->pipe_ready) {
+			ring->pipe_ready = false;
+			if (check_cancel(serial)) {
+				ring->interrupted = true;
+				return abort_read(ring) < 0 ? -E_IO : -E_INTERRUPT;
+			}
+
+			// a read submitted before reading was suspended is withdrawn
+			if (ring->read_pending && __atomic_load_n(&serial->read_suspended, __ATOMIC_ACQUIRE)) {
+				int r = abort_read(ring);
+				if (r != 0) return r;
+				reading = false;
+			}
+		}
+
+		if (ring->writable_ready) {
+			ring->writable_ready = false;
+			if (tx_flush(serial) < 0) {
+				abort_read(ring);
+				return -E_IO;
+			}
+		}
+
+		if (reading && !ring->read_pending) {
+			int r = ring->read_result;
+
+			// spurious wakeup, try again
+			if (r == -EAGAIN || r == -EINTR) continue;
+
+			// as with the poll engine, 0 bytes after a poll indicate a disconnect
+			if (r <= 0) {
+				print_debug("Error reading from port through io_uring", -r);
+				return -E_IO;
+			}
+			serial->read_timestamp = serial_timestamp();
+			count_read(serial, r);
+			return r;
+		}
+
+		// the drained flag is only ever set by this thread, hence may be checked without lock
+		if (serial->tx_drained) {
+			int r = abort_read(ring);
+			if (r < 0) return r;
+			if (r > 0) {
+				// the read completed before it could be cancelled, the drain is reported on the next call
+				serial->read_timestamp = serial_timestamp();
+				count_read(serial, r);
+				return r;
+			}
+			tx_take_drained(serial);
+			return 0;
+		}
+	}
+}
+
+#else /* HAVE_IO_URING */
+
+// suppress unused parameter warnings
+#define UNUSED_ARG(x) (void)(x)
+
+int uring_open(struct serial_config* const serial)
+{
+	UNUSED_ARG(serial);
+	print_debug("io_uring support was not compiled in", 0);
+	return -E_UNSUPPORTED;
+}
+
+void uring_close(struct uring* const ring)
+{
+	UNUSED_ARG(ring);
+}
+
+int uring_read(struct serial_config* const serial, char* const buffer, size_t size)
+{
+	UNUSED_ARG(serial);
+	UNUSED_ARG(buffer);
+	UNUSED_ARG(size);
+	return -E_UNSUPPORTED;
+}
+
+#endif /* HAVE_IO_URING */
@@ -0,0 +1,120 @@
+/*
+ * Tests checksums: every checksum matches the check value of its catalogued
+ * definition and published frames, every kernel supported by the running CPU
+ * agrees with the table kernel at any size and alignment, and benchmarks
+ * kernels against each other.
+ */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "akka_serial.h"
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+#define DATA_SIZE (1 << 20)
+#define ROUNDS 32
+
+static const char* kinds[] = {"none", "crc16", "crc16-ccitt", "crc32", "lrc"};
+static const char* kernels[] = {"auto", "table", "slice8", "pclmul"};
+
+static const struct {
+	int kind;
+	const char* data;
+	size_t size;
+	int64_t expected;
+} vectors[] = {
+	// check values, i.e. checksums of "123456789"
+	{CHECKSUM_CRC16, "123456789", 9, 0x4B37},
+	{CHECKSUM_CRC16_CCITT, "123456789", 9, 0x29B1},
+	{CHECKSUM_CRC32, "123456789", 9, 0xCBF43926},
+	{CHECKSUM_LRC, "123456789", 9, 0x23},
+	// empty data yields the initial value, with the final inversion of CRC-32
+	{CHECKSUM_CRC16, "", 0, 0xFFFF},
+	{CHECKSUM_CRC16_CCITT, "", 0, 0xFFFF},
+	{CHECKSUM_CRC32, "", 0, 0},
+	{CHECKSUM_LRC, "", 0, 0},
+	// Modbus RTU request: read 1 holding register at 0 from slave 1, sent as 84 0A
+	{CHECKSUM_CRC16, "\x01\x03\x00\x00\x00\x01", 6, 0x0A84},
+	// Modbus ASCII request ":010300000001FB", whose LRC covers the binary bytes
+	{CHECKSUM_LRC, "\x01\x03\x00\x00\x00\x01", 6, 0xFB},
+	// 64 bytes and more are folded by the PCLMUL kernel
+	{CHECKSUM_CRC32, "The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog.", 89, 0x9AE90AA7},
+};
+
+/* Checksums data repeatedly, returning the throughput in MB/s. */
+static double benchmark(int kind, const char* data, size_t size)
+{
+	int64_t sink = 0;
+	int64_t start = serial_timestamp();
+	for (int i = 0; i < ROUNDS; ++i) {
+		sink ^= serial_checksum(kind, data, size);
+	}
+	int64_t elapsed = serial_timestamp() - start;
+	return sink < 0 ? -1 : (double) size * ROUNDS * 1000 / (double) elapsed;
+}
+
+int main(void)
+{
+	char* data = malloc(DATA_SIZE + 64);
+	ASSERT(data != NULL, "Error allocating data");
+	srand(42);
+	for (size_t i = 0; i < DATA_SIZE + 64; ++i) {
+		data[i] = (char) (rand() % 256);
+	}
+
+	ASSERT(serial_checksum_kernel(-1) == -E_INVALID_SETTINGS, "Accepted unknown kernel");
+	ASSERT(serial_checksum(CHECKSUM_NONE, data, 1) == -E_INVALID_SETTINGS, "Accepted unknown checksum");
+	int best = serial_checksum_kernel(CHECKSUM_KERNEL_AUTO);
+	ASSERT(best > 0, "Error selecting kernel");
+
+	for (int kernel = CHECKSUM_KERNEL_TABLE; kernel <= CHECKSUM_KERNEL_PCLMUL; ++kernel) {
+		if (serial_checksum_kernel(kernel) != kernel) continue;
+		for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); ++i) {
+			int64_t checksum = serial_checksum(vectors[i].kind, vectors[i].data, vectors[i].size);
+			if (checksum != vectors[i].expected) {
+				fprintf(stderr, "%s kernel computed %s 0x%llx instead of 0x%llx for vector %zu\n",
+					kernels[kernel], kinds[vectors[i].kind], (long long) checksum,
+					(long long) vectors[i].expected, i);
+				return 1;
+			}
+		}
+	}
+
+	// all kernels agree at any size and alignment
+	for (int kind = CHECKSUM_CRC16; kind <= CHECKSUM_LRC; ++kind) {
+		for (size_t offset = 0; offset < 16; ++offset) {
+			for (size_t size = 0; size <= 300; ++size) {
+				serial_checksum_kernel(CHECKSUM_KERNEL_TABLE);
+				int64_t expected = serial_checksum(kind, data + offset, size);
+				for (int kernel = CHECKSUM_KERNEL_SLICE8; kernel <= CHECKSUM_KERNEL_PCLMUL; ++kernel) {
+					if (serial_checksum_kernel(kernel) != kernel) continue;
+					if (serial_checksum(kind, data + offset, size) != expected) {
+						fprintf(stderr, "%s kernel disagrees on %s (offset %zu, size %zu)\n",
+							kernels[kernel], kinds[kind], offset, size);
+						return 1;
+					}
+				}
+			}
+		}
+	}
+
+	for (int kind = CHECKSUM_CRC16; kind <= CHECKSUM_LRC; ++kind) {
+		printf("%-12s", kinds[kind]);
+		for (int kernel = CHECKSUM_KERNEL_TABLE; kernel <= CHECKSUM_KERNEL_PCLMUL; ++kernel) {
+			if (serial_checksum_kernel(kernel) != kernel) {
+				printf("  %s not supported", kernels[kernel]);
+				continue;
+			}
+			double rate = benchmark(kind, data, DATA_SIZE);
+			ASSERT(rate > 0, "Error computing checksum");
+			printf("  %s %7.0f MB/s", kernels[kernel], rate);
+		}
+		printf("\n");
+	}
+	printf("default kernel: %s\n", kernels[best]);
+
+	free(data);
+	return 0;
+}
@@ -0,0 +1,197 @@
+/*
+ * Tests read coalescing: data that trickles into a pseudo terminal in small
+ * chunks is returned by few reads, once enough bytes have accumulated or the
+ * inter-byte timeout expired. The same is expected of non-blocking reads of a
+ * reactor and of the notifications of a receive ring. The test is aborted if a
+ * read hangs.
+ */
+#define _XOPEN_SOURCE 600
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include "akka_serial.h"
+
+#define CHUNKS 40
+#define CHUNK_SIZE 8
+#define RING_CAPACITY 4096
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+static int master;
+
+// number of bytes written after all chunks
+static size_t padding;
+
+// writes small chunks with short pauses, as a slow device would, and the padding
+static void* writer(void* arg)
+{
+	char chunk[CHUNK_SIZE] = {0};
+	(void) arg;
+	for (int i = 0; i < CHUNKS; ++i) {
+		if (write(master, chunk, sizeof(chunk)) != sizeof(chunk)) return (void*) 1;
+		usleep(2000);
+	}
+	for (size_t i = 0; i < padding; ++i) {
+		if (write(master, chunk, 1) != 1) return (void*) 1;
+	}
+	return NULL;
+}
+
+/* reads all chunks, returning the number of reads needed or -1 on error; the
+ * last read may return part of the padding, which is left unread otherwise */
+static int count_reads(struct serial_config* serial, size_t pad)
+{
+	char buffer[4096];
+	int reads = 0;
+	int total = 0;
+
+	padding = pad;
+	pthread_t writer_thread;
+	pthread_create(&writer_thread, NULL, writer, NULL);
+	while (total < CHUNKS * CHUNK_SIZE) {
+		int n = serial_read(serial, buffer, sizeof(buffer));
+		if (n < 0) return -1;
+		total += n;
+		reads++;
+	}
+	pthread_join(writer_thread, NULL);
+	return reads;
+}
+
+// reads all chunks through a reactor, returning the number of reads that returned data
+static int count_reactor_reads(struct serial_config* serial, size_t pad)
+{
+	char buffer[4096];
+	int64_t token;
+	int reads = 0;
+	int total = 0;
+
+	struct serial_reactor* reactor;
+	if (serial_reactor_open(&reactor) < 0) return -1;
+	if (serial_reactor_register(reactor, serial, 1) < 0) return -1;
+
+	padding = pad;
+	pthread_t writer_thread;
+	pthread_create(&writer_thread, NULL, writer, NULL);
+	while (total < CHUNKS * CHUNK_SIZE) {
+		if (serial_reactor_wait(reactor, &token, 1) < 0) return -1;
+		int n = serial_try_read(serial, buffer, sizeof(buffer));
+		if (n < 0) return -1;
+		if (n > 0) reads++;
+		total += n;
+	}
+	pthread_join(writer_thread, NULL);
+
+	serial_reactor_unregister(reactor, serial);
+	serial_reactor_close(reactor);
+	return reads;
+}
+
+// fills all chunks into a ring, returning the number of times a waiting consumer was notified
+static int count_ring_notifications(struct serial_config* serial)
+{
+	char* ring;
+	int notifications = 0;
+
+	if (posix_memalign((void**) &ring, 64, RING_DATA + RING_CAPACITY) != 0) return -1;
+	memset(ring, 0, RING_DATA);
+	int64_t* head = (int64_t*) (ring + RING_HEAD);
+	int64_t* tail = (int64_t*) (ring + RING_TAIL);
+	int32_t* waiting = (int32_t*) (ring + RING_CONSUMER_WAITING);
+
+	padding = 0;
+	pthread_t writer_thread;
+	pthread_create(&writer_thread, NULL, writer, NULL);
+	*waiting = 1;
+	while (*head < CHUNKS * CHUNK_SIZE) {
+		int events = serial_ring_fill(serial, ring, RING_CAPACITY);
+		if (events < 0) return -1;
+		if (events & RING_DATA_AVAILABLE) {
+			// consume everything, then wait again
+			notifications++;
+			*tail = *head;
+			*waiting = 1;
+		}
+	}
+	pthread_join(writer_thread, NULL);
+
+	free(ring);
+	return notifications;
+}
+
+// opens a port on a new pseudo terminal, with the given coalescing
+static struct serial_config* open_port(size_t min_size, unsigned int timeout)
+{
+	struct serial_config* serial;
+	master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return NULL;
+	if (serial_open(ptsname(master), 115200, 8, false, PARITY_NONE, &serial) != 0) return NULL;
+	if (serial_set_read_coalescing(serial, min_size, timeout) != 0) return NULL;
+	return serial;
+}
+
+static void close_port(struct serial_config* serial)
+{
+	serial_close(serial);
+	close(master);
+}
+
+int main(void)
+{
+	struct serial_config* serial;
+
+	// a read that never returns fails the test
+	alarm(30);
+
+	master = posix_openpt(O_RDWR | O_NOCTTY);
+	ASSERT(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0, "Error opening pty");
+	ASSERT(serial_open(ptsname(master), 115200, 8, false, PARITY_NONE, &serial) == 0, "Error opening port");
+
+	int plain = count_reads(serial, 0);
+	ASSERT(plain > 0, "Error reading without coalescing");
+
+	// the timeout is well above the writer's pauses, hence all data should arrive in one read
+	ASSERT(serial_set_read_coalescing(serial, 0, 100) == 0, "Error setting timeout");
+	int timed = count_reads(serial, 0);
+	ASSERT(timed == 1, "Data was not coalesced with an inter-byte timeout");
+
+	/* a minimum size alone is enforced by the kernel, which does not signal
+	 * fewer bytes as readable; however the kernel splits data into reads,
+	 * padding makes up for a remainder of less than the minimum */
+	ASSERT(serial_set_read_coalescing(serial, 4 * CHUNK_SIZE, 0) == 0, "Error setting minimum");
+	int minimum = count_reads(serial, 4 * CHUNK_SIZE);
+	ASSERT(minimum > 0 && minimum <= CHUNKS / 4, "Reads returned less than the minimum size");
+
+	serial_close(serial);
+	close(master);
+
+	// non-blocking reads of a reactor are coalesced alike
+	serial = open_port(0, 100);
+	ASSERT(serial != NULL, "Error opening port with timeout");
+	int reactor_timed = count_reactor_reads(serial, 0);
+	ASSERT(reactor_timed == 1, "Reactor reads were not coalesced with an inter-byte timeout");
+	close_port(serial);
+
+	serial = open_port(4 * CHUNK_SIZE, 0);
+	ASSERT(serial != NULL, "Error opening port with minimum");
+	int reactor_minimum = count_reactor_reads(serial, 4 * CHUNK_SIZE);
+	ASSERT(reactor_minimum > 0 && reactor_minimum <= CHUNKS / 4, "Reactor reads returned less than the minimum size");
+	close_port(serial);
+
+	// as are notifications of a ring's consumer
+	serial = open_port(0, 100);
+	ASSERT(serial != NULL, "Error opening port with timeout");
+	int notified = count_ring_notifications(serial);
+	ASSERT(notified == 1, "Ring notifications were not coalesced with an inter-byte timeout");
+	close_port(serial);
+
+	printf("reads of %d chunks: %d plain, %d with timeout, %d with minimum size\n", CHUNKS, plain, timed, minimum);
+	printf("reactor reads: %d with timeout, %d with minimum size; ring notifications: %d with timeout\n",
+		reactor_timed, reactor_minimum, notified);
+	return 0;
+}
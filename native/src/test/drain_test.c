@@ -0,0 +1,85 @@
+/*
+ * Tests drain confirmation: data that is queued because the other end of a
+ * pseudo terminal does not read is only reported as drained once it has been
+ * consumed, and a drain is interrupted by cancelling the port.
+ */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include "akka_serial.h"
+
+#define PAYLOAD_SIZE (64 * 1024)
+#define CONSUMER_DELAY 50000 // microseconds
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+static struct serial_config* serial;
+static int master;
+
+// blocks in serial_read, which drains the transmit queue
+static void* reader(void* arg)
+{
+	char buffer[64];
+	(void) arg;
+	while (serial_read(serial, buffer, sizeof(buffer)) >= 0) {}
+	return NULL;
+}
+
+// starts consuming data on the master side after a delay
+static void* consumer(void* arg)
+{
+	char buffer[4096];
+	size_t received = 0;
+	(void) arg;
+	usleep(CONSUMER_DELAY);
+	while (received < PAYLOAD_SIZE) {
+		ssize_t n = read(master, buffer, sizeof(buffer));
+		if (n <= 0) break;
+		received += n;
+	}
+	return NULL;
+}
+
+int main(void)
+{
+	static char payload[PAYLOAD_SIZE];
+	int64_t drained;
+
+	master = posix_openpt(O_RDWR | O_NOCTTY);
+	ASSERT(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0, "Error opening pty");
+	ASSERT(serial_open(ptsname(master), 115200, 8, false, PARITY_NONE, &serial) == 0, "Error opening port");
+
+	// nothing written, hence drained immediately
+	int64_t start = serial_timestamp();
+	ASSERT(serial_drain(serial, &drained) == 0 && drained >= start, "Error draining idle port");
+
+	pthread_t reader_thread, consumer_thread;
+	pthread_create(&reader_thread, NULL, reader, NULL);
+	pthread_create(&consumer_thread, NULL, consumer, NULL);
+
+	start = serial_timestamp();
+	int accepted = serial_write(serial, payload, sizeof(payload));
+	ASSERT(accepted > 0, "Error writing payload");
+	ASSERT(serial_output_queued(serial) > 0, "Written data not reported as queued");
+	ASSERT(serial_drain(serial, &drained) == 0, "Error draining port");
+	ASSERT(drained - start >= CONSUMER_DELAY * 1000LL, "Port reported drained before data was consumed");
+	ASSERT(serial_output_queued(serial) == 0, "Data still queued after drain");
+
+	pthread_join(consumer_thread, NULL);
+
+	// a cancellation also interrupts drains
+	ASSERT(serial_cancel_read(serial) == 0, "Error cancelling port");
+	pthread_join(reader_thread, NULL);
+	ASSERT(serial_write(serial, payload, sizeof(payload)) > 0, "Error writing after cancel");
+	ASSERT(serial_drain(serial, &drained) == -E_INTERRUPT, "Drain not interrupted");
+
+	serial_close(serial);
+	close(master);
+
+	printf("%d bytes drained after %.1f ms\n", accepted, (drained - start) / 1e6);
+	return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * Tests flow control settings and suspension of reads: while reading is
+ * suspended, data received by a pseudo terminal stays in the kernel's buffer
+ * until reading is resumed.
+ */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <pthread.h>
+#include "akka_serial.h"
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+static struct serial_config* serial;
+static volatile int result = -1;
+
+static void* reader(void* arg)
+{
+	char buffer[64];
+	(void) arg;
+	result = serial_read(serial, buffer, sizeof(buffer));
+	return NULL;
+}
+
+int main(void)
+{
+	char buffer[64];
+	struct termios tio;
+
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	ASSERT(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0, "Error opening pty");
+	ASSERT(serial_open(ptsname(master), 115200, 8, false, PARITY_NONE, &serial) == 0, "Error opening port");
+
+	// settings of the slave side are reported through the master
+	ASSERT(serial_set_flow_control(serial, FLOW_SOFTWARE) == 0, "Error setting software flow control");
+	ASSERT(tcgetattr(master, &tio) == 0 && (tio.c_iflag & IXOFF) && (tio.c_iflag & IXON), "XON/XOFF not set");
+	ASSERT(serial_set_flow_control(serial, FLOW_NONE) == 0, "Error clearing flow control");
+	ASSERT(tcgetattr(master, &tio) == 0 && !(tio.c_iflag & (IXON | IXOFF)), "XON/XOFF not cleared");
+	ASSERT(serial_set_flow_control(serial, 42) == -E_INVALID_SETTINGS, "Invalid flow control accepted");
+
+	// a read that is blocked when reading is suspended stops waiting for data
+	pthread_t reader_thread;
+	pthread_create(&reader_thread, NULL, reader, NULL);
+	usleep(10000);
+	ASSERT(serial_suspend_reading(serial, true) == 0, "Error suspending reading");
+	usleep(10000);
+	ASSERT(write(master, "hello", 5) == 5, "Error writing to pty");
+	usleep(50000);
+	ASSERT(result == -1, "Blocking read returned while suspended");
+
+	// non-blocking reads leave data in the kernel's buffer
+	ASSERT(serial_try_read(serial, buffer, sizeof(buffer)) == 0, "Data read while suspended");
+
+	// the blocked read returns once reading is resumed
+	ASSERT(serial_suspend_reading(serial, false) == 0, "Error resuming reading");
+	pthread_join(reader_thread, NULL);
+	ASSERT(result == 5, "Data not read once resumed");
+
+	serial_close(serial);
+	close(master);
+
+	printf("reading suspended and resumed\n");
+	return 0;
+}
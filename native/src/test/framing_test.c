@@ -0,0 +1,196 @@
+/*
+ * Tests native framing: delimited, length-prefixed and fixed-size frames
+ * written to a pseudo terminal in arbitrary chunks are read one whole frame at
+ * a time, invalid data is discarded until the next frame, and so are frames
+ * whose checksum does not match. Frames separated by silence end once the gap
+ * has elapsed, also for ports waited on by a reactor.
+ */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "akka_serial.h"
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+/* Reads a frame and compares it to the expected one, which may contain zeros. */
+static int read_frame(struct serial_config* serial, const char* expected, int size)
+{
+	char buffer[64];
+	int n = serial_read(serial, buffer, sizeof(buffer));
+	if (n != size || memcmp(buffer, expected, size) != 0) {
+		fprintf(stderr, "Expected frame of %d bytes, read %d bytes\n", size, n);
+		return 1;
+	}
+	return 0;
+}
+
+#define READ_FRAME(serial, expected) read_frame(serial, expected, sizeof(expected) - 1)
+
+int main(void)
+{
+	char buffer[64];
+	struct serial_config* serial;
+
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	ASSERT(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0, "Error opening pty");
+	ASSERT(serial_open(ptsname(master), 115200, 8, false, PARITY_NONE, &serial) == 0, "Error opening port");
+
+	struct serial_framing framing;
+	memset(&framing, 0, sizeof(framing));
+	framing.kind = FRAMING_DELIMITER;
+	framing.max_size = 8;
+	ASSERT(serial_set_framing(serial, &framing) == -E_INVALID_SETTINGS, "Accepted empty delimiter");
+
+	// delimited frames, split across writes and with a delimiter straddling writes
+	memcpy(framing.delimiter, "\r\n", 2);
+	framing.delimiter_size = 2;
+	framing.strip_delimiter = true;
+	ASSERT(serial_set_framing(serial, &framing) == 0, "Error setting delimiter framing");
+	ASSERT(write(master, "ab\r\ncd\r", 7) == 7, "Error writing to pty");
+	ASSERT(READ_FRAME(serial, "ab") == 0, "Error reading first delimited frame");
+	ASSERT(write(master, "\n\r\nef\r\n", 7) == 7, "Error writing to pty");
+	ASSERT(READ_FRAME(serial, "cd") == 0, "Error reading frame with split delimiter");
+	usleep(10000);
+	ASSERT(serial_try_read(serial, buffer, sizeof(buffer)) == 2, "Error reading buffered frame without blocking");
+	ASSERT(memcmp(buffer, "ef", 2) == 0, "Wrong buffered frame");
+	ASSERT(serial_try_read(serial, buffer, sizeof(buffer)) == 0, "Read a frame that was not written");
+
+	// oversized frames are discarded up to the next delimiter
+	ASSERT(write(master, "0123456789abcdef\r\nok\r\n", 22) == 22, "Error writing to pty");
+	ASSERT(READ_FRAME(serial, "ok") == 0, "Error reading frame after oversized frame");
+
+	// partial frames count as queued input
+	ASSERT(write(master, "xyz", 3) == 3, "Error writing to pty");
+	usleep(10000);
+	ASSERT(serial_try_read(serial, buffer, sizeof(buffer)) == 0, "Read a partial frame");
+	ASSERT(serial_input_queued(serial) == 3, "Partial frame not counted as queued input");
+	ASSERT(write(master, "\r\n", 2) == 2, "Error writing to pty");
+	ASSERT(READ_FRAME(serial, "xyz") == 0, "Error reading completed frame");
+
+	// delimiters are kept if requested
+	framing.strip_delimiter = false;
+	ASSERT(serial_set_framing(serial, &framing) == 0, "Error setting delimiter framing");
+	ASSERT(write(master, "ab\r\n", 4) == 4, "Error writing to pty");
+	ASSERT(READ_FRAME(serial, "ab\r\n") == 0, "Error reading frame with delimiter");
+
+	// frames not fitting into the buffer are reported and dropped
+	ASSERT(write(master, "abcdef\r\ngh\r\n", 12) == 12, "Error writing to pty");
+	ASSERT(serial_read(serial, buffer, 4) == -E_INVALID_SETTINGS, "Read a frame into a buffer too small");
+	ASSERT(READ_FRAME(serial, "gh\r\n") == 0, "Error reading frame after frame too large for buffer");
+
+	// length-prefixed frames, with a marker before a big-endian length of the payload
+	memset(&framing, 0, sizeof(framing));
+	framing.kind = FRAMING_LENGTH;
+	framing.max_size = 16;
+	framing.length_offset = 1;
+	framing.length_width = 2;
+	framing.length_big_endian = true;
+	ASSERT(serial_set_framing(serial, &framing) == 0, "Error setting length framing");
+	ASSERT(write(master, "~\x00\x03" "ab", 5) == 5, "Error writing to pty");
+	usleep(10000);
+	ASSERT(serial_try_read(serial, buffer, sizeof(buffer)) == 0, "Read a partial length-prefixed frame");
+	ASSERT(write(master, "c" "~\x00\x01" "d", 5) == 5, "Error writing to pty");
+	ASSERT(READ_FRAME(serial, "~\x00\x03" "abc") == 0, "Error reading length-prefixed frame");
+	ASSERT(READ_FRAME(serial, "~\x00\x01" "d") == 0, "Error reading second length-prefixed frame");
+
+	// a length beyond the maximum frame size resynchronizes on the next byte
+	ASSERT(write(master, "~\x7f" "~\x00\x00", 5) == 5, "Error writing to pty");
+	ASSERT(READ_FRAME(serial, "~\x00\x00") == 0, "Error resynchronizing after invalid length");
+
+	// little-endian length of the whole frame, including the length field itself
+	framing.length_offset = 0;
+	framing.length_big_endian = false;
+	framing.length_adjustment = -2;
+	ASSERT(serial_set_framing(serial, &framing) == 0, "Error setting length framing");
+	ASSERT(write(master, "\x05\x00" "abc", 5) == 5, "Error writing to pty");
+	ASSERT(READ_FRAME(serial, "\x05\x00" "abc") == 0, "Error reading adjusted length-prefixed frame");
+
+	// fixed-size frames
+	memset(&framing, 0, sizeof(framing));
+	framing.kind = FRAMING_FIXED;
+	framing.max_size = 4;
+	ASSERT(serial_set_framing(serial, &framing) == 0, "Error setting fixed framing");
+	ASSERT(write(master, "abcdefgh", 8) == 8, "Error writing to pty");
+	ASSERT(READ_FRAME(serial, "abcd") == 0, "Error reading first fixed-size frame");
+	ASSERT(READ_FRAME(serial, "efgh") == 0, "Error reading second fixed-size frame");
+
+	// Modbus RTU requests, with a little-endian CRC-16 at their end; corrupted frames are discarded
+	framing.max_size = 8;
+	framing.checksum = 42;
+	ASSERT(serial_set_framing(serial, &framing) == -E_INVALID_SETTINGS, "Accepted unknown checksum");
+	framing.checksum = CHECKSUM_CRC16;
+	ASSERT(serial_set_framing(serial, &framing) == 0, "Error setting checksummed framing");
+	ASSERT(write(master, "\x01\x03\x00\x00\x00\x02\x84\x0a" "\x01\x03\x00\x00\x00\x01\x84\x0a", 16) == 16, "Error writing to pty");
+	ASSERT(READ_FRAME(serial, "\x01\x03\x00\x00\x00\x01\x84\x0a") == 0, "Error reading frame after corrupted frame");
+
+	// delimited frames with a big-endian CRC-16/CCITT of their payload, after a start byte
+	memset(&framing, 0, sizeof(framing));
+	framing.kind = FRAMING_DELIMITER;
+	framing.max_size = 32;
+	framing.delimiter[0] = '\n';
+	framing.delimiter_size = 1;
+	framing.strip_delimiter = true;
+	framing.checksum = CHECKSUM_CRC16_CCITT;
+	framing.checksum_offset = 1;
+	framing.checksum_big_endian = true;
+	ASSERT(serial_set_framing(serial, &framing) == 0, "Error setting checksummed delimiter framing");
+	ASSERT(write(master, "\x02" "\x29\xb1\n" "\x02" "123456789" "\x29\xb1\n", 17) == 17, "Error writing to pty");
+	ASSERT(READ_FRAME(serial, "\x02" "123456789" "\x29\xb1") == 0, "Error reading checksummed delimited frame");
+
+	// frames separated by silence, with a gap long enough not to be missed under load
+	memset(&framing, 0, sizeof(framing));
+	framing.kind = FRAMING_GAP;
+	framing.max_size = 8;
+	ASSERT(serial_set_framing(serial, &framing) == 0, "Error setting gap framing with default gap");
+	framing.gap = 50000;
+	ASSERT(serial_set_framing(serial, &framing) == 0, "Error setting gap framing");
+	ASSERT(write(master, "abc", 3) == 3, "Error writing to pty");
+	usleep(5000);
+	ASSERT(write(master, "de", 2) == 2, "Error writing to pty");
+	int64_t start = serial_timestamp();
+	ASSERT(READ_FRAME(serial, "abcde") == 0, "Error reading frame ended by a gap");
+	ASSERT(serial_timestamp() - start >= 50000000, "Frame ended before the gap");
+
+	// gaps are detected without blocking, and reported by reactors
+	struct serial_reactor* reactor;
+	int64_t token;
+	ASSERT(serial_reactor_open(&reactor) == 0, "Error opening reactor");
+	ASSERT(serial_reactor_register(reactor, serial, 7) == 0, "Error registering port");
+	ASSERT(write(master, "fg", 2) == 2, "Error writing to pty");
+	ASSERT(serial_reactor_wait(reactor, &token, 1) == 1 && token == 7, "Reactor did not report data");
+	ASSERT(serial_try_read(serial, buffer, sizeof(buffer)) == 0, "Read a frame before its gap");
+	ASSERT(serial_reactor_wait(reactor, &token, 1) == 1 && token == 7, "Reactor did not report gap");
+	ASSERT(serial_try_read(serial, buffer, sizeof(buffer)) == 2, "Error reading frame after gap");
+	ASSERT(memcmp(buffer, "fg", 2) == 0, "Wrong frame after gap");
+	ASSERT(serial_reactor_unregister(reactor, serial) == 0, "Error unregistering port");
+	ASSERT(serial_reactor_close(reactor) == 0, "Error closing reactor");
+
+	// data beyond the maximum frame size is discarded until the next gap
+	ASSERT(write(master, "0123456789", 10) == 10, "Error writing to pty");
+	usleep(10000);
+	ASSERT(serial_try_read(serial, buffer, sizeof(buffer)) == 0, "Read an oversized frame");
+	usleep(100000);
+	ASSERT(serial_try_read(serial, buffer, sizeof(buffer)) == 0, "Read an oversized frame after its gap");
+	ASSERT(write(master, "ok", 2) == 2, "Error writing to pty");
+	ASSERT(READ_FRAME(serial, "ok") == 0, "Error reading frame after oversized frame");
+
+	// framed ports cannot fill rings
+	char* ring;
+	ASSERT(posix_memalign((void**) &ring, 64, RING_DATA + 4096) == 0, "Error allocating ring");
+	memset(ring, 0, RING_DATA);
+	ASSERT(serial_ring_fill(serial, ring, 4096) == -E_INVALID_SETTINGS, "Filled a ring of a framed port");
+	free(ring);
+
+	// removing framing returns data as it arrives
+	ASSERT(serial_set_framing(serial, NULL) == 0, "Error removing framing");
+	ASSERT(write(master, "ab", 2) == 2, "Error writing to pty");
+	ASSERT(READ_FRAME(serial, "ab") == 0, "Error reading unframed data");
+
+	serial_close(serial);
+	close(master);
+	return 0;
+}
@@ -0,0 +1,71 @@
+/*
+ * Tests low-latency tuning against a fake sysfs tree, in which a latency
+ * timer attribute is provided for a pseudo terminal.
+ */
+#define _XOPEN_SOURCE 700
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "akka_serial.h"
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+int main(void)
+{
+	char root[] = "/tmp/akka-serial-sysfs-XXXXXX";
+	char path[512];
+	struct serial_config* serial;
+
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	ASSERT(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0, "Error opening pty");
+	ASSERT(serial_open(ptsname(master), 115200, 8, false, PARITY_NONE, &serial) == 0, "Error opening port");
+
+	// ports without an adapter have no latency timer
+	ASSERT(serial_get_latency_timer(serial) == -E_UNSUPPORTED, "Pty reported a latency timer");
+	ASSERT(serial_set_low_latency(serial) == 0, "Low latency settings applied to a pty");
+
+	// fake tree: <root>/class/tty/<name>/device/latency_timer
+	ASSERT(mkdtemp(root) != NULL, "Error creating fake sysfs root");
+	const char* name = strrchr(ptsname(master), '/') + 1;
+	const char* dirs[] = {"class", "tty", name, "device"};
+	snprintf(path, sizeof(path), "%s", root);
+	for (int i = 0; i < 4; ++i) {
+		strcat(path, "/");
+		strcat(path, dirs[i]);
+		ASSERT(mkdir(path, 0755) == 0, "Error creating fake sysfs tree");
+	}
+	strcat(path, "/latency_timer");
+
+	// a timer that cannot be written is reported as an error rather than ignored
+	ASSERT(symlink("/dev/full", path) == 0, "Error creating unwritable latency timer");
+	ASSERT(serial_sysfs_root(root) == 0, "Error setting sysfs root");
+	ASSERT(serial_set_low_latency(serial) == -E_IO, "Failed write of latency timer was not reported");
+	unlink(path);
+
+	FILE* file = fopen(path, "w");
+	ASSERT(file != NULL, "Error creating fake latency timer");
+	fputs("16\n", file);
+	fclose(file);
+
+	ASSERT(serial_get_latency_timer(serial) == 16, "Latency timer not read from fake tree");
+	ASSERT(serial_set_low_latency(serial) == LOW_LATENCY_TIMER, "Latency timer was not set");
+	ASSERT(serial_get_latency_timer(serial) == 1, "Latency timer was not lowered");
+
+	serial_close(serial);
+	close(master);
+	serial_sysfs_root("/sys");
+
+	// remove fake tree, from the attribute up to its root
+	unlink(path);
+	for (int i = 0; i < 5; ++i) {
+		*strrchr(path, '/') = '\0';
+		rmdir(path);
+	}
+
+	printf("latency timer set in fake sysfs tree\n");
+	return 0;
+}
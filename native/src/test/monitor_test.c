@@ -0,0 +1,191 @@
+/*
+ * Tests monitors of devices against a fake sysfs tree and fake uevents: USB
+ * serial adapters are matched by their vendor id and reported as connected,
+ * also when present on opening, and as disconnected; other devices and
+ * uevents split across reads are handled, as are names matched by patterns
+ * and sources that end. Attributes of ttys, such as their driver, are looked
+ * up from the same tree.
+ */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "akka_serial.h"
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+static char root[64];
+
+/* Writes a file of the fake sysfs tree, creating its directories. */
+static void put(const char* const path, const char* const content)
+{
+	char buffer[512];
+	snprintf(buffer, sizeof(buffer), "%s%s", root, path);
+	for (char* slash = strchr(buffer + strlen(root) + 1, '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+		*slash = '\0';
+		mkdir(buffer, 0755);
+		*slash = '/';
+	}
+	FILE* file = fopen(buffer, "w");
+	if (file != NULL) {
+		fputs(content, file);
+		fclose(file);
+	}
+}
+
+/* Creates a symbolic link in the fake sysfs tree. */
+static void put_link(const char* const path, const char* const target)
+{
+	char link[256];
+	snprintf(link, sizeof(link), "%s%s", root, path);
+	if (symlink(target, link) < 0) perror("symlink");
+}
+
+/* Links an entry of the tty class to a device of the fake sysfs tree. */
+static void link_tty(const char* const name, const char* const devpath)
+{
+	char target[256], entry[256];
+	snprintf(target, sizeof(target), "../..%s", devpath);
+	snprintf(entry, sizeof(entry), "%s/class/tty/%s", root, name);
+	if (symlink(target, entry) < 0) perror("symlink");
+}
+
+/* Writes a uevent of a tty, followed by the empty field that ends it. */
+static int send(int fd, const char* const action, const char* const subsystem, const char* const devpath, const char* const devname)
+{
+	char buffer[512];
+	int n = snprintf(buffer, sizeof(buffer), "%s@%s", action, devpath) + 1;
+	n += snprintf(buffer + n, sizeof(buffer) - n, "ACTION=%s", action) + 1;
+	n += snprintf(buffer + n, sizeof(buffer) - n, "DEVPATH=%s", devpath) + 1;
+	n += snprintf(buffer + n, sizeof(buffer) - n, "SUBSYSTEM=%s", subsystem) + 1;
+	n += snprintf(buffer + n, sizeof(buffer) - n, "DEVNAME=%s", devname) + 1;
+	buffer[n++] = '\0';
+	return write(fd, buffer, n) == n ? 0 : 1;
+}
+
+static void filter_init(struct serial_device_filter* const filter)
+{
+	memset(filter, 0, sizeof(*filter));
+	filter->vendor = -1;
+	filter->product = -1;
+}
+
+#define FTDI "/devices/pci0/usb1/1-1"
+#define FTDI_TTY FTDI "/1-1:1.0/ttyUSB0/tty/ttyUSB0"
+#define FTDI2 "/devices/pci0/usb1/1-2"
+#define FTDI2_TTY FTDI2 "/1-2:1.0/ttyUSB1/tty/ttyUSB1"
+#define ARDUINO "/devices/pci0/usb1/1-3"
+#define ARDUINO_TTY ARDUINO "/1-3:1.0/tty/ttyACM0"
+#define UART_TTY "/devices/platform/serial8250/tty/ttyS0"
+
+int main(void)
+{
+	struct serial_monitor* monitor;
+	struct serial_device_event event;
+
+	snprintf(root, sizeof(root), "/tmp/akka-serial-sysfs-%d", (int) getpid());
+	ASSERT(mkdir(root, 0755) == 0, "Error creating fake sysfs tree");
+	ASSERT(serial_sysfs_root(root) == 0, "Error setting sysfs root");
+
+	put(FTDI "/idVendor", "0403\n");
+	put(FTDI "/idProduct", "6001\n");
+	put(FTDI "/serial", "A50285BI\n");
+	put(FTDI "/manufacturer", "FTDI\n");
+	put(FTDI "/product", "FT232R USB UART\n");
+	put(FTDI_TTY "/uevent", "MAJOR=188\nMINOR=0\nDEVNAME=ttyUSB0\n");
+	put(UART_TTY "/uevent", "MAJOR=4\nMINOR=64\nDEVNAME=ttyS0\n");
+	put("/class/tty/.keep", "");
+	link_tty("ttyUSB0", FTDI_TTY);
+	link_tty("ttyS0", UART_TTY);
+	put_link(FTDI_TTY "/device", "../..");
+	put_link(FTDI "/1-1:1.0/ttyUSB0/driver", "../../../../../bus/usb-serial/drivers/ftdi_sio");
+
+	// attributes of ttys, with and without a USB device
+	struct serial_device_info info;
+	ASSERT(serial_device_info("ttyUSB0", &info) == 0, "Error looking up tty");
+	ASSERT(strcmp(info.devpath, FTDI_TTY) == 0, "Wrong path of tty in sysfs");
+	ASSERT(strcmp(info.driver, "ftdi_sio") == 0, "Wrong driver of tty");
+	ASSERT(info.vendor == 0x0403 && info.product == 0x6001, "Wrong ids of USB device");
+	ASSERT(strcmp(info.serial, "A50285BI") == 0, "Wrong serial number of USB device");
+	ASSERT(strcmp(info.manufacturer, "FTDI") == 0 && strcmp(info.description, "FT232R USB UART") == 0,
+		"Wrong strings of USB device");
+	ASSERT(serial_device_info("ttyS0", &info) == 0, "Error looking up tty");
+	ASSERT(info.vendor == -1 && info.driver[0] == '\0' && info.serial[0] == '\0', "Found USB device of UART");
+	ASSERT(serial_device_info("ttyUSB9", &info) == -E_NO_PORT, "Found tty that does not exist");
+	ASSERT(serial_device_info("../ttyS0", &info) == -E_NO_PORT, "Found tty outside of class");
+
+	// uevents are written into a pipe, which the monitor opens by path
+	int pipe_fd[2];
+	ASSERT(pipe(pipe_fd) == 0, "Error opening pipe");
+	char source[32];
+	snprintf(source, sizeof(source), "/dev/fd/%d", pipe_fd[0]);
+
+	// ttys of FTDI adapters, the adapter present on opening is reported first
+	struct serial_device_filter filter;
+	filter_init(&filter);
+	strcpy(filter.subsystem, "tty");
+	filter.vendor = 0x0403;
+	ASSERT(serial_monitor_open(source, "/dev", &filter, 1, true, &monitor) == 0, "Error opening monitor");
+	ASSERT(serial_monitor_pending(monitor) == 1, "Wrong number of present devices");
+	ASSERT(serial_monitor_next(monitor, &event) == 1, "Error waiting for present device");
+	ASSERT(serial_monitor_pending(monitor) == 0, "Present device still pending");
+	ASSERT(event.action == DEVICE_CONNECTED && strcmp(event.path, "/dev/ttyUSB0") == 0, "Wrong present device");
+
+	// an Arduino and the USB device of an adapter do not match, the adapter's tty does
+	put(ARDUINO "/idVendor", "2341\n");
+	put(ARDUINO "/idProduct", "0043\n");
+	put(ARDUINO_TTY "/uevent", "DEVNAME=ttyACM0\n");
+	put(FTDI2 "/idVendor", "0403\n");
+	put(FTDI2 "/idProduct", "6015\n");
+	put(FTDI2_TTY "/uevent", "DEVNAME=ttyUSB1\n");
+	ASSERT(send(pipe_fd[1], "add", "tty", ARDUINO_TTY, "ttyACM0") == 0, "Error writing uevent");
+	ASSERT(send(pipe_fd[1], "add", "usb", FTDI2, "bus/usb/001/003") == 0, "Error writing uevent");
+	ASSERT(send(pipe_fd[1], "add", "tty", FTDI2_TTY, "ttyUSB1") == 0, "Error writing uevent");
+	ASSERT(serial_monitor_next(monitor, &event) == 1, "Error waiting for connected device");
+	ASSERT(event.action == DEVICE_CONNECTED && strcmp(event.path, "/dev/ttyUSB1") == 0, "Wrong connected device");
+
+	// removals of devices that were not matched are not reported, uevents may be split across reads
+	ASSERT(send(pipe_fd[1], "remove", "tty", ARDUINO_TTY, "ttyACM0") == 0, "Error writing uevent");
+	ASSERT(write(pipe_fd[1], "ACTION=remove", 14) == 14, "Error writing uevent");
+	usleep(10000);
+	ASSERT(send(pipe_fd[1], "remove", "tty", FTDI_TTY, "ttyUSB0") == 0, "Error writing uevent");
+	ASSERT(serial_monitor_next(monitor, &event) == 1, "Error waiting for disconnected device");
+	ASSERT(event.action == DEVICE_DISCONNECTED && strcmp(event.path, "/dev/ttyUSB0") == 0, "Wrong disconnected device");
+
+	ASSERT(serial_monitor_cancel(monitor) == 0, "Error cancelling monitor");
+	ASSERT(serial_monitor_next(monitor, &event) == -E_INTERRUPT, "Wait was not cancelled");
+	ASSERT(serial_monitor_close(monitor) == 0, "Error closing monitor");
+
+	// names matched by pattern, from a file whose end ends the monitor
+	char file[96];
+	snprintf(file, sizeof(file), "%s/uevents", root);
+	int fd = open(file, O_WRONLY | O_CREAT, 0644);
+	ASSERT(fd >= 0, "Error creating file of uevents");
+	ASSERT(send(fd, "add", "tty", FTDI2_TTY, "ttyUSB1") == 0, "Error writing uevent");
+	ASSERT(send(fd, "add", "tty", "/devices/platform/serial8250/tty/ttyS1", "ttyS1") == 0, "Error writing uevent");
+	close(fd);
+	filter_init(&filter);
+	strcpy(filter.name, "ttyS*");
+	ASSERT(serial_monitor_open(file, "/dev", &filter, 1, false, &monitor) == 0, "Error opening monitor");
+	ASSERT(serial_monitor_next(monitor, &event) == 1, "Error waiting for connected device");
+	ASSERT(event.action == DEVICE_CONNECTED && strcmp(event.path, "/dev/ttyS1") == 0, "Wrong device matched by name");
+	ASSERT(serial_monitor_next(monitor, &event) == 0, "Monitor did not end with its source");
+	ASSERT(serial_monitor_close(monitor) == 0, "Error closing monitor");
+
+	// the kernel's uevents may not be available, e.g. in containers
+	serial_sysfs_root("/sys");
+	int r = serial_monitor_open(NULL, "/dev", NULL, 0, false, &monitor);
+	ASSERT(r == 0 || r == -E_UNSUPPORTED, "Error opening monitor of kernel");
+	if (r == 0) ASSERT(serial_monitor_close(monitor) == 0, "Error closing monitor of kernel");
+
+	close(pipe_fd[0]);
+	close(pipe_fd[1]);
+	char command[96];
+	snprintf(command, sizeof(command), "rm -rf %s", root);
+	ASSERT(system(command) == 0, "Error removing fake sysfs tree");
+	return 0;
+}
@@ -0,0 +1,40 @@
+/*
+ * Tests queue depth queries: data written to a pseudo terminal is reported in
+ * the receive queue of its other end until it is read.
+ */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "akka_serial.h"
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+int main(void)
+{
+	char buffer[64];
+	struct serial_config* serial;
+
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	ASSERT(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0, "Error opening pty");
+	ASSERT(serial_open(ptsname(master), 115200, 8, false, PARITY_NONE, &serial) == 0, "Error opening port");
+
+	ASSERT(serial_input_queued(serial) == 0, "Input queue not empty after opening");
+	ASSERT(serial_output_queued(serial) == 0, "Output queue not empty after opening");
+
+	ASSERT(write(master, "hello world", 11) == 11, "Error writing to pty");
+	usleep(10000);
+	int input = serial_input_queued(serial);
+	ASSERT(input == 11, "Input queue does not contain written data");
+
+	ASSERT(serial_read(serial, buffer, sizeof(buffer)) == 11, "Error reading data");
+	ASSERT(serial_input_queued(serial) == 0, "Input queue not empty after reading");
+
+	serial_close(serial);
+	close(master);
+
+	printf("input queue held %d bytes\n", input);
+	return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * Scaling test of the reactor: opens a large number of pseudo terminals (by
+ * default more than FD_SETSIZE file descriptors), registers them all with a
+ * single reactor and checks that data written to every one of them is
+ * reported and read from one thread.
+ *
+ * Usage: reactor_test [number of ptys]
+ */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "akka_serial.h"
+
+#define DEFAULT_PORTS 2048
+
+struct pty {
+	int master_fd;
+	struct serial_config* serial;
+	int received;
+};
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int open_pty(struct pty* pty)
+{
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+		perror("Error opening pseudo terminal");
+		return -1;
+	}
+
+	int r = serial_open(ptsname(master), 115200, 8, false, PARITY_NONE, &pty->serial);
+	if (r < 0) {
+		fprintf(stderr, "Error opening serial port %s: %d\n", ptsname(master), r);
+		close(master);
+		return -1;
+	}
+
+	pty->master_fd = master;
+	pty->received = 0;
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	int count = argc > 1 ? atoi(argv[1]) : DEFAULT_PORTS;
+
+	/* every pty requires four file descriptors (master, slave and the
+	 * slave's cancellation pipe), raise limit as far as possible */
+	struct rlimit limit;
+	getrlimit(RLIMIT_NOFILE, &limit);
+	limit.rlim_cur = limit.rlim_max;
+	setrlimit(RLIMIT_NOFILE, &limit);
+
+	struct pty* ptys = calloc(count, sizeof(*ptys));
+	int64_t* tokens = calloc(count, sizeof(*tokens));
+	char buffer[64];
+	struct serial_reactor* reactor;
+
+	if (serial_reactor_open(&reactor) < 0) {
+		fprintf(stderr, "Error opening reactor\n");
+		return 1;
+	}
+
+	int opened = 0;
+	for (; opened < count; ++opened) {
+		if (open_pty(&ptys[opened]) < 0) break;
+		// tokens must be non-zero
+		if (serial_reactor_register(reactor, ptys[opened].serial, opened + 1) < 0) {
+			fprintf(stderr, "Error registering port %d\n", opened);
+			return 1;
+		}
+	}
+	if (opened < count) {
+		fprintf(stderr, "Could only open %d of %d ptys\n", opened, count);
+		return 1;
+	}
+
+	double start = now();
+	for (int i = 0; i < count; ++i) {
+		if (write(ptys[i].master_fd, "x", 1) != 1) {
+			perror("Error writing to master");
+			return 1;
+		}
+	}
+
+	int total = 0;
+	int wakeups = 0;
+	while (total < count) {
+		int n = serial_reactor_wait(reactor, tokens, count);
+		if (n <= 0) {
+			fprintf(stderr, "Error waiting on reactor: %d\n", n);
+			return 1;
+		}
+		++wakeups;
+		for (int i = 0; i < n; ++i) {
+			struct pty* pty = &ptys[tokens[i] - 1];
+			int r = serial_try_read(pty->serial, buffer, sizeof(buffer));
+			if (r < 0) {
+				fprintf(stderr, "Error reading from port %d: %d\n", (int) tokens[i] - 1, r);
+				return 1;
+			}
+			if (r > 0 && pty->received == 0) ++total;
+			pty->received += r;
+		}
+	}
+	double elapsed = now() - start;
+
+	printf("received data from %d ptys on one thread in %d wakeups (%.3f ms)\n",
+		total, wakeups, elapsed * 1000);
+
+	// a cancelled reactor must not block
+	serial_reactor_cancel(reactor);
+	if (serial_reactor_wait(reactor, tokens, count) != -E_INTERRUPT) {
+		fprintf(stderr, "Reactor wait was not interrupted\n");
+		return 1;
+	}
+
+	for (int i = 0; i < count; ++i) {
+		serial_reactor_unregister(reactor, ptys[i].serial);
+		serial_close(ptys[i].serial);
+		close(ptys[i].master_fd);
+	}
+	serial_reactor_close(reactor);
+	free(tokens);
+	free(ptys);
+
+	return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * Tests the receive ring: a payload much larger than the ring is sent to a
+ * pseudo terminal and drained by a consumer that only exchanges indices with
+ * the producer, verifying that no data is lost or reordered and that the
+ * producer resumes after the ring has been full.
+ */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include "akka_serial.h"
+
+#define PAYLOAD_SIZE (1024 * 1024)
+#define CAPACITY 4096
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+#define HEAD ((int64_t*) (ring + RING_HEAD))
+#define TAIL ((int64_t*) (ring + RING_TAIL))
+#define CONSUMER_WAITING ((int32_t*) (ring + RING_CONSUMER_WAITING))
+#define PRODUCER_WAITING ((int32_t*) (ring + RING_PRODUCER_WAITING))
+
+static struct serial_config* serial;
+static char* ring;
+static int master;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static int notifications = 0;
+
+// fills the ring until cancelled, forwarding notifications to the consumer
+static void* producer(void* arg)
+{
+	(void) arg;
+	int events;
+	while ((events = serial_ring_fill(serial, ring, CAPACITY)) > 0) {
+		pthread_mutex_lock(&lock);
+		if (events & RING_DATA_AVAILABLE) notifications++;
+		pthread_cond_signal(&cond);
+		pthread_mutex_unlock(&lock);
+	}
+	return events == -E_INTERRUPT ? NULL : (void*) 1;
+}
+
+// writes the payload to the master side
+static void* writer(void* arg)
+{
+	char* payload = arg;
+	size_t offset = 0;
+	while (offset < PAYLOAD_SIZE) {
+		ssize_t n = write(master, payload + offset, PAYLOAD_SIZE - offset);
+		if (n <= 0) return (void*) 1;
+		offset += n;
+	}
+	return NULL;
+}
+
+int main(void)
+{
+	char* payload = malloc(PAYLOAD_SIZE);
+	for (size_t i = 0; i < PAYLOAD_SIZE; ++i) payload[i] = i % 251;
+
+	ASSERT(posix_memalign((void**) &ring, 64, RING_DATA + CAPACITY) == 0, "Error allocating ring");
+	memset(ring, 0, RING_DATA);
+	*CONSUMER_WAITING = 1;
+
+	master = posix_openpt(O_RDWR | O_NOCTTY);
+	ASSERT(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0, "Error opening pty");
+	ASSERT(serial_open(ptsname(master), 115200, 8, false, PARITY_NONE, &serial) == 0, "Error opening port");
+
+	pthread_t producer_thread, writer_thread;
+	pthread_create(&producer_thread, NULL, producer, NULL);
+	pthread_create(&writer_thread, NULL, writer, payload);
+
+	// consume, waiting for a notification whenever the ring is empty
+	int64_t tail = 0;
+	int seen = 0;
+	int wakes = 0;
+	while (tail < PAYLOAD_SIZE) {
+		int64_t head = __atomic_load_n(HEAD, __ATOMIC_ACQUIRE);
+
+		if (head == tail) {
+			__atomic_store_n(CONSUMER_WAITING, 1, __ATOMIC_SEQ_CST);
+			if (__atomic_load_n(HEAD, __ATOMIC_SEQ_CST) != tail) continue;
+			pthread_mutex_lock(&lock);
+			while (notifications == seen) pthread_cond_wait(&cond, &lock);
+			seen = notifications;
+			pthread_mutex_unlock(&lock);
+			continue;
+		}
+
+		for (int64_t i = tail; i < head; ++i) {
+			if ((unsigned char) ring[RING_DATA + (i & (CAPACITY - 1))] != i % 251) {
+				fprintf(stderr, "Corrupt data at offset %lld\n", (long long) i);
+				return 1;
+			}
+		}
+		tail = head;
+		__atomic_store_n(TAIL, tail, __ATOMIC_SEQ_CST);
+		if (__atomic_exchange_n(PRODUCER_WAITING, 0, __ATOMIC_SEQ_CST) != 0) {
+			ASSERT(serial_ring_wake(serial) == 0, "Error waking producer");
+			wakes++;
+		}
+	}
+
+	void* result;
+	pthread_join(writer_thread, &result);
+	ASSERT(result == NULL, "Error writing payload");
+
+	serial_cancel_read(serial);
+	pthread_join(producer_thread, &result);
+	ASSERT(result == NULL, "Error filling ring");
+	ASSERT(wakes > 0, "Ring was never full, payload too small");
+
+	serial_close(serial);
+	close(master);
+	free(ring);
+	free(payload);
+
+	printf("received %d bytes through a ring of %d bytes, %d notifications, %d producer wake ups\n",
+		PAYLOAD_SIZE, CAPACITY, notifications, wakes);
+	return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * Tests delimiter scanning: every kernel supported by the running CPU finds
+ * the same delimiters as the scalar kernel, at any alignment and size, and
+ * benchmarks kernels against each other on line-oriented data and on data
+ * without delimiters.
+ */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "akka_serial.h"
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+#define DATA_SIZE (1 << 20)
+#define LINE_SIZE 80
+#define ROUNDS 64
+
+static const char* names[] = {"auto", "scalar", "sse2", "avx2"};
+
+/* Counts the delimiters of data, scanning from one to the next. */
+static size_t count_lines(const char* data, size_t size)
+{
+	size_t lines = 0;
+	size_t i = 0;
+	while ((i += serial_scan(data + i, size - i, '\n', '\r')) < size) {
+		++lines;
+		++i;
+	}
+	return lines;
+}
+
+/* Scans data repeatedly, returning the throughput in MB/s. */
+static double benchmark(const char* data, size_t size, size_t expected)
+{
+	int64_t start = serial_timestamp();
+	for (int i = 0; i < ROUNDS; ++i) {
+		if (count_lines(data, size) != expected) return -1;
+	}
+	int64_t elapsed = serial_timestamp() - start;
+	return (double) size * ROUNDS * 1000 / (double) elapsed;
+}
+
+int main(void)
+{
+	char* data = malloc(DATA_SIZE + 64);
+	ASSERT(data != NULL, "Error allocating data");
+
+	// random data without delimiters, into which single delimiters are placed
+	srand(42);
+	for (size_t i = 0; i < DATA_SIZE + 64; ++i) {
+		char c = (char) (rand() % 256);
+		data[i] = (c == '\n' || c == '\r') ? 'x' : c;
+	}
+
+	ASSERT(serial_scan_kernel(-1) == -E_INVALID_SETTINGS, "Accepted unknown kernel");
+	int best = serial_scan_kernel(SCAN_AUTO);
+	ASSERT(best > 0, "Error selecting kernel");
+
+	for (int kernel = SCAN_SCALAR; kernel <= SCAN_AVX2; ++kernel) {
+		if (serial_scan_kernel(kernel) != kernel) continue;
+		for (size_t offset = 0; offset < 64; ++offset) {
+			for (size_t size = 0; size <= 130; ++size) {
+				char* d = data + offset;
+				ASSERT(serial_scan(d, size, '\n', '\r') == size, "Found a delimiter in data without any");
+				for (size_t at = 0; at < size; ++at) {
+					char saved = d[at];
+					d[at] = (at % 2) ? '\n' : '\r';
+					size_t found = serial_scan(d, size, '\n', '\r');
+					size_t single = serial_scan(d, size, d[at], d[at]);
+					d[at] = saved;
+					if (found != at || single != at) {
+						fprintf(stderr, "%s kernel found delimiter at %zu instead of %zu (offset %zu, size %zu)\n",
+							names[kernel], found, at, offset, size);
+						return 1;
+					}
+				}
+			}
+		}
+	}
+
+	// lines of printable characters, as sent by NMEA or AT devices
+	for (size_t i = 0; i < DATA_SIZE; ++i) {
+		data[i] = (i % LINE_SIZE == LINE_SIZE - 1) ? '\n' : (char) ('A' + i % 26);
+	}
+	size_t lines = DATA_SIZE / LINE_SIZE;
+	char* plain = malloc(DATA_SIZE);
+	ASSERT(plain != NULL, "Error allocating data");
+	memset(plain, 'x', DATA_SIZE);
+
+	for (int kernel = SCAN_SCALAR; kernel <= SCAN_AVX2; ++kernel) {
+		if (serial_scan_kernel(kernel) != kernel) {
+			printf("%-6s not supported\n", names[kernel]);
+			continue;
+		}
+		double lined = benchmark(data, DATA_SIZE, lines);
+		ASSERT(lined > 0, "Wrong number of lines");
+		double unlined = benchmark(plain, DATA_SIZE, 0);
+		ASSERT(unlined >= 0, "Found lines in data without any");
+		printf("%-6s %8.0f MB/s on %d-byte lines, %8.0f MB/s without delimiters\n",
+			names[kernel], lined, LINE_SIZE, unlined);
+	}
+	printf("default kernel: %s\n", names[best]);
+
+	free(plain);
+	free(data);
+	return 0;
+}
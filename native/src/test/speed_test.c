@@ -0,0 +1,46 @@
+/*
+ * Tests setting standard and non-standard baud rates on a pseudo terminal,
+ * which reports back any rate it is set to.
+ */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "akka_serial.h"
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+static int check_speed(const char* port, int baud)
+{
+	struct serial_config* serial;
+	ASSERT(serial_open(port, baud, 8, false, PARITY_NONE, &serial) == 0, "Error opening port");
+	int speed = serial_get_speed(serial);
+	serial_close(serial);
+	if (speed != baud) {
+		fprintf(stderr, "Requested %d baud, but port reports %d\n", baud, speed);
+		return 1;
+	}
+	return 0;
+}
+
+int main(void)
+{
+	int bauds[] = {9600, 115200, 250000, 921600, 1000000, 3000000, 12345};
+
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	ASSERT(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0, "Error opening pty");
+
+	for (size_t i = 0; i < sizeof(bauds) / sizeof(bauds[0]); ++i) {
+		if (check_speed(ptsname(master), bauds[i])) return 1;
+	}
+
+	struct serial_config* serial;
+	ASSERT(serial_open(ptsname(master), 0, 8, false, PARITY_NONE, &serial) == -E_INVALID_SETTINGS,
+		"Invalid baud rate was accepted");
+
+	close(master);
+	printf("set %zu baud rates\n", sizeof(bauds) / sizeof(bauds[0]));
+	return 0;
+}
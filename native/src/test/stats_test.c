@@ -0,0 +1,58 @@
+/*
+ * Tests statistics of ports: bytes and system calls of reads and writes,
+ * wakeups and cancellations are counted, and error counts are reported as
+ * unavailable for pseudo terminals, whose driver does not count them.
+ */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "akka_serial.h"
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+int main(void)
+{
+	char buffer[64];
+	struct serial_config* serial;
+	struct serial_stats stats;
+
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	ASSERT(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0, "Error opening pty");
+	ASSERT(serial_open(ptsname(master), 115200, 8, false, PARITY_NONE, &serial) == 0, "Error opening port");
+
+	ASSERT(serial_get_stats(serial, &stats) == 0, "Error getting statistics");
+	ASSERT(stats.bytes_read == 0 && stats.reads == 0 && stats.bytes_written == 0 && stats.writes == 0,
+		"Counted transfers of a new port");
+	ASSERT(stats.overruns == -1 && stats.frame_errors == -1, "Reported error counts of a pty");
+
+	// a blocking read waits once, then reads
+	ASSERT(write(master, "hello", 5) == 5, "Error writing to pty");
+	ASSERT(serial_read(serial, buffer, sizeof(buffer)) == 5, "Error reading from port");
+	usleep(10000);
+	ASSERT(write(master, "abc", 3) == 3, "Error writing to pty");
+	usleep(10000);
+	ASSERT(serial_try_read(serial, buffer, sizeof(buffer)) == 3, "Error reading without blocking");
+	ASSERT(serial_try_read(serial, buffer, sizeof(buffer)) == 0, "Read data that was not written");
+
+	ASSERT(serial_write(serial, "world", 5) == 5, "Error writing to port");
+
+	ASSERT(serial_get_stats(serial, &stats) == 0, "Error getting statistics");
+	ASSERT(stats.bytes_read == 8, "Wrong number of bytes read");
+	ASSERT(stats.reads == 2, "Wrong number of reads, empty reads are not counted");
+	ASSERT(stats.bytes_written == 5 && stats.writes == 1, "Wrong number of writes");
+	ASSERT(stats.wakeups >= 1, "No wakeup counted");
+	ASSERT(stats.cancels == 0, "Counted a cancellation");
+
+	ASSERT(serial_cancel_read(serial) == 0, "Error cancelling read");
+	ASSERT(serial_read(serial, buffer, sizeof(buffer)) == -E_INTERRUPT, "Read was not cancelled");
+	ASSERT(serial_get_stats(serial, &stats) == 0, "Error getting statistics");
+	ASSERT(stats.cancels == 1, "Cancellation not counted");
+
+	serial_close(serial);
+	close(master);
+	return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * Tests receive timestamps: the time at which data was read from a pseudo
+ * terminal lies between the time it was written and the time the read
+ * returned, for plain reads, non-blocking reads and reads into a ring.
+ */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "akka_serial.h"
+
+#define CAPACITY 4096
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+int main(void)
+{
+	char buffer[64];
+	struct serial_config* serial;
+
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	ASSERT(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0, "Error opening pty");
+	ASSERT(serial_open(ptsname(master), 115200, 8, false, PARITY_NONE, &serial) == 0, "Error opening port");
+	ASSERT(serial_read_timestamp(serial) == 0, "Timestamp set before reading");
+
+	int64_t written = serial_timestamp();
+	ASSERT(write(master, "hello", 5) == 5, "Error writing to pty");
+	ASSERT(serial_read(serial, buffer, sizeof(buffer)) == 5, "Error reading");
+	int64_t returned = serial_timestamp();
+	int64_t stamp = serial_read_timestamp(serial);
+	ASSERT(written <= stamp && stamp <= returned, "Read timestamp out of bounds");
+
+	written = serial_timestamp();
+	ASSERT(write(master, "hello", 5) == 5, "Error writing to pty");
+	usleep(10000);
+	ASSERT(serial_try_read(serial, buffer, sizeof(buffer)) == 5, "Error reading without blocking");
+	returned = serial_timestamp();
+	stamp = serial_read_timestamp(serial);
+	ASSERT(written <= stamp && stamp <= returned, "Non-blocking read timestamp out of bounds");
+
+	char* ring;
+	ASSERT(posix_memalign((void**) &ring, 64, RING_DATA + CAPACITY) == 0, "Error allocating ring");
+	memset(ring, 0, RING_DATA);
+	*(int32_t*) (ring + RING_CONSUMER_WAITING) = 1;
+
+	written = serial_timestamp();
+	ASSERT(write(master, "hello", 5) == 5, "Error writing to pty");
+	ASSERT(serial_ring_fill(serial, ring, CAPACITY) & RING_DATA_AVAILABLE, "Error filling ring");
+	returned = serial_timestamp();
+	stamp = *(int64_t*) (ring + RING_READ_TIMESTAMP);
+	ASSERT(written <= stamp && stamp <= returned, "Ring timestamp out of bounds");
+
+	free(ring);
+	serial_close(serial);
+	close(master);
+
+	printf("data read %lld ns before the read returned\n", (long long) (returned - stamp));
+	return 0;
+}
@@ -0,0 +1,260 @@
+/*
+ * Tests the transmit queue: a payload much larger than the kernel's
+ * transmission buffer is written to a pseudo terminal, without any write
+ * failing or data being lost. Writes that are not completely accepted are
+ * resumed once a blocked read reports that the queue has drained. Plain and
+ * gather writes are interleaved. The test is run with every available engine.
+ * A drain is also checked to be reported while data is received, as when a
+ * peer answers every chunk it receives, even if the queue drains just as data
+ * arrives. Finally, a drain is checked to be reported once by
+ * 'serial_take_drained' when the queue is flushed by non-blocking reads, as on
+ * a reactor.
+ */
+#define _XOPEN_SOURCE 600
+
+#include <errno.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include "akka_serial.h"
+
+#define PAYLOAD_SIZE (1024 * 1024)
+#define GATHER_BUFFERS 300
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+static struct serial_config* serial;
+static int master;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static int drained = 0;
+
+// blocks in serial_read, which drains the transmit queue, and counts drain notifications
+static void* reader(void* arg)
+{
+	char buffer[64];
+	(void) arg;
+	while (serial_read(serial, buffer, sizeof(buffer)) == 0) {
+		pthread_mutex_lock(&lock);
+		drained++;
+		pthread_cond_signal(&cond);
+		pthread_mutex_unlock(&lock);
+	}
+	return NULL;
+}
+
+// consumes data on the master side, checking its contents
+static void* consumer(void* arg)
+{
+	char buffer[4096];
+	size_t received = 0;
+	(void) arg;
+	while (received < PAYLOAD_SIZE) {
+		ssize_t n = read(master, buffer, sizeof(buffer));
+		if (n <= 0) break;
+		for (ssize_t i = 0; i < n; ++i) {
+			if ((unsigned char) buffer[i] != (received + i) % 251) {
+				fprintf(stderr, "Corrupt data at offset %zu\n", received + i);
+				return (void*) 1;
+			}
+		}
+		received += n;
+		usleep(100); // slower than the writer
+	}
+	return received == PAYLOAD_SIZE ? NULL : (void*) 1;
+}
+
+static int run(int engine)
+{
+	char* payload = malloc(PAYLOAD_SIZE);
+	for (size_t i = 0; i < PAYLOAD_SIZE; ++i) payload[i] = i % 251;
+
+	serial_engine(engine);
+	master = posix_openpt(O_RDWR | O_NOCTTY);
+	ASSERT(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0, "Error opening pty");
+	ASSERT(serial_open(ptsname(master), 115200, 8, false, PARITY_NONE, &serial) == 0, "Error opening port");
+	drained = 0;
+
+	pthread_t reader_thread, consumer_thread;
+	pthread_create(&reader_thread, NULL, reader, NULL);
+	pthread_create(&consumer_thread, NULL, consumer, NULL);
+
+	size_t offset = 0;
+	int blocked = 0;
+	while (offset < PAYLOAD_SIZE) {
+		// alternate between plain writes and gather writes of many small, uneven buffers
+		int n;
+		if (blocked % 2 == 0) {
+			n = serial_write(serial, payload + offset, PAYLOAD_SIZE - offset);
+		} else {
+			struct serial_buffer buffers[GATHER_BUFFERS];
+			size_t count = 0;
+			size_t end = offset;
+			while (count < GATHER_BUFFERS && end < PAYLOAD_SIZE) {
+				size_t size = 1 + (count * 37) % 1500;
+				if (size > PAYLOAD_SIZE - end) size = PAYLOAD_SIZE - end;
+				buffers[count].data = payload + end;
+				buffers[count].size = size;
+				end += size;
+				count++;
+			}
+			n = serial_writev(serial, buffers, count);
+		}
+		ASSERT(n >= 0, "Error writing");
+		offset += n;
+
+		if (offset < PAYLOAD_SIZE) {
+			// not completely accepted, wait for queue to drain
+			blocked++;
+			pthread_mutex_lock(&lock);
+			while (drained < blocked) pthread_cond_wait(&cond, &lock);
+			pthread_mutex_unlock(&lock);
+		}
+	}
+
+	void* result;
+	pthread_join(consumer_thread, &result);
+	ASSERT(result == NULL, "Data was lost or corrupted");
+	ASSERT(blocked > 0, "Writes were never blocked, payload too small");
+
+	int used = serial_get_engine(serial);
+	serial_cancel_read(serial);
+	pthread_join(reader_thread, NULL);
+	serial_close(serial);
+	close(master);
+	free(payload);
+
+	printf("engine %d: transmitted %d bytes, blocked %d times\n", used, PAYLOAD_SIZE, blocked);
+	return 0;
+}
+
+// consumes data on the master side and answers every chunk, including the last one
+static void* answerer(void* arg)
+{
+	char buffer[4096];
+	size_t received = 0;
+	(void) arg;
+	while (received < PAYLOAD_SIZE) {
+		ssize_t n = read(master, buffer, sizeof(buffer));
+		if (n <= 0) break;
+		received += n;
+		if (write(master, "a", 1) != 1) break;
+	}
+	return received == PAYLOAD_SIZE ? NULL : (void*) 1;
+}
+
+// blocks in serial_read, discarding data, and counts drain notifications
+static void* answer_reader(void* arg)
+{
+	char buffer[64];
+	(void) arg;
+	int n;
+	while ((n = serial_read(serial, buffer, sizeof(buffer))) >= 0) {
+		if (n > 0) continue;
+		pthread_mutex_lock(&lock);
+		drained++;
+		pthread_cond_signal(&cond);
+		pthread_mutex_unlock(&lock);
+	}
+	return NULL;
+}
+
+// writes to a peer that answers while the queue drains, every drain must still be reported
+static int run_answered(int engine)
+{
+	char* payload = malloc(PAYLOAD_SIZE);
+	memset(payload, 'x', PAYLOAD_SIZE);
+
+	serial_engine(engine);
+	master = posix_openpt(O_RDWR | O_NOCTTY);
+	ASSERT(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0, "Error opening pty");
+	ASSERT(serial_open(ptsname(master), 115200, 8, false, PARITY_NONE, &serial) == 0, "Error opening port");
+	drained = 0;
+
+	pthread_t reader_thread, answerer_thread;
+	pthread_create(&reader_thread, NULL, answer_reader, NULL);
+	pthread_create(&answerer_thread, NULL, answerer, NULL);
+
+	size_t offset = 0;
+	int blocked = 0;
+	while (offset < PAYLOAD_SIZE) {
+		int n = serial_write(serial, payload + offset, PAYLOAD_SIZE - offset);
+		ASSERT(n >= 0, "Error writing");
+		offset += n;
+
+		if (offset < PAYLOAD_SIZE) {
+			// a drain that is not reported stalls the writer, which is bounded here
+			blocked++;
+			struct timespec deadline;
+			clock_gettime(CLOCK_REALTIME, &deadline);
+			deadline.tv_sec += 5;
+			pthread_mutex_lock(&lock);
+			int r = 0;
+			while (drained < blocked && r != ETIMEDOUT) r = pthread_cond_timedwait(&cond, &lock, &deadline);
+			pthread_mutex_unlock(&lock);
+			ASSERT(r != ETIMEDOUT, "Drain was not reported while data was received");
+		}
+	}
+
+	void* result;
+	pthread_join(answerer_thread, &result);
+	ASSERT(result == NULL, "Data was lost");
+	ASSERT(blocked > 0, "Writes were never blocked, payload too small");
+
+	int used = serial_get_engine(serial);
+	serial_cancel_read(serial);
+	pthread_join(reader_thread, NULL);
+	serial_close(serial);
+	close(master);
+	free(payload);
+
+	printf("engine %d: answered writes blocked %d times\n", used, blocked);
+	return 0;
+}
+
+// flushes the transmit queue through non-blocking reads, which cannot report a drain themselves
+static int run_try_read(void)
+{
+	char* payload = malloc(PAYLOAD_SIZE);
+	memset(payload, 'x', PAYLOAD_SIZE);
+	char buffer[4096];
+
+	serial_engine(ENGINE_POLL);
+	master = posix_openpt(O_RDWR | O_NOCTTY);
+	ASSERT(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0, "Error opening pty");
+	ASSERT(serial_open(ptsname(master), 115200, 8, false, PARITY_NONE, &serial) == 0, "Error opening port");
+	ASSERT(serial_take_drained(serial) == 0, "Drain reported before any write");
+
+	int n = serial_write(serial, payload, PAYLOAD_SIZE);
+	ASSERT(n >= 0 && n < PAYLOAD_SIZE, "Write was not blocked, payload too small");
+
+	// whatever was queued is written by non-blocking reads as the master consumes it
+	size_t remaining = (size_t) serial_output_queued(serial);
+	int reads = 0;
+	while (serial_take_drained(serial) == 0) {
+		ASSERT(remaining > 0 && ++reads < 100000, "Drain was never reported");
+		ssize_t r = read(master, buffer, sizeof(buffer));
+		ASSERT(r > 0, "Error reading from master");
+		remaining -= (size_t) r;
+		ASSERT(serial_try_read(serial, buffer, sizeof(buffer)) == 0, "Unexpected data read");
+	}
+	ASSERT(serial_take_drained(serial) == 0, "Drain reported twice");
+
+	serial_close(serial);
+	close(master);
+	free(payload);
+
+	printf("try read: drain reported after %d reads\n", reads);
+	return 0;
+}
+
+int main(void)
+{
+	return run(ENGINE_POLL) || run(ENGINE_IO_URING) || run_answered(ENGINE_POLL) || run_answered(ENGINE_IO_URING)
+		|| run_try_read();
+}
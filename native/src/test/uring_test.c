@@ -0,0 +1,67 @@
+/*
+ * Tests reading through the io_uring engine: data written to a pseudo
+ * terminal is read, a blocked read is interrupted by a cancellation and a
+ * hung up terminal results in an error. The test passes trivially if
+ * io_uring is not available on the running system.
+ */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include "akka_serial.h"
+
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); return 1; }
+
+static void* cancel_later(void* serial)
+{
+	usleep(100000);
+	serial_cancel_read(serial);
+	return NULL;
+}
+
+static int open_pty(int* master, struct serial_config** serial)
+{
+	*master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (*master < 0 || grantpt(*master) < 0 || unlockpt(*master) < 0) return -1;
+	return serial_open(ptsname(*master), 115200, 8, false, PARITY_NONE, serial);
+}
+
+int main(void)
+{
+	struct serial_config* serial;
+	int master;
+	char buffer[64];
+
+	ASSERT(serial_engine(ENGINE_IO_URING) == 0, "Error selecting engine");
+	ASSERT(open_pty(&master, &serial) == 0, "Error opening pty");
+	if (serial_get_engine(serial) != ENGINE_IO_URING) {
+		printf("io_uring is not available, skipping\n");
+		return 0;
+	}
+
+	for (int i = 0; i < 100; ++i) {
+		ASSERT(write(master, "hello", 5) == 5, "Error writing to master");
+		int r = serial_read(serial, buffer, sizeof(buffer));
+		ASSERT(r == 5 && memcmp(buffer, "hello", 5) == 0, "Error reading data");
+	}
+
+	pthread_t canceller;
+	pthread_create(&canceller, NULL, cancel_later, serial);
+	ASSERT(serial_read(serial, buffer, sizeof(buffer)) == -E_INTERRUPT, "Read was not interrupted");
+	ASSERT(serial_read(serial, buffer, sizeof(buffer)) == -E_INTERRUPT, "Read after cancel was not interrupted");
+	pthread_join(canceller, NULL);
+	ASSERT(serial_close(serial) == 0, "Error closing port");
+	close(master);
+
+	ASSERT(open_pty(&master, &serial) == 0, "Error opening pty");
+	close(master);
+	ASSERT(serial_read(serial, buffer, sizeof(buffer)) == -E_IO, "Hangup was not reported");
+	serial_close(serial);
+
+	printf("io_uring engine passed\n");
+	return 0;
+}
@@ -0,0 +1,86 @@
+package akka.serial
+package samples.lines
+
+import scala.concurrent.Await
+import scala.concurrent.duration._
+import scala.io.StdIn
+
+import akka.NotUsed
+import akka.actor.ActorSystem
+import akka.stream.ActorMaterializer
+import akka.stream.scaladsl.{Flow, Framing, Sink, Source}
+import akka.util.ByteString
+
+import stream.Serial
+import sync.UnsafeSerial
+
+/**
+  * Measures the throughput of splitting NMEA-like data into lines, with `Serial.lines()` using
+  * each scan kernel of the native backend, against Akka's `Framing.delimiter()`, which scans byte
+  * by byte in the JVM. Data is generated in memory and cut into chunks as read from a port, no
+  * device is needed.
+  */
+object Main {
+
+  implicit val system = ActorSystem("lines")
+  implicit val materializer = ActorMaterializer()
+
+  def ask(label: String, default: String) = {
+    print(label + " [" + default.toString + "]: ")
+    val in = StdIn.readLine()
+    println("")
+    if (in.isEmpty) default else in
+  }
+
+  val Sentence = ByteString("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n")
+
+  /** Runs chunks through a splitter, returning the number of lines and the time taken in nanoseconds. */
+  def measure(chunks: List[ByteString], splitter: Flow[ByteString, ByteString, NotUsed]): (Int, Long) = {
+    val start = System.nanoTime()
+    val lines = Await.result(Source(chunks).via(splitter).runWith(Sink.fold(0)((n, _) => n + 1)), 1.minute)
+    (lines, System.nanoTime() - start)
+  }
+
+  def main(args: Array[String]): Unit = {
+    val sentences = ask("Sentences per run", "200000").toInt
+    val chunkSize = ask("Chunk size", "256").toInt
+    val runs = ask("Runs", "5").toInt
+
+    val data = (0 until sentences).foldLeft(ByteString.newBuilder)((b, _) => b ++= Sentence).result().compact
+    val chunks = data.grouped(chunkSize).toList
+
+    val kernels = List(
+      "scalar" -> UnsafeSerial.ScanScalar,
+      "sse2" -> UnsafeSerial.ScanSse2,
+      "avx2" -> UnsafeSerial.ScanAvx2
+    )
+    val splitters: List[(String, () => Flow[ByteString, ByteString, NotUsed])] =
+      kernels.map { case (name, kernel) =>
+        s"Serial.lines ($name)" -> { () =>
+          UnsafeSerial.scanKernel(kernel)
+          Serial.lines(256)
+        }
+      } :+ ("Framing.delimiter" -> { () =>
+        Framing.delimiter(ByteString("\r\n"), 256)
+      })
+
+    try {
+      for (run <- 0 to runs) {
+        if (run > 0) println(s"Run $run:")
+        for ((name, splitter) <- splitters) {
+          try {
+            val (lines, nanos) = measure(chunks, splitter())
+            if (lines != sentences) println(s"  $name split $lines lines instead of $sentences")
+            if (run > 0) println(f"  $name%-24s ${data.length * 1000.0 / nanos}%8.1f MB/s")
+          } catch {
+            case _: UnsupportedOperationException => if (run > 0) println(f"  $name%-24s not supported")
+          }
+        }
+      }
+    } finally {
+      UnsafeSerial.scanKernel(UnsafeSerial.ScanAuto)
+      system.terminate()
+    }
+  }
+
+}
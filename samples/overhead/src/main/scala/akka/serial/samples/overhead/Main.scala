@@ -0,0 +1,86 @@
+package akka.serial
+package samples.overhead
+
+import java.nio.ByteBuffer
+import scala.io.StdIn
+
+import sync.{ NativeBinding, SerialConnection, UnsafeSerial }
+
+/**
+  * Measures the per-call overhead of native calls, by calling non-blocking natives in a tight loop
+  * on a port that receives no data. Small-chunk workloads pay this overhead on every read and
+  * write, irrespective of the amount of data transferred. Calls are measured through JNI and, when
+  * running on JDK 22 or above, through the Foreign Function & Memory API.
+  */
+object Main {
+
+  def ask(label: String, default: String) = {
+    print(label + " [" + default.toString + "]: ")
+    val in = StdIn.readLine()
+    println("")
+    if (in.isEmpty) default else in
+  }
+
+  /** Runs a call repeatedly, returning the average time per call in nanoseconds. */
+  def measure(calls: Int)(call: => Int): Double = {
+    var sink = 0
+    val start = System.nanoTime()
+    var i = 0
+    while (i < calls) {
+      sink += call
+      i += 1
+    }
+    val elapsed = System.nanoTime() - start
+    if (sink != 0) println("Port received data, results are skewed.")
+    elapsed.toDouble / calls
+  }
+
+  /** Measures all benchmarks, after a first run that only warms up. */
+  def report(calls: Int, runs: Int, benchmarks: List[(String, () => Int)]): Unit = {
+    for (run <- 0 to runs) {
+      val results = benchmarks.map { case (name, call) => name -> measure(calls)(call()) }
+      if (run > 0) {
+        println(s"Run $run:")
+        for ((name, nanos) <- results) println(f"  $name%-28s $nanos%8.1f ns/call")
+      }
+    }
+  }
+
+  def main(args: Array[String]): Unit = {
+    val port = ask("Device (must not receive data)", "/dev/ttyS0")
+    val calls = ask("Calls per run", "1000000").toInt
+    val runs = ask("Runs", "5").toInt
+
+    val buffer = ByteBuffer.allocateDirect(64)
+
+    // the low-level wrapper, calling natives directly through each available binding
+    val foreign = if (NativeBinding.select(Binding.Foreign) == Binding.Foreign) Some(NativeBinding.current) else None
+    NativeBinding.select(Binding.Jni)
+    for (natives <- UnsafeSerial :: foreign.toList) {
+      println(s"Binding ${natives.binding}:")
+      val unsafe = new UnsafeSerial(natives.open(port, 115200, 8, false, 0), natives)
+      val registered = UnsafeSerial.register(buffer)
+      try {
+        report(calls, runs, List(
+          "inputQueued()" -> (() => unsafe.inputQueued()),
+          "tryRead(ByteBuffer)" -> (() => unsafe.tryRead(buffer)),
+          "tryRead(RegisteredBuffer)" -> (() => unsafe.tryRead(registered)),
+          "write(RegisteredBuffer, 0)" -> (() => unsafe.write(registered, 0))
+        ))
+      } finally {
+        unsafe.close()
+      }
+    }
+
+    // the thread-safe wrapper, which registers buffers it is passed
+    val connection = SerialConnection.open(port, SerialSettings(115200))
+    try {
+      report(calls, runs, List(
+        "SerialConnection.tryRead" -> (() => connection.tryRead(buffer))
+      ))
+    } finally {
+      connection.close()
+    }
+  }
+
+}
@@ -8,17 +8,13 @@ import scala.io.StdIn
 class Watcher extends Actor with ActorLogging {
   import context._
 
-  val ports = List(
-    "/dev/ttyUSB\\d+",
-    "/dev/ttyACM\\d+",
-    "/dev/cu\\d+",
-    "/dev/ttyS\\d+"
-  )
+  // serial devices, other devices are filtered out before reaching this actor
+  val ports = List("ttyUSB*", "ttyACM*", "cu*", "ttyS*").map(name => DeviceFilter(name = Some(name)))
 
   override def preStart() = {
-    val cmd = Serial.Watch()
+    val cmd = Serial.Watch(filters = ports)
     IO(Serial) ! cmd //watch for new devices
-    log.info(s"Watching ${cmd.directory} for new devices.")
+    log.info(s"Watching ${cmd.directory} for serial devices.")
   }
 
   def receive = {
@@ -28,11 +24,10 @@ class Watcher extends Actor with ActorLogging {
       context stop self
 
     case Serial.Connected(path) =>
-      log.info(s"New device: ${path}")
-      ports.find(path matches _) match {
-        case Some(port) => log.info(s"Device is a serial device.")
-        case None => log.warning(s"Device is NOT serial device.")
-      }
+      log.info(s"New serial device: ${path}")
+
+    case Serial.Disconnected(path) =>
+      log.info(s"Serial device removed: ${path}")
 
   }
 
@@ -4,6 +4,7 @@ package stream
 import akka.stream.scaladsl.Source
 import scala.concurrent.Future
 
+import akka.NotUsed
 import akka.actor.{Extension, ActorSystem, ExtendedActorSystem, ExtensionId, ExtensionIdProvider}
 import akka.io.IO
 import akka.stream.scaladsl.Flow
@@ -20,10 +21,42 @@ object Serial extends ExtensionId[Serial] with ExtensionIdProvider {
     */
   case class Connection(port: String, settings: SerialSettings)
 
+  /**
+    * Data received on a serial port, along with the times at which it passed each hop on its way
+    * downstream, see `Serial.openTimestamped()`. Timestamps are in nanoseconds of a monotonic
+    * clock (see `akka.serial.sync.SerialConnection.timestamp`).
+    *
+    * @param data data received on the port
+    * @param read time at which the data was read by the native backend
+    * @param returned time at which the native read returned to the JVM
+    * @param delivered time at which the data was delivered to the stream stage
+    * @param pushed time at which the data was pushed downstream
+    */
+  case class Timestamped(data: ByteString, read: Long, returned: Long, delivered: Long, pushed: Long)
+
   case class Watch(ports: Set[String])
 
   def apply()(implicit system: ActorSystem): Serial = super.apply(system)
 
+  /**
+    * Creates a Flow that splits bytes, such as those received from a serial port, into lines.
+    * Delimiters are searched by the native backend with vector instructions where the CPU supports
+    * them, several lines at a time, rather than byte by byte in the JVM.
+    *
+    * Lines are emitted without their delimiter, and empty lines are skipped. With both '\n' and
+    * '\r' as delimiters, as by default, lines may hence end with either of them or with "\r\n".
+    * An unterminated last line is emitted when upstream completes.
+    *
+    * @param maxLength maximum length of a line, the Flow fails with a `FramingException` on
+    * longer lines
+    * @param delimiters one or two bytes, either of which ends a line
+    * @return a Flow that emits one line per element
+    */
+  def lines(maxLength: Int, delimiters: Seq[Byte] = Seq('\n'.toByte, '\r'.toByte)): Flow[ByteString, ByteString, NotUsed] = {
+    require(delimiters.size == 1 || delimiters.size == 2, "one or two delimiters are required")
+    Flow.fromGraph(new LineSplitterStage(maxLength, delimiters.head, delimiters.last))
+  }
+
   override def lookup() = Serial
 
   override def createExtension(system: ExtendedActorSystem): Serial = new Serial(system)
@@ -43,7 +76,9 @@ class Serial(system: ExtendedActorSystem) extends Extension {
     * on the port will be emitted by its outlet.
     * @param port name of serial port to open
     * @param settings settings to use with serial port
-    * @param failOnOverflow when set, the returned Flow will fail when incoming data is dropped
+    * @param failOnOverflow when set, the returned Flow will fail when incoming data is dropped.
+    * Incoming data is never dropped if flow control is enabled in the settings, in which case
+    * the flow backpressures the serial device.
     * @param bufferSize maximum read and write buffer sizes
     * @return a Flow associated to the given serial port
     */
@@ -54,7 +89,30 @@ class Serial(system: ExtendedActorSystem) extends Extension {
       port,
       settings,
       failOnOverflow,
-      bufferSize
+      bufferSize,
+      SerialConnectionLogic.Data
+    )
+  )
+
+  /**
+    * Creates a Flow that will open a serial port when materialized, as `open()` does, however its
+    * outlet emits received data along with timestamps of each hop on the data's way downstream.
+    * These allow the latency of serial reads to be broken down.
+    * @param port name of serial port to open
+    * @param settings settings to use with serial port
+    * @param failOnOverflow when set, the returned Flow will fail when incoming data is dropped
+    * @param bufferSize maximum read and write buffer sizes
+    * @return a Flow associated to the given serial port
+    */
+  def openTimestamped(port: String, settings: SerialSettings, failOnOverflow: Boolean = false, bufferSize: Int = 1024):
+      Flow[ByteString, Serial.Timestamped, Future[Serial.Connection]] = Flow.fromGraph(
+    new SerialConnectionStage(
+      IO(CoreSerial)(system),
+      port,
+      settings,
+      failOnOverflow,
+      bufferSize,
+      SerialConnectionLogic.Timestamped
     )
   )
 
@@ -0,0 +1,85 @@
+package akka.serial
+package stream
+package impl
+
+import java.nio.Buffer
+
+import akka.stream.{Attributes, FlowShape, Inlet, Outlet}
+import akka.stream.scaladsl.Framing.FramingException
+import akka.stream.stage.{GraphStage, GraphStageLogic, InHandler, OutHandler}
+import akka.util.ByteString
+
+import sync.UnsafeSerial
+
+/**
+  * Graph stage that splits bytes into lines, see `Serial.lines()`. Each chunk is scanned for
+  * delimiters by the native backend, which reports the positions of many delimiters per call, so
+  * that lines are sliced out of chunks without inspecting their bytes in the JVM.
+  */
+private[stream] class LineSplitterStage(maxLength: Int, first: Byte, second: Byte)
+    extends GraphStage[FlowShape[ByteString, ByteString]] {
+
+  val in: Inlet[ByteString] = Inlet("LineSplitter.in")
+  val out: Outlet[ByteString] = Outlet("LineSplitter.out")
+
+  val shape: FlowShape[ByteString, ByteString] = FlowShape(in, out)
+
+  override def createLogic(inheritedAttributes: Attributes): GraphStageLogic =
+    new GraphStageLogic(shape) with InHandler with OutHandler {
+
+      // start of a line whose delimiter has not been received yet
+      private var partial = ByteString.empty
+
+      // positions of delimiters found by a single scan
+      private val positions = new Array[Int](64)
+
+      private def tooLong() = new FramingException(s"line longer than $maxLength bytes")
+
+      /** Splits a chunk into the lines it terminates, keeping its unterminated rest. */
+      private def split(chunk: ByteString): Vector[ByteString] = {
+        val lines = Vector.newBuilder[ByteString]
+        var start = 0 // start in chunk of the current line
+        var base = 0 // start in chunk of the buffer being scanned
+
+        for (buffer <- chunk.asByteBuffers) {
+          val origin = buffer.position
+          val size = buffer.remaining
+          var found = positions.length
+          while (found == positions.length) {
+            found = UnsafeSerial.scan(buffer, first, second, positions)
+            var i = 0
+            while (i < found) {
+              val end = base + positions(i) - origin
+              val line = if (partial.isEmpty) chunk.slice(start, end) else partial ++ chunk.slice(start, end)
+              partial = ByteString.empty
+              if (line.length > maxLength) throw tooLong()
+              if (line.nonEmpty) lines += line
+              start = end + 1
+              i += 1
+            }
+            if (found > 0) buffer.asInstanceOf[Buffer].position(positions(found - 1) + 1)
+          }
+          base += size
+        }
+
+        partial ++= chunk.drop(start)
+        if (partial.length > maxLength) throw tooLong()
+        lines.result()
+      }
+
+      override def onPush(): Unit = {
+        val lines = split(grab(in))
+        if (lines.isEmpty) pull(in) else emitMultiple(out, lines)
+      }
+
+      override def onPull(): Unit = pull(in)
+
+      override def onUpstreamFinish(): Unit = {
+        if (partial.nonEmpty) emit(out, partial)
+        complete(out)
+      }
+
+      setHandlers(in, out, this)
+    }
+
+}
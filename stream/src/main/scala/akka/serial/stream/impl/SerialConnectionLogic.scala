@@ -2,6 +2,7 @@ package akka.serial
 package stream
 package impl
 
+import scala.collection.immutable.Queue
 import scala.concurrent.Promise
 
 import akka.actor.{ActorRef, Terminated}
@@ -9,20 +10,27 @@ import akka.stream.{FlowShape, Inlet, Outlet}
 import akka.stream.stage.{GraphStageLogic, InHandler, OutHandler}
 import akka.util.ByteString
 
-import akka.serial.{Serial => CoreSerial, SerialSettings}
+import akka.serial.{Serial => CoreSerial, FlowControl, SerialSettings}
+import akka.serial.sync.SerialConnection
 
 /**
   * Graph logic that handles establishing and forwarding serial communication.
   * The underlying stream is closed when downstream (output) finishes,
   * upstream (input) closes are ignored.
+  *
+  * If flow control is enabled in the settings, reading is suspended while downstream does not
+  * demand data, so that the remote device is paused instead of data being dropped.
+  *
+  * @param element creates the elements pushed downstream from received data
   */
-private[stream] class SerialConnectionLogic(
-  shape: FlowShape[ByteString, ByteString],
+private[stream] class SerialConnectionLogic[Out](
+  shape: FlowShape[ByteString, Out],
   manager: ActorRef,
   port: String,
   settings: SerialSettings,
   failOnOverflow: Boolean,
   bufferSize: Int,
+  element: SerialConnectionLogic.Element[Out],
   connectionPromise: Promise[Serial.Connection])
     extends GraphStageLogic(shape) {
   import GraphStageLogic._
@@ -32,12 +40,22 @@ private[stream] class SerialConnectionLogic(
   private def in: Inlet[ByteString] = shape.in
 
   /** Receives data from the serial backend and pushes it downstream. */
-  private def out: Outlet[ByteString] = shape.out
+  private def out: Outlet[Out] = shape.out
 
   /** Implicit alias to stageActor so it will be used in "!" calls, without
     * explicitly specifying a sender. */
   implicit private def self = stageActor.ref
 
+  /** Backpressure is propagated to the device, rather than dropping data. */
+  private val backpressure = settings.flowControl != FlowControl.None
+
+  /** Data received while downstream did not demand any, along with the time it was delivered to
+    * this stage. Reading is suspended meanwhile. */
+  private var buffered = Queue.empty[Buffered]
+
+  /** Current time, if elements are timestamped. */
+  private def now: Long = if (element.timestamped) SerialConnection.timestamp else 0L
+
   /**
     * Input handler for an established connection.
     * @param operator the operator actor of the established connection
@@ -63,9 +81,14 @@ private[stream] class SerialConnectionLogic(
     implicit val self = stageActor.ref
 
     override def onPull(): Unit = {
-      // serial connections are at the end of the "backpressure chain",
+      // without flow control, serial connections are at the end of the "backpressure chain",
       // they do not natively support backpressure (as does TCP for example)
-      // therefore nothing is done here
+      if (buffered.nonEmpty) {
+        val (received, rest) = buffered.dequeue
+        push(out, element(received.data, received.timestamps, received.delivered, now))
+        buffered = rest
+        if (buffered.isEmpty) operator ! CoreSerial.ResumeReading
+      }
     }
 
     override def onDownstreamFinish(): Unit = {
@@ -79,7 +102,7 @@ private[stream] class SerialConnectionLogic(
     setKeepGoing(true) // serial connection operator will manage completing stage
     getStageActor(connecting)
     stageActor watch manager
-    manager ! CoreSerial.Open(port, settings, bufferSize)
+    manager ! CoreSerial.Open(port, settings, bufferSize, timestamped = element.timestamped)
   }
 
   setHandler(in, IgnoreTerminateInput)
@@ -137,19 +160,18 @@ private[stream] class SerialConnectionLogic(
         failStage(new StreamSerialException(s"Serial command [$cmd] failed.", reason))
 
       case CoreSerial.Closed =>
-        completeStage()
+        if (buffered.nonEmpty) {
+          val elements = buffered.iterator.map(received => element(received.data, received.timestamps, received.delivered, now))
+          emitMultiple(out, elements, () => completeStage())
+        } else {
+          completeStage()
+        }
 
       case CoreSerial.Received(data) =>
-        if (isAvailable(out)) {
-          push(out, data)
-        } else if (failOnOverflow) {
-          /* Note that the native backend does not provide any way of informing about dropped serial
-           * data. However, in most cases, a computer capable of running akka-serial is also capable
-           * of processing incoming serial data at typical baud rates. Hence packets will usually
-           * only be dropped if an application that uses akka-serial backpressures, which can
-           * however be detected here. */
-          failStage(new StreamSerialException("Incoming serial data was dropped."))
-        }
+        receive(operator, data, CoreSerial.ReceiveTimestamps.Unknown)
+
+      case CoreSerial.ReceivedTimestamped(data, timestamps) =>
+        receive(operator, data, timestamps)
 
       case WriteAck =>
         if (!isClosed(in)) {
@@ -163,10 +185,60 @@ private[stream] class SerialConnectionLogic(
 
   }
 
+  /** Pushes received data downstream, or buffers it until demanded. */
+  private def receive(operator: ActorRef, data: ByteString, timestamps: CoreSerial.ReceiveTimestamps): Unit = {
+    val delivered = now
+    if (isAvailable(out)) {
+      push(out, element(data, timestamps, delivered, now))
+    } else if (backpressure) {
+      // data that was already being read when reading was suspended is still received
+      if (buffered.isEmpty) operator ! CoreSerial.SuspendReading
+      buffered = buffered.enqueue(Buffered(data, timestamps, delivered))
+    } else if (failOnOverflow) {
+      /* Note that the native backend only informs about serial data dropped before it was read
+       * through the counts of `Serial.GetStats`. However, in most cases, a computer capable of
+       * running akka-serial is also capable of processing incoming serial data at typical baud
+       * rates. Hence packets will usually only be dropped if an application that uses
+       * akka-serial backpressures, which can however be detected here. */
+      failStage(new StreamSerialException("Incoming serial data was dropped."))
+    }
+  }
+
 }
 
 private[stream] object SerialConnectionLogic {
 
   case object WriteAck extends CoreSerial.Event
 
+  /** Data received while downstream did not demand any, delivered to the stage at the given time. */
+  case class Buffered(data: ByteString, timestamps: CoreSerial.ReceiveTimestamps, delivered: Long)
+
+  /** Creates the elements pushed by a serial connection stage from received data. */
+  trait Element[Out] {
+
+    /** Set if elements carry timestamps, which are otherwise not taken. */
+    def timestamped: Boolean
+
+    /**
+      * @param data data received from the operator
+      * @param timestamps times at which the data was read, unknown unless elements are timestamped
+      * @param delivered time at which the data was delivered to the stage
+      * @param pushed time at which the element is pushed downstream
+      */
+    def apply(data: ByteString, timestamps: CoreSerial.ReceiveTimestamps, delivered: Long, pushed: Long): Out
+  }
+
+  /** Elements consisting of received data only. */
+  object Data extends Element[ByteString] {
+    def timestamped = false
+    def apply(data: ByteString, timestamps: CoreSerial.ReceiveTimestamps, delivered: Long, pushed: Long) = data
+  }
+
+  /** Elements carrying timestamps of each hop. */
+  object Timestamped extends Element[Serial.Timestamped] {
+    def timestamped = true
+    def apply(data: ByteString, timestamps: CoreSerial.ReceiveTimestamps, delivered: Long, pushed: Long) =
+      Serial.Timestamped(data, timestamps.read, timestamps.returned, delivered, pushed)
+  }
+
 }
@@ -13,18 +13,19 @@ import akka.util.ByteString
   * Graph stage that establishes and thereby materializes a serial connection.
   * The actual connection logic is deferred to [[SerialConnectionLogic]].
   */
-private[stream] class SerialConnectionStage(
+private[stream] class SerialConnectionStage[Out](
   manager: ActorRef,
   port: String,
   settings: SerialSettings,
   failOnOverflow: Boolean,
-  bufferSize: Int
-) extends GraphStageWithMaterializedValue[FlowShape[ByteString, ByteString], Future[Serial.Connection]] {
+  bufferSize: Int,
+  element: SerialConnectionLogic.Element[Out]
+) extends GraphStageWithMaterializedValue[FlowShape[ByteString, Out], Future[Serial.Connection]] {
 
   val in: Inlet[ByteString] = Inlet("Serial.in")
-  val out: Outlet[ByteString] = Outlet("Serial.out")
+  val out: Outlet[Out] = Outlet("Serial.out")
 
-  val shape: FlowShape[ByteString, ByteString] = FlowShape(in, out)
+  val shape: FlowShape[ByteString, Out] = FlowShape(in, out)
 
   override def createLogicAndMaterializedValue(inheritedAttributes: Attributes):
       (GraphStageLogic, Future[Serial.Connection]) = {
@@ -38,6 +39,7 @@ private[stream] class SerialConnectionStage(
       settings,
       failOnOverflow,
       bufferSize,
+      element,
       connectionPromise
     )
 
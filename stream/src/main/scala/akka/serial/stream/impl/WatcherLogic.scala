@@ -22,8 +22,9 @@ private[stream] class WatcherLogic(
   override def preStart(): Unit = {
     getStageActor(receive)
     stageActor watch ioManager
-    for (dir <- WatcherLogic.getDirs(ports)) {
-      ioManager ! CoreSerial.Watch(dir, skipInitial = false)
+    // only the watched ports are reported, they are selected by the native backend where possible
+    for ((dir, names) <- WatcherLogic.getNames(ports)) {
+      ioManager ! CoreSerial.Watch(dir, skipInitial = false, filters = names.toSeq.map(DeviceFilter.named))
     }
   }
 
@@ -52,6 +53,8 @@ private[stream] class WatcherLogic(
           }
         }
 
+      case CoreSerial.Disconnected(_) => // only connections are emitted
+
       case other =>
         failStage(new StreamWatcherException(s"Stage actor received unkown message [$other]"))
 
@@ -61,5 +64,7 @@ private[stream] class WatcherLogic(
 }
 
 private[stream] object WatcherLogic {
-  def getDirs(ports: Set[String]): Set[String] = ports.map(_.split("/").init.mkString("/"))
+  /** Names of ports, grouped by their directory. */
+  def getNames(ports: Set[String]): Map[String, Set[String]] =
+    ports.groupBy(_.split("/").init.mkString("/")).map { case (dir, paths) => dir -> paths.map(_.split("/").last) }
 }
@@ -34,6 +34,42 @@ class SerialSpec extends WordSpec with BeforeAndAfterAll with PseudoTerminal {
       }
     }
 
+    "stamp received data at every hop" in {
+      withEcho { case (port, settings) =>
+        val start = System.nanoTime
+        val graph = Source.single(data)
+          .via(Serial().openTimestamped(port, settings))
+          .toMat(Sink.head)(Keep.right)
+
+        val element = Await.result(graph.run(), 2.seconds)
+        assert(start <= element.read)
+        assert(element.read <= element.returned)
+        assert(element.returned <= element.delivered)
+        assert(element.delivered <= element.pushed)
+      }
+    }
+
+    "split data into lines across chunks" in {
+      val chunks = List("$GPGGA,1\r", "\n$GPRMC", ",2\r\n\r\n", "x" * 100 + "\n", "last").map(ByteString(_))
+      val graph = Source(chunks)
+        .via(Serial.lines(128))
+        .map(_.utf8String)
+        .toMat(Sink.seq)(Keep.right)
+
+      val lines = Await.result(graph.run(), 2.seconds)
+      assert(lines == Seq("$GPGGA,1", "$GPRMC,2", "x" * 100, "last"))
+    }
+
+    "fail on lines longer than the maximum length" in {
+      val graph = Source.single(ByteString("x" * 200 + "\n"))
+        .via(Serial.lines(128))
+        .toMat(Sink.seq)(Keep.right)
+
+      intercept[akka.stream.scaladsl.Framing.FramingException] {
+        Await.result(graph.run(), 2.seconds)
+      }
+    }
+
     "fail if the underlying pty fails" in {
       val result = withEcho { case (port, settings) =>
         Source.single(data)
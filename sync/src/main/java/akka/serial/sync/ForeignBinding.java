@@ -0,0 +1,21 @@
+package akka.serial.sync;
+
+/**
+ * Binding to the native backend through the Foreign Function & Memory API, which requires JDK 22
+ * or above. This is the version for older JDKs, on which the binding is not available; the actual
+ * binding is packaged under META-INF/versions/22 of the multi-release jar.
+ */
+final class ForeignBinding {
+
+    private ForeignBinding() {}
+
+    /**
+     * Gets the foreign binding.
+     *
+     * @return null, since the binding is not available on this JDK
+     */
+    static NativeBinding create() {
+        return null;
+    }
+
+}
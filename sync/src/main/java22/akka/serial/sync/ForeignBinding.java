@@ -0,0 +1,328 @@
+package akka.serial.sync;
+
+import java.io.IOException;
+import java.lang.foreign.Arena;
+import java.lang.foreign.FunctionDescriptor;
+import java.lang.foreign.Linker;
+import java.lang.foreign.MemorySegment;
+import java.lang.foreign.SymbolLookup;
+import java.lang.foreign.ValueLayout;
+import java.lang.invoke.MethodHandle;
+import java.nio.ByteBuffer;
+
+import akka.serial.AccessDeniedException;
+import akka.serial.Binding$;
+import akka.serial.InvalidSettingsException;
+import akka.serial.NoSuchPortException;
+import akka.serial.PortInUseException;
+import akka.serial.PortInterruptedException;
+import scala.Enumeration;
+
+/**
+ * Binding to the native backend through the Foreign Function & Memory API, calling the C API of
+ * akka_serial.h directly instead of going through akka_serial_jni.c.
+ *
+ * Calls that never block are linked as critical, i.e. the calling thread does not transition out
+ * of Java, which makes small non-blocking reads and writes cheaper than through JNI. Blocking
+ * calls are linked as regular downcalls, so that they do not hold up garbage collection. Calls
+ * off the data path are delegated to the JNI binding; both share the library loaded by
+ * UnsafeSerial.
+ *
+ * This is the version for JDK 22 and above, packaged under META-INF/versions/22 of the
+ * multi-release jar.
+ */
+final class ForeignBinding implements NativeBinding {
+
+    // error codes of akka_serial.h
+    private static final int E_IO = 1;
+    private static final int E_ACCESS_DENIED = 2;
+    private static final int E_BUSY = 3;
+    private static final int E_INVALID_SETTINGS = 4;
+    private static final int E_INTERRUPT = 5;
+    private static final int E_NO_PORT = 6;
+    private static final int E_UNSUPPORTED = 7;
+
+    private static final ValueLayout.OfLong SIZE_T = ValueLayout.JAVA_LONG;
+
+    private final NativeBinding jni;
+
+    private final MethodHandle open;
+    private final MethodHandle read;
+    private final MethodHandle tryRead;
+    private final MethodHandle readTimestamp;
+    private final MethodHandle cancelRead;
+    private final MethodHandle write;
+    private final MethodHandle inputQueued;
+    private final MethodHandle outputQueued;
+    private final MethodHandle close;
+
+    private ForeignBinding(NativeBinding jni) {
+        this.jni = jni;
+
+        Linker linker = Linker.nativeLinker();
+        SymbolLookup lookup = SymbolLookup.loaderLookup();
+        Linker.Option critical = Linker.Option.critical(false);
+        ValueLayout address = ValueLayout.ADDRESS;
+        ValueLayout.OfInt integer = ValueLayout.JAVA_INT;
+
+        open = linker.downcallHandle(lookup.find("serial_open").orElseThrow(), FunctionDescriptor.of(
+            integer, address, integer, integer, ValueLayout.JAVA_BOOLEAN, integer, address));
+        read = linker.downcallHandle(lookup.find("serial_read").orElseThrow(), FunctionDescriptor.of(
+            integer, address, address, SIZE_T));
+        tryRead = linker.downcallHandle(lookup.find("serial_try_read").orElseThrow(), FunctionDescriptor.of(
+            integer, address, address, SIZE_T), critical);
+        readTimestamp = linker.downcallHandle(lookup.find("serial_read_timestamp").orElseThrow(), FunctionDescriptor.of(
+            ValueLayout.JAVA_LONG, address), critical);
+        cancelRead = linker.downcallHandle(lookup.find("serial_cancel_read").orElseThrow(), FunctionDescriptor.of(
+            integer, address));
+        write = linker.downcallHandle(lookup.find("serial_write").orElseThrow(), FunctionDescriptor.of(
+            integer, address, address, SIZE_T), critical);
+        inputQueued = linker.downcallHandle(lookup.find("serial_input_queued").orElseThrow(), FunctionDescriptor.of(
+            integer, address), critical);
+        outputQueued = linker.downcallHandle(lookup.find("serial_output_queued").orElseThrow(), FunctionDescriptor.of(
+            integer, address), critical);
+        close = linker.downcallHandle(lookup.find("serial_close").orElseThrow(), FunctionDescriptor.of(
+            integer, address));
+    }
+
+    private static final class Holder {
+        static final ForeignBinding INSTANCE = link();
+    }
+
+    private static ForeignBinding link() {
+        try {
+            // initializing the JNI binding loads the library, whose symbols are then looked up
+            return new ForeignBinding(UnsafeSerial$.MODULE$);
+        } catch (RuntimeException e) {
+            // symbols not found, or native access denied to this module
+            return null;
+        }
+    }
+
+    /**
+     * Gets the foreign binding.
+     *
+     * @return the binding, null if the native library cannot be linked
+     */
+    static NativeBinding create() {
+        return Holder.INSTANCE;
+    }
+
+    /* Exceptions of the native backend are checked in Java, however NativeBinding is declared in
+     * Scala and hence does not declare them. They are thrown as is, without being wrapped. */
+    @SuppressWarnings("unchecked")
+    private static <T extends Throwable> T unchecked(Throwable t) throws T {
+        throw (T) t;
+    }
+
+    /** Checks a return code and throws the corresponding exception if it is negative. */
+    private static int check(int ret) {
+        if (ret >= 0) return ret;
+        Exception e;
+        switch (-ret) {
+        case E_ACCESS_DENIED: e = new AccessDeniedException(""); break;
+        case E_BUSY: e = new PortInUseException(""); break;
+        case E_INVALID_SETTINGS: e = new InvalidSettingsException(""); break;
+        case E_INTERRUPT: e = new PortInterruptedException(""); break;
+        case E_NO_PORT: e = new NoSuchPortException(""); break;
+        case E_UNSUPPORTED: e = new UnsupportedOperationException(""); break;
+        case E_IO:
+        default: e = new IOException(""); break;
+        }
+        throw ForeignBinding.<RuntimeException>unchecked(e);
+    }
+
+    /** Gets the address of the memory of a direct buffer, irrespective of its position. */
+    private static long address(ByteBuffer buffer) {
+        if (!buffer.isDirect()) throw new IllegalArgumentException("buffer is not direct");
+        return MemorySegment.ofBuffer(buffer).address() - buffer.position();
+    }
+
+    private static MemorySegment pointer(long address) {
+        return MemorySegment.ofAddress(address);
+    }
+
+    @Override
+    public Enumeration.Value binding() {
+        return Binding$.MODULE$.Foreign();
+    }
+
+    @Override
+    public long open(String port, int baud, int characterSize, boolean twoStopBits, int parity) {
+        try (Arena arena = Arena.ofConfined()) {
+            MemorySegment serial = arena.allocate(ValueLayout.ADDRESS);
+            check((int) open.invokeExact(arena.allocateFrom(port), baud, characterSize, twoStopBits, parity, serial));
+            return serial.get(ValueLayout.ADDRESS, 0).address();
+        } catch (Throwable t) {
+            throw ForeignBinding.<RuntimeException>unchecked(t);
+        }
+    }
+
+    @Override
+    public int read(long serial, ByteBuffer buffer) {
+        return readAddress(serial, address(buffer), buffer.capacity());
+    }
+
+    @Override
+    public int readAddress(long serial, long address, int size) {
+        try {
+            return check((int) read.invokeExact(pointer(serial), pointer(address), (long) size));
+        } catch (Throwable t) {
+            throw ForeignBinding.<RuntimeException>unchecked(t);
+        }
+    }
+
+    @Override
+    public int tryRead(long serial, ByteBuffer buffer) {
+        return tryReadAddress(serial, address(buffer), buffer.capacity());
+    }
+
+    @Override
+    public int tryReadAddress(long serial, long address, int size) {
+        try {
+            return check((int) tryRead.invokeExact(pointer(serial), pointer(address), (long) size));
+        } catch (Throwable t) {
+            throw ForeignBinding.<RuntimeException>unchecked(t);
+        }
+    }
+
+    @Override
+    public boolean takeDrained(long serial) {
+        return jni.takeDrained(serial);
+    }
+
+    @Override
+    public long readTimestamp(long serial) {
+        try {
+            return (long) readTimestamp.invokeExact(pointer(serial));
+        } catch (Throwable t) {
+            throw ForeignBinding.<RuntimeException>unchecked(t);
+        }
+    }
+
+    @Override
+    public void cancelRead(long serial) {
+        try {
+            check((int) cancelRead.invokeExact(pointer(serial)));
+        } catch (Throwable t) {
+            throw ForeignBinding.<RuntimeException>unchecked(t);
+        }
+    }
+
+    @Override
+    public int write(long serial, ByteBuffer buffer, int length) {
+        return writeAddress(serial, address(buffer), length);
+    }
+
+    @Override
+    public int writeAddress(long serial, long address, int length) {
+        try {
+            return check((int) write.invokeExact(pointer(serial), pointer(address), (long) length));
+        } catch (Throwable t) {
+            throw ForeignBinding.<RuntimeException>unchecked(t);
+        }
+    }
+
+    @Override
+    public int inputQueued(long serial) {
+        try {
+            return check((int) inputQueued.invokeExact(pointer(serial)));
+        } catch (Throwable t) {
+            throw ForeignBinding.<RuntimeException>unchecked(t);
+        }
+    }
+
+    @Override
+    public int outputQueued(long serial) {
+        try {
+            return check((int) outputQueued.invokeExact(pointer(serial)));
+        } catch (Throwable t) {
+            throw ForeignBinding.<RuntimeException>unchecked(t);
+        }
+    }
+
+    @Override
+    public void close(long serial) {
+        try {
+            check((int) close.invokeExact(pointer(serial)));
+        } catch (Throwable t) {
+            throw ForeignBinding.<RuntimeException>unchecked(t);
+        }
+    }
+
+    // calls off the data path, delegated to JNI
+
+    @Override
+    public void setReadCoalescing(long serial, int minSize, int timeout) {
+        jni.setReadCoalescing(serial, minSize, timeout);
+    }
+
+    @Override
+    public void setFlowControl(long serial, int flow) {
+        jni.setFlowControl(serial, flow);
+    }
+
+    @Override
+    public void suspendReading(long serial, boolean suspended) {
+        jni.suspendReading(serial, suspended);
+    }
+
+    @Override
+    public void setFraming(long serial, int kind, int maxSize, byte[] delimiter, boolean stripDelimiter,
+            int lengthOffset, int lengthWidth, boolean bigEndian, int lengthAdjustment,
+            int checksum, int checksumOffset, boolean checksumBigEndian, int gap) {
+        jni.setFraming(serial, kind, maxSize, delimiter, stripDelimiter, lengthOffset, lengthWidth, bigEndian,
+            lengthAdjustment, checksum, checksumOffset, checksumBigEndian, gap);
+    }
+
+    @Override
+    public int fill(long serial, ByteBuffer ring) {
+        return jni.fill(serial, ring);
+    }
+
+    @Override
+    public void wakeRing(long serial) {
+        jni.wakeRing(serial);
+    }
+
+    @Override
+    public int tryReadArray(long serial, byte[] array, int offset, int length) {
+        return jni.tryReadArray(serial, array, offset, length);
+    }
+
+    @Override
+    public int writev(long serial, ByteBuffer[] buffers) {
+        return jni.writev(serial, buffers);
+    }
+
+    @Override
+    public long drain(long serial) {
+        return jni.drain(serial);
+    }
+
+    @Override
+    public int readEngine(long serial) {
+        return jni.readEngine(serial);
+    }
+
+    @Override
+    public int speed(long serial) {
+        return jni.speed(serial);
+    }
+
+    @Override
+    public void stats(long serial, long[] values) {
+        jni.stats(serial, values);
+    }
+
+    @Override
+    public int lowLatency(long serial) {
+        return jni.lowLatency(serial);
+    }
+
+    @Override
+    public int latencyTimer(long serial) {
+        return jni.latencyTimer(serial);
+    }
+
+}
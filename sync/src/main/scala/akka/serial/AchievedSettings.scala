@@ -0,0 +1,12 @@
+package akka.serial
+
+import scala.concurrent.duration.FiniteDuration
+
+/**
+ * Settings actually in effect on an open serial port. Depending on the port's hardware and
+ * driver, these may differ from the requested `SerialSettings`.
+ * @param baud baud rate actually used by the port
+ * @param lowLatency set if the driver's low-latency flag has been set
+ * @param latencyTimer latency timer of the USB adapter behind the port, if it has one
+ */
+case class AchievedSettings(baud: Int, lowLatency: Boolean, latencyTimer: Option[FiniteDuration])
@@ -0,0 +1,15 @@
+package akka.serial
+
+/**
+ * Specifies available bindings through which the native backend is called.
+ *
+ * `Jni` calls the backend through JNI and is always available. `Foreign` calls the backend's C
+ * API directly through the Foreign Function & Memory API, which spares non-blocking calls such as
+ * small writes the transitions of JNI. It requires JDK 22 or above; ports fall back to `Jni` on
+ * older runtimes.
+ */
+object Binding extends Enumeration {
+  type Binding = Value
+  val Jni = Value(0)
+  val Foreign = Value(1)
+}
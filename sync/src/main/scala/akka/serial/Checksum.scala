@@ -0,0 +1,36 @@
+package akka.serial
+
+import java.nio.ByteBuffer
+
+import sync.UnsafeSerial
+
+/**
+ * Specifies checksums computed by the native backend, used to verify frames (see
+ * `Framing.Checked`) or to compute checksums of data to send.
+ *
+ * `Crc16` is the CRC-16 of Modbus RTU, `Crc16Ccitt` the CRC-16/CCITT-FALSE of many other
+ * protocols, `Crc32` the CRC-32 of Ethernet and zlib, and `Lrc` the longitudinal redundancy check
+ * of Modbus ASCII, i.e. the negated sum of all bytes. CRCs are computed eight bytes at a time, and
+ * CRC-32 by carry-less multiplication on CPUs that support it.
+ */
+object Checksum extends Enumeration {
+  type Checksum = Value
+  val Crc16 = Value(1)
+  val Crc16Ccitt = Value(2)
+  val Crc32 = Value(3)
+  val Lrc = Value(4)
+
+  /** Size in bytes of a checksum, as transmitted in frames. */
+  def size(checksum: Checksum): Int = checksum match {
+    case Crc16 | Crc16Ccitt => 2
+    case Crc32 => 4
+    case _ => 1
+  }
+
+  /**
+   * Computes the checksum of the data of a buffer, between its position and its limit. The
+   * buffer's position is not changed. Direct buffers and buffers backed by an array are supported.
+   */
+  def compute(checksum: Checksum, buffer: ByteBuffer): Long = UnsafeSerial.checksum(checksum.id, buffer)
+
+}
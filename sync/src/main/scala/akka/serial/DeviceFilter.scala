@@ -0,0 +1,39 @@
+package akka.serial
+
+/**
+ * Selects the devices reported when watching for ports. A device matches a filter if it matches
+ * all of the filter's criteria, criteria that are not set match any device.
+ *
+ * Attributes of USB devices are those of the USB device behind a port, such as an adapter plugged
+ * into a USB port. These are evaluated by the native backend, where it monitors devices (Linux).
+ *
+ * @param subsystem kernel subsystem of the device, "tty" for serial ports
+ * @param name shell pattern of the name of the device's node, e.g. "ttyUSB*"
+ * @param vendor vendor id of the USB device, e.g. 0x0403 for FTDI
+ * @param product product id of the USB device
+ * @param serial serial number of the USB device
+ */
+case class DeviceFilter(
+  subsystem: Option[String] = Some("tty"),
+  name: Option[String] = None,
+  vendor: Option[Int] = None,
+  product: Option[Int] = None,
+  serial: Option[String] = None
+) {
+
+  /** Set if this filter selects devices by attributes of their USB device. */
+  def usb: Boolean = vendor.isDefined || product.isDefined || serial.isDefined
+
+}
+
+object DeviceFilter {
+
+  /**
+   * Selects the device whose node has the given name, as opposed to a pattern of names, of any
+   * subsystem.
+   * @param name name of the device's node, e.g. "ttyUSB0"
+   */
+  def named(name: String): DeviceFilter =
+    DeviceFilter(subsystem = None, name = Some(name.replaceAll("""([*?\[\\])""", """\\$1""")))
+
+}
@@ -0,0 +1,32 @@
+package akka.serial
+
+/**
+ * Attributes of a serial device, as reported by the kernel (sysfs on Linux). Attributes of USB
+ * devices are those of the USB device behind a port, such as an adapter plugged into a USB port,
+ * and are not set for other ports.
+ *
+ * @param devpath path of the device in sysfs, which identifies the physical port it is plugged into
+ * @param driver name of the device's driver, e.g. "ftdi_sio" or "cdc_acm"
+ * @param vendor vendor id of the USB device, e.g. 0x0403 for FTDI
+ * @param product product id of the USB device
+ * @param serial serial number of the USB device
+ * @param manufacturer manufacturer string of the USB device
+ * @param description product string of the USB device
+ */
+case class DeviceInfo(
+  devpath: String,
+  driver: Option[String] = None,
+  vendor: Option[Int] = None,
+  product: Option[Int] = None,
+  serial: Option[String] = None,
+  manufacturer: Option[String] = None,
+  description: Option[String] = None
+) {
+
+  /** Checks if this device matches the given filter, other than by its name or subsystem. */
+  def matches(filter: DeviceFilter): Boolean =
+    filter.vendor.forall(vendor.contains) &&
+      filter.product.forall(product.contains) &&
+      filter.serial.forall(serial.contains)
+
+}
@@ -0,0 +1,15 @@
+package akka.serial
+
+/**
+ * Specifies available engines used by the native backend to read from serial ports.
+ *
+ * `Poll` waits for data to become available and then reads it, requiring two system calls per
+ * read. `IoUring` submits a poll linked to a read through io_uring, and waits for its completion
+ * in a single system call. It is only available on Linux 5.17 and above; ports fall back to `Poll`
+ * on other systems.
+ */
+object Engine extends Enumeration {
+  type Engine = Value
+  val Poll = Value(0)
+  val IoUring = Value(1)
+}
@@ -0,0 +1,11 @@
+package akka.serial
+
+/** Specifies available kinds of flow control used in serial communication. */
+object FlowControl extends Enumeration {
+  type FlowControl = Value
+  val None = Value(0)
+  /** RTS/CTS hardware handshaking. */
+  val Hardware = Value(1)
+  /** XON/XOFF software handshaking, the control characters are consumed by the driver. */
+  val Software = Value(2)
+}
@@ -0,0 +1,85 @@
+package akka.serial
+
+import scala.concurrent.duration._
+
+/**
+ * Framing of data received from a serial port. With framing, the native backend accumulates
+ * received data and every read returns exactly one whole frame, so that frames arrive in one
+ * piece rather than split across or merged into arbitrary chunks. Data that cannot be part of a
+ * valid frame is discarded until the next possible start of a frame.
+ */
+sealed trait Framing {
+  /** Maximum size of a frame, a read buffer must be at least this large. 0 without framing. */
+  def maxSize: Int
+}
+
+object Framing {
+
+  /** Received data is returned as it arrives. */
+  case object None extends Framing {
+    def maxSize = 0
+  }
+
+  /**
+   * Frames end with a delimiter, such as a line ending.
+   * @param delimiter sequence of 1 to 16 bytes ending a frame
+   * @param maxSize maximum size of a frame, including its delimiter. Longer frames are discarded.
+   * @param strip set to leave the delimiter out of frames. Empty frames are then skipped.
+   */
+  case class Delimiter(delimiter: collection.Seq[Byte], maxSize: Int, strip: Boolean = true) extends Framing
+
+  /**
+   * Frames contain an unsigned length field.
+   * @param maxSize maximum size of a frame. Frames with a larger length are considered invalid.
+   * @param offset offset of the length field from the start of a frame
+   * @param width size of the length field, 1, 2, 4 or 8 bytes
+   * @param bigEndian byte order of the length field
+   * @param adjustment added to the value of the length field to get the number of bytes that
+   * follow the field. For example, a length counting the whole frame has an adjustment of
+   * `-(offset + width)`, a length followed by a 2-byte checksum it does not count one of 2.
+   */
+  case class LengthPrefixed(
+    maxSize: Int,
+    offset: Int = 0,
+    width: Int = 2,
+    bigEndian: Boolean = true,
+    adjustment: Int = 0
+  ) extends Framing
+
+  /**
+   * Frames are of a fixed size.
+   * @param size size of every frame
+   */
+  case class Fixed(size: Int) extends Framing {
+    def maxSize = size
+  }
+
+  /**
+   * Frames are separated by silence on the line, as in Modbus RTU. A frame is all data received
+   * until no further data arrived for the gap. Silence is timed as data is read by the native
+   * backend, hence ports with `lowLatency` set time gaps best.
+   * @param maxSize maximum size of a frame. Longer frames are discarded.
+   * @param gap silence that ends a frame, with a resolution of one microsecond. Zero for 3.5
+   * character times at the port's baud rate, or 1750 microseconds above 19200 baud.
+   */
+  case class Gap(maxSize: Int, gap: FiniteDuration = Duration.Zero) extends Framing
+
+  /**
+   * Frames of another framing end with a checksum, which is verified as frames are received.
+   * Frames whose checksum does not match are discarded; returned frames include their checksum.
+   * @param framing framing of the frames, other than `None` and `Checked`
+   * @param checksum checksum at the end of every frame, before any delimiter
+   * @param offset offset from the start of a frame of the data covered by the checksum, for
+   * example to leave out a start byte
+   * @param bigEndian byte order of the checksum, little-endian as in Modbus RTU by default
+   */
+  case class Checked(
+    framing: Framing,
+    checksum: Checksum.Checksum,
+    offset: Int = 0,
+    bigEndian: Boolean = false
+  ) extends Framing {
+    def maxSize = framing.maxSize
+  }
+
+}
@@ -1,10 +1,38 @@
 package akka.serial
 
+import scala.concurrent.duration._
+
 /**
  * Groups settings used in communication over a serial port.
- * @param baud baud rate to use with serial port
+ * @param baud baud rate to use with serial port. On Linux, any rate supported by the port's driver
+ * may be used, on other systems only standard rates up to 230400 are available.
  * @param characterSize size of a character of the data sent through the serial port
  * @param twoStopBits set to use two stop bits instead of one
  * @param parity type of parity to use with serial port
+ * @param minimumRead minimum number of bytes returned by a read, 0 to return any data as soon as
+ * it is available. Without a read timeout, a read waits indefinitely for this many bytes.
+ * @param readTimeout inter-byte timeout of a read, i.e. a read that received some data returns
+ * once no further data arrived within this time, even if it has fewer than `minimumRead` bytes.
+ * Without a minimum read size, a read returns only once this timeout expires or its buffer is
+ * full. Zero disables the timeout, its resolution is one millisecond.
+ * @param lowLatency set to tune the port for low latency, at the cost of more frequent
+ * transfers. This sets the driver's low-latency flag and, on Linux, lowers the latency timer of
+ * USB adapters that have one (such as FTDI's) to 1 ms, if it is writable by the current user.
+ * USB adapters otherwise buffer received data for up to 16 ms.
+ * @param flowControl type of flow control to use with serial port. With flow control, the remote
+ * device is paused once reading from the port is suspended and the driver's buffer fills up,
+ * hence data is not lost if a client cannot keep up.
+ * @param framing framing of received data, see [[Framing]]. With framing, every read returns one
+ * whole frame, and read buffers are at least as large as the maximum frame size.
  */
-case class SerialSettings(baud: Int, characterSize: Int = 8, twoStopBits: Boolean = false, parity: Parity.Parity = Parity.None)
+case class SerialSettings(
+  baud: Int,
+  characterSize: Int = 8,
+  twoStopBits: Boolean = false,
+  parity: Parity.Parity = Parity.None,
+  minimumRead: Int = 0,
+  readTimeout: FiniteDuration = Duration.Zero,
+  lowLatency: Boolean = false,
+  flowControl: FlowControl.FlowControl = FlowControl.None,
+  framing: Framing = Framing.None
+)
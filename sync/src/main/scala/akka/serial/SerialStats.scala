@@ -0,0 +1,36 @@
+package akka.serial
+
+/**
+ * Statistics of an open serial port, counted since it was opened.
+ * @param bytesRead number of bytes read from the port
+ * @param bytesWritten number of bytes written to the port
+ * @param reads number of system calls that read data
+ * @param writes number of system calls that wrote data
+ * @param wakeups number of times a read waited for the port and was woken up
+ * @param cancels number of reads cancelled, e.g. by closing the port
+ * @param errors errors on the line counted by the port's driver, if it counts them
+ */
+case class SerialStats(
+  bytesRead: Long,
+  bytesWritten: Long,
+  reads: Long,
+  writes: Long,
+  wakeups: Long,
+  cancels: Long,
+  errors: Option[SerialStats.LineErrors]
+)
+
+object SerialStats {
+
+  /**
+   * Errors on the line, as counted by a port's driver. Received data is lost on any of these
+   * errors, which happen out of band and are not otherwise reported on reads.
+   * @param overruns number of times the UART's receive FIFO overflowed
+   * @param bufferOverruns number of times the driver's receive buffer overflowed
+   * @param frame number of characters received without a valid stop bit
+   * @param parity number of characters received with a wrong parity bit
+   * @param breaks number of breaks received
+   */
+  case class LineErrors(overruns: Long, bufferOverruns: Long, frame: Long, parity: Long, breaks: Long)
+
+}
@@ -0,0 +1,127 @@
+package akka.serial
+package sync
+
+import java.nio.{Buffer, ByteBuffer}
+import java.util.concurrent.ConcurrentLinkedQueue
+import java.util.concurrent.atomic.{AtomicBoolean, AtomicLong}
+
+/**
+ * A pool of direct buffers into which data is read, shared by any number of serial connections.
+ * Buffers are leased for a read, and returned to the pool once their lease is released, so that
+ * neither their allocation nor a copy of their data is needed per read.
+ *
+ * Buffers come in size classes, powers of two between `minSize` and `maxSize`, and a lease gets a
+ * buffer of the smallest class that fits the requested size. Buffers are registered with the
+ * native backend once, when allocated. A lease is never refused: if no buffer of a class is free,
+ * a new one is allocated. Released buffers are only kept as long as the free buffers of the pool
+ * amount to at most `capacity` bytes, hence buffers of leases that are released late, or never,
+ * are eventually reclaimed by the garbage collector rather than retained.
+ *
+ * This class is thread-safe.
+ *
+ * @param minSize size of the smallest buffers, a power of two
+ * @param maxSize size of the largest buffers, a power of two; larger leases are not pooled
+ * @param capacity maximum number of bytes of free buffers kept by the pool
+ */
+class BufferPool(val minSize: Int, val maxSize: Int, val capacity: Long) {
+  import BufferPool._
+
+  require(minSize > 0 && (minSize & (minSize - 1)) == 0, "minimum size must be a power of two")
+  require(maxSize >= minSize && (maxSize & (maxSize - 1)) == 0, "maximum size must be a power of two")
+  require(capacity >= 0, "capacity must not be negative")
+
+  private val minShift = Integer.numberOfTrailingZeros(minSize)
+  private val classes = Array.fill(Integer.numberOfTrailingZeros(maxSize) - minShift + 1) {
+    new ConcurrentLinkedQueue[UnsafeSerial.RegisteredBuffer]
+  }
+
+  private val free = new AtomicLong(0)
+  private val allocated = new AtomicLong(0)
+  private val leased = new AtomicLong(0)
+
+  /** Index of the smallest class whose buffers hold the given size, the number of classes if none. */
+  private def sizeClass(size: Int): Int =
+    if (size <= minSize) 0 else 32 - Integer.numberOfLeadingZeros(size - 1) - minShift
+
+  /**
+   * Leases a buffer of at least the given size, whose position is zero and whose limit is its
+   * capacity.
+   *
+   * @param size minimum capacity of the buffer
+   * @return a lease, which must be released once its buffer is no longer used
+   */
+  def lease(size: Int): BufferLease = {
+    leased.incrementAndGet()
+    val index = sizeClass(size)
+    val pooled = index < classes.length
+    val reused = if (pooled) classes(index).poll() else null
+    val registered = if (reused != null) {
+      free.addAndGet(-reused.capacity)
+      reused.buffer.asInstanceOf[Buffer].clear()
+      reused
+    } else {
+      allocated.incrementAndGet()
+      UnsafeSerial.register(ByteBuffer.allocateDirect(if (pooled) minSize << index else size))
+    }
+    new BufferLease(if (pooled) this else null, registered)
+  }
+
+  private[sync] def recycle(registered: UnsafeSerial.RegisteredBuffer): Unit = {
+    // the capacity is not exceeded by more than the buffers of concurrent releases
+    if (free.get + registered.capacity <= capacity) {
+      free.addAndGet(registered.capacity)
+      classes(sizeClass(registered.capacity)).offer(registered)
+    }
+  }
+
+  /** Current statistics of this pool. */
+  def stats: Stats = Stats(leased.get, allocated.get, free.get)
+
+}
+
+object BufferPool {
+
+  /** Pool used by default, of buffers between 256 bytes and 64 KiB that keeps up to 16 MiB. */
+  lazy val shared: BufferPool = new BufferPool(256, 64 * 1024, 16L * 1024 * 1024)
+
+  /**
+   * Statistics of a pool, counted since it was created.
+   * @param leases number of leases
+   * @param allocations number of buffers allocated, i.e. of leases that did not reuse a buffer
+   * @param free number of bytes of free buffers kept by the pool
+   */
+  case class Stats(leases: Long, allocations: Long, free: Long)
+
+}
+
+/**
+ * A buffer leased from a `BufferPool`, which returns to the pool once released. The buffer must
+ * not be used after its lease has been released, neither directly nor through views of it.
+ *
+ * @param pool pool to which the buffer returns, null if the buffer is not pooled
+ * @param registered the leased buffer
+ */
+final class BufferLease private[sync] (pool: BufferPool, private[sync] val registered: UnsafeSerial.RegisteredBuffer) {
+
+  private val released = new AtomicBoolean(false)
+
+  /** The leased buffer. */
+  def buffer: ByteBuffer = registered.buffer
+
+  /**
+   * A read-only view of the data of the leased buffer, between its position and its limit. The
+   * view shares the buffer's memory, hence is only valid until the lease is released.
+   */
+  def data: ByteBuffer = registered.buffer.asReadOnlyBuffer()
+
+  /** Checks if this lease has been released. */
+  def isReleased: Boolean = released.get
+
+  /**
+   * Releases this lease, returning its buffer to the pool. Only the first call has any effect.
+   */
+  def release(): Unit = {
+    if (released.compareAndSet(false, true) && pool != null) pool.recycle(registered)
+  }
+
+}
@@ -0,0 +1,134 @@
+package akka.serial
+package sync
+
+import java.util.concurrent.atomic.AtomicBoolean
+
+/**
+ * Reports devices, such as USB serial adapters, as they are connected and disconnected. This class
+ * wraps an `UnsafeMonitor` in the same way `SerialReactor` wraps an `UnsafeReactor`, and is
+ * thread-safe.
+ *
+ * Devices are filtered by the native backend, so that only those matching any of the monitor's
+ * filters are reported. A device is only reported as disconnected if it has been matched, either
+ * when connected or when the monitor was opened.
+ */
+class DeviceMonitor private (unsafe: UnsafeMonitor) {
+
+  private val waitLock = new Object
+
+  private val closed = new AtomicBoolean(false)
+
+  /**
+   * Checks if this monitor is closed.
+   */
+  def isClosed = closed.get()
+
+  /**
+   * Waits until a device is connected or disconnected.
+   *
+   * A call to this method is blocking, however it is interrupted if the monitor is closed.
+   *
+   * @return the device's event, `None` if the monitor's source has ended
+   * @throws PortInterruptedException if the monitor is closed while waiting
+   * @throws IOException on IO error
+   */
+  def next(): Option[DeviceMonitor.Event] = waitLock.synchronized {
+    if (closed.get) throw new PortClosedException("monitor is closed")
+    val paths = new Array[String](1)
+    unsafe.next(paths) match {
+      case 0 => None
+      case UnsafeMonitor.DeviceConnected => Some(DeviceMonitor.Connected(paths(0)))
+      case _ => Some(DeviceMonitor.Disconnected(paths(0)))
+    }
+  }
+
+  /**
+   * Gets the number of devices present on opening that have not been reported yet. As many calls
+   * to `next()` return these without waiting, which allows them to be taken before waiting for
+   * devices to be connected. This method blocks while another thread waits in `next()`.
+   */
+  def pending(): Int = waitLock.synchronized {
+    if (closed.get) throw new PortClosedException("monitor is closed")
+    unsafe.pending()
+  }
+
+  /**
+   * Closes this monitor. Any caller blocked on `next()` will return.
+   *
+   * @throws IOException on IO error
+   */
+  def close(): Unit = this.synchronized {
+    if (!closed.get) {
+      closed.set(true)
+      unsafe.cancel()
+      // a waiting caller holds the lock until it has been interrupted
+      waitLock.synchronized {
+        unsafe.close()
+      }
+    }
+  }
+
+}
+
+object DeviceMonitor {
+
+  /** A device that has been connected or disconnected. */
+  sealed trait Event {
+    /** Absolute path of the device's node. */
+    def port: String
+  }
+
+  /** A device has been connected. */
+  case class Connected(port: String) extends Event
+
+  /** A device has been disconnected. */
+  case class Disconnected(port: String) extends Event
+
+  /**
+   * Opens a new monitor of devices.
+   *
+   * @param directory directory in which device nodes are created, usually "/dev"
+   * @param filters filters of reported devices, all devices that have a node if empty
+   * @param initial set to report devices present on opening as connected
+   * @param source file from which uevents are read instead of the kernel, in the format of Linux's
+   * uevent socket with each uevent followed by an additional null character; intended for testing
+   * @return an open monitor
+   * @throws InvalidSettingsException if an attribute of a filter is too long
+   * @throws UnsupportedOperationException if monitors are not available on the current platform
+   * @throws IOException on IO error
+   */
+  def open(directory: String, filters: Seq[DeviceFilter], initial: Boolean,
+    source: Option[String] = None): DeviceMonitor = {
+    val address = UnsafeMonitor.open(
+      source.orNull,
+      directory,
+      initial,
+      filters.map(_.subsystem.orNull).toArray,
+      filters.map(_.name.orNull).toArray,
+      filters.map(_.vendor.getOrElse(-1)).toArray,
+      filters.map(_.product.getOrElse(-1)).toArray,
+      filters.map(_.serial.orNull).toArray
+    )
+    new DeviceMonitor(new UnsafeMonitor(address))
+  }
+
+  /**
+   * Looks up the attributes of a port, as found under the sysfs root.
+   *
+   * @param port path of the port's node, e.g. "/dev/ttyUSB0"
+   * @return the port's attributes, `None` if it is not a tty known to the kernel
+   * @throws UnsupportedOperationException if sysfs is not available on the current platform
+   */
+  def info(port: String): Option[DeviceInfo] = {
+    val ids = new Array[Int](2)
+    val attributes = new Array[String](5)
+    if (!UnsafeMonitor.info(port.substring(port.lastIndexOf('/') + 1), ids, attributes)) {
+      None
+    } else {
+      def string(index: Int) = Option(attributes(index)).filter(_.nonEmpty)
+      def id(index: Int) = Some(ids(index)).filter(_ >= 0)
+      Some(DeviceInfo(attributes(0), string(1), id(0), id(1), string(2), string(3), string(4)))
+    }
+  }
+
+}
@@ -0,0 +1,73 @@
+package akka.serial
+package sync
+
+import java.nio.ByteBuffer
+
+/**
+  * Calls of the native backend that concern a single serial port, implemented by each binding
+  * (see `Binding`). The first argument of each is the address of a natively allocated serial
+  * configuration structure, as returned by `open()`. See `UnsafeSerial` for a description of every
+  * call.
+  *
+  * Exceptions declared by the calls of `UnsafeSerial` are thrown as is.
+  */
+private[serial] trait NativeBinding {
+
+  /** The binding implemented. */
+  def binding: Binding.Binding
+
+  def open(port: String, baud: Int, characterSize: Int, twoStopBits: Boolean, parity: Int): Long
+  def setReadCoalescing(serial: Long, minSize: Int, timeout: Int): Unit
+  def setFlowControl(serial: Long, flow: Int): Unit
+  def suspendReading(serial: Long, suspended: Boolean): Unit
+  def setFraming(serial: Long, kind: Int, maxSize: Int, delimiter: Array[Byte], stripDelimiter: Boolean,
+    lengthOffset: Int, lengthWidth: Int, bigEndian: Boolean, lengthAdjustment: Int,
+    checksum: Int, checksumOffset: Int, checksumBigEndian: Boolean, gap: Int): Unit
+  def read(serial: Long, buffer: ByteBuffer): Int
+  def readAddress(serial: Long, address: Long, size: Int): Int
+  def tryRead(serial: Long, buffer: ByteBuffer): Int
+  def tryReadAddress(serial: Long, address: Long, size: Int): Int
+  def tryReadArray(serial: Long, array: Array[Byte], offset: Int, length: Int): Int
+  def takeDrained(serial: Long): Boolean
+  def readTimestamp(serial: Long): Long
+  def fill(serial: Long, ring: ByteBuffer): Int
+  def wakeRing(serial: Long): Unit
+  def cancelRead(serial: Long): Unit
+  def write(serial: Long, buffer: ByteBuffer, length: Int): Int
+  def writeAddress(serial: Long, address: Long, length: Int): Int
+  def writev(serial: Long, buffers: Array[ByteBuffer]): Int
+  def drain(serial: Long): Long
+  def readEngine(serial: Long): Int
+  def speed(serial: Long): Int
+  def inputQueued(serial: Long): Int
+  def outputQueued(serial: Long): Int
+  def stats(serial: Long, values: Array[Long]): Unit
+  def lowLatency(serial: Long): Int
+  def latencyTimer(serial: Long): Int
+  def close(serial: Long): Unit
+
+}
+
+private[serial] object NativeBinding {
+
+  @volatile private var selected: NativeBinding = UnsafeSerial
+
+  /** Binding used by subsequently opened ports. */
+  def current: NativeBinding = selected
+
+  /**
+    * Selects the binding used by subsequently opened ports, falling back to JNI if the given
+    * binding is not available on the running JDK.
+    *
+    * @param value binding to use
+    * @return the binding actually selected
+    */
+  def select(value: Binding.Binding): Binding.Binding = synchronized {
+    selected = value match {
+      case Binding.Foreign => Option(ForeignBinding.create()).getOrElse(UnsafeSerial)
+      case _ => UnsafeSerial
+    }
+    selected.binding
+  }
+
+}
@@ -0,0 +1,134 @@
+package akka.serial
+package sync
+
+import java.nio.{Buffer, ByteBuffer, ByteOrder}
+
+/**
+ * A single-producer/single-consumer ring into which data received from a serial port is read.
+ * The ring lives in a direct ByteBuffer that is shared with the native backend: a producer
+ * thread fills it by calling `SerialConnection.fill()`, while a consumer on another thread
+ * drains it with `SerialConnection.drain()`. Both sides only exchange indices, hence a
+ * consumer may drain data of many reads without any native call.
+ *
+ * This class is not thread-safe, its consumer methods must always be called from the same
+ * thread (or, equivalently, from the same actor).
+ *
+ * @param capacity number of bytes that can be stored in the ring, a power of two
+ */
+class ReceiveRing(val capacity: Int) {
+  import ReceiveRing._
+
+  require(capacity > 0 && (capacity & (capacity - 1)) == 0, "capacity must be a power of two")
+
+  // indices are shared with native code, hence stored in native byte order
+  private[sync] val buffer = ByteBuffer.allocateDirect(DataOffset + capacity).order(ByteOrder.nativeOrder())
+  buffer.putInt(ConsumerWaitingOffset, 1)
+
+  // read-only view handed to consumers
+  private val view = buffer.asReadOnlyBuffer()
+
+  // consumer's copy of the tail index
+  private var tail = 0L
+
+  private def head: Long = {
+    val h = buffer.getLong(HeadOffset)
+    fences.loadFence() // data must not be read before the head index
+    h
+  }
+
+  /** Number of bytes that are currently available to be drained. */
+  def available: Int = (head - tail).toInt
+
+  /**
+   * Time at which the producer last read data into the ring, in nanoseconds (see
+   * `SerialConnection.timestamp`). After a drain, this is the time at which the last part of the
+   * drained data, or possibly of data that arrived meanwhile, was read.
+   */
+  def readTimestamp: Long = buffer.getLong(ReadTimestampOffset)
+
+  private def slice(index: Int, length: Int): ByteBuffer = {
+    view.asInstanceOf[Buffer].clear()
+    view.asInstanceOf[Buffer].position(DataOffset + index)
+    view.asInstanceOf[Buffer].limit(DataOffset + index + length)
+    view
+  }
+
+  /**
+   * Passes all available data to a consumer, in at most two parts if data wraps around the end
+   * of the ring, and frees its space. The consumer must copy any data it wishes to keep, since
+   * the buffers passed to it are reused.
+   * @return number of bytes drained
+   */
+  private[sync] def drain(consumer: ByteBuffer => Unit): Int = {
+    val h = head
+    val n = (h - tail).toInt
+    if (n > 0) {
+      val index = (tail & (capacity - 1)).toInt
+      val first = math.min(n, capacity - index)
+      consumer(slice(index, first))
+      if (first < n) consumer(slice(0, n - first))
+
+      tail = h
+      fences.storeFence() // data must be read before space is freed
+      buffer.putLong(TailOffset, tail)
+      fences.fullFence() // the tail index must be visible before checking the producer's flag
+    }
+    n
+  }
+
+  /**
+   * Checks and clears whether the producer waits for space, in which case it must be woken up.
+   */
+  private[sync] def takeProducerWaiting(): Boolean = {
+    if (buffer.getInt(ProducerWaitingOffset) != 0) {
+      buffer.putInt(ProducerWaitingOffset, 0)
+      true
+    } else {
+      false
+    }
+  }
+
+  /**
+   * Announces that the consumer is about to wait for data. If this method returns true, the
+   * producer will report `DataAvailable` once data has been read into the ring. Otherwise, data
+   * arrived in the meantime and should be drained first.
+   * @return true if the ring is empty and the consumer may wait
+   */
+  def prepareWait(): Boolean = {
+    buffer.putInt(ConsumerWaitingOffset, 1)
+    fences.fullFence() // the flag must be visible before checking the head index
+    if (buffer.getLong(HeadOffset) != tail) {
+      buffer.putInt(ConsumerWaitingOffset, 0)
+      false
+    } else {
+      true
+    }
+  }
+
+}
+
+object ReceiveRing {
+
+  /* Layout of the ring's header, must match the RING_* definitions of the native backend. Every
+   * field is placed on its own cache line. */
+  private final val HeadOffset = 0
+  private final val TailOffset = 64
+  private final val ConsumerWaitingOffset = 128
+  private final val ProducerWaitingOffset = 192
+  private final val ReadTimestampOffset = 256
+  private final val DataOffset = 320
+
+  /** Event reported by `fill()`: data has been read into the ring while the consumer waited. */
+  final val DataAvailable: Int = 1
+
+  /** Event reported by `fill()`: the transmit queue has been drained after a blocked write. */
+  final val TransmitDrained: Int = 2
+
+  // memory fences, which are not otherwise available for direct buffers on Java 8
+  private val fences: sun.misc.Unsafe = {
+    val field = classOf[sun.misc.Unsafe].getDeclaredField("theUnsafe")
+    field.setAccessible(true)
+    field.get(null).asInstanceOf[sun.misc.Unsafe]
+  }
+
+}
@@ -2,8 +2,9 @@ package akka.serial
 package sync
 
 import java.io.IOException
-import java.nio.{Buffer, ByteBuffer}
+import java.nio.{Buffer, ByteBuffer, ReadOnlyBufferException}
 import java.util.concurrent.atomic.AtomicBoolean
+import scala.concurrent.duration._
 
 /**
  * Represents a serial connection in a more secure and object-oriented style than `UnsafeSerial`. In
@@ -14,7 +15,9 @@ import java.util.concurrent.atomic.AtomicBoolean
  */
 class SerialConnection private (
   unsafe: UnsafeSerial,
-  val port: String
+  val port: String,
+  lowLatency: Boolean,
+  val framing: Framing
 ) {
 
   private var reading: Boolean = false
@@ -23,15 +26,59 @@ class SerialConnection private (
   private var writing: Boolean = false
   private val writeLock = new Object
 
+  private var draining: Boolean = false
+  private val drainLock = new Object
+
   private val closed = new AtomicBoolean(false)
 
+  // registrations of the buffers last read into and written from, reused as long as callers pass
+  // the same buffers, which spares the native lookup of their addresses on every call
+  private var readBuffer: UnsafeSerial.RegisteredBuffer = null
+  private var writeBuffer: UnsafeSerial.RegisteredBuffer = null
+
+  // buffer through which blocking reads into arrays go, grown to the largest read up to a bound,
+  // which is raised to the maximum frame size so that frames fitting the caller's range are read
+  private var arrayBuffer: UnsafeSerial.RegisteredBuffer = null
+  private val arrayBufferMax = math.max(SerialConnection.ArrayBufferSize, framing.maxSize)
+
+  private def registered(current: UnsafeSerial.RegisteredBuffer, buffer: ByteBuffer) =
+    if (current != null && (current.buffer eq buffer)) current else UnsafeSerial.register(buffer)
+
+  /** Address of the underlying native serial configuration, used to register with reactors. */
+  private[sync] def serialAddr: Long = unsafe.serialAddr
+
   /**
    * Checks if this serial port is closed.
    */
   def isClosed = closed.get()
 
   /**
-   * Closes the underlying serial connection. Any callers blocked on read or write will return.
+   * The engine actually used to read from this serial port.
+   */
+  val engine: Engine.Engine = Engine(unsafe.engine())
+
+  /**
+   * The binding through which this serial port is accessed, see `Binding`.
+   */
+  val binding: Binding.Binding = unsafe.natives.binding
+
+  /**
+   * The baud rate actually used by this serial port. Depending on the port's hardware and
+   * driver, this may differ from the requested rate.
+   */
+  val baud: Int = unsafe.speed()
+
+  /**
+   * The settings actually in effect on this serial port.
+   */
+  val achieved: AchievedSettings = {
+    val timer = unsafe.latencyTimer()
+    AchievedSettings(baud, lowLatency, if (timer >= 0) Some(timer.millis) else None)
+  }
+
+  /**
+   * Closes the underlying serial connection. Any callers blocked on read, write or
+   * `awaitTransmitted()` will return.
    * A call of this method has no effect if the serial port is already closed.
    * @throws IOException on IO error
    */
@@ -45,6 +92,9 @@ class SerialConnection private (
       writeLock.synchronized {
         while (writing) this.wait()
       }
+      drainLock.synchronized {
+        while (draining) this.wait()
+      }
       unsafe.close()
     }
   }
@@ -61,16 +111,117 @@ class SerialConnection private (
    * This method works only for direct buffers.
    *
    * @param buffer a ByteBuffer into which data is read
-   * @return the actual number of bytes read
+   * @return the actual number of bytes read, 0 if the transmit queue has been drained after a
+   * write was not completely accepted
    * @throws PortInterruptedException if port is closed while reading
+   * @throws InvalidSettingsException if the port has framing and the next frame does not fit into
+   * the buffer, the frame is dropped
    * @throws IOException on IO error
    */
   def read(buffer: ByteBuffer): Int = readLock.synchronized {
+    readBuffer = registered(readBuffer, buffer)
+    readRegistered(readBuffer)
+  }
+
+  /**
+   * Reads data into the buffer of a lease, as with `read(ByteBuffer)`. Buffers of leases are
+   * registered with the native backend by their pool, hence reading into a different buffer on
+   * every call is as cheap as reading into the same one.
+   *
+   * @param lease lease of the buffer into which data is read
+   * @return the actual number of bytes read, 0 if the transmit queue has been drained after a
+   * write was not completely accepted
+   * @throws PortInterruptedException if port is closed while reading
+   * @throws InvalidSettingsException if the port has framing and the next frame does not fit into
+   * the buffer, the frame is dropped
+   * @throws IOException on IO error
+   */
+  def read(lease: BufferLease): Int = readLock.synchronized {
+    readRegistered(lease.registered)
+  }
+
+  /**
+   * Reads data from underlying serial connection into a range of a byte array. Since an array must
+   * not stay pinned while a read waits, data is read into a direct buffer that is kept by this
+   * connection, and copied into the array from there. At most 64 KiB, or the port's maximum frame
+   * size if larger, are read per call. Only `tryRead(Array[Byte], Int, Int)` reads straight into an
+   * array.
+   *
+   * A call to this method is blocking, however it is interrupted if the connection is closed.
+   *
+   * @param array an array into which data is read
+   * @param offset index of the first byte of the range
+   * @param length number of bytes of the range, i.e. the maximum number of bytes read
+   * @return the actual number of bytes read, 0 if the transmit queue has been drained after a
+   * write was not completely accepted
+   * @throws IllegalArgumentException if the range is not within the array
+   * @throws PortInterruptedException if port is closed while reading
+   * @throws InvalidSettingsException if the port has framing and the next frame does not fit into
+   * the range, the frame is dropped
+   * @throws IOException on IO error
+   */
+  def read(array: Array[Byte], offset: Int, length: Int): Int = readLock.synchronized {
+    readArray(array, offset, length)
+  }
+
+  private def readArray(array: Array[Byte], offset: Int, length: Int): Int = {
+    require(offset >= 0 && length >= 0 && offset <= array.length - length, "range is out of array bounds")
+    val size = math.min(length, arrayBufferMax)
+    if (arrayBuffer == null || arrayBuffer.capacity < size) {
+      arrayBuffer = UnsafeSerial.register(ByteBuffer.allocateDirect(size))
+    }
+    val n = blocking(unsafe.read(arrayBuffer, 0, size))
+    if (n > 0) {
+      arrayBuffer.buffer.asInstanceOf[Buffer].clear()
+      arrayBuffer.buffer.get(array, offset, n)
+    }
+    n
+  }
+
+  /**
+   * Reads data from underlying serial connection into the remaining space of a ByteBuffer, in
+   * the manner of NIO channels: data is read starting at the buffer's position, up to its limit,
+   * and the position is advanced by the number of bytes read. Hence a large buffer can be filled
+   * incrementally by successive calls. Both direct and heap buffers are supported; data is read
+   * into heap buffers as with `read(Array[Byte], Int, Int)`.
+   *
+   * A call to this method is blocking, however it is interrupted if the connection is closed.
+   *
+   * @param buffer a ByteBuffer into which data is read
+   * @return the actual number of bytes read, 0 if the transmit queue has been drained after a
+   * write was not completely accepted
+   * @throws ReadOnlyBufferException if the buffer is read-only
+   * @throws PortInterruptedException if port is closed while reading
+   * @throws InvalidSettingsException if the port has framing and the next frame does not fit into
+   * the remaining space, the frame is dropped
+   * @throws IOException on IO error
+   */
+  def readInto(buffer: ByteBuffer): Int = readLock.synchronized {
+    if (buffer.isReadOnly) throw new ReadOnlyBufferException
+    val position = buffer.position
+    val n = if (buffer.isDirect) {
+      readBuffer = registered(readBuffer, buffer)
+      blocking(unsafe.read(readBuffer, position, buffer.remaining))
+    } else {
+      readArray(buffer.array, buffer.arrayOffset + position, buffer.remaining)
+    }
+    buffer.asInstanceOf[Buffer].position(position + n)
+    n
+  }
+
+  private def readRegistered(registered: UnsafeSerial.RegisteredBuffer): Int = {
+    val n = blocking(unsafe.read(registered))
+    registered.buffer.asInstanceOf[Buffer].limit(n)
+    n
+  }
+
+  // runs a blocking read, which close() interrupts and waits for
+  private def blocking(read: => Int): Int = {
     if (!closed.get) {
       try {
         reading = true
-        val n = unsafe.read(buffer)
-        buffer.asInstanceOf[Buffer].limit(n)
+        val n = read
+        if (n > 0) lastRead = unsafe.readTimestamp()
         n
       } finally {
         reading = false
@@ -81,25 +232,302 @@ class SerialConnection private (
     }
   }
 
+  /**
+   * Reads data that is immediately available from underlying serial connection into a ByteBuffer.
+   * As with `read()`, data is read into the buffer's memory starting at the first position, and the
+   * buffer's limit is set to the number of bytes read.
+   *
+   * A call to this method never blocks. It is intended to be used in conjunction with a
+   * [[SerialReactor]], once the connection has been reported as readable.
+   *
+   * This method works only for direct buffers.
+   *
+   * @param buffer a ByteBuffer into which data is read
+   * @return the actual number of bytes read, 0 if no data is available
+   * @throws InvalidSettingsException if the port has framing and the next frame does not fit into
+   * the buffer, the frame is dropped
+   * @throws IOException on IO error
+   */
+  def tryRead(buffer: ByteBuffer): Int = readLock.synchronized {
+    readBuffer = registered(readBuffer, buffer)
+    tryReadRegistered(readBuffer)
+  }
+
+  /**
+   * Reads data that is immediately available into the buffer of a lease, as with
+   * `tryRead(ByteBuffer)`.
+   *
+   * @param lease lease of the buffer into which data is read
+   * @return the actual number of bytes read, 0 if no data is available
+   * @throws InvalidSettingsException if the port has framing and the next frame does not fit into
+   * the buffer, the frame is dropped
+   * @throws IOException on IO error
+   */
+  def tryRead(lease: BufferLease): Int = readLock.synchronized {
+    tryReadRegistered(lease.registered)
+  }
+
+  /**
+   * Reads data that is immediately available into a range of a byte array, as with
+   * `read(Array[Byte], Int, Int)` but without blocking.
+   *
+   * @param array an array into which data is read
+   * @param offset index of the first byte of the range
+   * @param length number of bytes of the range, i.e. the maximum number of bytes read
+   * @return the actual number of bytes read, 0 if no data is available
+   * @throws IllegalArgumentException if the range is not within the array
+   * @throws InvalidSettingsException if the port has framing and the next frame does not fit into
+   * the range, the frame is dropped
+   * @throws IOException on IO error
+   */
+  def tryRead(array: Array[Byte], offset: Int, length: Int): Int = readLock.synchronized {
+    nonBlocking(unsafe.tryRead(array, offset, length))
+  }
+
+  /**
+   * Reads data that is immediately available into the remaining space of a ByteBuffer, as with
+   * `readInto()` but without blocking.
+   *
+   * @param buffer a ByteBuffer into which data is read
+   * @return the actual number of bytes read, 0 if no data is available
+   * @throws ReadOnlyBufferException if the buffer is read-only
+   * @throws InvalidSettingsException if the port has framing and the next frame does not fit into
+   * the remaining space, the frame is dropped
+   * @throws IOException on IO error
+   */
+  def tryReadInto(buffer: ByteBuffer): Int = readLock.synchronized {
+    if (buffer.isReadOnly) throw new ReadOnlyBufferException
+    val position = buffer.position
+    val n = if (buffer.isDirect) {
+      readBuffer = registered(readBuffer, buffer)
+      nonBlocking(unsafe.tryRead(readBuffer, position, buffer.remaining))
+    } else {
+      nonBlocking(unsafe.tryRead(buffer.array, buffer.arrayOffset + position, buffer.remaining))
+    }
+    buffer.asInstanceOf[Buffer].position(position + n)
+    n
+  }
+
+  private def tryReadRegistered(registered: UnsafeSerial.RegisteredBuffer): Int = {
+    val n = nonBlocking(unsafe.tryRead(registered))
+    registered.buffer.asInstanceOf[Buffer].limit(n)
+    n
+  }
+
+  /**
+   * Checks whether the transmit queue has been drained after a write was not completely accepted,
+   * which a blocking `read()` reports by returning 0. Intended to be called by the reading thread
+   * after `tryRead()`, whose 0 also means that no data is available. A drain is reported once.
+   *
+   * @return true if the port became writable again since this was last checked
+   */
+  def transmitDrained: Boolean = readLock.synchronized {
+    if (!closed.get) unsafe.takeDrained() else throw new PortClosedException(s"${port} is closed")
+  }
+
+  private def nonBlocking(read: => Int): Int = {
+    if (!closed.get) {
+      val n = read
+      if (n > 0) lastRead = unsafe.readTimestamp()
+      n
+    } else {
+      throw new PortClosedException(s"${port} is closed")
+    }
+  }
+
+  /**
+   * Time at which the data returned by the last `read()` or `tryRead()` was read from the
+   * operating system, in nanoseconds (see `SerialConnection.timestamp`). The timestamp is taken by
+   * the native backend right after the underlying system call returned. This method is intended to
+   * be called by the reading thread, after a read.
+   */
+  def readTimestamp: Long = lastRead
+
+  // timestamp of the last read, kept since the native structure may be freed after a read
+  @volatile private var lastRead: Long = 0
+
+  /**
+   * Reads data from underlying serial connection into a receive ring, until an event has to be
+   * reported to the ring's consumer. Data is read continuously, without returning, as long as the
+   * consumer is busy draining the ring.
+   *
+   * A call to this method is blocking, however it is interrupted if the connection is closed. It
+   * must not be called concurrently with `read()`.
+   *
+   * @param ring the ring into which data is read
+   * @return a bitmask of `ReceiveRing.DataAvailable` and `ReceiveRing.TransmitDrained`
+   * @throws PortInterruptedException if port is closed while reading
+   * @throws IOException on IO error
+   */
+  def fill(ring: ReceiveRing): Int = readLock.synchronized {
+    if (!closed.get) {
+      try {
+        reading = true
+        unsafe.fill(ring.buffer)
+      } finally {
+        reading = false
+        if (closed.get) readLock.notify()
+      }
+    } else {
+      throw new PortClosedException(s"${port} is closed")
+    }
+  }
+
+  /**
+   * Drains all data available in a receive ring that is filled by this connection, see
+   * `ReceiveRing`. The consumer is called with at most two read-only buffers, which are only
+   * valid during the call. This method never blocks and may be called while another thread is
+   * blocked in `fill()`.
+   *
+   * @param ring the ring from which data is drained
+   * @param consumer called with the buffers of available data, in order
+   * @return the number of bytes drained
+   * @throws IOException on IO error
+   */
+  def drain(ring: ReceiveRing)(consumer: ByteBuffer => Unit): Int = {
+    val n = ring.drain(consumer)
+    if (ring.takeProducerWaiting()) writeLock.synchronized {
+      // the port cannot be freed while the write lock is held
+      if (!closed.get) unsafe.wakeRing()
+    }
+    n
+  }
+
+  /**
+   * Suspends or resumes reading from underlying serial connection. While suspended, `read()` and
+   * `fill()` keep blocking (and `tryRead()` returns 0) even if data is available, which is left
+   * in the driver's buffer instead. Once that buffer fills up, flow control (if enabled in the
+   * connection's settings) pauses the remote device, otherwise further data is dropped by the
+   * driver. Transmit queues are still drained while reading is suspended.
+   *
+   * A read that is already in progress may still complete once. This method may be called from
+   * any thread, it has no effect if the connection is closed.
+   *
+   * @param suspended set to suspend reading, clear to resume it
+   * @throws IOException on IO error
+   */
+  def suspendReading(suspended: Boolean): Unit = writeLock.synchronized {
+    // the port cannot be freed while the write lock is held
+    if (!closed.get) unsafe.suspendReading(suspended)
+  }
+
+  /**
+   * Waits until all data written to underlying serial connection has been transmitted, i.e. until
+   * the connection's transmit queue and the operating system's transmission buffer are empty and,
+   * if the driver can tell, the last character has left the UART. Since the transmit queue is
+   * drained by a thread waiting on the connection, a concurrent `read()`, `fill()` or
+   * [[SerialReactor]] is required while data is queued.
+   *
+   * A call to this method is blocking, however it is interrupted if the connection is closed.
+   *
+   * @return the time at which the connection was found drained, see `SerialConnection.timestamp`
+   * @throws PortInterruptedException if port is closed while waiting
+   * @throws IOException on IO error
+   */
+  def awaitTransmitted(): Long = drainLock.synchronized {
+    if (!closed.get) {
+      try {
+        draining = true
+        unsafe.drain()
+      } finally {
+        draining = false
+        if (closed.get) drainLock.notify()
+      }
+    } else {
+      throw new PortClosedException(s"${port} is closed")
+    }
+  }
+
+  /**
+   * Gets the number of bytes received by underlying serial connection that have not yet been
+   * read, i.e. the depth of the operating system's receive queue. This method never blocks and
+   * may be called from any thread.
+   *
+   * @return number of bytes waiting to be read
+   * @throws PortClosedException if the connection is closed
+   * @throws IOException on IO error
+   */
+  def inputQueued: Int = writeLock.synchronized {
+    if (!closed.get) unsafe.inputQueued() else throw new PortClosedException(s"${port} is closed")
+  }
+
+  /**
+   * Gets the number of bytes written to underlying serial connection that have not yet been
+   * transmitted, including data in the connection's transmit queue. This method never blocks and
+   * may be called from any thread.
+   *
+   * @return number of bytes waiting to be transmitted
+   * @throws PortClosedException if the connection is closed
+   * @throws IOException on IO error
+   */
+  def outputQueued: Int = writeLock.synchronized {
+    if (!closed.get) unsafe.outputQueued() else throw new PortClosedException(s"${port} is closed")
+  }
+
+  /**
+   * Gets statistics of underlying serial connection, such as the number of bytes transferred and,
+   * if the port's driver counts them, errors on the line that lost received data. This method
+   * never blocks and may be called from any thread.
+   *
+   * @return statistics counted since the connection was opened
+   * @throws PortClosedException if the connection is closed
+   * @throws IOException on IO error
+   */
+  def stats: SerialStats = writeLock.synchronized {
+    if (!closed.get) unsafe.stats() else throw new PortClosedException(s"${port} is closed")
+  }
+
   /**
    * Writes data from a ByteBuffer to underlying serial connection.
    * Note that data is read from the buffer's memory, its attributes
    * such as position and limit are not modified.
    *
    * The write is non-blocking, this function returns as soon as the data is copied into the kernel's
-   * transmission buffer.
+   * transmission buffer or, if that is full, into the connection's transmit queue. The queue is
+   * drained by a thread waiting on the connection, i.e. a blocked `read()` or a [[SerialReactor]].
+   * Once it has been drained after a write was not completely accepted, `read()` returns 0.
    *
    * This method works only for direct buffers.
    *
    * @param buffer a ByteBuffer from which data is taken
-   * @return the actual number of bytes written
+   * @return the actual number of bytes accepted, less than the buffer's position if the transmit
+   * queue is full
    * @throws IOException on IO error
    */
   def write(buffer: ByteBuffer): Int = writeLock.synchronized {
     if (!closed.get) {
       try {
         writing = true
-        unsafe.write(buffer, buffer.position)
+        writeBuffer = registered(writeBuffer, buffer)
+        unsafe.write(writeBuffer, buffer.position)
+      } finally {
+        writing = false
+        if (closed.get) writeLock.notify()
+      }
+    } else {
+      throw new PortClosedException(s"${port} is closed")
+    }
+  }
+  /**
+   * Writes data from several ByteBuffers to underlying serial connection, as if they were
+   * concatenated (gather write). Data is taken from between each buffer's position and limit,
+   * which are not modified.
+   *
+   * As with `write(buffer)`, the write is non-blocking and data that cannot be transmitted
+   * immediately is queued. Heap buffers are supported and written without being copied, hence
+   * the buffers of a composite ByteString, as returned by `asByteBuffers`, may be written
+   * directly.
+   *
+   * @param buffers ByteBuffers from which data is taken, in order
+   * @return the actual number of bytes accepted, less than the total of all buffers if the
+   * transmit queue is full
+   * @throws IOException on IO error
+   */
+  def write(buffers: Array[ByteBuffer]): Int = writeLock.synchronized {
+    if (!closed.get) {
+      try {
+        writing = true
+        unsafe.writev(buffers)
       } finally {
         writing = false
         if (closed.get) writeLock.notify()
@@ -113,9 +541,19 @@ class SerialConnection private (
 
 object SerialConnection {
 
+  /** Size up to which the buffer of blocking reads into arrays grows, see `read(Array[Byte], Int, Int)`. */
+  private final val ArrayBufferSize = 64 * 1024
+
+  /**
+   * Current time of the clock used for timestamps reported by serial connections, in nanoseconds.
+   * This is a monotonic clock, which on Linux is the same as the one of `System.nanoTime`.
+   */
+  def timestamp: Long = UnsafeSerial.timestamp()
+
   /**
    * Opens a new connection to a serial port.
-   * This method acts as a factory to creating serial connections.
+   * This method acts as a factory to creating serial connections. It may be called concurrently,
+   * the native backend locks every port exclusively, so that a port can only be opened once.
    *
    * @param port name of serial port to open
    * @param settings settings with which to initialize the connection
@@ -129,15 +567,48 @@ object SerialConnection {
   def open(
     port: String,
     settings: SerialSettings
-  ): SerialConnection = synchronized {
-    val pointer = UnsafeSerial.open(
+  ): SerialConnection = {
+    if (settings.minimumRead < 0) {
+      throw new InvalidSettingsException("minimum read size must not be negative")
+    }
+    if (settings.readTimeout < Duration.Zero || settings.readTimeout.toMillis > Int.MaxValue) {
+      throw new InvalidSettingsException("read timeout must be between 0 and Int.MaxValue milliseconds")
+    }
+
+    val natives = NativeBinding.current
+    val pointer = natives.open(
       port,
       settings.baud,
       settings.characterSize,
       settings.twoStopBits,
       settings.parity.id
     )
-    new SerialConnection(new UnsafeSerial(pointer), port)
+    val unsafe = new UnsafeSerial(pointer, natives)
+
+    // the port must not be leaked if it cannot be configured further
+    try {
+      if (settings.minimumRead > 0 || settings.readTimeout > Duration.Zero) {
+        // round up, so that sub-millisecond timeouts are not disabled
+        val timeout = (settings.readTimeout + 999.micros).toMillis.toInt
+        unsafe.setReadCoalescing(settings.minimumRead, timeout)
+      }
+
+      if (settings.flowControl != FlowControl.None) {
+        unsafe.setFlowControl(settings.flowControl.id)
+      }
+
+      if (settings.framing != Framing.None) {
+        unsafe.setFraming(settings.framing)
+      }
+
+      val lowLatency = settings.lowLatency && (unsafe.lowLatency() & UnsafeSerial.LowLatencyAsync) != 0
+
+      new SerialConnection(unsafe, port, lowLatency, settings.framing)
+    } catch {
+      case ex: Exception =>
+        unsafe.close()
+        throw ex
+    }
   }
 
 }
@@ -0,0 +1,106 @@
+package akka.serial
+package sync
+
+import java.util.concurrent.atomic.AtomicBoolean
+
+/**
+ * Multiplexes readiness of many serial connections, thereby allowing a single thread to serve
+ * any number of ports. This class wraps an `UnsafeReactor` in the same way `SerialConnection`
+ * wraps an `UnsafeSerial`, and is thread-safe.
+ *
+ * A typical usage consists of registering connections, each under a distinct token, and then
+ * repeatedly calling `await()` and reading from the connections that were reported readable with
+ * `SerialConnection.tryRead()`.
+ */
+class SerialReactor private (unsafe: UnsafeReactor) {
+
+  private var waiting: Boolean = false
+  private val waitLock = new Object
+
+  private val closed = new AtomicBoolean(false)
+
+  /**
+   * Checks if this reactor is closed.
+   */
+  def isClosed = closed.get()
+
+  /**
+   * Registers a connection with this reactor.
+   * Note that a connection must be unregistered before it is closed.
+   *
+   * @param connection an open serial connection
+   * @param token non-zero value identifying the connection, reported by `await()` when the
+   * connection becomes readable
+   * @throws IOException on IO error
+   */
+  def register(connection: SerialConnection, token: Long): Unit = {
+    require(token != 0, "token must be non-zero")
+    if (closed.get) throw new PortClosedException("reactor is closed")
+    unsafe.register(connection.serialAddr, token)
+  }
+
+  /**
+   * Removes a connection from this reactor. A concurrent call to `await()` may still report it.
+   *
+   * @param connection a previously registered connection
+   * @throws IOException on IO error
+   */
+  def unregister(connection: SerialConnection): Unit = {
+    if (!closed.get && !connection.isClosed) unsafe.unregister(connection.serialAddr)
+  }
+
+  /**
+   * Waits until at least one registered connection is readable.
+   *
+   * A call to this method is blocking, however it is interrupted if the reactor is closed.
+   *
+   * @param tokens an array into which the tokens of readable connections are written
+   * @return the number of tokens written
+   * @throws PortInterruptedException if the reactor is closed while waiting
+   * @throws IOException on IO error
+   */
+  def await(tokens: Array[Long]): Int = waitLock.synchronized {
+    if (!closed.get) {
+      try {
+        waiting = true
+        unsafe.await(tokens)
+      } finally {
+        waiting = false
+        if (closed.get) waitLock.notify()
+      }
+    } else {
+      throw new PortClosedException("reactor is closed")
+    }
+  }
+
+  /**
+   * Closes this reactor. Any caller blocked on `await()` will return.
+   * Registered connections are not closed.
+   *
+   * @throws IOException on IO error
+   */
+  def close(): Unit = this.synchronized {
+    if (!closed.get) {
+      closed.set(true)
+      unsafe.cancel()
+      waitLock.synchronized {
+        while (waiting) this.wait()
+      }
+      unsafe.close()
+    }
+  }
+
+}
+
+object SerialReactor {
+
+  /**
+   * Opens a new reactor.
+   *
+   * @return an open reactor, without any registered connections
+   * @throws UnsupportedOperationException if reactors are not available on the current platform
+   * @throws IOException on IO error
+   */
+  def open(): SerialReactor = new SerialReactor(new UnsafeReactor(UnsafeReactor.open()))
+
+}
@@ -0,0 +1,95 @@
+package akka.serial
+package sync
+
+import ch.jodersky.jni.nativeLoader
+
+/**
+  * Low-level wrapper of a native monitor, which reports devices as they are connected and
+  * disconnected.
+  *
+  * WARNING: as with `UnsafeSerial`, methods in this class deal with pointers, which are NOT
+  * checked for correctness.
+  *
+  * See DeviceMonitor for a higher-level, more secured wrapper.
+  *
+  * @param monitorAddr address of natively allocated monitor structure
+  */
+@nativeLoader("akkaserial1")
+private[serial] class UnsafeMonitor(final val monitorAddr: Long) {
+
+  /**
+    * Waits until a device is connected or disconnected.
+    *
+    * The wait is blocking, however it may be interrupted by calling cancel().
+    *
+    * @param paths array into which the path of the device's node is written, at index 0
+    * @return `DeviceConnected` or `DeviceDisconnected`, 0 if the monitor's source has ended
+    * @throws PortInterruptedException if the call to this function was interrupted
+    * @throws IOException on IO error
+    */
+  @native def next(paths: Array[String]): Int
+
+  /**
+    * Gets the number of devices present on opening that have not been reported by next() yet,
+    * which returns as many of them without waiting. Must not be called while waiting in next().
+    *
+    * @return the number of devices not yet reported
+    */
+  @native def pending(): Int
+
+  /**
+    * Cancels any current and future call to next(). This function may be called from any thread.
+    *
+    * @throws IOException on IO error
+    */
+  @native def cancel(): Unit
+
+  /**
+    * Closes this monitor. Natively allocated resources are freed and the monitor pointer becomes
+    * invalid, therefore this function should only be called ONCE per monitor.
+    *
+    * @throws IOException on IO error
+    */
+  @native def close(): Unit
+
+}
+
+private[serial] object UnsafeMonitor {
+
+  // actions of devices, see `next()`
+  final val DeviceConnected: Int = 1
+  final val DeviceDisconnected: Int = 2
+
+  /**
+    * Opens a new monitor of the devices that match any of the given filters, which are passed as
+    * arrays of their attributes; null strings and negative ids match any device.
+    *
+    * @param source path of a file from which uevents are read, null to monitor the kernel's
+    * @param directory directory in which device nodes are created
+    * @param initial set to report devices present on opening as connected
+    * @param subsystems kernel subsystems of the filters
+    * @param names shell patterns of the names of devices of the filters
+    * @param vendors USB vendor ids of the filters
+    * @param products USB product ids of the filters
+    * @param serials USB serial numbers of the filters
+    * @return address of natively allocated monitor structure
+    * @throws InvalidSettingsException if an attribute or the directory is too long
+    * @throws UnsupportedOperationException if monitors are not available on the current platform
+    * @throws IOException on IO error
+    */
+  @native def open(source: String, directory: String, initial: Boolean, subsystems: Array[String],
+    names: Array[String], vendors: Array[Int], products: Array[Int], serials: Array[String]): Long
+
+  /**
+    * Looks up the attributes of a tty in sysfs. Strings that are not known are empty, ids -1.
+    *
+    * @param name name of the tty's node, e.g. "ttyUSB0"
+    * @param ids array into which the vendor and product ids of its USB device are written
+    * @param attributes array into which its path in sysfs, driver, and the serial number,
+    * manufacturer and product strings of its USB device are written
+    * @return false if there is no such tty
+    * @throws UnsupportedOperationException if sysfs is not available on the current platform
+    */
+  @native def info(name: String, ids: Array[Int], attributes: Array[String]): Boolean
+
+}
@@ -0,0 +1,76 @@
+package akka.serial
+package sync
+
+import ch.jodersky.jni.nativeLoader
+
+/**
+  * Low-level wrapper of a native reactor, which multiplexes readiness of many serial ports.
+  *
+  * WARNING: as with `UnsafeSerial`, methods in this class deal with pointers, which are NOT
+  * checked for correctness.
+  *
+  * See SerialReactor for a higher-level, more secured wrapper.
+  *
+  * @param reactorAddr address of natively allocated reactor structure
+  */
+@nativeLoader("akkaserial1")
+private[serial] class UnsafeReactor(final val reactorAddr: Long) {
+
+  /**
+    * Registers a serial port with this reactor.
+    *
+    * @param serialAddr address of natively allocated serial configuration structure
+    * @param token non-zero value that will be reported when the port becomes readable
+    * @throws IOException on IO error
+    */
+  @native def register(serialAddr: Long, token: Long): Unit
+
+  /**
+    * Removes a serial port from this reactor.
+    *
+    * @param serialAddr address of natively allocated serial configuration structure
+    * @throws IOException on IO error
+    */
+  @native def unregister(serialAddr: Long): Unit
+
+  /**
+    * Waits until at least one registered port is readable.
+    *
+    * The wait is blocking, however it may be interrupted by calling cancel().
+    *
+    * @param tokens array into which the tokens of readable ports are written
+    * @return number of tokens written
+    * @throws PortInterruptedException if the call to this function was interrupted
+    * @throws IOException on IO error
+    */
+  @native def await(tokens: Array[Long]): Int
+
+  /**
+    * Cancels any current and future call to await(). This function may be called from any thread.
+    *
+    * @throws IOException on IO error
+    */
+  @native def cancel(): Unit
+
+  /**
+    * Closes this reactor. Natively allocated resources are freed and the reactor pointer becomes
+    * invalid, therefore this function should only be called ONCE per reactor.
+    *
+    * @throws IOException on IO error
+    */
+  @native def close(): Unit
+
+}
+
+private[serial] object UnsafeReactor {
+
+  /**
+    * Opens a new reactor.
+    *
+    * @return address of natively allocated reactor structure
+    * @throws UnsupportedOperationException if reactors are not available on the current platform
+    * @throws IOException on IO error
+    */
+  @native def open(): Long
+
+}
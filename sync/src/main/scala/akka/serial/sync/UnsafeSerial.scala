@@ -15,15 +15,88 @@ import ch.jodersky.jni.nativeLoader
   * See SerialConnection for a higher-level, more secured wrapper
   * of serial communication.
   *
+  * Calls are made through a binding, which takes the address of the serial configuration as an
+  * argument, rather than having the native backend look up `serialAddr` through reflection on
+  * every call. The JNI binding is implemented by the companion object.
+  *
   * @param serialAddr address of natively allocated serial configuration structure
+  * @param natives binding through which the port has been opened
   */
 @nativeLoader("akkaserial1")
-private[serial] class UnsafeSerial(final val serialAddr: Long) {
+private[serial] class UnsafeSerial(final val serialAddr: Long, final val natives: NativeBinding) {
+
+  def this(serialAddr: Long) = this(serialAddr, UnsafeSerial)
 
   final val ParityNone: Int = 0
   final val ParityOdd: Int = 1
   final val ParityEven: Int = 2
 
+  /**
+    * Configures how reads coalesce data that arrives in small chunks. By default, a read returns
+    * as soon as any data is available.
+    *
+    * @param minSize minimum number of bytes returned by a read, 0 for none
+    * @param timeout inter-byte timeout in milliseconds after which a read returns whatever data
+    * it has, 0 for none
+    * @throws IOException on IO error
+    */
+  def setReadCoalescing(minSize: Int, timeout: Int): Unit = natives.setReadCoalescing(serialAddr, minSize, timeout)
+
+  /**
+    * Sets the flow control of this port.
+    *
+    * @param flow id of a kind of flow control, see `FlowControl`
+    * @throws InvalidSettingsException if the kind of flow control is not supported
+    * @throws IOException on IO error
+    */
+  def setFlowControl(flow: Int): Unit = natives.setFlowControl(serialAddr, flow)
+
+  /**
+    * Suspends or resumes reading from this port. While suspended, read() and reactors do not wait
+    * for received data and tryRead() reads none, however transmit queues are still drained. This
+    * function may be called from any thread.
+    *
+    * @param suspended set to suspend reading, clear to resume it
+    * @throws IOException on IO error
+    */
+  def suspendReading(suspended: Boolean): Unit = natives.suspendReading(serialAddr, suspended)
+
+  /**
+    * Sets the framing of data received by this port, after which every read returns one whole
+    * frame. Frames accumulated under a previous framing are dropped. This function must not be
+    * called while a read is in progress, and framing cannot be combined with receive rings.
+    *
+    * @param framing framing to apply, `Framing.None` to return data as it arrives
+    * @throws InvalidSettingsException if the framing is invalid
+    * @throws IOException on IO error
+    */
+  def setFraming(framing: Framing): Unit = framing match {
+    case Framing.Checked(Framing.None | _: Framing.Checked, _, _, _) =>
+      throw new InvalidSettingsException("Checksums apply to frames of another framing")
+    case Framing.Checked(framed, checksum, offset, bigEndian) =>
+      setFraming(framed, checksum.id, offset, bigEndian)
+    case _ =>
+      setFraming(framing, UnsafeSerial.ChecksumNone, 0, false)
+  }
+
+  private def setFraming(framing: Framing, checksum: Int, checksumOffset: Int, checksumBigEndian: Boolean): Unit =
+    framing match {
+      case Framing.Delimiter(delimiter, maxSize, strip) =>
+        natives.setFraming(serialAddr, UnsafeSerial.FramingDelimiter, maxSize, delimiter.toArray, strip, 0, 0, false, 0,
+          checksum, checksumOffset, checksumBigEndian, 0)
+      case Framing.LengthPrefixed(maxSize, offset, width, bigEndian, adjustment) =>
+        natives.setFraming(serialAddr, UnsafeSerial.FramingLength, maxSize, null, false, offset, width, bigEndian,
+          adjustment, checksum, checksumOffset, checksumBigEndian, 0)
+      case Framing.Fixed(size) =>
+        natives.setFraming(serialAddr, UnsafeSerial.FramingFixed, size, null, false, 0, 0, false, 0,
+          checksum, checksumOffset, checksumBigEndian, 0)
+      case Framing.Gap(maxSize, gap) =>
+        natives.setFraming(serialAddr, UnsafeSerial.FramingGap, maxSize, null, false, 0, 0, false, 0,
+          checksum, checksumOffset, checksumBigEndian, gap.toMicros.toInt)
+      case _ =>
+        natives.setFraming(serialAddr, UnsafeSerial.FramingNone, 0, null, false, 0, 0, false, 0, 0, 0, false, 0)
+    }
+
   /**
     * Reads from a previously opened serial port into a direct ByteBuffer. Note that data is only
     * read into the buffer's allocated memory, its position or limit are not changed.
@@ -32,12 +105,144 @@ private[serial] class UnsafeSerial(final val serialAddr: Long) {
     * serial port.
     *
     * @param buffer direct ByteBuffer to read into
-    * @return number of bytes actually read
+    * @return number of bytes actually read, 0 if the transmit queue has been drained after a
+    * write was not completely accepted
     * @throws IllegalArgumentException if the ByteBuffer is not direct
     * @throws PortInterruptedException if the call to this function was interrupted
+    * @throws InvalidSettingsException if the next frame does not fit into the buffer, the frame
+    * is dropped
     * @throws IOException on IO error
     */
-  @native def read(buffer: ByteBuffer): Int
+  def read(buffer: ByteBuffer): Int = natives.read(serialAddr, buffer)
+
+  /**
+    * Reads data that is immediately available from a previously opened serial port into a direct
+    * ByteBuffer. As with read(), the buffer's position or limit are not changed.
+    *
+    * This method never blocks, it is intended to be called once a port is known to be readable,
+    * e.g. after it has been reported by a reactor.
+    *
+    * @param buffer direct ByteBuffer to read into
+    * @return number of bytes actually read, 0 if no data is available
+    * @throws IllegalArgumentException if the ByteBuffer is not direct
+    * @throws InvalidSettingsException if the next frame does not fit into the buffer, the frame
+    * is dropped
+    * @throws IOException on IO error
+    */
+  def tryRead(buffer: ByteBuffer): Int = natives.tryRead(serialAddr, buffer)
+
+  /**
+    * Checks whether this port's transmit queue has been drained after a write was not completely
+    * accepted, as read() reports by returning 0. Since tryRead() also returns 0 if no data is
+    * available, this is checked after it instead. A drain is only reported once.
+    *
+    * @return true if the transmit queue has been drained since this was last checked
+    */
+  def takeDrained(): Boolean = natives.takeDrained(serialAddr)
+
+  /**
+    * Gets the time at which the data returned by the last successful read() or tryRead() was
+    * read from the operating system. This function is not thread-safe, it is intended to be
+    * called by the reading thread after a read.
+    *
+    * @return time in nanoseconds, see `UnsafeSerial.timestamp()`, 0 if nothing has been read
+    */
+  def readTimestamp(): Long = natives.readTimestamp(serialAddr)
+
+  /**
+    * Reads from a previously opened serial port into a registered buffer, see read(ByteBuffer).
+    * The buffer's address and capacity are not looked up again.
+    *
+    * @param buffer registered buffer to read into
+    * @return number of bytes actually read, see read(ByteBuffer)
+    * @throws PortInterruptedException if the call to this function was interrupted
+    * @throws IOException on IO error
+    */
+  def read(buffer: UnsafeSerial.RegisteredBuffer): Int =
+    natives.readAddress(serialAddr, buffer.address, buffer.capacity)
+
+  /**
+    * Reads data that is immediately available into a registered buffer, see tryRead(ByteBuffer).
+    *
+    * @param buffer registered buffer to read into
+    * @return number of bytes actually read, 0 if no data is available
+    * @throws IOException on IO error
+    */
+  def tryRead(buffer: UnsafeSerial.RegisteredBuffer): Int =
+    natives.tryReadAddress(serialAddr, buffer.address, buffer.capacity)
+
+  /**
+    * Reads into a range of a registered buffer, see read(UnsafeSerial.RegisteredBuffer).
+    *
+    * @param buffer registered buffer to read into
+    * @param offset index of the first byte of the range
+    * @param length number of bytes of the range, i.e. the maximum number of bytes read
+    * @return number of bytes actually read, see read(ByteBuffer)
+    * @throws IllegalArgumentException if the range is not within the buffer
+    * @throws PortInterruptedException if the call to this function was interrupted
+    * @throws IOException on IO error
+    */
+  def read(buffer: UnsafeSerial.RegisteredBuffer, offset: Int, length: Int): Int = {
+    buffer.checkRange(offset, length)
+    natives.readAddress(serialAddr, buffer.address + offset, length)
+  }
+
+  /**
+    * Reads data that is immediately available into a range of a registered buffer, see
+    * tryRead(UnsafeSerial.RegisteredBuffer).
+    *
+    * @param buffer registered buffer to read into
+    * @param offset index of the first byte of the range
+    * @param length number of bytes of the range, i.e. the maximum number of bytes read
+    * @return number of bytes actually read, 0 if no data is available
+    * @throws IllegalArgumentException if the range is not within the buffer
+    * @throws IOException on IO error
+    */
+  def tryRead(buffer: UnsafeSerial.RegisteredBuffer, offset: Int, length: Int): Int = {
+    buffer.checkRange(offset, length)
+    natives.tryReadAddress(serialAddr, buffer.address + offset, length)
+  }
+
+  /**
+    * Reads data that is immediately available into a range of a byte array, see
+    * tryRead(ByteBuffer). Data is read straight into the array, which is pinned during the read;
+    * there is no blocking counterpart, since an array must not stay pinned while a read waits.
+    *
+    * @param array array to read into
+    * @param offset index of the first byte of the range
+    * @param length number of bytes of the range, i.e. the maximum number of bytes read
+    * @return number of bytes actually read, 0 if no data is available
+    * @throws IllegalArgumentException if the range is not within the array
+    * @throws InvalidSettingsException if the next frame does not fit into the range, the frame
+    * is dropped
+    * @throws IOException on IO error
+    */
+  def tryRead(array: Array[Byte], offset: Int, length: Int): Int =
+    natives.tryReadArray(serialAddr, array, offset, length)
+
+  /**
+    * Reads from a previously opened serial port into a receive ring, until an event has to be
+    * reported to the ring's consumer (see `ReceiveRing`). The transmit queue is drained while
+    * waiting, as with read().
+    *
+    * The call is blocking, however it may be interrupted by calling cancelRead() on the given
+    * serial port.
+    *
+    * @param ring direct ByteBuffer of a `ReceiveRing`
+    * @return a bitmask of `ReceiveRing.DataAvailable` and `ReceiveRing.TransmitDrained`
+    * @throws IllegalArgumentException if the ByteBuffer is not direct
+    * @throws PortInterruptedException if the call to this function was interrupted
+    * @throws IOException on IO error
+    */
+  def fill(ring: ByteBuffer): Int = natives.fill(serialAddr, ring)
+
+  /**
+    * Wakes up a call to fill() that is waiting for space in its ring. This function may be called
+    * from any thread.
+    *
+    * @throws IOException on IO error
+    */
+  def wakeRing(): Unit = natives.wakeRing(serialAddr)
 
   /**
     * Cancels a read (any caller to read or readDirect will return with a
@@ -46,24 +251,127 @@ private[serial] class UnsafeSerial(final val serialAddr: Long) {
     * @param serial address of natively allocated serial configuration structure
     * @throws IOException on IO error
     */
-  @native def cancelRead(): Unit
+  def cancelRead(): Unit = natives.cancelRead(serialAddr)
 
   /**
     * Writes data from a direct ByteBuffer to a previously opened serial port. Note that data is
     * only taken from the buffer's allocated memory, its position or limit are not changed.
     *
     * The write is non-blocking, this function returns as soon as the data is copied into the kernel's
-    * transmission buffer.
+    * transmission buffer or, if that is full, into the port's transmit queue. The queue is drained
+    * by a thread waiting on the port, either in read() or in a reactor.
     *
     * @param serial address of natively allocated serial configuration structure
     * @param buffer direct ByteBuffer from which data is taken
     * @param length actual amount of data that should be taken from the buffer (this is needed since the native
     * backend does not provide a way to query the buffer's current limit)
-    * @return number of bytes actually written
+    * @return number of bytes actually accepted, less than length if the transmit queue is full
     * @throws IllegalArgumentException if the ByteBuffer is not direct
     * @throws IOException on IO error
     */
-  @native def write(buffer: ByteBuffer, length: Int): Int
+  def write(buffer: ByteBuffer, length: Int): Int = natives.write(serialAddr, buffer, length)
+
+  /**
+    * Writes data from a registered buffer, see write(ByteBuffer, Int).
+    *
+    * @param buffer registered buffer from which data is taken
+    * @param length amount of data that should be taken from the buffer
+    * @return number of bytes actually accepted, less than length if the transmit queue is full
+    * @throws IOException on IO error
+    */
+  def write(buffer: UnsafeSerial.RegisteredBuffer, length: Int): Int =
+    natives.writeAddress(serialAddr, buffer.address, math.min(length, buffer.capacity))
+
+  /**
+    * Writes data from several ByteBuffers to a previously opened serial port, in a single system
+    * call where possible (gather write). Unlike write(), the data of each buffer is taken from
+    * between its position and limit, however positions are not changed either.
+    *
+    * Both direct and heap buffers, including read-only ones, are supported. Heap buffers are not
+    * copied, their backing arrays are pinned for the duration of the write.
+    *
+    * @param buffers ByteBuffers from which data is taken, in order
+    * @return number of bytes actually accepted, less than the total of all buffers if the
+    * transmit queue is full
+    * @throws IOException on IO error
+    */
+  def writev(buffers: Array[ByteBuffer]): Int = natives.writev(serialAddr, buffers)
+
+  /**
+    * Waits until all data written to this port has been transmitted, including data in its
+    * transmit queue (which must be drained by a thread waiting on the port meanwhile).
+    *
+    * The call is blocking, however it may be interrupted by calling cancelRead() on the given
+    * serial port.
+    *
+    * @return time at which the port was found drained, see `UnsafeSerial.timestamp()`
+    * @throws PortInterruptedException if the call to this function was interrupted
+    * @throws IOException on IO error
+    */
+  def drain(): Long = natives.drain(serialAddr)
+
+  /**
+    * Gets the engine used to read from this port.
+    *
+    * @return id of an engine, see `Engine`
+    */
+  def engine(): Int = natives.readEngine(serialAddr)
+
+  /**
+    * Gets the baud rate actually used by this port, as reported by its driver.
+    *
+    * @return baud rate
+    * @throws IOException on IO error
+    */
+  def speed(): Int = natives.speed(serialAddr)
+
+  /**
+    * Gets the number of bytes received by this port that have not yet been read.
+    *
+    * @return depth of the kernel's receive queue
+    * @throws IOException on IO error
+    */
+  def inputQueued(): Int = natives.inputQueued(serialAddr)
+
+  /**
+    * Gets the number of bytes written to this port that have not yet been transmitted, including
+    * data in the port's transmit queue.
+    *
+    * @return depth of the kernel's and the port's transmit queues
+    * @throws IOException on IO error
+    */
+  def outputQueued(): Int = natives.outputQueued(serialAddr)
+
+  /**
+    * Gets statistics of this port, counted since it was opened.
+    *
+    * @return counts of transfers and, if the port's driver counts them, of errors on the line
+    * @throws IOException on IO error
+    */
+  def stats(): SerialStats = {
+    val values = new Array[Long](UnsafeSerial.StatsValues)
+    natives.stats(serialAddr, values)
+    val errors = if (values(6) < 0) None else Some(
+      SerialStats.LineErrors(values(6), values(7), values(8), values(9), values(10))
+    )
+    SerialStats(values(0), values(1), values(2), values(3), values(4), values(5), errors)
+  }
+
+  /**
+    * Tunes this port for low latency, as far as its driver supports it.
+    *
+    * @return a bitmask of the settings found in effect, `LowLatencyAsync` and `LowLatencyTimer`
+    * @throws IOException if a setting supported by the driver could not be applied
+    */
+  def lowLatency(): Int = natives.lowLatency(serialAddr)
+
+  /**
+    * Gets the latency timer of the USB adapter behind this port.
+    *
+    * @return latency timer in milliseconds, -1 if the port has none
+    * @throws IOException on IO error
+    */
+  def latencyTimer(): Int = natives.latencyTimer(serialAddr)
 
   /**
     * Closes an previously open serial port. Natively allocated resources are freed and the serial
@@ -76,11 +384,73 @@ private[serial] class UnsafeSerial(final val serialAddr: Long) {
     * @param serial address of natively allocated serial configuration structure
     * @throws IOException on IO error
     */
-  @native def close(): Unit
+  def close(): Unit = natives.close(serialAddr)
 
 }
 
-private[serial] object UnsafeSerial {
+private[serial] object UnsafeSerial extends NativeBinding {
+
+  /** The driver's low-latency flag has been set, see `lowLatency()`. */
+  final val LowLatencyAsync: Int = 1
+
+  /** The adapter's latency timer has been set to its minimum, see `lowLatency()`. */
+  final val LowLatencyTimer: Int = 2
+
+  /** Number of values filled in by `stats()`, in the order of the fields of `serial_stats`. */
+  final val StatsValues: Int = 11
+
+  // kernels used to scan for delimiters, see `scanKernel()`
+  final val ScanAuto: Int = 0
+  final val ScanScalar: Int = 1
+  final val ScanSse2: Int = 2
+  final val ScanAvx2: Int = 3
+
+  // kinds of framing, see `setFraming()`
+  final val FramingNone: Int = 0
+  final val FramingDelimiter: Int = 1
+  final val FramingLength: Int = 2
+  final val FramingFixed: Int = 3
+  final val FramingGap: Int = 4
+
+  /** No checksum is verified, see `setFraming()`. Other checksums are the ids of `Checksum`. */
+  final val ChecksumNone: Int = 0
+
+  // kernels used to compute checksums, see `checksumKernel()`
+  final val ChecksumAuto: Int = 0
+  final val ChecksumTable: Int = 1
+  final val ChecksumSlice8: Int = 2
+  final val ChecksumPclmul: Int = 3
+
+  /**
+    * A direct ByteBuffer whose native address has been looked up once, so that reads and writes
+    * through it skip the lookup. The buffer is referenced for as long as this registration is, which
+    * keeps its memory from being freed.
+    *
+    * @param buffer the registered buffer
+    * @param address native address of the buffer's memory
+    */
+  final class RegisteredBuffer private[UnsafeSerial] (val buffer: ByteBuffer, val address: Long) {
+    /** Capacity of the registered buffer, the maximum size of a read. */
+    val capacity: Int = buffer.capacity
+
+    private[sync] def checkRange(offset: Int, length: Int): Unit =
+      require(offset >= 0 && length >= 0 && offset <= capacity - length, "range is out of buffer bounds")
+  }
+
+  /**
+    * Registers a direct ByteBuffer for repeated reads and writes.
+    *
+    * @param buffer direct ByteBuffer to register
+    * @throws IllegalArgumentException if the ByteBuffer is not direct
+    */
+  def register(buffer: ByteBuffer): RegisteredBuffer = new RegisteredBuffer(buffer, address(buffer))
+
+  /**
+    * Gets the native address of a direct ByteBuffer.
+    *
+    * @throws IllegalArgumentException if the ByteBuffer is not direct
+    */
+  @native private[sync] def address(buffer: ByteBuffer): Long
 
   /**
     * Opens a serial port.
@@ -98,7 +468,84 @@ private[serial] object UnsafeSerial {
     */
   @native def open(port: String, baud: Int, characterSize: Int, twoStopBits: Boolean, parity: Int): Long
 
-   /**
+  /**
+    * Sets the engine used to read from subsequently opened ports. Ports fall back to polling if
+    * the engine is not available on the running system.
+    *
+    * @param value id of an engine, see `Engine`
+    * @throws InvalidSettingsException if the engine is not known
+    */
+  @native def engine(value: Int): Unit
+
+  /**
+    * Sets the directory under which sysfs is mounted, used to look up attributes of ports.
+    *
+    * @param value path of sysfs, "/sys" by default
+    * @throws InvalidSettingsException if the path is too long
+    */
+  @native def sysfsRoot(value: String): Unit
+
+  /**
+    * Finds delimiters in a ByteBuffer, between its position and its limit. The buffer's position
+    * and limit are not changed. Direct buffers and buffers backed by an array, including read-only
+    * ones, are supported.
+    *
+    * @param buffer ByteBuffer to scan
+    * @param first a byte to search for
+    * @param second another byte to search for, the same as `first` to search for a single one
+    * @param positions array into which the indices in the buffer of bytes equal to `first` or
+    * `second` are stored, in ascending order
+    * @return number of indices stored; if the array is full, more delimiters may follow the last
+    * @throws IllegalArgumentException if the buffer is neither direct nor backed by an array
+    * @throws UnsupportedOperationException if the arrays of heap buffers cannot be accessed
+    */
+  @native def scan(buffer: ByteBuffer, first: Byte, second: Byte, positions: Array[Int]): Int
+
+  /**
+    * Selects the kernel used to scan for delimiters, by default the fastest one supported by the
+    * running CPU. This is intended for benchmarks.
+    *
+    * @param value one of the `Scan*` kernels
+    * @return the kernel selected, `ScanAuto` is resolved to an actual kernel
+    * @throws UnsupportedOperationException if the kernel is not supported by the running CPU
+    * @throws InvalidSettingsException if the kernel is not known
+    */
+  @native def scanKernel(value: Int): Int
+
+  /**
+    * Computes a checksum of the data of a ByteBuffer, between its position and its limit. The
+    * buffer's position and limit are not changed. Direct buffers and buffers backed by an array,
+    * including read-only ones, are supported.
+    *
+    * @param kind id of a checksum, see `Checksum`
+    * @param buffer ByteBuffer to checksum
+    * @return the checksum, as an unsigned value
+    * @throws InvalidSettingsException if the checksum is not known
+    * @throws IllegalArgumentException if the buffer is neither direct nor backed by an array
+    * @throws UnsupportedOperationException if the arrays of heap buffers cannot be accessed
+    */
+  @native def checksum(kind: Int, buffer: ByteBuffer): Long
+
+  /**
+    * Selects the kernel used to compute checksums, by default the fastest one supported by the
+    * running CPU. `ChecksumPclmul` only accelerates CRC-32, other checksums are then computed as
+    * with `ChecksumSlice8`. This is intended for benchmarks.
+    *
+    * @param value one of the `Checksum*` kernels
+    * @return the kernel selected, `ChecksumAuto` is resolved to an actual kernel
+    * @throws UnsupportedOperationException if the kernel is not supported by the running CPU
+    * @throws InvalidSettingsException if the kernel is not known
+    */
+  @native def checksumKernel(value: Int): Int
+
+  /**
+    * Gets the current time of the clock used for timestamps reported by the native backend.
+    *
+    * @return time in nanoseconds of the monotonic clock
+    */
+  @native def timestamp(): Long
+
+  /**
     * Sets native debugging mode. If debugging is enabled, detailed error messages
     * are printed (to stderr) from native method calls.
     *
@@ -106,4 +553,38 @@ private[serial] object UnsafeSerial {
     */
   @native def debug(value: Boolean): Unit
 
+  /*
+   * JNI binding, see `NativeBinding`.
+   */
+  def binding: Binding.Binding = Binding.Jni
+
+  @native def setReadCoalescing(serial: Long, minSize: Int, timeout: Int): Unit
+  @native def setFlowControl(serial: Long, flow: Int): Unit
+  @native def suspendReading(serial: Long, suspended: Boolean): Unit
+  @native def setFraming(serial: Long, kind: Int, maxSize: Int, delimiter: Array[Byte], stripDelimiter: Boolean,
+    lengthOffset: Int, lengthWidth: Int, bigEndian: Boolean, lengthAdjustment: Int,
+    checksum: Int, checksumOffset: Int, checksumBigEndian: Boolean, gap: Int): Unit
+  @native def read(serial: Long, buffer: ByteBuffer): Int
+  @native def readAddress(serial: Long, address: Long, size: Int): Int
+  @native def tryRead(serial: Long, buffer: ByteBuffer): Int
+  @native def tryReadAddress(serial: Long, address: Long, size: Int): Int
+  @native def tryReadArray(serial: Long, array: Array[Byte], offset: Int, length: Int): Int
+  @native def takeDrained(serial: Long): Boolean
+  @native def readTimestamp(serial: Long): Long
+  @native def fill(serial: Long, ring: ByteBuffer): Int
+  @native def wakeRing(serial: Long): Unit
+  @native def cancelRead(serial: Long): Unit
+  @native def write(serial: Long, buffer: ByteBuffer, length: Int): Int
+  @native def writeAddress(serial: Long, address: Long, length: Int): Int
+  @native def writev(serial: Long, buffers: Array[ByteBuffer]): Int
+  @native def drain(serial: Long): Long
+  @native def readEngine(serial: Long): Int
+  @native def speed(serial: Long): Int
+  @native def inputQueued(serial: Long): Int
+  @native def outputQueued(serial: Long): Int
+  @native def stats(serial: Long, values: Array[Long]): Unit
+  @native def lowLatency(serial: Long): Int
+  @native def latencyTimer(serial: Long): Int
+  @native def close(serial: Long): Unit
+
 }
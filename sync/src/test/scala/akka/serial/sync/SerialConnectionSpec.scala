@@ -2,6 +2,8 @@ package akka.serial
 package sync
 
 import java.nio.ByteBuffer
+import java.nio.file.{Files, Paths}
+import scala.concurrent.duration._
 import org.scalatest._
 
 class SerialConnectionSpec extends WordSpec with PseudoTerminal {
@@ -25,6 +27,91 @@ class SerialConnectionSpec extends WordSpec with PseudoTerminal {
       }
     }
 
+    "open a port at a non-standard baud rate" in {
+      withEcho { (port, settings) =>
+        val conn = SerialConnection.open(port, settings.copy(baud = 250000))
+        try {
+          assert(conn.baud == 250000)
+        } finally {
+          conn.close()
+        }
+      }
+    }
+
+    "lower the latency timer of an adapter in low-latency mode" in {
+      withEcho { (port, settings) =>
+        // fake sysfs tree providing a latency timer for the pty
+        val root = Files.createTempDirectory("akka-serial-sysfs")
+        val name = Paths.get(port).toRealPath().getFileName.toString
+        val device = Files.createDirectories(root.resolve(s"class/tty/$name/device"))
+        val timer = Files.write(device.resolve("latency_timer"), "16\n".getBytes)
+
+        UnsafeSerial.sysfsRoot(root.toString)
+        try {
+          val conn = SerialConnection.open(port, settings.copy(lowLatency = true))
+          try {
+            assert(conn.achieved.latencyTimer == Some(1.milli))
+          } finally {
+            conn.close()
+          }
+        } finally {
+          UnsafeSerial.sysfsRoot("/sys")
+          Files.delete(timer)
+          var dir = device
+          while (dir != root.getParent) {
+            Files.delete(dir)
+            dir = dir.getParent
+          }
+        }
+      }
+    }
+
+    "report queue depths, statistics and transmit drains" in {
+      withEchoConnection { conn =>
+        val before = SerialConnection.timestamp
+        val outBuffer = ByteBuffer.allocateDirect(64)
+        outBuffer.put("hello world".getBytes)
+        assert(conn.write(outBuffer) == 11)
+        assert(conn.awaitTransmitted() >= before)
+        assert(conn.outputQueued == 0)
+
+        var queued = 0
+        while (queued < 11) { Thread.sleep(10); queued = conn.inputQueued }
+        assert(queued == 11)
+
+        val inBuffer = ByteBuffer.allocateDirect(64)
+        assert(conn.tryRead(inBuffer) == 11)
+        assert(conn.readTimestamp >= before)
+        assert(!conn.transmitDrained)
+
+        val stats = conn.stats
+        assert(stats.bytesWritten == 11 && stats.bytesRead == 11)
+      }
+    }
+
+    "report a port to a reactor once it is readable" in {
+      withEchoConnection { conn =>
+        val reactor = new UnsafeReactor(UnsafeReactor.open())
+        try {
+          reactor.register(conn.serialAddr, 7)
+          val outBuffer = ByteBuffer.allocateDirect(64)
+          outBuffer.put("hello".getBytes)
+          conn.write(outBuffer)
+
+          val tokens = new Array[Long](4)
+          assert(reactor.await(tokens) == 1 && tokens(0) == 7)
+          reactor.unregister(conn.serialAddr)
+
+          reactor.cancel()
+          intercept[PortInterruptedException] {
+            reactor.await(tokens)
+          }
+        } finally {
+          reactor.close()
+        }
+      }
+    }
+
     "throw an exception on an invalid port" in {
       val settings = SerialSettings(baud = 115200)
       intercept[NoSuchPortException] {
@@ -56,6 +143,291 @@ class SerialConnectionSpec extends WordSpec with PseudoTerminal {
       }
     }
 
+    "read into and write from alternating buffers" in {
+      withEchoConnection { conn =>
+        // buffers are registered on first use, a registration must not outlive a change of buffer
+        val buffers = Seq.fill(2)(ByteBuffer.allocateDirect(64))
+        for (i <- 0 until 4) {
+          val outBuffer = buffers(i % 2)
+          outBuffer.clear()
+          outBuffer.put(s"message $i".getBytes)
+          assert(conn.write(outBuffer) == 9)
+
+          val inBuffer = buffers((i + 1) % 2)
+          var inString = ""
+          while (inString.length < 9) {
+            inBuffer.clear()
+            conn.read(inBuffer)
+            val inData = new Array[Byte](inBuffer.remaining())
+            inBuffer.get(inData)
+            inString += new String(inData)
+          }
+          assert(inString == s"message $i")
+        }
+        intercept[IllegalArgumentException] {
+          conn.tryRead(ByteBuffer.allocate(64))
+        }
+      }
+    }
+
+    "leave received data unread while reading is suspended" in {
+      withEcho { (port, settings) =>
+        val conn = SerialConnection.open(port, settings.copy(flowControl = FlowControl.Software))
+        try {
+          val outBuffer = ByteBuffer.allocateDirect(64)
+          outBuffer.put("hello world".getBytes)
+
+          conn.suspendReading(true)
+          conn.write(outBuffer)
+          Thread.sleep(100) // allow data to be echoed
+
+          val inBuffer = ByteBuffer.allocateDirect(64)
+          assert(conn.tryRead(inBuffer) == 0)
+
+          conn.suspendReading(false)
+          assert(conn.read(inBuffer) == 11)
+        } finally {
+          conn.close()
+        }
+      }
+    }
+
+    "read the same data it writes when using the io_uring engine" in {
+      UnsafeSerial.engine(Engine.IoUring.id)
+      try {
+        withEchoConnection { conn =>
+          val outBuffer = ByteBuffer.allocateDirect(64)
+          outBuffer.put("hello world".getBytes)
+          conn.write(outBuffer)
+
+          val inBuffer = ByteBuffer.allocateDirect(64)
+          conn.read(inBuffer)
+          val inData = new Array[Byte](inBuffer.remaining())
+          inBuffer.get(inData)
+
+          assert(new String(inData) == "hello world")
+        }
+      } finally {
+        UnsafeSerial.engine(Engine.Poll.id)
+      }
+    }
+
+    "read the same data it writes when using the foreign binding" in {
+      assume(NativeBinding.select(Binding.Foreign) == Binding.Foreign, "foreign binding requires JDK 22")
+      try {
+        withEchoConnection { conn =>
+          assert(conn.binding == Binding.Foreign)
+          val outBuffer = ByteBuffer.allocateDirect(64)
+          outBuffer.put("hello world".getBytes)
+          conn.write(outBuffer)
+
+          val inBuffer = ByteBuffer.allocateDirect(64)
+          conn.read(inBuffer)
+          val inData = new Array[Byte](inBuffer.remaining())
+          inBuffer.get(inData)
+
+          assert(new String(inData) == "hello world")
+          assert(conn.readTimestamp > 0)
+          intercept[IllegalArgumentException] {
+            conn.tryRead(ByteBuffer.allocate(64))
+          }
+        }
+      } finally {
+        NativeBinding.select(Binding.Jni)
+      }
+    }
+
+    "gather write direct and heap buffers" in {
+      withEchoConnection { conn =>
+        val direct = ByteBuffer.allocateDirect(64)
+        direct.put("hello".getBytes).flip()
+        val heap = ByteBuffer.wrap(" wide".getBytes)
+        val readOnly = ByteBuffer.wrap("xx world".getBytes).asReadOnlyBuffer()
+        readOnly.position(2)
+
+        assert(conn.write(Array(direct, heap, readOnly)) == 16)
+
+        val inBuffer = ByteBuffer.allocateDirect(64)
+        var inString = ""
+        while (inString.length < 16) {
+          inBuffer.clear()
+          conn.read(inBuffer)
+          val inData = new Array[Byte](inBuffer.remaining())
+          inBuffer.get(inData)
+          inString += new String(inData)
+        }
+
+        assert(inString == "hello wide world")
+      }
+    }
+
+    "read into byte arrays and fill buffers incrementally" in {
+      withEchoConnection { conn =>
+        val outBuffer = ByteBuffer.allocateDirect(64)
+        def send(data: String) = {
+          outBuffer.clear()
+          outBuffer.put(data.getBytes)
+          conn.write(outBuffer)
+        }
+
+        // data lands in the given range of the array only
+        send("hello")
+        val array = Array.fill[Byte](16)('.')
+        var n = 0
+        while (n < 5) n += conn.read(array, 4 + n, 5 - n)
+        assert(new String(array) == "....hello.......")
+        intercept[IllegalArgumentException] {
+          conn.tryRead(array, 12, 5)
+        }
+
+        // heap and direct buffers are filled between their position and limit
+        for (inBuffer <- Seq(ByteBuffer.allocate(32), ByteBuffer.allocateDirect(32))) {
+          inBuffer.position(2).limit(13)
+          for (word <- Seq("hello", " world")) {
+            send(word)
+            val position = inBuffer.position
+            while (inBuffer.position < position + word.length) conn.readInto(inBuffer)
+          }
+          assert(inBuffer.position == 13 && inBuffer.limit == 13)
+          assert(conn.tryReadInto(inBuffer) == 0)
+          inBuffer.flip().position(2)
+          val inData = new Array[Byte](inBuffer.remaining())
+          inBuffer.get(inData)
+          assert(new String(inData) == "hello world")
+        }
+        intercept[java.nio.ReadOnlyBufferException] {
+          conn.readInto(ByteBuffer.allocate(8).asReadOnlyBuffer())
+        }
+      }
+    }
+
+    "coalesce data written separately into a single read" in {
+      withEcho { (port, settings) =>
+        val conn = SerialConnection.open(port, settings.copy(readTimeout = 200.millis))
+        try {
+          val outBuffer = ByteBuffer.allocateDirect(64)
+          for (word <- Seq("hello", " ", "world")) {
+            outBuffer.clear()
+            outBuffer.put(word.getBytes)
+            conn.write(outBuffer)
+            Thread.sleep(10)
+          }
+
+          val inBuffer = ByteBuffer.allocateDirect(64)
+          conn.read(inBuffer)
+          val inData = new Array[Byte](inBuffer.remaining())
+          inBuffer.get(inData)
+
+          assert(new String(inData) == "hello world")
+        } finally {
+          conn.close()
+        }
+      }
+    }
+
+    "read whole delimited frames" in {
+      withEcho { (port, settings) =>
+        val framing = Framing.Delimiter("\n".getBytes, maxSize = 16)
+        val conn = SerialConnection.open(port, settings.copy(framing = framing))
+        try {
+          val outBuffer = ByteBuffer.allocateDirect(64)
+          for (chunk <- Seq("hel", "lo\nwor", "ld\n")) {
+            outBuffer.clear()
+            outBuffer.put(chunk.getBytes)
+            conn.write(outBuffer)
+            Thread.sleep(10)
+          }
+
+          val inBuffer = ByteBuffer.allocateDirect(64)
+          val frames = for (_ <- 0 until 2) yield {
+            inBuffer.clear()
+            conn.read(inBuffer)
+            val inData = new Array[Byte](inBuffer.remaining())
+            inBuffer.get(inData)
+            new String(inData)
+          }
+
+          assert(frames == Seq("hello", "world"))
+        } finally {
+          conn.close()
+        }
+      }
+    }
+
+    "read frames separated by silence" in {
+      withEcho { (port, settings) =>
+        val framing = Framing.Gap(maxSize = 16, gap = 50.millis)
+        val conn = SerialConnection.open(port, settings.copy(framing = framing))
+        try {
+          val outBuffer = ByteBuffer.allocateDirect(64)
+          val inBuffer = ByteBuffer.allocateDirect(64)
+          def send(chunk: String) = {
+            outBuffer.clear()
+            outBuffer.put(chunk.getBytes)
+            conn.write(outBuffer)
+          }
+          def receive() = {
+            inBuffer.clear()
+            conn.read(inBuffer)
+            val inData = new Array[Byte](inBuffer.remaining())
+            inBuffer.get(inData)
+            new String(inData)
+          }
+
+          send("hel")
+          Thread.sleep(5)
+          send("lo")
+          assert(receive() == "hello")
+          send("world")
+          assert(receive() == "world")
+        } finally {
+          conn.close()
+        }
+      }
+    }
+
+    "discard frames whose checksum does not match" in {
+      withEcho { (port, settings) =>
+        val framing = Framing.Checked(Framing.Fixed(8), Checksum.Crc16)
+        val conn = SerialConnection.open(port, settings.copy(framing = framing))
+        try {
+          val request = Array[Byte](0x01, 0x03, 0x00, 0x00, 0x00, 0x01)
+          val crc = Checksum.compute(Checksum.Crc16, ByteBuffer.wrap(request))
+          assert(crc == 0x0a84)
+          val valid = request ++ Array(crc.toByte, (crc >> 8).toByte)
+          val corrupted = valid.updated(5, 0x02.toByte)
+
+          val outBuffer = ByteBuffer.allocateDirect(64)
+          outBuffer.put(corrupted).put(valid)
+          conn.write(outBuffer)
+
+          val inBuffer = ByteBuffer.allocateDirect(64)
+          conn.read(inBuffer)
+          val inData = new Array[Byte](inBuffer.remaining())
+          inBuffer.get(inData)
+          assert(inData.toSeq == valid.toSeq)
+        } finally {
+          conn.close()
+        }
+      }
+    }
+
+    "throw an exception on invalid framing settings" in {
+      withEcho { (port, settings) =>
+        intercept[InvalidSettingsException] {
+          SerialConnection.open(port, settings.copy(framing = Framing.LengthPrefixed(maxSize = 16, width = 3)))
+        }
+      }
+    }
+
+    "throw an exception on invalid read coalescing settings" in {
+      withEcho { (port, settings) =>
+        intercept[InvalidSettingsException] {
+          SerialConnection.open(port, settings.copy(minimumRead = -1))
+        }
+      }
+    }
+
     "interrupt a read when closing a port" in {
       withEchoConnection { conn =>
         val buffer = ByteBuffer.allocateDirect(64)